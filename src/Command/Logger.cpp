@@ -29,12 +29,14 @@ Logger::Logger(const std::string& filePath) {
 }
 
 void Logger::open() {
+  std::lock_guard<std::mutex> lock{m_mutex};
   if (m_stream == nullptr) {
     m_stream = new std::ofstream(m_fileName, std::fstream::app);
   }
 }
 
 void Logger::close() {
+  std::lock_guard<std::mutex> lock{m_mutex};
   if (m_stream) {
     delete m_stream;
     m_stream = nullptr;
@@ -42,12 +44,14 @@ void Logger::close() {
 }
 
 void Logger::log(const std::string& text) {
+  std::lock_guard<std::mutex> lock{m_mutex};
   if (m_stream) {
     *m_stream << text << std::endl << std::flush;
   }
 }
 
 void Logger::appendLog(const std::string& text) {
+  std::lock_guard<std::mutex> lock{m_mutex};
   if (m_stream) {
     *m_stream << text << std::flush;
   }
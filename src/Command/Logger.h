@@ -23,6 +23,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -44,6 +45,8 @@ class Logger {
  private:
   std::ofstream* m_stream = nullptr;
   std::string m_fileName;
+  // Flows of batch_run log from their own threads
+  std::mutex m_mutex;
 };
 
 }  // namespace FOEDAG
@@ -0,0 +1,258 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "BatchRunner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <thread>
+
+#include "Compiler/Compiler.h"
+#include "Compiler/TaskManager.h"
+#include "Main/CommandLine.h"
+#include "Main/ProjectFile/ProjectFileLoader.h"
+#include "Main/Settings.h"
+#include "MainWindow/Session.h"
+#include "NewProject/ProjectManager/project_manager.h"
+#include "ProjNavigator/tcl_command_integration.h"
+#include "Tcl/TclInterpreter.h"
+#include "Utils/FileUtils.h"
+
+namespace FOEDAG {
+
+namespace {
+
+int LogCloseProc(ClientData instanceData, Tcl_Interp* interp) { return 0; }
+
+int LogOutputProc(ClientData instanceData, const char* buf, int toWrite,
+                  int* errorCodePtr) {
+  std::ostream* log = static_cast<std::ostream*>(instanceData);
+  log->write(buf, toWrite);
+  log->flush();
+  return toWrite;
+}
+
+void LogWatchProc(ClientData instanceData, int mask) {}
+
+Tcl_ChannelType logChannelType{
+    "batchlog",
+    TCL_CHANNEL_VERSION_5,
+    LogCloseProc /*ChannelClose */,
+    nullptr /*ChannelInput*/,
+    LogOutputProc,
+    nullptr /*ChannelSeek*/,
+    nullptr,
+    nullptr,
+    LogWatchProc,
+    nullptr, /*ChannelGetHandle,*/
+    nullptr /*ChannelClose2*/,
+    nullptr, /*ChannelBlockMode,*/
+    nullptr /*ChannelFlush*/,
+    nullptr /*ChannelHandler*/,
+    nullptr /*ChannelWideSeek*/,
+    nullptr /*DriverThreadAction*/,
+    nullptr /*DriverTruncate*/,
+};
+
+// Tcl keeps the standard channels per thread, the ones of a flow thread write
+// to the log of the flow. They are closed by Tcl_FinalizeThread()
+void setLogChannels(std::ostream* log) {
+  for (int type : {TCL_STDOUT, TCL_STDERR}) {
+    const char* name = (type == TCL_STDOUT) ? "stdout" : "stderr";
+    Tcl_Channel channel = Tcl_CreateChannel(
+        &logChannelType, name, static_cast<void*>(log), TCL_WRITABLE);
+    Tcl_SetChannelOption(nullptr, channel, "-translation", "lf");
+    Tcl_SetChannelOption(nullptr, channel, "-buffering", "none");
+    Tcl_RegisterChannel(nullptr, channel);
+    Tcl_SetStdChannel(channel, type);
+  }
+}
+
+// exit ends the script of the flow, not the process
+struct FlowExit {
+  bool called{false};
+  int code{0};
+};
+
+int flowExit(void* clientData, Tcl_Interp* interp, int argc,
+             const char* argv[]) {
+  FlowExit* exit = static_cast<FlowExit*>(clientData);
+  exit->called = true;
+  if (argc > 1 && Tcl_GetInt(interp, argv[1], &exit->code) != TCL_OK)
+    exit->code = 1;
+  // catch can't stop the unwinding
+  Tcl_CancelEval(interp, nullptr, nullptr, TCL_CANCEL_UNWIND);
+  return TCL_ERROR;
+}
+
+}  // namespace
+
+BatchRunner::BatchRunner(const CompilerFactory& factory, Session* session,
+                         std::ostream* out)
+    : m_factory(factory), m_session(session), m_out(out) {}
+
+void BatchRunner::AddRun(const std::filesystem::path& script,
+                         const std::filesystem::path& workingDir) {
+  Run run;
+  run.script = std::filesystem::absolute(script);
+  run.workingDir = std::filesystem::absolute(workingDir);
+  run.logFile = run.workingDir / "batch_run.log";
+  m_runs.push_back(run);
+}
+
+bool BatchRunner::Execute() {
+  // The settings constructor fills process wide tables, create the settings
+  // of the flows here
+  std::vector<std::unique_ptr<Settings>> settings;
+  for (size_t i = 0; i < m_runs.size(); i++) {
+    settings.emplace_back(new Settings);
+    if (m_session && m_session->GetSettings())
+      settings.back()->getJson() = m_session->GetSettings()->getJson();
+  }
+  size_t next{0};
+  const size_t threadCount = std::min<size_t>(m_jobs, m_runs.size());
+  size_t workers{threadCount};
+  auto worker = [this, &next, &workers, &settings]() {
+    for (;;) {
+      size_t index{0};
+      {
+        std::lock_guard<std::mutex> lock{m_flowsMutex};
+        index = next++;
+      }
+      if (index >= m_runs.size()) break;
+      if (stopRequested()) {
+        message("[run " + std::to_string(index + 1) + "] skipped");
+        continue;
+      }
+      // Tcl keeps its state per thread, so every flow gets a thread of its own
+      std::thread flow{[this, index, &settings]() {
+        execute(m_runs[index], index, settings[index].get());
+      }};
+      flow.join();
+    }
+    std::lock_guard<std::mutex> lock{m_flowsMutex};
+    workers--;
+    m_flowsChanged.notify_all();
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < threadCount; i++) threads.emplace_back(worker);
+  {
+    // Wait for the workers, stopping the running flows on request
+    std::unique_lock<std::mutex> lock{m_flowsMutex};
+    bool stopped{false};
+    while (workers != 0) {
+      m_flowsChanged.wait_for(lock, std::chrono::milliseconds{100});
+      if (stopped || !stopRequested()) continue;
+      for (Compiler* compiler : m_flows) compiler->Stop();
+      stopped = true;
+    }
+  }
+  for (auto& thread : threads) thread.join();
+
+  bool result{true};
+  for (const auto& run : m_runs) result &= (run.status == 0);
+  return result;
+}
+
+void BatchRunner::execute(Run& run, size_t index, Settings* settings) {
+  const std::string runId{"[run " + std::to_string(index + 1) + "/" +
+                          std::to_string(m_runs.size()) + "] "};
+  FileUtils::MkDirs(run.workingDir);
+  std::ofstream log{run.logFile};
+  message(runId + run.script.string() + " started in " +
+          run.workingDir.string());
+  auto start = std::chrono::steady_clock::now();
+  run.status = runFlow(run, settings, log);
+  run.duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  message(runId + run.script.filename().string() +
+          ((run.status == 0) ? " passed" : " failed") + " in " +
+          std::to_string(run.duration) + " ms, log: " + run.logFile.string());
+  // Releases the channels and data Tcl keeps for this thread
+  Tcl_FinalizeThread();
+}
+
+int BatchRunner::runFlow(const Run& run, Settings* settings,
+                         std::ostream& log) {
+  // Everything below belongs to this flow and lives on this thread
+  Project project;
+  Project::Scope scope{&project};
+  setLogChannels(&log);
+  ProjectManager projectManager;
+  std::unique_ptr<Compiler> compiler{m_factory()};
+  CommandLine* cmdLine = new CommandLine{0, nullptr};
+  cmdLine->Script(run.script.string());
+  TclInterpreter* interp = new TclInterpreter;
+  // Owns the interpreter and the command line
+  Session session{nullptr,
+                  interp,
+                  nullptr,
+                  cmdLine,
+                  m_session ? m_session->Context() : nullptr,
+                  compiler.get(),
+                  settings};
+  compiler->SetOutStream(&log);
+  compiler->SetErrStream(&log);
+  compiler->WorkingDir(run.workingDir);
+  compiler->setGuiTclSync(new TclCommandIntegration{&projectManager, nullptr});
+  compiler->setTaskManager(new TaskManager{compiler.get()});
+  compiler->RegisterCommands(interp, true);
+  FlowExit exit;
+  interp->registerCmd("exit", flowExit, &exit, nullptr);
+
+  ProjectFileLoader loader{&project};
+  loader.registerComponent(new ProjectManagerComponent{&projectManager},
+                           ComponentId::ProjectManager);
+  loader.registerComponent(
+      new TaskManagerComponent{compiler->GetTaskManager()},
+      ComponentId::TaskManager);
+  loader.registerComponent(new CompilerComponent{compiler.get()},
+                           ComponentId::Compiler);
+
+  {
+    std::lock_guard<std::mutex> lock{m_flowsMutex};
+    m_flows.insert(compiler.get());
+    // Started while the running flows were being stopped
+    if (stopRequested()) compiler->Stop();
+  }
+  int status{TCL_OK};
+  const std::string result = interp->evalFile(run.script.string(), &status);
+  {
+    std::lock_guard<std::mutex> lock{m_flowsMutex};
+    m_flows.erase(compiler.get());
+  }
+  if (status != TCL_OK && !exit.called) log << result << std::endl;
+  loader.Save();
+  if (exit.called) return exit.code;
+  return (status == TCL_OK) ? 0 : 1;
+}
+
+bool BatchRunner::stopRequested() const { return m_stop && m_stop(); }
+
+void BatchRunner::message(const std::string& msg) {
+  if (!m_out) return;
+  std::lock_guard<std::mutex> lock{m_outMutex};
+  (*m_out) << msg << std::endl;
+}
+
+}  // namespace FOEDAG
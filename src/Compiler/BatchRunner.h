@@ -0,0 +1,95 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace FOEDAG {
+
+class Compiler;
+class Session;
+class Settings;
+
+/*!
+ * \brief The BatchRunner class
+ * Runs independent flows (one Tcl script each) concurrently in this process
+ * with a job limit. Every flow has its own compiler, project, Tcl interpreter,
+ * working directory and log file, nothing depends on the process current
+ * path.
+ */
+class BatchRunner {
+ public:
+  // Creates the compiler of a flow, the runner owns it
+  using CompilerFactory = std::function<Compiler*()>;
+  struct Run {
+    std::filesystem::path script;
+    std::filesystem::path workingDir;
+    std::filesystem::path logFile;
+    int status{-1};
+    int64_t duration{0};  // ms
+  };
+
+  // The flows start from the tool context and settings of the session, if any
+  BatchRunner(const CompilerFactory& factory, Session* session,
+              std::ostream* out);
+
+  void Jobs(uint32_t jobs) { m_jobs = (jobs == 0) ? 1 : jobs; }
+  uint32_t Jobs() const { return m_jobs; }
+  // Pending runs are skipped and running flows stopped once it returns true
+  void StopRequested(const std::function<bool()>& stop) { m_stop = stop; }
+
+  // Add run of the script in the working directory, log goes to
+  // <workingDir>/batch_run.log
+  void AddRun(const std::filesystem::path& script,
+              const std::filesystem::path& workingDir);
+
+  // Blocks until all runs are finished. Return true if all runs passed
+  bool Execute();
+  const std::vector<Run>& Runs() const { return m_runs; }
+
+ private:
+  void execute(Run& run, size_t index, Settings* settings);
+  int runFlow(const Run& run, Settings* settings, std::ostream& log);
+  bool stopRequested() const;
+  void message(const std::string& msg);
+
+  CompilerFactory m_factory;
+  Session* m_session{nullptr};
+  std::ostream* m_out{nullptr};
+  std::mutex m_outMutex;
+  // Compilers of the running flows, stopped on request
+  std::set<Compiler*> m_flows;
+  std::mutex m_flowsMutex;
+  std::condition_variable m_flowsChanged;
+  uint32_t m_jobs{1};
+  std::function<bool()> m_stop{};
+  std::vector<Run> m_runs;
+};
+
+}  // namespace FOEDAG
@@ -35,6 +35,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <sstream>
 #include <thread>
 
+#include "Compiler/BatchRunner.h"
 #include "Compiler/Constraints.h"
 #include "Compiler/TclInterpreterHandler.h"
 #include "Compiler/WorkerThread.h"
@@ -62,6 +63,8 @@ extern FOEDAG::Session* GlobalSession;
 using namespace FOEDAG;
 using Time = std::chrono::high_resolution_clock;
 using ms = std::chrono::milliseconds;
+// console output limit of a single tool run when GUI is used
+static constexpr uint64_t kGuiConsoleCap{32 * 1024 * 1024};
 LogLevel SpeedLog::speed_logLevel = LOG_INFO;
 
 auto CreateDummyLog = [](Compiler::Action action,
@@ -138,6 +141,21 @@ Compiler::~Compiler() {
   delete m_netlistEditData;
 }
 
+Compiler* Compiler::CreateBatchCompiler() const {
+  Compiler* compiler = new Compiler;
+  CopyToolSetup(compiler);
+  return compiler;
+}
+
+void Compiler::CopyToolSetup(Compiler* compiler) const {
+  compiler->m_parserType = m_parserType;
+  compiler->m_toolOutput = m_toolOutput;
+  compiler->m_toolOutputConfigured = m_toolOutputConfigured;
+  compiler->m_programmerToolExecutablePath = m_programmerToolExecutablePath;
+  compiler->m_configFileSearchDir = m_configFileSearchDir;
+  compiler->m_environmentVariableMap = m_environmentVariableMap;
+}
+
 std::string Compiler::GetMessagePrefix() const {
   if (!GetTaskManager()) return std::string{};
   auto task = GetTaskManager()->currentTask();
@@ -387,6 +405,103 @@ bool Compiler::RegisterCommands(TclInterpreter* interp, bool batchMode) {
   };
   interp->registerCmd("script_path", script_path, this, 0);
 
+  auto batch_run = [](void* clientData, Tcl_Interp* interp, int argc,
+                      const char* argv[]) -> int {
+    // Every script runs as a flow of this process with its own compiler,
+    // project, interpreter and working directory, see BatchRunner
+    Compiler* compiler = (Compiler*)clientData;
+    uint32_t jobs{std::max(1u, std::thread::hardware_concurrency())};
+    std::filesystem::path outputDir{compiler->WorkingDir()};
+    std::vector<std::filesystem::path> scripts;
+    for (int i = 1; i < argc; i++) {
+      std::string arg{argv[i]};
+      if (arg == "-jobs" && (i < argc - 1)) {
+        auto [value, ok] = StringUtils::to_number<uint32_t>(argv[++i]);
+        if (!ok || value == 0) {
+          compiler->ErrorMessage("Wrong -jobs value: " + std::string{argv[i]});
+          return TCL_ERROR;
+        }
+        jobs = value;
+      } else if (arg == "-output_dir" && (i < argc - 1)) {
+        outputDir = compiler->WorkingDir() / argv[++i];
+      } else if (FileUtils::FileExists(compiler->WorkingDir() / arg)) {
+        scripts.push_back(compiler->WorkingDir() / arg);
+      } else {
+        compiler->ErrorMessage("Cannot open script file: " + arg);
+        return TCL_ERROR;
+      }
+    }
+    if (scripts.empty()) {
+      compiler->ErrorMessage(
+          "batch_run ?-jobs <N>? ?-output_dir <dir>? <script> ...");
+      return TCL_ERROR;
+    }
+    auto factory = [compiler]() { return compiler->CreateBatchCompiler(); };
+    BatchRunner runner{factory, compiler->GetSession(),
+                       compiler->GetOutStream()};
+    runner.Jobs(jobs);
+    runner.StopRequested([compiler]() { return compiler->m_stop; });
+    for (size_t i = 0; i < scripts.size(); i++) {
+      runner.AddRun(scripts[i],
+                    outputDir / (scripts[i].stem().string() + "_" +
+                                 std::to_string(i + 1)));
+    }
+    compiler->Message("Batch of " + std::to_string(scripts.size()) +
+                      " runs, " + std::to_string(runner.Jobs()) + " jobs");
+    bool ok = runner.Execute();
+    size_t failed{0};
+    for (const auto& run : runner.Runs()) failed += (run.status != 0) ? 1 : 0;
+    compiler->Message("Batch done: " +
+                      std::to_string(scripts.size() - failed) + " passed, " +
+                      std::to_string(failed) + " failed");
+    return ok ? TCL_OK : TCL_ERROR;
+  };
+  interp->registerCmd("batch_run", batch_run, this, 0);
+
+  auto tool_output = [](void* clientData, Tcl_Interp* interp, int argc,
+                        const char* argv[]) -> int {
+    Compiler* compiler = (Compiler*)clientData;
+    auto options = compiler->m_toolOutput;
+    for (int i = 1; i < argc; i++) {
+      std::string arg{argv[i]};
+      if (i == argc - 1) {
+        compiler->ErrorMessage("Missing value for " + arg);
+        return TCL_ERROR;
+      }
+      std::string value{argv[++i]};
+      auto [number, ok] = StringUtils::to_number<uint64_t>(value);
+      if (arg == "-mode" && (value == "full" || value == "tail")) {
+        options.mode = (value == "tail") ? ToolOutputStream::ConsoleMode::Tail
+                                         : ToolOutputStream::ConsoleMode::Full;
+      } else if (arg == "-max_size" && ok) {
+        options.consoleCap = number;
+      } else if (arg == "-tail_size" && ok) {
+        options.tailSize = number;
+      } else if (arg == "-flush_interval" && ok) {
+        options.flushInterval = static_cast<uint32_t>(number);
+      } else {
+        compiler->ErrorMessage("Wrong tool_output option: " + arg + " " +
+                               value);
+        return TCL_ERROR;
+      }
+    }
+    if (argc > 1) {
+      compiler->m_toolOutput = options;
+      compiler->m_toolOutputConfigured = true;
+    }
+    std::string result{
+        "-mode " +
+        std::string{(options.mode == ToolOutputStream::ConsoleMode::Tail)
+                        ? "tail"
+                        : "full"} +
+        " -max_size " + std::to_string(options.consoleCap) + " -tail_size " +
+        std::to_string(options.tailSize) + " -flush_interval " +
+        std::to_string(options.flushInterval)};
+    Tcl_AppendResult(interp, result.c_str(), nullptr);
+    return TCL_OK;
+  };
+  interp->registerCmd("tool_output", tool_output, this, 0);
+
   auto version = [](void* clientData, Tcl_Interp* interp, int argc,
                     const char* argv[]) -> int {
     Compiler* compiler = (Compiler*)clientData;
@@ -597,7 +712,7 @@ bool Compiler::RegisterCommands(TclInterpreter* interp, bool batchMode) {
     }
     std::filesystem::path the_path = expandedFile;
     if (!the_path.is_absolute()) {
-      const auto& path = std::filesystem::current_path();
+      const auto& path = compiler->WorkingDir();
       expandedFile = std::filesystem::path(path / expandedFile).string();
     }
 
@@ -744,7 +859,7 @@ bool Compiler::RegisterCommands(TclInterpreter* interp, bool batchMode) {
     }
     std::filesystem::path the_path = expandedFile;
     if (!the_path.is_absolute()) {
-      const auto& path = std::filesystem::current_path();
+      const auto& path = compiler->WorkingDir();
       expandedFile = std::filesystem::path(path / expandedFile).string();
     }
     compiler->Message("Adding constraint file " + expandedFile);
@@ -855,14 +970,24 @@ bool Compiler::RegisterCommands(TclInterpreter* interp, bool batchMode) {
     auto ipgenerate = [](void* clientData, Tcl_Interp* interp, int argc,
                          const char* argv[]) -> int {
       Compiler* compiler = (Compiler*)clientData;
+      uint32_t jobs{std::max(1u, std::thread::hardware_concurrency())};
       for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
         if (arg == "clean") {
           compiler->IPGenOpt(Compiler::IPGenerateOpt::Clean);
+        } else if (arg == "-jobs" && (i < argc - 1)) {
+          auto [value, ok] = StringUtils::to_number<uint32_t>(argv[++i]);
+          if (!ok || value == 0) {
+            compiler->ErrorMessage("Wrong -jobs value: " +
+                                   std::string{argv[i]});
+            return TCL_ERROR;
+          }
+          jobs = value;
         } else {
           compiler->ErrorMessage("Unknown option: " + arg);
         }
       }
+      compiler->GetIPGenerator()->Jobs(jobs);
       return compiler->Compile(Action::IPGen) ? TCL_OK : TCL_ERROR;
     };
     interp->registerCmd("ipgenerate", ipgenerate, this, 0);
@@ -1166,10 +1291,19 @@ bool Compiler::RegisterCommands(TclInterpreter* interp, bool batchMode) {
     auto ipgenerate = [](void* clientData, Tcl_Interp* interp, int argc,
                          const char* argv[]) -> int {
       Compiler* compiler = (Compiler*)clientData;
+      uint32_t jobs{std::max(1u, std::thread::hardware_concurrency())};
       for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
         if (arg == "clean") {
           compiler->IPGenOpt(Compiler::IPGenerateOpt::Clean);
+        } else if (arg == "-jobs" && (i < argc - 1)) {
+          auto [value, ok] = StringUtils::to_number<uint32_t>(argv[++i]);
+          if (!ok || value == 0) {
+            compiler->ErrorMessage("Wrong -jobs value: " +
+                                   std::string{argv[i]});
+            return TCL_ERROR;
+          }
+          jobs = value;
         } else if (arg == "-modules") {
           compiler->IPGenOpt(Compiler::IPGenerateOpt::List);
           i++;
@@ -1186,6 +1320,7 @@ bool Compiler::RegisterCommands(TclInterpreter* interp, bool batchMode) {
           compiler->ErrorMessage("Unknown option: " + arg);
         }
       }
+      compiler->GetIPGenerator()->Jobs(jobs);
       std::function<void(int)> generateReport =
           std::bind(&Compiler::GenerateReport, compiler, std::placeholders::_1);
       WorkerThread* wthread =
@@ -2191,46 +2326,11 @@ bool Compiler::Compile(Action action) {
 void Compiler::GenerateReport(int action) {
   Action act = static_cast<Action>(action);
   auto files = FileUtils::FindFilesByExtension(FilePath(act), ".rpt");
+  const auto& replacer = getNetlistEditData()->InnerNet2PIOReplacer();
   for (const auto& file : files) {
-    std::ifstream ifs(file);
-    if (ifs.good()) {
-      std::stringstream buffer;
-      buffer << ifs.rdbuf();
-      ifs.close();
-      std::string contents = buffer.str();
-      for (const auto& pair :
-           getNetlistEditData()->getReversePrimaryInputMap()) {
-        contents = StringUtils::replaceAll(contents, pair.first, pair.second);
-      }
-      for (const auto& pair :
-           getNetlistEditData()->getReversePrimaryOutputMap()) {
-        contents = StringUtils::replaceAll(contents, pair.first, pair.second);
-      }
-      std::filesystem::path temporaryFile = FilePath(act) / "tmp.rpt";
-      std::ofstream ofs(temporaryFile.string());
-      if (ofs.good()) {
-        ofs << contents;
-        if (ofs.good()) {
-          ofs.close();
-
-          std::error_code ec;
-          std::filesystem::copy_file(
-              temporaryFile, file,
-              std::filesystem::copy_options::overwrite_existing, ec);
-          if (ec) {
-            qWarning() << "Failed to write data to: " << file.c_str()
-                       << ". Error: " << ec.message().c_str();
-          } else {
-            std::filesystem::remove(temporaryFile);
-          }
-        } else {
-          qWarning() << "Failed to write content to file: "
-                     << temporaryFile.c_str();
-        }
-      } else {
-        qWarning() << "Failed to open file: " << temporaryFile.c_str();
-      }
-    }
+    std::string error;
+    if (!replacer.replaceInFile(file, nullptr, &error))
+      qWarning() << error.c_str();
   }
 
   handleJsonReportGeneration(m_taskManager->task(toTaskId(action, this)),
@@ -2263,8 +2363,8 @@ bool Compiler::Analyze() {
   }
   Message("Analyzing design: " + m_projManager->projectName());
 
-  auto currentPath = std::filesystem::current_path();
-  auto it = std::filesystem::directory_iterator{currentPath};
+  std::error_code ec;
+  auto it = std::filesystem::directory_iterator{FilePath(Action::Analyze), ec};
   for (int i = 0; i < 100; i = i + 10) {
     std::stringstream outStr;
     outStr << std::setw(2) << i << "%";
@@ -2304,8 +2404,9 @@ bool Compiler::Synthesize() {
   for (auto keep : m_constraints->GetKeeps()) {
     Message("Keep name: " + keep);
   }
-  auto currentPath = std::filesystem::current_path();
-  auto it = std::filesystem::directory_iterator{currentPath};
+  std::error_code ec;
+  auto it =
+      std::filesystem::directory_iterator{FilePath(Action::Synthesis), ec};
   for (int i = 0; i < 100; i = i + 10) {
     std::stringstream outStr;
     outStr << std::setw(2) << i << "%";
@@ -2440,21 +2541,25 @@ bool Compiler::RunCompileTask(Action action) {
 
 bool Compiler::SwitchCompileContext(Action action,
                                     const std::function<bool()>& fn) {
+  // The action runs in its own working directory context: stages resolve
+  // their files against WorkingDir() and pass it to the tools they start,
+  // the process current path is left untouched
   auto compilePath = FilePath(action);
-  auto current_path = fs::current_path();
-  if (!compilePath.empty()) {
-    // make sure path exists
-    bool ok = FileUtils::MkDirs(compilePath);
-    if (ok) {
-      // switch actions context here
-      std::filesystem::current_path(compilePath);
-    }
-  }
+  if (compilePath.empty()) return fn();
+  FileUtils::MkDirs(compilePath);
+  const fs::path previous = m_workingDir;  // actions may nest
+  m_workingDir = compilePath;
   auto res = fn();
-  if (!compilePath.empty()) fs::current_path(current_path);
+  m_workingDir = previous;
   return res;
 }
 
+std::filesystem::path Compiler::WorkingDir() const {
+  if (!m_workingDir.empty()) return m_workingDir;
+  if (!m_flowDir.empty()) return m_flowDir;
+  return fs::current_path();
+}
+
 void Compiler::setTaskManager(TaskManager* newTaskManager) {
   m_taskManager = newTaskManager;
   if (m_taskManager) {
@@ -2690,7 +2795,9 @@ std::pair<bool, std::string> Compiler::CreateDesign(const std::string& name,
     if (m_projManager->HasDesign()) m_tclCmdIntegration->TclCloseProject();
 
     std::ostringstream out;
-    bool ok = m_tclCmdIntegration->TclCreateProject(name, type, cleanup, out);
+    const QString baseDir = QString::fromStdString(WorkingDir().string());
+    bool ok = m_tclCmdIntegration->TclCreateProject(name, type, cleanup, out,
+                                                    baseDir);
     output = out.str();
     if (!ok) return {false, output};
     std::string message{"Created design: " + name};
@@ -2769,17 +2876,17 @@ int Compiler::ExecuteAndMonitorSystemCommand(
   auto start = Time::now();
   PERF_LOG("Command: " + command);
   (*m_out) << "Command: " << command << std::endl;
-  std::error_code ec;
-  auto path = std::filesystem::current_path();  // getting path
-  std::filesystem::current_path(
-      workingDir.empty() ? fs::path{ProjManager()->projectPath()} : workingDir,
-      ec);  // setting path
+  // The working directory is passed to the child only, the process current
+  // path is left untouched
+  fs::path runDir =
+      workingDir.empty() ? fs::path{ProjManager()->projectPath()} : workingDir;
+  if (runDir.empty()) runDir = WorkingDir();
   // new QProcess must be created here to avoid issues related to creating
   // QObjects in different threads
   m_process = new QProcess;
-  if (!workingDir.empty()) {
-    m_process->setWorkingDirectory(QString::fromStdString(workingDir.string()));
-    FileUtils::MkDirs(workingDir);
+  if (!runDir.empty()) {
+    FileUtils::MkDirs(runDir);
+    m_process->setWorkingDirectory(QString::fromStdString(runDir.string()));
   }
   QStringList env = QProcess::systemEnvironment();
   if (!m_environmentVariableMap.empty()) {
@@ -2790,35 +2897,41 @@ int Compiler::ExecuteAndMonitorSystemCommand(
     }
   }
   m_process->setEnvironment(env);
+  ToolOutputStream::Options outputOptions{m_toolOutput};
+  if (!m_toolOutputConfigured && GetSession() && GetSession()->CmdLine() &&
+      (GetSession()->CmdLine()->WithQt() || GetSession()->CmdLine()->WithQml()))
+    outputOptions.consoleCap = kGuiConsoleCap;
+  // large buffer for the log, tools like VPR may print hundreds of MB
+  std::vector<char> logBuffer(1024 * 1024);
   std::ofstream ofs;
+  fs::path logPath{logFile};
   if (!logFile.empty()) {
     std::ios_base::openmode openMode{std::ios_base::out};
     if (appendLog) openMode = std::ios_base::out | std::ios_base::app;
-    ofs.open(logFile, openMode);
-    QObject::connect(m_process, &QProcess::readyReadStandardOutput,
-                     [this, &ofs]() {
-                       qint64 bytes = m_process->bytesAvailable();
-                       QByteArray bufout = m_process->readAllStandardOutput();
-                       ofs.write(bufout, bytes);
-                       m_out->write(bufout, bytes);
-                     });
-    QObject::connect(m_process, &QProcess::readyReadStandardError,
-                     [this, &ofs]() {
-                       QByteArray data = m_process->readAllStandardError();
-                       int bytes = data.size();
-                       ofs.write(data, bytes);
-                       m_err->write(data, bytes);
-                     });
-  } else {
-    QObject::connect(m_process, &QProcess::readyReadStandardOutput, [this]() {
-      m_out->write(m_process->readAllStandardOutput(),
-                   m_process->bytesAvailable());
-    });
-    QObject::connect(m_process, &QProcess::readyReadStandardError, [this]() {
-      QByteArray data = m_process->readAllStandardError();
-      m_err->write(data, data.size());
-    });
-  }
+    // relative log file belongs to the command working directory
+    if (logPath.is_relative()) logPath = runDir / logPath;
+    ofs.rdbuf()->pubsetbuf(logBuffer.data(), logBuffer.size());
+    ofs.open(logPath, openMode);
+  }
+  std::ostream* log = logFile.empty() ? nullptr : &ofs;
+  ToolOutputStream outStream{log, m_out, outputOptions};
+  ToolOutputStream errStream{log, m_err, outputOptions};
+  std::vector<char> chunk(64 * 1024);  // reused for every read
+  auto drain = [this, &chunk](QProcess::ProcessChannel channel,
+                              ToolOutputStream& stream) {
+    m_process->setReadChannel(channel);
+    qint64 size{0};
+    while ((size = m_process->read(chunk.data(), chunk.size())) > 0)
+      stream.write(chunk.data(), size);
+  };
+  QObject::connect(m_process, &QProcess::readyReadStandardOutput,
+                   [&drain, &outStream]() {
+                     drain(QProcess::StandardOutput, outStream);
+                   });
+  QObject::connect(m_process, &QProcess::readyReadStandardError,
+                   [&drain, &errStream]() {
+                     drain(QProcess::StandardError, errStream);
+                   });
   ProcessUtils utils;
   QObject::connect(m_process, &QProcess::started,
                    [&utils, this]() { utils.Start(m_process->processId()); });
@@ -2853,11 +2966,21 @@ int Compiler::ExecuteAndMonitorSystemCommand(
   }
 
   m_process->start(program, adjustedArgs);
-  std::filesystem::current_path(path);
-  m_process->waitForFinished(-1);
+  // wake up periodically so that console output of a quiet tool isn't held
+  const int flushInterval = std::max(outputOptions.flushInterval, 10u);
+  while (m_process->state() != QProcess::NotRunning &&
+         !m_process->waitForFinished(flushInterval)) {
+    outStream.poll();
+    errStream.poll();
+  }
+  drain(QProcess::StandardOutput, outStream);
+  drain(QProcess::StandardError, errStream);
+  outStream.finish(logPath.string());
+  errStream.finish(logPath.string());
   utils.Stop();
   // DEBUG: (*m_out) << "Changed path to: " << (path).string() << std::endl;
   uint max_utiliation{utils.Utilization()};
+  const ProcessStats& stats = utils.Stats();
   auto status = m_process->exitStatus();
   auto exitCode = m_process->exitCode();
   delete m_process;
@@ -2874,8 +2997,14 @@ int Compiler::ExecuteAndMonitorSystemCommand(
     stream << max_utiliation << " kiB";
   else
     stream << max_utiliation / 1024 << " MB";
+  stream << ". CPU: " << stats.userTime << " ms user, " << stats.systemTime
+         << " ms system. IO: " << stats.readBytes / 1024 << " kiB read, "
+         << stats.writeBytes / 1024 << " kiB written";
   m_utils.utilization = max_utiliation;
   m_utils.duration = d.count();
+  m_utils.cpuTime = stats.userTime + stats.systemTime;
+  m_utils.readBytes = stats.readBytes;
+  m_utils.writeBytes = stats.writeBytes;
   PERF_LOG(stream.str());
   return (status == QProcess::NormalExit) ? exitCode : -1;
 }
@@ -3005,7 +3134,7 @@ int Compiler::add_files(Compiler* compiler, Tcl_Interp* interp, int argc,
       }
       std::filesystem::path the_path = expandedFile;
       if (!the_path.is_absolute()) {
-        const auto& path = std::filesystem::current_path();
+        const auto& path = compiler->WorkingDir();
         expandedFile = std::filesystem::path(path / expandedFile).string();
       }
       fileList.emplace_back(expandedFile);
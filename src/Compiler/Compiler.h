@@ -45,6 +45,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <unistd.h>
 #endif
 
+#include <atomic>
 #include <filesystem>
 #include <iostream>
 #include <map>
@@ -59,6 +60,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Simulation/Simulator.h"
 #include "Task.h"
 #include "Tcl/TclInterpreter.h"
+#include "ToolOutputStream.h"
 
 class QProcess;
 namespace fs = std::filesystem;
@@ -154,6 +156,9 @@ class Compiler {
   void SetSession(Session* session) { m_session = session; }
   Session* GetSession() const { return m_session; }
   virtual ~Compiler();
+  // New compiler of the same kind with the same tools, for a flow of
+  // batch_run. The caller owns it
+  virtual Compiler* CreateBatchCompiler() const;
 
   void BatchScript(const std::string& script) { m_batchScript = script; }
   State CompilerState() const { return m_state; }
@@ -327,6 +332,13 @@ class Compiler {
       SynthesisOptimization::Mixed};
   std::filesystem::path FilePath(Action action) const;
   std::filesystem::path FilePath(Action action, const std::string& file) const;
+  // Directory relative paths of this compiler are resolved against: the
+  // directory of the running action, else the directory of the flow, else the
+  // process current path. It is passed to the tools explicitly, the current
+  // path is never changed
+  std::filesystem::path WorkingDir() const;
+  // Directory of the flow, set for the flows of batch_run
+  void WorkingDir(const std::filesystem::path& dir) { m_flowDir = dir; }
   virtual std::pair<bool, std::string> isRtlClock(const std::string& str,
                                                   bool regex, bool input_only) {
     return std::make_pair(false, std::string{});
@@ -346,6 +358,8 @@ class Compiler {
   bool DeviceFileLocal() const;
 
  protected:
+  // Copies the tool paths and options set up by main to a batch compiler
+  void CopyToolSetup(Compiler* compiler) const;
   /* Methods that can be customized for each new compiler flow */
   virtual bool IPGenerate();
   virtual bool Analyze();
@@ -404,11 +418,15 @@ class Compiler {
   TclInterpreter* m_interp = nullptr;
   Session* m_session = nullptr;
   class ProjectManager* m_projManager = nullptr;
-  bool m_stop = false;
+  // Read by batch_run worker threads
+  std::atomic<bool> m_stop{false};
   State m_state = State::None;
   std::ostream* m_out = &std::cout;
   std::ostream* m_err = &std::cerr;
   std::string m_batchScript;
+  // Directory of the running action and of the flow, see WorkingDir()
+  std::filesystem::path m_workingDir{};
+  std::filesystem::path m_flowDir{};
   std::string m_result;
   TclInterpreterHandler* m_tclInterpreterHandler{nullptr};
   TaskManager* m_taskManager{nullptr};
@@ -471,6 +489,8 @@ class Compiler {
   std::filesystem::path m_configFileSearchDir{};
   std::string m_name;
   ProcessUtilization m_utils;
+  ToolOutputStream::Options m_toolOutput;
+  bool m_toolOutputConfigured{false};
   struct ErrorState m_errorState;
   bool m_compile2bits{false};
   std::filesystem::path m_deviceFile{};
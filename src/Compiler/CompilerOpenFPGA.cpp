@@ -27,6 +27,7 @@
 #include <QTextStream>
 #include <chrono>
 #include <filesystem>
+#include <mutex>
 #include <regex>
 #include <sstream>
 #include <thread>
@@ -35,6 +36,7 @@
 #include "Configuration/CFGCommon/CFGCommon.h"
 #include "Log.h"
 #include "Main/Settings.h"
+#include "NewProject/ProjectManager/DesignFileWatcher.h"
 #include "NewProject/ProjectManager/config.h"
 #include "NewProject/ProjectManager/project_manager.h"
 #include "ProjNavigator/tcl_command_integration.h"
@@ -50,6 +52,10 @@ namespace fs = std::filesystem;
 
 using namespace FOEDAG;
 
+// The device models and model_config are process wide, flows of batch_run
+// generate their IO bitstream one after the other
+static std::mutex ioBitstreamMutex;
+
 void CompilerOpenFPGA::Version(std::ostream* out) {
   (*out) << "Foedag OpenFPGA Compiler"
          << "\n";
@@ -218,7 +224,7 @@ bool CompilerOpenFPGA::RegisterCommands(TclInterpreter* interp,
       }
       std::filesystem::path the_path = expandedFile;
       if (!the_path.is_absolute()) {
-        const auto& path = std::filesystem::current_path();
+        const auto& path = compiler->WorkingDir();
         expandedFile = std::filesystem::path(path / expandedFile).string();
       }
       stream.close();
@@ -271,7 +277,7 @@ bool CompilerOpenFPGA::RegisterCommands(TclInterpreter* interp,
     }
     std::filesystem::path the_path = expandedFile;
     if (!the_path.is_absolute()) {
-      const auto& path = std::filesystem::current_path();
+      const auto& path = compiler->WorkingDir();
       expandedFile = std::filesystem::path(path / expandedFile).string();
     }
     stream.close();
@@ -712,6 +718,51 @@ bool CompilerOpenFPGA::RegisterCommands(TclInterpreter* interp,
     return TCL_OK;
   };
   interp->registerCmd("packing_options", packing_options, this, nullptr);
+
+  auto stage_status = [](void* clientData, Tcl_Interp* interp, int argc,
+                         const char* argv[]) -> int {
+    CompilerOpenFPGA* compiler = (CompilerOpenFPGA*)clientData;
+    if (!compiler->ProjManager()->HasDesign()) {
+      compiler->ErrorMessage("Create a design first: create_design <name>");
+      return TCL_ERROR;
+    }
+    const std::string analysis =
+        compiler->FilePath(Action::Analyze).filename().string();
+    const std::string synthesis =
+        compiler->FilePath(Action::Synthesis).filename().string();
+    std::vector<std::string> stages{analysis, synthesis};
+    if (argc > 1) {
+      if (argv[1] != analysis && argv[1] != synthesis) {
+        compiler->ErrorMessage("stage_status ?" + analysis + "|" + synthesis +
+                               "?");
+        return TCL_ERROR;
+      }
+      stages = {argv[1]};
+    }
+    for (const auto& stage : stages) {
+      if (stage == analysis) {
+        // Analysis script doesn't depend on anything else, re-evaluate it
+        std::string script;
+        std::filesystem::path scriptPath;
+        std::filesystem::path outputPath;
+        compiler->DesignChangedForAnalysis(script, scriptPath, outputPath);
+      }
+      auto decision = compiler->m_fingerprints.lastDecision(stage);
+      if (!decision) {
+        compiler->Message(stage + ": not evaluated in this session");
+        continue;
+      }
+      compiler->Message(stage + ": " +
+                        (decision->stale ? "stale" : "up to date"));
+      for (const auto& reason : decision->reasons)
+        compiler->Message("    " + reason);
+      if (stages.size() == 1)
+        Tcl_AppendResult(interp, decision->stale ? "stale" : "up_to_date",
+                         nullptr);
+    }
+    return TCL_OK;
+  };
+  interp->registerCmd("stage_status", stage_status, this, nullptr);
   return true;
 }
 
@@ -777,15 +828,14 @@ bool CompilerOpenFPGA::VerifyTargetDevice() const {
 }
 
 std::filesystem::path CompilerOpenFPGA::copyLog(
-    FOEDAG::ProjectManager* projManager, const std::string& srcFileName,
+    const std::filesystem::path& logDir, const std::string& srcFileName,
     const std::string& destFileName) {
   std::filesystem::path dest{};
 
-  if (projManager) {
-    std::filesystem::path projectPath(fs::current_path());
-    std::filesystem::path src = projectPath / srcFileName;
+  if (!logDir.empty()) {
+    std::filesystem::path src = logDir / srcFileName;
     if (FileUtils::FileExists(src)) {
-      dest = projectPath / destFileName;
+      dest = logDir / destFileName;
       std::filesystem::remove(dest);
       std::filesystem::copy_file(src, dest);
     }
@@ -803,7 +853,7 @@ bool CompilerOpenFPGA::DesignChangedForAnalysis(
   synth_scrypt_path =
       FilePath(Action::Analyze, ProjManager()->projectName() + "_analyzer.cmd");
   outputFile = FilePath(Action::Analyze, "port_info.json");
-  return DesignChanged(synth_script, synth_scrypt_path, outputFile);
+  return DesignChanged(synth_script, outputFile);
 }
 
 void CompilerOpenFPGA::processCustomLayout() {
@@ -857,86 +907,141 @@ bool CompilerOpenFPGA::IPGenerate() {
   return true;
 }
 
-bool CompilerOpenFPGA::DesignChanged(
-    const std::string& synth_script,
-    const std::filesystem::path& synth_scrypt_path,
+std::string CompilerOpenFPGA::FingerprintStage(
     const std::filesystem::path& outputFile) {
-  bool result = false;
-  time_t time_netlist = FileUtils::Mtime(outputFile);
-  if (time_netlist == -1) {
-    result = true;
-  }
-  for (const auto& lang_file : ProjManager()->DesignFiles()) {
-    std::vector<std::string> tokens;
-    StringUtils::tokenize(lang_file.second, " ", tokens);
-    for (auto file : tokens) {
-      file = StringUtils::trim(file);
-      if (file.size()) {
-        time_t tf = FileUtils::Mtime(file);
-        if ((tf > time_netlist) || (tf == -1)) {
-          result = true;
-          break;
-        }
-      }
-    }
-  }
-  for (auto file : ProjManager()->getConstrFiles()) {
+  // Stage results live in their own directory (analysis, synthesis, ...)
+  auto stageDir = std::filesystem::absolute(outputFile).parent_path();
+  return stageDir.filename().string();
+}
+
+bool CompilerOpenFPGA::DesignChanged(const std::string& synth_script,
+                                     const std::filesystem::path& outputFile) {
+  const std::string projectPath = ProjManager()->projectPath();
+  m_fingerprints.setDatabaseFile(ProjectManager::implPath(projectPath) /
+                                 "stage_fingerprints.json");
+  m_fingerprints.setRootPath(projectPath);
+  StageFingerprint fingerprint;
+  // Every file is stat'ed and only re-hashed when its mtime or size changed.
+  // The watcher journal may lag behind the file system, it is only used to
+  // re-hash files modified within the mtime resolution.
+  std::set<std::string> changed;
+  WatchedFileChanges(changed);
+  for (const auto& file : changed) m_fingerprints.markChanged(file);
+  auto addInput = [&](std::string file) {
     file = StringUtils::trim(file);
-    if (file.size()) {
-      time_t tf = FileUtils::Mtime(file);
-      if ((tf > time_netlist) || (tf == -1)) {
-        result = true;
-        break;
+    if (file.empty()) return;
+    if (FileUtils::FileIsDirectory(file)) {
+      // Include and library directories: every file directly inside counts
+      std::error_code ec;
+      for (const auto& entry : fs::directory_iterator{file, ec}) {
+        if (entry.is_regular_file(ec)) {
+          fingerprint.addFile(m_fingerprints.fileKey(entry.path()),
+                              m_fingerprints.fileHash(entry.path()));
+        }
       }
+      return;
     }
+    // Missing files get an empty hash and are reported as changed
+    fingerprint.addFile(m_fingerprints.fileKey(file),
+                        m_fingerprints.fileHash(file));
+  };
+  for (const auto& lang_file : ProjManager()->DesignFiles()) {
+    std::vector<std::string> tokens;
+    StringUtils::tokenize(lang_file.second, " ", tokens);
+    for (const auto& file : tokens) addInput(file);
   }
-  for (auto path : ProjManager()->includePathList()) {
+  for (const auto& file : ProjManager()->getConstrFiles()) addInput(file);
+  for (const auto& path : ProjManager()->includePathList()) {
     std::vector<std::string> tokens;
     StringUtils::tokenize(
         FileUtils::AdjustPath(path, ProjManager()->projectPath()).string(), " ",
         tokens);
-    for (auto file : tokens) {
-      file = StringUtils::trim(file);
-      if (file.size()) {
-        time_t tf = FileUtils::Mtime(file);
-        if ((tf > time_netlist) || (tf == -1)) {
-          result = true;
-          break;
-        }
-      }
-    }
+    for (const auto& file : tokens) addInput(file);
   }
-  for (auto path : ProjManager()->libraryPathList()) {
+  for (const auto& path : ProjManager()->libraryPathList()) {
     std::vector<std::string> tokens;
     StringUtils::tokenize(
         FileUtils::AdjustPath(path, ProjManager()->projectPath()).string(), " ",
         tokens);
-    for (auto file : tokens) {
-      file = StringUtils::trim(file);
-      if (file.size()) {
-        time_t tf = FileUtils::Mtime(file);
-        if ((tf > time_netlist) || (tf == -1)) {
-          result = true;
-          break;
-        }
-      }
-    }
-  }
+    for (const auto& file : tokens) addInput(file);
+  }
+  // Script refers to design files by absolute path, hash it independently of
+  // the project location
+  fingerprint.addScript(FingerprintDatabase::textHash(
+      projectPath.empty() ? synth_script
+                          : StringUtils::replaceAll(synth_script, projectPath,
+                                                    "${PROJECT_PATH}")));
+  std::string stage = FingerprintStage(outputFile);
+  const auto tool = (stage == FilePath(Action::Analyze).filename().string())
+                        ? AnalyzeExecutablePath()
+                        : m_yosysExecutablePath;
+  fingerprint.addTool(tool.string(), m_fingerprints.fileHash(tool));
+  fingerprint.addOption("target_device", ProjManager()->getTargetDevice());
+  fingerprint.addOption("parser_type",
+                        std::to_string(static_cast<int>(GetParserType())));
+  fingerprint.addOption("netlist_type",
+                        std::to_string(static_cast<int>(GetNetlistType())));
+
+  return m_fingerprints.check(stage, fingerprint, outputFile).stale;
+}
 
-  std::ifstream script(synth_scrypt_path);
-  if (!script.good()) {
-    result = true;
+std::filesystem::path CompilerOpenFPGA::AnalyzeExecutablePath() {
+  if (GetParserType() == ParserType::Default ||
+      GetParserType() == ParserType::Surelog ||
+      GetParserType() == ParserType::GHDL) {
+    // Yosys-based parsers run the yosys installed next to the analyzer
+    return m_analyzeExecutablePath.parent_path() / "yosys";
   }
-  std::stringstream buffer;
-  buffer << script.rdbuf();
-  if (synth_script != buffer.str()) {
-    result = true;
+  return m_analyzeExecutablePath;
+}
+
+void CompilerOpenFPGA::WatchedFileChanges(std::set<std::string>& changed) {
+  DesignFileWatcher* watcher = DesignFileWatcher::Instance();
+  const uint64_t since = m_journalSequence;
+  m_journalSequence = watcher->journal().lastSequence();
+  // Batch mode has no watcher, flows of batch_run don't use the one of the
+  // main window project
+  if (!watcher->isValid() || since == 0 || Project::Scoped()) return;
+  std::vector<DesignFileChange> changes;
+  if (!watcher->journal().changesSince(since, changes)) return;
+  for (const auto& change : changes) {
+    switch (change.kind) {
+      case DesignFileChange::Kind::Modified:
+      case DesignFileChange::Kind::Created:
+      case DesignFileChange::Kind::Removed:
+        changed.insert(FileUtils::GetFullPath(change.path).string());
+        break;
+      default:
+        // File list or device changed, stamps are checked anyway
+        break;
+    }
   }
-  return result;
+}
+
+void CompilerOpenFPGA::CommitDesignFingerprint(
+    const std::filesystem::path& outputFile) {
+  m_fingerprints.commit(FingerprintStage(outputFile));
+}
+
+Compiler* CompilerOpenFPGA::CreateBatchCompiler() const {
+  CompilerOpenFPGA* compiler = new CompilerOpenFPGA;
+  CopyToolSetup(compiler);
+  compiler->m_analyzeExecutablePath = m_analyzeExecutablePath;
+  compiler->m_yosysExecutablePath = m_yosysExecutablePath;
+  compiler->m_vprExecutablePath = m_vprExecutablePath;
+  compiler->m_openFpgaExecutablePath = m_openFpgaExecutablePath;
+  compiler->m_ReConstructVExecPath = m_ReConstructVExecPath;
+  compiler->m_staExecutablePath = m_staExecutablePath;
+  compiler->m_pinConvExecutablePath = m_pinConvExecutablePath;
+  compiler->m_OpenFpgaBitstreamSettingFile = m_OpenFpgaBitstreamSettingFile;
+  compiler->m_OpenFpgaSimSettingFile = m_OpenFpgaSimSettingFile;
+  compiler->m_OpenFpgaRepackConstraintsFile = m_OpenFpgaRepackConstraintsFile;
+  return compiler;
 }
 
 void CompilerOpenFPGA::reloadSettings() {
-  FOEDAG::Settings* settings = GlobalSession->GetSettings();
+  FOEDAG::Settings* settings = GetSession() ? GetSession()->GetSettings()
+                                             : GlobalSession->GetSettings();
   try {
     auto& synth = settings->getJson()["Tasks"]["Synthesis"];
     synth["dsp_spinbox_ex"]["maxVal"] = MaxDeviceDSPCount();
@@ -1222,25 +1327,20 @@ bool CompilerOpenFPGA::Analyze() {
   FileUtils::WriteToFile(script_path, analysisScript, false);
   std::string command;
   int status = 0;
-  std::filesystem::path analyse_path = ANALYSIS_LOG;
-  if (GetParserType() == ParserType::Default ||
-      GetParserType() == ParserType::Surelog ||
-      GetParserType() == ParserType::GHDL) {
-    m_analyzeExecutablePath = m_analyzeExecutablePath.parent_path();
-    m_analyzeExecutablePath = m_analyzeExecutablePath / "yosys";
-  }
-  if (!FileUtils::FileExists(m_analyzeExecutablePath)) {
-    ErrorMessage("Cannot find executable: " + m_analyzeExecutablePath.string());
+  std::filesystem::path analyse_path = FilePath(Action::Analyze, ANALYSIS_LOG);
+  const std::filesystem::path analyzeExecutable = AnalyzeExecutablePath();
+  if (!FileUtils::FileExists(analyzeExecutable)) {
+    ErrorMessage("Cannot find executable: " + analyzeExecutable.string());
     return false;
   }
   if (GetParserType() == ParserType::Default ||
       GetParserType() == ParserType::Surelog ||
       GetParserType() == ParserType::GHDL) {
     // Yosys-based analyze
-    command = m_analyzeExecutablePath.string() + " -s " + script_path.string();
+    command = analyzeExecutable.string() + " -s " + script_path.string();
   } else {
     // Verific-based analyze
-    command = m_analyzeExecutablePath.string() + " -f " + script_path.string();
+    command = analyzeExecutable.string() + " -f " + script_path.string();
   }
   Message("Analyze command: " + command);
   status = ExecuteAndMonitorSystemCommand(command, analyse_path.string(), false,
@@ -1300,6 +1400,7 @@ bool CompilerOpenFPGA::Analyze() {
     return false;
   } else {
     m_state = State::Analyzed;
+    CommitDesignFingerprint(output_path);
     Message("Design " + ProjManager()->projectName() + " is analyzed");
   }
 
@@ -1794,8 +1895,8 @@ bool CompilerOpenFPGA::Synthesize() {
     getNetlistEditData()->ReadData(configJsonPath, fabricJsonPath);
 
     // Rename log file
-    copyLog(ProjManager(), ProjManager()->projectName() + "_synth.log",
-            SYNTHESIS_LOG);
+    copyLog(FilePath(Action::Synthesis),
+            ProjManager()->projectName() + "_synth.log", SYNTHESIS_LOG);
   });
 
   if (!m_projManager->HasDesign()) {
@@ -1830,8 +1931,9 @@ bool CompilerOpenFPGA::Synthesize() {
     }
   }
 
-  const std::string sdcOut =
-      "pin_location_" + ProjManager()->projectName() + ".sdc";
+  const std::filesystem::path sdcOut =
+      FilePath(Action::Synthesis,
+               "pin_location_" + ProjManager()->projectName() + ".sdc");
   std::ofstream ofssdc(sdcOut);
   for (auto constraint : m_constraints->getConstraints()) {
     constraint = ReplaceAll(constraint, "@", "[");
@@ -2069,7 +2171,8 @@ bool CompilerOpenFPGA::Synthesize() {
 
   yosysScript = FinishSynthesisScript(yosysScript);
 
-  yosysScript = ReplaceAll(yosysScript, "${PIN_LOCATION_SDC}", sdcOut);
+  yosysScript =
+      ReplaceAll(yosysScript, "${PIN_LOCATION_SDC}", sdcOut.string());
 
   yosysScript = ReplaceAll(yosysScript, "${CONFIG_JSON}", "config.json");
 
@@ -2132,7 +2235,8 @@ bool CompilerOpenFPGA::Synthesize() {
                  std::string("fabric_" + ProjManager()->projectName() +
                              "_post_synth.edif"));
 
-  std::string script_path = ProjManager()->projectName() + ".ys";
+  const std::string script_name = ProjManager()->projectName() + ".ys";
+  const auto script_path = FilePath(Action::Synthesis, script_name);
   std::string output_path;
   switch (GetNetlistType()) {
     case NetlistType::Verilog:
@@ -2152,19 +2256,20 @@ bool CompilerOpenFPGA::Synthesize() {
       output_path = ProjManager()->projectName() + "_post_synth.eblif";
       break;
   }
+  output_path = FilePath(Action::Synthesis, output_path).string();
 
-  if (!DesignChanged(yosysScript, script_path, output_path)) {
+  if (!DesignChanged(yosysScript, output_path)) {
     m_state = State::Synthesized;
     Message("Design didn't change: " + ProjManager()->projectName() +
             ", skipping synthesis.");
     return true;
   }
-  std::filesystem::remove(
-      std::string(ProjManager()->projectName() + "_post_synth.blif"));
-  std::filesystem::remove(
-      std::string(ProjManager()->projectName() + "_post_synth.eblif"));
-  std::filesystem::remove(
-      std::string(ProjManager()->projectName() + "_post_synth.v"));
+  std::filesystem::remove(FilePath(
+      Action::Synthesis, ProjManager()->projectName() + "_post_synth.blif"));
+  std::filesystem::remove(FilePath(
+      Action::Synthesis, ProjManager()->projectName() + "_post_synth.eblif"));
+  std::filesystem::remove(FilePath(
+      Action::Synthesis, ProjManager()->projectName() + "_post_synth.v"));
   // Create Yosys command and execute
   FileUtils::WriteToFile(script_path, yosysScript, false);
   if (!FileUtils::FileExists(m_yosysExecutablePath)) {
@@ -2173,14 +2278,15 @@ bool CompilerOpenFPGA::Synthesize() {
   }
   std::string command =
       m_yosysExecutablePath.string() + " -s " +
-      std::string(script_path + " -l " + ProjManager()->projectName() +
+      std::string(script_name + " -l " + ProjManager()->projectName() +
                   "_synth.log");
   Message("Synthesis command: " + command);
   int status = ExecuteAndMonitorSystemCommand(
       command, {}, false, FilePath(Action::Synthesis).string());
   if (status) {
     if (GetParserType() == ParserType::Default) {
-      std::ifstream raptor_log(ProjManager()->projectName() + "_synth.log");
+      std::ifstream raptor_log(FilePath(
+          Action::Synthesis, ProjManager()->projectName() + "_synth.log"));
       if (raptor_log.good()) {
         std::stringstream buffer;
         buffer << raptor_log.rdbuf();
@@ -2204,6 +2310,7 @@ bool CompilerOpenFPGA::Synthesize() {
     return false;
   } else {
     m_state = State::Synthesized;
+    CommitDesignFingerprint(output_path);
     Message("Design " + ProjManager()->projectName() + " is synthesized");
     return true;
   }
@@ -2350,7 +2457,7 @@ std::string CompilerOpenFPGA::BaseStaScript(std::string libFileName,
       std::string("\n") +
       std::string("report_checks\n");  // to do: add more check/report flavors
   const std::string openStaFile = ProjManager()->projectName() + "_opensta.tcl";
-  FileUtils::WriteToFile(openStaFile, script);
+  FileUtils::WriteToFile(FilePath(Action::STA, openStaFile), script);
   return openStaFile;
 }
 
@@ -2375,8 +2482,8 @@ bool CompilerOpenFPGA::WriteTimingConstraints() {
     }
   }
 
-  const std::string sdcOut =
-      "fabric_" + ProjManager()->projectName() + "_openfpga.sdc";
+  const std::filesystem::path sdcOut = FilePath(
+      Action::Pack, "fabric_" + ProjManager()->projectName() + "_openfpga.sdc");
   std::ofstream ofssdc(sdcOut);
   // TODO: Massage the SDC so VPR can understand them
   for (auto constraint : m_constraints->getConstraints()) {
@@ -2425,7 +2532,7 @@ bool CompilerOpenFPGA::Packing() {
   // This will fire when the containing function goes out of scope
   auto guard = sg::make_scope_guard([this] {
     // Rename log file
-    copyLog(ProjManager(), "vpr_stdout.log", PACKING_LOG);
+    copyLog(FilePath(Action::Pack), "vpr_stdout.log", PACKING_LOG);
   });
 
   if (!ProjManager()->HasDesign()) {
@@ -2471,7 +2578,8 @@ bool CompilerOpenFPGA::Packing() {
   PackOpt(PackingOpt::None);
 
   std::string command = BaseVprCommand({}) + " --pack";
-  auto file = ProjManager()->projectName() + "_pack.cmd";
+  auto file =
+      FilePath(Action::Pack, ProjManager()->projectName() + "_pack.cmd");
   FileUtils::WriteToFile(file, command);
 
   fs::path netlistPath = GetNetlistPath();
@@ -2535,7 +2643,7 @@ bool CompilerOpenFPGA::Placement() {
   // This will fire when the containing function goes out of scope
   auto guard = sg::make_scope_guard([this] {
     // Rename log file
-    copyLog(ProjManager(), "vpr_stdout.log", PLACEMENT_LOG);
+    copyLog(FilePath(Action::Placement), "vpr_stdout.log", PLACEMENT_LOG);
   });
 
   if (!ProjManager()->HasDesign()) {
@@ -2565,7 +2673,8 @@ bool CompilerOpenFPGA::Placement() {
     return false;
   }
 
-  const std::string pcfOut = ProjManager()->projectName() + "_openfpga.pcf";
+  const std::filesystem::path pcfOut = FilePath(
+      Action::Placement, ProjManager()->projectName() + "_openfpga.pcf");
   std::string previousConstraints;
   std::ifstream ifspcf(pcfOut);
   if (ifspcf.good()) {
@@ -2588,7 +2697,11 @@ bool CompilerOpenFPGA::Placement() {
     if (properties["INI"].contains("OVERWRITE_PIN_LOCATION_AND_MODE_FILE")) {
       std::string manual_pin_file =
           properties["INI"]["OVERWRITE_PIN_LOCATION_AND_MODE_FILE"];
-      if (!std::filesystem::exists(manual_pin_file)) {
+      // relative to the placement directory first, then to the project
+      std::filesystem::path wp = WorkingDir() / manual_pin_file;
+      if (std::filesystem::exists(wp)) {
+        manual_pin_file = wp.string();
+      } else {
         std::filesystem::path pp = ProjManager()->projectPath();
         std::filesystem::path mp =
             std::filesystem::absolute(pp / ".." / manual_pin_file);
@@ -2793,8 +2906,9 @@ bool CompilerOpenFPGA::Placement() {
         ProjManager()->projectName() + "_repack_constraints.xml";
 
     if (!set_clks.empty() && repackConstraint) {
-      const std::string repack_out =
-          ProjManager()->projectName() + ".temp_file_clkmap";
+      const std::filesystem::path repack_out =
+          FilePath(Action::Placement,
+                   ProjManager()->projectName() + ".temp_file_clkmap");
       std::ofstream ofsclkmap(repack_out);
 
       for (auto constraint : set_clks) {
@@ -2817,7 +2931,8 @@ bool CompilerOpenFPGA::Placement() {
 
     std::string pin_loc_constraint_file;
 
-    auto file = ProjManager()->projectName() + "_pin_loc.cmd";
+    auto file = FilePath(Action::Placement,
+                         ProjManager()->projectName() + "_pin_loc.cmd");
     FileUtils::WriteToFile(file, pincommand);
 
     auto workingDir = FilePath(Action::Placement);
@@ -2838,7 +2953,8 @@ bool CompilerOpenFPGA::Placement() {
     }
   }
 
-  auto file = ProjManager()->projectName() + "_place.cmd";
+  auto file =
+      FilePath(Action::Placement, ProjManager()->projectName() + "_place.cmd");
   FileUtils::WriteToFile(file, command);
   auto workingDir = FilePath(Action::Placement);
   int status = ExecuteAndMonitorSystemCommand(command, {}, false, workingDir);
@@ -2957,7 +3073,7 @@ bool CompilerOpenFPGA::Route() {
   auto guard = sg::make_scope_guard([this, &routingUtilization] {
     // Rename log file
     m_utils = routingUtilization;
-    copyLog(ProjManager(), "vpr_stdout.log", ROUTING_LOG);
+    copyLog(FilePath(Action::Routing), "vpr_stdout.log", ROUTING_LOG);
     RenamePostSynthesisFiles(Action::Routing);
   });
 
@@ -3050,7 +3166,7 @@ bool CompilerOpenFPGA::TimingAnalysis() {
   // This will fire when the containing function goes out of scope
   auto guard = sg::make_scope_guard([this] {
     // Rename log file
-    copyLog(ProjManager(), "vpr_stdout.log", TIMING_ANALYSIS_LOG);
+    copyLog(FilePath(Action::STA), "vpr_stdout.log", TIMING_ANALYSIS_LOG);
     RenamePostSynthesisFiles(Action::STA);
   });
 
@@ -3108,7 +3224,8 @@ bool CompilerOpenFPGA::TimingAnalysis() {
     // allows SDF to be generated for OpenSTA
     std::string command =
         BaseVprCommand({}) + " --gen_post_synthesis_netlist on";
-    auto file = std::string(ProjManager()->projectName() + "_sta.cmd");
+    auto file =
+        FilePath(Action::STA, ProjManager()->projectName() + "_sta.cmd");
     FileUtils::WriteToFile(file, command);
     int status = ExecuteAndMonitorSystemCommand(command, {}, false, workingDir);
     if (status) {
@@ -3130,7 +3247,8 @@ bool CompilerOpenFPGA::TimingAnalysis() {
       taCommand = BaseStaCommand() + " " +
                   BaseStaScript(libFileName.string(), netlistFileName.string(),
                                 sdfFileName.string(), sdcFileName.string());
-      auto file = std::string(ProjManager()->projectName() + "_sta.cmd");
+      auto file =
+          FilePath(Action::STA, ProjManager()->projectName() + "_sta.cmd");
       FileUtils::WriteToFile(file, taCommand);
     } else {
       auto fileList =
@@ -3145,7 +3263,8 @@ bool CompilerOpenFPGA::TimingAnalysis() {
     }
   } else {  // use vpr/tatum engine
     taCommand = BaseVprCommand({}) + " --analysis";
-    auto file = std::string(ProjManager()->projectName() + "_sta.cmd");
+    auto file =
+        FilePath(Action::STA, ProjManager()->projectName() + "_sta.cmd");
     FileUtils::WriteToFile(file, taCommand + " --disp on");
   }
 
@@ -3165,7 +3284,7 @@ bool CompilerOpenFPGA::PowerAnalysis() {
   // This will fire when the containing function goes out of scope
   auto guard = sg::make_scope_guard([this] {
     // Rename log file
-    copyLog(ProjManager(), "vpr_stdout.log", POWER_ANALYSIS_LOG);
+    copyLog(FilePath(Action::Power), "vpr_stdout.log", POWER_ANALYSIS_LOG);
   });
 
   if (!ProjManager()->HasDesign()) {
@@ -3204,7 +3323,8 @@ bool CompilerOpenFPGA::PowerAnalysis() {
     return false;
   }
 
-  auto file = ProjManager()->projectName() + "_power.cmd";
+  auto file =
+      FilePath(Action::Power, ProjManager()->projectName() + "_power.cmd");
   FileUtils::WriteToFile(file, command);
 
   int status = ExecuteAndMonitorSystemCommand(command, {}, false,
@@ -3501,7 +3621,7 @@ bool CompilerOpenFPGA::GenerateBitstream() {
   // This will fire when the containing function goes out of scope
   auto guard = sg::make_scope_guard([this] {
     // Rename log file
-    copyLog(ProjManager(), "vpr_stdout.log", BITSTREAM_LOG);
+    copyLog(FilePath(Action::Bitstream), "vpr_stdout.log", BITSTREAM_LOG);
     m_compile2bits = false;
   });
 
@@ -3541,7 +3661,7 @@ bool CompilerOpenFPGA::GenerateBitstream() {
   }
 
   if (BitsFlags() == BitstreamFlags::EnableSimulation) {
-    std::filesystem::path bit_path = "BIT_SIM";
+    std::filesystem::path bit_path = FilePath(Action::Bitstream) / "BIT_SIM";
     std::filesystem::create_directory(bit_path);
   }
 
@@ -3586,10 +3706,12 @@ bool CompilerOpenFPGA::GenerateBitstream() {
     script = StringUtils::replaceAll(script, "--analysis", {});
   }
 
-  std::string script_path = ProjManager()->projectName() + ".openfpga";
+  const std::filesystem::path script_path =
+      FilePath(Action::Bitstream, ProjManager()->projectName() + ".openfpga");
 
-  std::filesystem::remove("fabric_bitstream.bit");
-  std::filesystem::remove("fabric_independent_bitstream.xml");
+  std::filesystem::remove(FilePath(Action::Bitstream, "fabric_bitstream.bit"));
+  std::filesystem::remove(
+      FilePath(Action::Bitstream, "fabric_independent_bitstream.xml"));
   // Create OpenFpga command and execute
   FileUtils::WriteToFile(script_path, script, false);
   if (!FileUtils::FileExists(m_openFpgaExecutablePath)) {
@@ -3598,9 +3720,10 @@ bool CompilerOpenFPGA::GenerateBitstream() {
     return false;
   }
 
-  auto file = ProjManager()->projectName() + "_bitstream.cmd";
-  FileUtils::WriteToFile(file, command);
   auto workingDir = FilePath(Action::Bitstream);
+  std::string file =
+      (workingDir / (ProjManager()->projectName() + "_bitstream.cmd")).string();
+  FileUtils::WriteToFile(file, command);
   int status = ExecuteAndMonitorSystemCommand(command, {}, false, workingDir);
   if (status) {
     ErrorMessage("Design " + ProjManager()->projectName() +
@@ -3613,23 +3736,20 @@ bool CompilerOpenFPGA::GenerateBitstream() {
   std::filesystem::path pinmapFile =
       FilePath(Action::Bitstream, "PinMapping.xml").string();
   if (FileUtils::FileExists(pinmapFile)) {
-    std::ifstream ifs(pinmapFile);
-    if (ifs.good()) {
-      std::stringstream buffer;
-      buffer << ifs.rdbuf();
-      ifs.close();
-      std::string contents = buffer.str();
-      for (auto pair : getNetlistEditData()->getReversePrimaryInputMap()) {
-        contents = StringUtils::replaceAll(contents, pair.first, pair.second);
-      }
-      for (auto pair : getNetlistEditData()->getReversePrimaryOutputMap()) {
-        contents = StringUtils::replaceAll(contents, pair.first, pair.second);
-      }
-      std::filesystem::path primaryPinmapFile =
-          FilePath(Action::Bitstream, "PrimaryPinMapping.xml").string();
-      std::ofstream ofs(primaryPinmapFile.string());
-      ofs << contents;
-      ofs.close();
+    // All the renames are applied in a single pass over the copy
+    std::filesystem::path primaryPinmapFile =
+        FilePath(Action::Bitstream, "PrimaryPinMapping.xml").string();
+    std::error_code ec;
+    std::filesystem::copy_file(
+        pinmapFile, primaryPinmapFile,
+        std::filesystem::copy_options::overwrite_existing, ec);
+    std::string error;
+    if (ec) {
+      ErrorMessage("Cannot create " + primaryPinmapFile.string() + ": " +
+                   ec.message());
+    } else if (!getNetlistEditData()->InnerNet2PIOReplacer().replaceInFile(
+                   primaryPinmapFile, nullptr, &error)) {
+      ErrorMessage(error);
     }
   }
 
@@ -3667,7 +3787,11 @@ bool CompilerOpenFPGA::GenerateBitstream() {
     if (properties.contains("INI")) {
       if (properties["INI"].contains("SOURCE_IO_MODEL_CONFIG_FILE")) {
         io_model_config_file = properties["INI"]["SOURCE_IO_MODEL_CONFIG_FILE"];
-        if (!std::filesystem::exists(io_model_config_file)) {
+        // relative to the bitstream directory first, then to the project
+        std::filesystem::path wp = workingDir / io_model_config_file;
+        if (std::filesystem::exists(wp)) {
+          io_model_config_file = wp.string();
+        } else {
           std::filesystem::path pp = ProjManager()->projectPath();
           std::filesystem::path mp =
               std::filesystem::absolute(pp / ".." / io_model_config_file);
@@ -3684,20 +3808,26 @@ bool CompilerOpenFPGA::GenerateBitstream() {
         }
       }
     }
-    // update constraints
-    command = CFG_print("cd %s", workingDir.c_str());
-    command = CFG_print("%s\nclear_property", command.c_str());
+    // update constraints. The script addresses its outputs by absolute path,
+    // it runs in the interpreter of this process and must not change the
+    // current path
+    auto output = [&workingDir](const std::string& name) {
+      return CFG_change_directory_to_linux_format((workingDir / name).string());
+    };
+    const std::string property_json = output("model_config.property.json");
+    command = "clear_property";
     m_constraints->reset();
     for (const auto& file : ProjManager()->getConstrFiles()) {
       command = CFG_print("%s\nread_sdc {%s}", command.c_str(), file.c_str());
     }
-    command = CFG_print("%s\nwrite_property model_config.property.json",
-                        command.c_str());
-    command = CFG_print(
-        "%s\nwrite_simplified_property model_config.simplified.property.json",
-        command.c_str());
+    command = CFG_print("%s\nwrite_property {%s}", command.c_str(),
+                        property_json.c_str());
+    command =
+        CFG_print("%s\nwrite_simplified_property {%s}", command.c_str(),
+                  output("model_config.simplified.property.json").c_str());
     command = CFG_print("%s\nundefine_device PERIPHERY", command.c_str());
-    command = CFG_print("%s\nsource %s", command.c_str(), ric_model.c_str());
+    command = CFG_print("%s\nload_device_model -file {%s}", command.c_str(),
+                        ric_model.c_str());
     command = CFG_print("%s\nmodel_config set_model -feature IO PERIPHERY",
                         command.c_str());
     for (auto file : api_files) {
@@ -3709,62 +3839,70 @@ bool CompilerOpenFPGA::GenerateBitstream() {
                             command.c_str(), filepath.c_str());
       }
     }
-    command = CFG_print("%s\nmodel_config dump_ric PERIPHERY io_ric.txt",
-                        command.c_str());
+    command = CFG_print("%s\nmodel_config dump_ric PERIPHERY {%s}",
+                        command.c_str(), output("io_ric.txt").c_str());
     uint32_t gen_bitstream_count = 1;
+    std::string design = output("model_config.ppdb.json");
     if (CFG_find_string_in_vector({"Gemini", "Virgo"}, device_data.series) >=
         0) {
       command = CFG_print(
           "%s\nmodel_config gen_ppdb -netlist_ppdb %s -config_mapping %s "
-          "-property_json model_config.property.json -pll_workaround 0 "
-          "model_config.ppdb.json",
-          command.c_str(), netlist_ppdb.c_str(), config_mapping.c_str());
+          "-property_json {%s} -pll_workaround 0 {%s}",
+          command.c_str(), netlist_ppdb.c_str(), config_mapping.c_str(),
+          property_json.c_str(), design.c_str());
       command = CFG_print(
           "%s\nmodel_config gen_ppdb -netlist_ppdb %s -config_mapping %s "
-          "-property_json model_config.property.json -pll_workaround 1 "
-          "model_config.post.ppdb.json",
-          command.c_str(), netlist_ppdb.c_str(), config_mapping.c_str());
+          "-property_json {%s} -pll_workaround 1 {%s}",
+          command.c_str(), netlist_ppdb.c_str(), config_mapping.c_str(),
+          property_json.c_str(), output("model_config.post.ppdb.json").c_str());
       gen_bitstream_count = 2;
     } else {
       command = CFG_print(
           "%s\nmodel_config gen_ppdb -netlist_ppdb %s -config_mapping %s "
-          "-property_json model_config.property.json model_config.ppdb.json",
-          command.c_str(), netlist_ppdb.c_str(), config_mapping.c_str());
+          "-property_json {%s} {%s}",
+          command.c_str(), netlist_ppdb.c_str(), config_mapping.c_str(),
+          property_json.c_str(), design.c_str());
     }
-    std::string design = "model_config.ppdb.json";
-    std::string bit_file = "io_bitstream.bit";
-    std::string detail_file = "io_bitstream.detail.bit";
-    std::string backdoor_file = "io_bitstream.backdoor.txt";
+    std::string bit_file = output("io_bitstream.bit");
+    std::string detail_file = output("io_bitstream.detail.bit");
+    std::string backdoor_file = output("io_bitstream.backdoor.txt");
     for (uint32_t i = 0; i < gen_bitstream_count; i++) {
-      command = CFG_print("%s\nmodel_config set_design -feature IO %s",
+      command = CFG_print("%s\nmodel_config set_design -feature IO {%s}",
                           command.c_str(), design.c_str());
       if (io_model_config_file.size()) {
         command = CFG_print("%s\nsource %s", command.c_str(),
                             io_model_config_file.c_str());
       }
-      command = CFG_print("%s\nmodel_config write -feature IO -format BIT %s",
-                          command.c_str(), bit_file.c_str());
       command =
-          CFG_print("%s\nmodel_config write -feature IO -format DETAIL %s",
+          CFG_print("%s\nmodel_config write -feature IO -format BIT {%s}",
+                    command.c_str(), bit_file.c_str());
+      command =
+          CFG_print("%s\nmodel_config write -feature IO -format DETAIL {%s}",
                     command.c_str(), detail_file.c_str());
       if (std::filesystem::exists(backdoor_script)) {
-        command = CFG_print("%s\nmodel_config backdoor -script %s -input %s %s",
-                            command.c_str(), backdoor_script.c_str(),
-                            detail_file.c_str(), backdoor_file.c_str());
+        command =
+            CFG_print("%s\nmodel_config backdoor -script %s -input {%s} {%s}",
+                      command.c_str(), backdoor_script.c_str(),
+                      detail_file.c_str(), backdoor_file.c_str());
       }
       if (i == 0 && gen_bitstream_count == 2) {
         command =
             CFG_print("%s\nmodel_config reset -feature IO", command.c_str());
-        design = "model_config.post.ppdb.json";
-        bit_file = "io_bitstream.post.bit";
-        detail_file = "io_bitstream.post.detail.bit";
-        backdoor_file = "io_bitstream.post.backdoor.txt";
+        design = output("model_config.post.ppdb.json");
+        bit_file = output("io_bitstream.post.bit");
+        detail_file = output("io_bitstream.post.detail.bit");
+        backdoor_file = output("io_bitstream.post.backdoor.txt");
       }
     }
-    file = ProjManager()->projectName() + "_io_bitstream_cmd.tcl";
+    file = (workingDir /
+            (ProjManager()->projectName() + "_io_bitstream_cmd.tcl"))
+               .string();
     FileUtils::WriteToFile(file, command);
-    command = CFG_print("source %s", file.c_str());
-    m_interp->evalCmd(command, &status);
+    command = CFG_print("source {%s}", file.c_str());
+    {
+      std::lock_guard<std::mutex> lock{ioBitstreamMutex};
+      m_interp->evalCmd(command, &status);
+    }
     if (status != TCL_OK) {
       ErrorMessage("Design " + ProjManager()->projectName() +
                    " IO bitstream generation failed");
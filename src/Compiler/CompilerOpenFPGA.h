@@ -23,10 +23,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <set>
 #include <string>
 #include <vector>
 
 #include "Compiler/Compiler.h"
+#include "Compiler/FingerprintDatabase.h"
 
 namespace FOEDAG {
 enum class SynthesisType { Yosys, QL, RS };
@@ -35,6 +38,7 @@ class CompilerOpenFPGA : public Compiler {
  public:
   CompilerOpenFPGA() { m_name = "openfpga"; };
   ~CompilerOpenFPGA() = default;
+  virtual Compiler* CreateBatchCompiler() const;
   void AnalyzeExecPath(const std::filesystem::path& path) {
     m_analyzeExecutablePath = path;
   }
@@ -175,7 +179,6 @@ class CompilerOpenFPGA : public Compiler {
                               bool& deviceFound);
   virtual bool LicenseDevice(const std::string& deviceName);
   virtual bool DesignChanged(const std::string& synth_script,
-                             const std::filesystem::path& synth_scrypt_path,
                              const std::filesystem::path& outputFile);
   virtual void reloadSettings();
   virtual std::string InitSynthesisScript();
@@ -192,12 +195,19 @@ class CompilerOpenFPGA : public Compiler {
   std::string YosysDesignParsingCommmands();
   std::string SurelogDesignParsingCommmands();
   std::string GhdlDesignParsingCommmands();
-  static std::filesystem::path copyLog(FOEDAG::ProjectManager* projManager,
+  static std::filesystem::path copyLog(const std::filesystem::path& logDir,
                                        const std::string& srcFileName,
                                        const std::string& destFileName);
   bool DesignChangedForAnalysis(std::string& synth_script,
                                 std::filesystem::path& synth_scrypt_path,
                                 std::filesystem::path& outputFile);
+  // Records the fingerprint checked by DesignChanged once the stage succeeded
+  void CommitDesignFingerprint(const std::filesystem::path& outputFile);
+  // Files the design file watcher saw changing since the previous call
+  void WatchedFileChanges(std::set<std::string>& changed);
+  static std::string FingerprintStage(const std::filesystem::path& outputFile);
+  // Executable run by Analyze() for the current parser type
+  std::filesystem::path AnalyzeExecutablePath();
   void processCustomLayout();
   void RenamePostSynthesisFiles(Action action);
   std::filesystem::path m_yosysExecutablePath = "yosys";
@@ -259,6 +269,9 @@ class CompilerOpenFPGA : public Compiler {
                                     std::string sdcFileName);
   bool m_keepAllSignals = false;
   std::string m_DeviceNameforLicense;
+  FingerprintDatabase m_fingerprints;
+  // Journal sequence of the last DesignChanged
+  uint64_t m_journalSequence{0};
 };
 
 }  // namespace FOEDAG
@@ -0,0 +1,208 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "FingerprintDatabase.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <fstream>
+#include <iomanip>
+
+#include "Utils/FileUtils.h"
+#include "nlohmann_json/json.hpp"
+
+using json = nlohmann::ordered_json;
+
+namespace FOEDAG {
+
+static constexpr int kDatabaseVersion{2};
+
+FingerprintDatabase::FingerprintDatabase(const std::filesystem::path& dbFile)
+    : m_dbFile(dbFile) {}
+
+void FingerprintDatabase::setDatabaseFile(const std::filesystem::path& dbFile) {
+  if (dbFile == m_dbFile) return;
+  m_dbFile = dbFile;
+  m_loaded = false;
+  m_files.clear();
+  m_records.clear();
+  m_pending.clear();
+  m_decisions.clear();
+}
+
+void FingerprintDatabase::setRootPath(const std::filesystem::path& root) {
+  m_root = root.empty() ? root : FileUtils::GetFullPath(root);
+}
+
+std::string FingerprintDatabase::fileKey(
+    const std::filesystem::path& file) const {
+  auto full = FileUtils::GetFullPath(file);
+  if (!m_root.empty()) {
+    auto relative = full.lexically_relative(m_root);
+    if (!relative.empty() && *relative.begin() != "..")
+      return relative.generic_string();
+  }
+  return full.string();
+}
+
+std::string FingerprintDatabase::fileHash(const std::filesystem::path& file) {
+  load();
+  std::error_code ec;
+  auto full = FileUtils::GetFullPath(file).string();
+  auto key = fileKey(full);
+  auto size = std::filesystem::file_size(file, ec);
+  if (ec) return {};
+  auto mtime = std::filesystem::last_write_time(file, ec);
+  if (ec) return {};
+  int64_t stamp = mtime.time_since_epoch().count();
+
+  auto it = m_files.find(key);
+  if (it != m_files.end() && it->second.mtime == stamp &&
+      it->second.size == size)
+    return it->second.hash;
+
+  QFile qfile{QString::fromStdString(full)};
+  if (!qfile.open(QFile::ReadOnly)) return {};
+  QCryptographicHash hash{QCryptographicHash::Sha256};
+  if (!hash.addData(&qfile)) return {};
+  FileStamp fileStamp{stamp, size, hash.result().toHex().toStdString()};
+  m_files[key] = fileStamp;
+  return fileStamp.hash;
+}
+
+void FingerprintDatabase::markChanged(const std::filesystem::path& file) {
+  load();
+  m_files.erase(fileKey(FileUtils::GetFullPath(file)));
+}
+
+std::string FingerprintDatabase::textHash(const std::string& text) {
+  return QCryptographicHash::hash(QByteArray::fromStdString(text),
+                                  QCryptographicHash::Sha256)
+      .toHex()
+      .toStdString();
+}
+
+FingerprintDatabase::Decision FingerprintDatabase::check(
+    const std::string& stage, const StageFingerprint& fp,
+    const std::filesystem::path& output) {
+  load();
+  m_pending[stage] = Pending{fp, std::filesystem::absolute(output)};
+  Decision decision{false, {}};
+  auto outputHash = fileHash(output);
+  if (outputHash.empty())
+    decision.reasons.push_back("output missing: " + output.string());
+
+  auto record = m_records.find(stage);
+  if (record == m_records.end()) {
+    decision.reasons.push_back("no fingerprint recorded for previous run");
+  } else {
+    if (!outputHash.empty() && outputHash != record->second.outputHash)
+      decision.reasons.push_back("output modified: " + output.string());
+    const auto& previous = record->second.entries;
+    for (const auto& [key, value] : fp.entries()) {
+      auto prev = previous.find(key);
+      if (prev == previous.end())
+        decision.reasons.push_back("added: " + key);
+      else if (prev->second != value)
+        decision.reasons.push_back("changed: " + key);
+    }
+    for (const auto& [key, value] : previous) {
+      if (fp.entries().count(key) == 0)
+        decision.reasons.push_back("removed: " + key);
+    }
+  }
+  decision.stale = !decision.reasons.empty();
+  if (!decision.stale)
+    decision.reasons.push_back(
+        "up to date, " + std::to_string(fp.entries().size()) +
+        " fingerprint entries unchanged");
+  m_decisions[stage] = decision;
+  return decision;
+}
+
+bool FingerprintDatabase::commit(const std::string& stage) {
+  load();
+  auto pending = m_pending.find(stage);
+  if (pending == m_pending.end()) return false;
+  Record record;
+  record.entries = pending->second.fingerprint.entries();
+  record.outputHash = fileHash(pending->second.output);
+  m_records[stage] = record;
+  m_pending.erase(pending);
+  return save();
+}
+
+const FingerprintDatabase::Decision* FingerprintDatabase::lastDecision(
+    const std::string& stage) const {
+  auto it = m_decisions.find(stage);
+  return (it != m_decisions.end()) ? &it->second : nullptr;
+}
+
+void FingerprintDatabase::load() {
+  if (m_loaded) return;
+  m_loaded = true;
+  if (m_dbFile.empty() || !FileUtils::FileExists(m_dbFile)) return;
+  std::ifstream stream{m_dbFile};
+  json data = json::parse(stream, nullptr, false);
+  if (data.is_discarded() || !data.is_object() ||
+      data.value("version", 0) != kDatabaseVersion)
+    return;  // unreadable or outdated database, everything is stale
+  const json files = data.value("files", json::object());
+  for (const auto& [path, stamp] : files.items()) {
+    m_files[path] = FileStamp{stamp.value("mtime", int64_t{-1}),
+                              stamp.value("size", uint64_t{0}),
+                              stamp.value("hash", std::string{})};
+  }
+  const json stages = data.value("stages", json::object());
+  for (const auto& [stage, rec] : stages.items()) {
+    Record record;
+    record.outputHash = rec.value("output_hash", std::string{});
+    const json entries = rec.value("entries", json::object());
+    for (const auto& [key, value] : entries.items())
+      record.entries[key] = value.get<std::string>();
+    m_records[stage] = record;
+  }
+}
+
+bool FingerprintDatabase::save() const {
+  if (m_dbFile.empty()) return false;
+  json data;
+  data["version"] = kDatabaseVersion;
+  json files = json::object();
+  for (const auto& [path, stamp] : m_files) {
+    files[path] = {
+        {"mtime", stamp.mtime}, {"size", stamp.size}, {"hash", stamp.hash}};
+  }
+  data["files"] = files;
+  json stages = json::object();
+  for (const auto& [stage, record] : m_records) {
+    stages[stage] = {{"output_hash", record.outputHash},
+                     {"entries", record.entries}};
+  }
+  data["stages"] = stages;
+  std::error_code ec;
+  std::filesystem::create_directories(m_dbFile.parent_path(), ec);
+  std::ofstream stream{m_dbFile};
+  if (!stream.good()) return false;
+  stream << std::setw(2) << data;
+  return stream.good();
+}
+
+}  // namespace FOEDAG
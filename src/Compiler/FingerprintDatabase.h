@@ -0,0 +1,132 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace FOEDAG {
+
+/*!
+ * \brief The StageFingerprint class
+ * Set of named content hashes describing everything a compilation stage
+ * depends on: input files, generated script, tool binaries and options.
+ */
+class StageFingerprint {
+ public:
+  void addFile(const std::string& key, const std::string& hash) {
+    m_entries["file:" + key] = hash;
+  }
+  void addTool(const std::string& key, const std::string& hash) {
+    m_entries["tool:" + key] = hash;
+  }
+  void addOption(const std::string& key, const std::string& value) {
+    m_entries["option:" + key] = value;
+  }
+  void addScript(const std::string& hash) { m_entries["script"] = hash; }
+
+  const std::map<std::string, std::string>& entries() const {
+    return m_entries;
+  }
+
+ private:
+  std::map<std::string, std::string> m_entries;
+};
+
+/*!
+ * \brief The FingerprintDatabase class
+ * Persistent per-stage fingerprint store. A stage is considered stale when
+ * its output is missing or modified, or when any entry of the freshly
+ * computed fingerprint differs from the one recorded after the last
+ * successful run. File hashes are cached by (mtime, size) so untouched files
+ * are not read again; a touched but unmodified file is re-hashed once and
+ * then considered unchanged. Files reported modified by the design file
+ * watcher are re-hashed even if their stamp didn't change.
+ */
+class FingerprintDatabase {
+ public:
+  struct Decision {
+    bool stale{true};
+    std::vector<std::string> reasons;
+  };
+
+  FingerprintDatabase() = default;
+  explicit FingerprintDatabase(const std::filesystem::path& dbFile);
+
+  // Switch to another database file, drops in-memory state
+  void setDatabaseFile(const std::filesystem::path& dbFile);
+  const std::filesystem::path& databaseFile() const { return m_dbFile; }
+
+  // Files under the root path (the project directory) are keyed relative to
+  // it, so the database stays valid when the project is copied or moved.
+  // Files outside the root keep their absolute path as key.
+  void setRootPath(const std::filesystem::path& root);
+  std::string fileKey(const std::filesystem::path& file) const;
+
+  // Content hash of a file, empty string if the file can't be read
+  std::string fileHash(const std::filesystem::path& file);
+  // Drop the cached hash of a file known to be modified, the next fileHash()
+  // reads it again
+  void markChanged(const std::filesystem::path& file);
+  static std::string textHash(const std::string& text);
+
+  // Compare fingerprint with the record of the last successful run. The
+  // fingerprint is kept as pending until commit() is called, nothing is
+  // written to the database file.
+  Decision check(const std::string& stage, const StageFingerprint& fp,
+                 const std::filesystem::path& output);
+  // Record pending fingerprint of the stage as successfully built and save
+  // the database together with the refreshed file stamps
+  bool commit(const std::string& stage);
+
+  // Last decision taken for the stage, for user diagnostics
+  const Decision* lastDecision(const std::string& stage) const;
+
+ private:
+  struct FileStamp {
+    int64_t mtime{-1};
+    uint64_t size{0};
+    std::string hash;
+  };
+  struct Record {
+    std::map<std::string, std::string> entries;
+    std::string outputHash;
+  };
+  struct Pending {
+    StageFingerprint fingerprint;
+    std::filesystem::path output;
+  };
+  void load();
+  bool save() const;
+
+  std::filesystem::path m_dbFile;
+  std::filesystem::path m_root;
+  bool m_loaded{false};
+  std::map<std::string, FileStamp> m_files;
+  std::map<std::string, Record> m_records;
+  std::map<std::string, Pending> m_pending;
+  std::map<std::string, Decision> m_decisions;
+};
+
+}  // namespace FOEDAG
@@ -65,7 +65,7 @@ void logAppend(Logger* logger, const QString& msg) {
 #define PERF_LOG(msg)                                                    \
   if (GlobalSession->CmdStack()->PerfLogger()) {                         \
     std::string t = FOEDAG::dateTimeToString(FOEDAG::now(), "%H:%M:%S"); \
-    PERF_LOGGER() << "[ " << t << " ] " << msg << "\n";                  \
+    PERF_LOGGER() << ("[ " + t + " ] " + std::string{msg} + "\n");       \
   }
 
 // write log into output log file
@@ -34,42 +34,6 @@ NetlistEditData::NetlistEditData() {}
 
 NetlistEditData::~NetlistEditData() {}
 
-static void recordGeneratedClock(std::set<std::string>& ports,
-                                 nlohmann::json& jsonObject,
-                                 const std::string name) {
-  ports.insert(name);
-  for (auto& instance : jsonObject["instances"]) {
-    if (instance.contains("connectivity")) {
-      auto connectivity = instance.at("connectivity");
-      if (connectivity.contains("I") && connectivity.contains("O")) {
-        auto input = connectivity.at("I");
-        auto output = connectivity.at("O");
-        if (input == name) {
-          recordGeneratedClock(ports, jsonObject, output);
-        }
-      }
-    }
-  }
-}
-
-static void recordDrivingClock(std::set<std::string>& ports,
-                               nlohmann::json& jsonObject,
-                               const std::string name) {
-  ports.insert(name);
-  for (auto& instance : jsonObject["instances"]) {
-    if (instance.contains("connectivity")) {
-      auto connectivity = instance.at("connectivity");
-      if (connectivity.contains("I") && connectivity.contains("O")) {
-        auto input = connectivity.at("I");
-        auto output = connectivity.at("O");
-        if (output == name) {
-          recordDrivingClock(ports, jsonObject, input);
-        }
-      }
-    }
-  }
-}
-
 void NetlistEditData::ReadData(std::filesystem::path configJsonFile,
                                std::filesystem::path fabricPortInfo) {
   if (FileUtils::FileExists(configJsonFile)) {
@@ -78,11 +42,16 @@ void NetlistEditData::ReadData(std::filesystem::path configJsonFile,
     input.open(configJsonFile.c_str());
     nlohmann::json netlist_instances = nlohmann::json::parse(input);
     input.close();
-    for (auto& instance : netlist_instances["instances"]) {
+    const nlohmann::json& instances = netlist_instances["instances"];
+    m_graph.build(instances);
+    static const nlohmann::json noConnectivity = nlohmann::json::object();
+    for (const auto& instance : instances) {
       if (instance.contains("linked_object")) {
         m_linked_objects.insert(std::string(instance["linked_object"]));
       }
-      nlohmann::json connectivity = instance["connectivity"];
+      const auto& connectivity = instance.contains("connectivity")
+                                     ? instance.at("connectivity")
+                                     : noConnectivity;
       // Record initial Connectivity
       if (connectivity.contains("I") && connectivity.contains("O")) {
         std::string input = std::string(connectivity["I"]);
@@ -93,29 +62,27 @@ void NetlistEditData::ReadData(std::filesystem::path configJsonFile,
 
       // Trace clocks
       if (instance.contains("module")) {
-        auto module = instance.at("module");
+        const auto& module = instance.at("module");
         if (instance.contains("linked_object")) {
-          auto linked_object = instance.at("linked_object");
+          const auto& linked_object = instance.at("linked_object");
           if (module == "CLK_BUF") {
             m_clocks.insert(linked_object.template get<std::string>());
           }
         }
 
         if (module == "FCLK_BUF") {
-          auto connectivity = instance.at("connectivity");
           if (connectivity.contains("O")) {
-            auto output = connectivity.at("O");
-            recordDrivingClock(m_generated_clocks, netlist_instances, output);
-            recordGeneratedClock(m_generated_clocks, netlist_instances, output);
+            const std::string output = connectivity.at("O");
+            m_graph.collectFanin(output, m_generated_clocks);
+            m_graph.collectFanout(output, m_generated_clocks);
           }
         }
 
         if (module == "BOOT_CLOCK") {
           if (instance.contains("linked_object")) {
-            auto linked_object = instance.at("linked_object");
+            const auto& linked_object = instance.at("linked_object");
             m_clocks.insert(linked_object.template get<std::string>());
           }
-          auto connectivity = instance.at("connectivity");
           if (connectivity.contains("O")) {
             std::string stem = connectivity.at("O");
             if (stem.find_last_of(".") != std::string::npos) {
@@ -125,15 +92,12 @@ void NetlistEditData::ReadData(std::filesystem::path configJsonFile,
               stem = stemtmp;
             }
             m_clocks.insert(stem);
-            auto output = connectivity.at("O");
-            recordDrivingClock(m_clocks, netlist_instances, output);
+            m_graph.collectFanin(connectivity.at("O"), m_clocks);
           }
         }
 
         if (module == "I_SERDES") {
-          auto connectivity = instance.at("connectivity");
-          for (nlohmann::json::iterator it = connectivity.begin();
-               it != connectivity.end(); ++it) {
+          for (auto it = connectivity.begin(); it != connectivity.end(); ++it) {
             std::string key = it.key();
             if (key.find("CLK_OUT") != std::string::npos) {
               std::string stem = it.value();
@@ -144,16 +108,13 @@ void NetlistEditData::ReadData(std::filesystem::path configJsonFile,
                 stem = stemtmp;
               }
               m_generated_clocks.insert(stem);
-              recordGeneratedClock(m_generated_clocks, netlist_instances,
-                                   it.value());
+              m_graph.collectFanout(it.value(), m_generated_clocks);
             }
           }
         }
 
         if (module == "PLL") {
-          auto connectivity = instance.at("connectivity");
-          for (nlohmann::json::iterator it = connectivity.begin();
-               it != connectivity.end(); ++it) {
+          for (auto it = connectivity.begin(); it != connectivity.end(); ++it) {
             std::string key = it.key();
             if (key.find("CLK_OUT") != std::string::npos) {
               std::string stem = it.value();
@@ -164,8 +125,7 @@ void NetlistEditData::ReadData(std::filesystem::path configJsonFile,
                 stem = stemtmp;
               }
               m_generated_clocks.insert(stem);
-              recordGeneratedClock(m_generated_clocks, netlist_instances,
-                                   it.value());
+              m_graph.collectFanout(it.value(), m_generated_clocks);
             } else if (key.find("FAST_CLK") != std::string::npos) {
               std::string stem = it.value();
               if (stem.find_last_of(".") != std::string::npos) {
@@ -175,8 +135,7 @@ void NetlistEditData::ReadData(std::filesystem::path configJsonFile,
                 stem = stemtmp;
               }
               m_generated_clocks.insert(stem);
-              recordGeneratedClock(m_generated_clocks, netlist_instances,
-                                   it.value());
+              m_graph.collectFanout(it.value(), m_generated_clocks);
             } else if (key.find("CLK_IN") != std::string::npos) {
               std::string stem = it.value();
               if (stem.find_last_of(".") != std::string::npos) {
@@ -186,8 +145,7 @@ void NetlistEditData::ReadData(std::filesystem::path configJsonFile,
                 stem = stemtmp;
               }
               m_reference_clocks.insert(stem);
-              recordDrivingClock(m_reference_clocks, netlist_instances,
-                                 it.value());
+              m_graph.collectFanin(it.value(), m_reference_clocks);
             }
           }
         }
@@ -195,7 +153,7 @@ void NetlistEditData::ReadData(std::filesystem::path configJsonFile,
     }
 
     // Compute Connectivity maps
-    ComputePrimaryMaps(netlist_instances);
+    ComputePrimaryMaps();
 
     if (FileUtils::FileExists(fabricPortInfo)) {
       std::ifstream input;
@@ -206,7 +164,7 @@ void NetlistEditData::ReadData(std::filesystem::path configJsonFile,
         if (port.contains("clock")) {
           std::string name = std::string(port["name"]);
           m_fabric_clocks.insert(name);
-          recordDrivingClock(m_fabric_clocks, netlist_instances, name);
+          m_graph.collectFanin(name, m_fabric_clocks);
         }
       }
     }
@@ -224,6 +182,8 @@ void NetlistEditData::ResetData() {
   m_reference_clocks.clear();
   m_primary_generated_clocks.clear();
   m_fabric_clocks.clear();
+  m_graph.clear();
+  m_replacersValid = false;
 }
 
 std::string NetlistEditData::FindAliasInInputOutputMap(
@@ -265,7 +225,7 @@ std::string NetlistEditData::FindAliasInInputOutputMap(
   return newname;
 }
 
-void NetlistEditData::ComputePrimaryMaps(nlohmann::json& netlist_instances) {
+void NetlistEditData::ComputePrimaryMaps() {
   {
     std::set<std::string> outputs;
     for (auto pair : m_input_output_map) {
@@ -305,22 +265,8 @@ void NetlistEditData::ComputePrimaryMaps(nlohmann::json& netlist_instances) {
     }
   }
   {
-    for (auto clk : m_generated_clocks) {
-      bool isOutput = false;
-      for (auto& instance : netlist_instances["instances"]) {
-        if (instance.contains("connectivity")) {
-          auto connectivity = instance.at("connectivity");
-          if (connectivity.contains("I") && connectivity.contains("O")) {
-            auto input = connectivity.at("I");
-            auto output = connectivity.at("O");
-            if (output == clk) {
-              isOutput = true;
-              break;
-            }
-          }
-        }
-      }
-      if (!isOutput) {
+    for (const auto& clk : m_generated_clocks) {
+      if (!m_graph.isDriven(clk)) {
         m_primary_generated_clocks.insert(clk);
       }
     }
@@ -378,6 +324,35 @@ std::string NetlistEditData::InnerNet2PIO(const std::string& orig) {
   return result;
 }
 
+static void addRenames(MultiPatternReplacer& replacer,
+                       const std::map<std::string, std::string>& renames) {
+  for (const auto& [from, to] : renames) {
+    if (from != to) replacer.add(from, to);
+  }
+}
+
+void NetlistEditData::BuildReplacers() {
+  if (m_replacersValid) return;
+  m_replacersValid = true;
+  m_pio2InnerNetReplacer.clear();
+  addRenames(m_pio2InnerNetReplacer, m_primary_input_map);
+  addRenames(m_pio2InnerNetReplacer, m_primary_output_map);
+  addRenames(m_pio2InnerNetReplacer, m_primary_generated_clocks_map);
+  m_innerNet2PIOReplacer.clear();
+  addRenames(m_innerNet2PIOReplacer, m_reverse_primary_input_map);
+  addRenames(m_innerNet2PIOReplacer, m_reverse_primary_output_map);
+}
+
+const MultiPatternReplacer& NetlistEditData::PIO2InnerNetReplacer() {
+  BuildReplacers();
+  return m_pio2InnerNetReplacer;
+}
+
+const MultiPatternReplacer& NetlistEditData::InnerNet2PIOReplacer() {
+  BuildReplacers();
+  return m_innerNet2PIOReplacer;
+}
+
 bool NetlistEditData::isPrimaryClock(const std::string& name) {
   if (m_clocks.find(name) != m_clocks.end()) {
     return true;
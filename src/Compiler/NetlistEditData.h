@@ -24,6 +24,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <set>
 #include <string>
 
+#include "Compiler/NetlistGraph.h"
+#include "Utils/MultiPatternReplacer.h"
 #include "nlohmann_json/json.hpp"
 
 #ifndef NETLIST_EDIT_DATA_H
@@ -52,6 +54,10 @@ class NetlistEditData {
   std::string PIO2InnerNet(const std::string& orig);
   std::string InnerNet2PIO(const std::string& orig);
 
+  // Same renames applied to any text in a single pass, built on first use
+  const MultiPatternReplacer& PIO2InnerNetReplacer();
+  const MultiPatternReplacer& InnerNet2PIOReplacer();
+
   std::string FindAliasInInputOutputMap(const std::string& orig);
 
   const std::map<std::string, std::string>& getPrimaryInputMap() const {
@@ -67,6 +73,8 @@ class NetlistEditData {
     return m_reverse_primary_output_map;
   }
   const std::set<std::string>& getPIs() const { return m_primary_inputs; }
+  // I/O connectivity of the netlist instances, for fan-in/fan-out queries
+  const NetlistGraph& getNetlistGraph() const { return m_graph; }
   const std::set<std::string>& getPOs() const { return m_primary_outputs; }
 
   bool isPrimaryClock(const std::string& name);
@@ -75,7 +83,8 @@ class NetlistEditData {
   bool isFabricClock(const std::string& name);
 
  protected:
-  void ComputePrimaryMaps(nlohmann::json& netlist_instances);
+  void ComputePrimaryMaps();
+  void BuildReplacers();
   std::set<std::string> m_linked_objects;
   std::set<std::string> m_primary_inputs;
   std::set<std::string> m_primary_outputs;
@@ -92,6 +101,10 @@ class NetlistEditData {
   std::map<std::string, std::string> m_reverse_primary_generated_clocks_map;
   std::set<std::string> m_clocks;
   std::set<std::string> m_fabric_clocks;
+  NetlistGraph m_graph;
+  MultiPatternReplacer m_pio2InnerNetReplacer;
+  MultiPatternReplacer m_innerNet2PIOReplacer;
+  bool m_replacersValid{false};
 };
 
 }  // namespace FOEDAG
@@ -0,0 +1,108 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "Compiler/NetlistGraph.h"
+
+#include <queue>
+
+namespace FOEDAG {
+
+static std::string stringValue(const nlohmann::json& object,
+                               const char* key) {
+  auto it = object.find(key);
+  return (it != object.end() && it->is_string()) ? it->get<std::string>()
+                                                 : std::string{};
+}
+
+void NetlistGraph::clear() {
+  m_instances.clear();
+  m_drivers.clear();
+  m_loads.clear();
+}
+
+void NetlistGraph::build(const nlohmann::json& instances) {
+  clear();
+  if (!instances.is_array()) return;
+  m_instances.reserve(instances.size());
+  for (const auto& object : instances) {
+    auto connectivity = object.find("connectivity");
+    if (connectivity == object.end() || !connectivity->is_object()) continue;
+    Instance instance;
+    instance.input = stringValue(*connectivity, "I");
+    instance.output = stringValue(*connectivity, "O");
+    if (instance.input.empty() || instance.output.empty()) continue;
+    instance.name = stringValue(object, "name");
+    instance.module = stringValue(object, "module");
+    instance.linkedObject = stringValue(object, "linked_object");
+    const size_t id = m_instances.size();
+    m_loads[instance.input].push_back(id);
+    m_drivers[instance.output].push_back(id);
+    m_instances.push_back(std::move(instance));
+  }
+}
+
+const std::vector<size_t>& NetlistGraph::drivers(const std::string& net) const {
+  static const std::vector<size_t> none;
+  auto it = m_drivers.find(net);
+  return (it != m_drivers.end()) ? it->second : none;
+}
+
+const std::vector<size_t>& NetlistGraph::loads(const std::string& net) const {
+  static const std::vector<size_t> none;
+  auto it = m_loads.find(net);
+  return (it != m_loads.end()) ? it->second : none;
+}
+
+bool NetlistGraph::isDriven(const std::string& net) const {
+  return m_drivers.count(net) != 0;
+}
+
+void NetlistGraph::collectFanout(const std::string& net,
+                                 std::set<std::string>& nets) const {
+  collect(net, nets, true);
+}
+
+void NetlistGraph::collectFanin(const std::string& net,
+                                std::set<std::string>& nets) const {
+  collect(net, nets, false);
+}
+
+void NetlistGraph::collect(const std::string& net, std::set<std::string>& nets,
+                           bool forward) const {
+  // visited nets of this walk, the output set may already hold other nets
+  std::set<std::string> visited{net};
+  std::queue<const std::string*> queue;
+  queue.push(&net);
+  nets.insert(net);
+  while (!queue.empty()) {
+    const std::string& current = *queue.front();
+    queue.pop();
+    for (size_t id : forward ? loads(current) : drivers(current)) {
+      const auto& next =
+          forward ? m_instances[id].output : m_instances[id].input;
+      if (visited.insert(next).second) {
+        nets.insert(next);
+        queue.push(&next);
+      }
+    }
+  }
+}
+
+}  // namespace FOEDAG
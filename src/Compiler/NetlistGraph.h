@@ -0,0 +1,75 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "nlohmann_json/json.hpp"
+
+namespace FOEDAG {
+
+/*!
+ * \brief The NetlistGraph class
+ * Net adjacency of the periphery netlist (netlist-PPDB "instances"). Each
+ * instance with both "I" and "O" connectivity is an edge from its input net
+ * to its output net; nets map to their driving and driven instances so
+ * fan-in/fan-out cones are walked breadth first without scanning the
+ * instance list.
+ */
+class NetlistGraph {
+ public:
+  struct Instance {
+    std::string name;
+    std::string module;
+    std::string linkedObject;
+    std::string input;   // "I" net
+    std::string output;  // "O" net
+  };
+
+  void clear();
+  void build(const nlohmann::json& instances);
+
+  size_t instanceCount() const { return m_instances.size(); }
+  const Instance& instance(size_t id) const { return m_instances.at(id); }
+  // Instances with "O" connected to the net
+  const std::vector<size_t>& drivers(const std::string& net) const;
+  // Instances with "I" connected to the net
+  const std::vector<size_t>& loads(const std::string& net) const;
+  bool isDriven(const std::string& net) const;
+
+  // Insert the net and all nets it drives (fan-out) or is driven by
+  // (fan-in), transitively
+  void collectFanout(const std::string& net, std::set<std::string>& nets) const;
+  void collectFanin(const std::string& net, std::set<std::string>& nets) const;
+
+ private:
+  void collect(const std::string& net, std::set<std::string>& nets,
+               bool forward) const;
+
+  std::vector<Instance> m_instances;
+  std::unordered_map<std::string, std::vector<size_t>> m_drivers;
+  std::unordered_map<std::string, std::vector<size_t>> m_loads;
+};
+
+}  // namespace FOEDAG
@@ -52,8 +52,11 @@ struct CustomData {
 };
 
 struct ProcessUtilization {
-  uint duration{};
-  uint utilization{};
+  uint duration{};     // ms
+  uint utilization{};  // peak memory of the process tree, kiB
+  uint cpuTime{};      // user + system, ms
+  uint64_t readBytes{};
+  uint64_t writeBytes{};
 };
 
 enum SettingType { SYN, IMPL, GEN };
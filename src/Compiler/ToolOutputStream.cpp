@@ -0,0 +1,155 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ToolOutputStream.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace FOEDAG {
+
+void RingBuffer::resize(size_t capacity) {
+  m_data.assign(capacity, '\0');
+  clear();
+}
+
+void RingBuffer::clear() {
+  m_head = 0;
+  m_full = false;
+}
+
+void RingBuffer::append(const char* data, size_t size) {
+  const size_t capacity = m_data.size();
+  if (capacity == 0 || size == 0) return;
+  if (size >= capacity) {
+    std::memcpy(m_data.data(), data + size - capacity, capacity);
+    m_head = 0;
+    m_full = true;
+    return;
+  }
+  const size_t first = std::min(size, capacity - m_head);
+  std::memcpy(m_data.data() + m_head, data, first);
+  std::memcpy(m_data.data(), data + first, size - first);
+  if (m_head + size >= capacity) m_full = true;
+  m_head = (m_head + size) % capacity;
+}
+
+std::string RingBuffer::contents() const {
+  if (!m_full) return std::string{m_data.data(), m_head};
+  std::string result;
+  result.reserve(m_data.size());
+  result.append(m_data.data() + m_head, m_data.size() - m_head);
+  result.append(m_data.data(), m_head);
+  return result;
+}
+
+ToolOutputStream::ToolOutputStream(std::ostream* log, std::ostream* console,
+                                   const Options& options)
+    : m_log(log),
+      m_consoleStream(console),
+      m_options(options),
+      m_tail(options.tailSize),
+      m_lastFlush(Clock::now()) {
+  m_pending.reserve(m_options.flushThreshold);
+}
+
+void ToolOutputStream::write(const char* data, size_t size) {
+  if (size == 0) return;
+  m_total += size;
+  if (m_log) m_log->write(data, size);
+  if (!m_consoleStream) return;
+  if (m_options.mode == ConsoleMode::Tail || m_capReached) {
+    m_tail.append(data, size);
+    m_skipped += size;
+    return;
+  }
+  m_pending.append(data, size);
+  if (m_pending.size() >= m_options.flushThreshold)
+    flush(false);
+  else
+    poll();
+}
+
+void ToolOutputStream::poll() {
+  if (m_pending.empty()) return;
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      Clock::now() - m_lastFlush);
+  if (elapsed.count() >= m_options.flushInterval) flush(false);
+}
+
+void ToolOutputStream::flush(bool all) {
+  m_lastFlush = Clock::now();
+  // forward complete lines only, unless the batch has no line break at all
+  size_t size = m_pending.size();
+  if (!all) {
+    auto pos = m_pending.rfind('\n');
+    if (pos != std::string::npos)
+      size = pos + 1;
+    else if (size < m_options.flushThreshold)
+      return;
+  }
+  if (m_options.consoleCap != 0 && m_console + size > m_options.consoleCap) {
+    size_t allowed = m_options.consoleCap - m_console;
+    auto pos = m_pending.rfind('\n', allowed == 0 ? 0 : allowed - 1);
+    allowed = (pos == std::string::npos || allowed == 0) ? 0 : pos + 1;
+    m_consoleStream->write(m_pending.data(), allowed);
+    m_console += allowed;
+    m_capReached = true;
+    // the rest goes to the tail
+    m_tail.append(m_pending.data() + allowed, m_pending.size() - allowed);
+    m_skipped += m_pending.size() - allowed;
+    m_pending.clear();
+    m_consoleStream->flush();
+    return;
+  }
+  m_consoleStream->write(m_pending.data(), size);
+  m_consoleStream->flush();
+  m_console += size;
+  m_pending.erase(0, size);
+}
+
+void ToolOutputStream::finish(const std::string& logFile) {
+  if (m_log) m_log->flush();
+  if (!m_consoleStream) return;
+  if (!m_pending.empty()) flush(true);
+  if (m_skipped == 0) return;
+  std::string tail = m_tail.contents();
+  uint64_t omitted = m_skipped - tail.size();
+  if (omitted != 0) {
+    // start from a line boundary
+    auto pos = tail.find('\n');
+    if (pos != std::string::npos && pos + 1 < tail.size()) {
+      tail.erase(0, pos + 1);
+      omitted = m_skipped - tail.size();
+    }
+    std::string note{"... " + std::to_string(omitted) +
+                     " bytes of output omitted"};
+    if (!logFile.empty()) note += ", see " + logFile;
+    (*m_consoleStream) << note << " ...\n";
+  }
+  m_consoleStream->write(tail.data(), tail.size());
+  if (!tail.empty() && tail.back() != '\n') (*m_consoleStream) << '\n';
+  m_consoleStream->flush();
+  m_console += tail.size();
+  m_tail.clear();
+  m_skipped = 0;
+}
+
+}  // namespace FOEDAG
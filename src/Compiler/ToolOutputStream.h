@@ -0,0 +1,101 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace FOEDAG {
+
+/*!
+ * \brief The RingBuffer class
+ * Fixed size byte buffer keeping the most recent data written to it.
+ */
+class RingBuffer {
+ public:
+  explicit RingBuffer(size_t capacity = 0) { resize(capacity); }
+  void resize(size_t capacity);
+  void clear();
+  void append(const char* data, size_t size);
+  size_t size() const { return m_full ? m_data.size() : m_head; }
+  size_t capacity() const { return m_data.size(); }
+  // Buffered data in write order
+  std::string contents() const;
+
+ private:
+  std::vector<char> m_data;
+  size_t m_head{0};
+  bool m_full{false};
+};
+
+/*!
+ * \brief The ToolOutputStream class
+ * Streams output of an external tool to its log and to the console. The log
+ * receives everything; console forwarding is batched by complete lines and
+ * rate limited, so a chatty tool doesn't flood the console with small
+ * writes. Console output can be capped: beyond the cap only the last
+ * tailSize bytes are kept and printed when the tool finishes. Tail mode
+ * prints only that tail.
+ */
+class ToolOutputStream {
+ public:
+  enum class ConsoleMode { Full, Tail };
+  struct Options {
+    ConsoleMode mode{ConsoleMode::Full};
+    uint64_t consoleCap{0};             // bytes, 0 - unlimited
+    size_t tailSize{64 * 1024};         // bytes
+    uint32_t flushInterval{100};        // ms
+    size_t flushThreshold{256 * 1024};  // bytes
+  };
+
+  ToolOutputStream(std::ostream* log, std::ostream* console,
+                   const Options& options);
+
+  void write(const char* data, size_t size);
+  // Flush pending console output if flush interval elapsed
+  void poll();
+  // Flush everything, logFile is mentioned if console output was truncated
+  void finish(const std::string& logFile = {});
+
+  uint64_t totalBytes() const { return m_total; }
+  uint64_t consoleBytes() const { return m_console; }
+  uint64_t skippedBytes() const { return m_skipped; }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+  void flush(bool all);
+
+  std::ostream* m_log{nullptr};
+  std::ostream* m_consoleStream{nullptr};
+  Options m_options;
+  std::string m_pending;
+  RingBuffer m_tail;
+  Clock::time_point m_lastFlush;
+  uint64_t m_total{0};
+  uint64_t m_console{0};
+  uint64_t m_skipped{0};
+  bool m_capReached{false};
+};
+
+}  // namespace FOEDAG
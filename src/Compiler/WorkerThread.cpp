@@ -47,7 +47,9 @@ bool WorkerThread::start() {
   QEventLoop* eventLoop{nullptr};
   const bool processEvents = isGui();
   if (processEvents) eventLoop = new QEventLoop;
-  m_thread = new std::thread([&, eventLoop] {
+  Project* project = Project::Scoped();
+  m_thread = new std::thread([&, eventLoop, project] {
+    Project::Scope scope{project};  // project of the calling flow
     result = m_compiler->Compile(m_action);
     if (eventLoop) eventLoop->quit();
   });
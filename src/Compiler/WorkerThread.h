@@ -34,6 +34,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Command/CommandStack.h"
 #include "Compiler/Compiler.h"
 #include "Main/CommandLine.h"
+#include "NewProject/ProjectManager/project.h"
 #include "Tcl/TclInterpreter.h"
 
 namespace FOEDAG {
@@ -64,10 +65,12 @@ class WorkerThread {
     QEventLoop* eventLoop{nullptr};
     const bool processEvents = isGui();
     if (processEvents) eventLoop = new QEventLoop;
+    Project* project = Project::Scoped();
     m_thread =
         // pack args as tuple for capturing
         new std::thread([&, args = std::make_tuple(std::forward<Args>(args)...),
-                         eventLoop]() mutable {
+                         eventLoop, project]() mutable {
+          Project::Scope scope{project};  // project of the calling flow
           // pass arguments to callback
           std::apply([&result, fn](auto&&... args) { result = fn(args...); },
                      std::move(args));
@@ -23,7 +23,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef _WIN32
 #include <Windows.h>
 #else
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
 #include <unistd.h>
+
+extern char** environ;
 #endif
 
 #include <algorithm>
@@ -509,41 +516,238 @@ int CFG_compiler_execute_cmd(const std::string& command,
   }
 }
 
-int CFG_execute_cmd(const std::string& cmd, std::string& output,
-                    std::ostream* outStream, std::atomic<bool>& stopCommand) {
-#ifdef _WIN32
-#define POPEN _popen
-#define PCLOSE _pclose
-#define WEXITSTATUS
-#else
-#define POPEN popen
-#define PCLOSE pclose
-#endif
+// Keeps the head and the tail of a stream of bytes
+class CFG_OUTPUT_CAPTURE {
+ public:
+  CFG_OUTPUT_CAPTURE(size_t head, size_t tail)
+      : m_head_limit(head), m_tail_limit(tail) {}
+  void append(const std::string& data) {
+    m_total += data.size();
+    size_t index = 0;
+    if (m_head.size() < m_head_limit) {
+      index = std::min(data.size(), m_head_limit - m_head.size());
+      m_head.append(data, 0, index);
+    }
+    if (index == data.size() || m_tail_limit == 0) {
+      return;
+    }
+    m_tail.append(data, index, std::string::npos);
+    // trim lazily, at most twice the tail is kept
+    if (m_tail.size() > 2 * m_tail_limit) {
+      m_tail.erase(0, m_tail.size() - m_tail_limit);
+    }
+  }
+  uint64_t total() const { return m_total; }
+  std::string result() const {
+    size_t tail_size = std::min(m_tail.size(), m_tail_limit);
+    uint64_t omitted = m_total - m_head.size() - tail_size;
+    std::string result = m_head;
+    if (omitted) {
+      result += CFG_print("\n... %lu bytes of output omitted ...\n",
+                          (unsigned long)(omitted));
+    }
+    result.append(m_tail, m_tail.size() - tail_size, std::string::npos);
+    return result;
+  }
 
-  FILE* pipe = POPEN(cmd.c_str(), "r");
-  if (pipe == nullptr) {
-    return -1;
+ private:
+  const size_t m_head_limit;
+  const size_t m_tail_limit;
+  uint64_t m_total = 0;
+  std::string m_head;
+  std::string m_tail;
+};
+
+// Split a stream into lines, a line longer than this is passed in pieces
+#define CFG_EXECUTE_MAX_LINE_SIZE (64 * 1024)
+#define CFG_EXECUTE_READ_SIZE (64 * 1024)
+#define CFG_EXECUTE_POLL_MS (100)
+#define CFG_EXECUTE_KILL_GRACE_MS (2000)
+
+static void CFG_execute_split_lines(
+    std::string& partial, const char* data, size_t size,
+    const std::function<void(const std::string&)>& deliver) {
+  partial.append(data, size);
+  size_t begin = 0;
+  size_t end = partial.find('\n');
+  while (end != std::string::npos) {
+    deliver(partial.substr(begin, end - begin + 1));
+    begin = end + 1;
+    end = partial.find('\n', begin);
+  }
+  partial.erase(0, begin);
+  if (partial.size() >= CFG_EXECUTE_MAX_LINE_SIZE) {
+    deliver(partial);
+    partial.clear();
   }
+}
 
-  // Read the output of the command and store it in the output string.
+CFG_EXECUTE_CMD_RESULT CFG_execute_cmd_ex(const std::string& cmd,
+                                          const CFG_EXECUTE_CMD_ARG& arg) {
+  CFG_EXECUTE_CMD_RESULT result;
+  CFG_OUTPUT_CAPTURE capture(arg.capture_head, arg.capture_tail);
+  auto deliver = [&](const std::string& line) {
+    capture.append(line);
+    if (arg.out_stream != nullptr) {
+      *arg.out_stream << line;
+    }
+    if (arg.line_callback != nullptr) {
+      arg.line_callback(line);
+    }
+  };
+  auto stop_requested = [&arg]() {
+    return arg.stop != nullptr && arg.stop->load();
+  };
+#ifdef _WIN32
+  // No process group nor non-blocking pipe here, stdout is read line by line
+  FILE* pipe = _popen(cmd.c_str(), "r");
+  if (pipe == nullptr) {
+    return result;
+  }
   char buffer[1024];
-  std::string newline;
-  while (fgets(buffer, sizeof(buffer), pipe) != nullptr && !stopCommand) {
-    output += buffer;
-    newline = buffer;
-
-    if (outStream) {
-      *outStream << newline;
+  std::string partial;
+  while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
+    CFG_execute_split_lines(partial, buffer, strlen(buffer), deliver);
+    if (stop_requested()) {
+      result.stopped = true;
+      break;
     }
+  }
+  if (partial.size()) {
+    deliver(partial);
+  }
+  int status = _pclose(pipe);
+  if (!result.stopped) {
+    result.exit_code = status;
+  }
+#else
+  int out_pipe[2] = {-1, -1};
+  int err_pipe[2] = {-1, -1};
+  if (pipe(out_pipe) != 0) {
+    return result;
+  }
+  if (pipe(err_pipe) != 0) {
+    close(out_pipe[0]);
+    close(out_pipe[1]);
+    return result;
+  }
+  for (int fd : {out_pipe[0], out_pipe[1], err_pipe[0], err_pipe[1]}) {
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+  }
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_adddup2(&actions, out_pipe[1], STDOUT_FILENO);
+  posix_spawn_file_actions_adddup2(&actions, err_pipe[1], STDERR_FILENO);
+  posix_spawnattr_t attr;
+  posix_spawnattr_init(&attr);
+  // Own process group so stop kills the whole tree. Signals are reset, the
+  // caller may block or ignore some of them.
+  posix_spawnattr_setpgroup(&attr, 0);
+  sigset_t signals;
+  sigemptyset(&signals);
+  posix_spawnattr_setsigmask(&attr, &signals);
+  sigaddset(&signals, SIGPIPE);
+  posix_spawnattr_setsigdefault(&attr, &signals);
+  posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP |
+                                      POSIX_SPAWN_SETSIGMASK |
+                                      POSIX_SPAWN_SETSIGDEF);
+  std::string shell_arg = "-c";
+  char* argv[] = {const_cast<char*>("sh"), &shell_arg[0],
+                  const_cast<char*>(cmd.c_str()), nullptr};
+  pid_t pid = 0;
+  int spawn_status =
+      posix_spawn(&pid, "/bin/sh", &actions, &attr, argv, environ);
+  posix_spawn_file_actions_destroy(&actions);
+  posix_spawnattr_destroy(&attr);
+  close(out_pipe[1]);
+  close(err_pipe[1]);
+  if (spawn_status != 0) {
+    close(out_pipe[0]);
+    close(err_pipe[0]);
+    return result;
+  }
 
-    if (stopCommand) {
+  std::vector<char> buffer(CFG_EXECUTE_READ_SIZE);
+  std::string partial[2];
+  struct pollfd fds[2] = {{out_pipe[0], POLLIN, 0}, {err_pipe[0], POLLIN, 0}};
+  auto start = std::chrono::steady_clock::now();
+  auto killed = start;
+  int kill_signal = 0;
+  while (fds[0].fd >= 0 || fds[1].fd >= 0) {
+    auto now = std::chrono::steady_clock::now();
+    if (kill_signal == 0) {
+      if (stop_requested()) {
+        result.stopped = true;
+      } else if (arg.timeout_ms &&
+                 now - start > std::chrono::milliseconds(arg.timeout_ms)) {
+        result.timed_out = true;
+      }
+      if (result.stopped || result.timed_out) {
+        kill_signal = SIGTERM;
+        kill(-pid, kill_signal);
+        killed = now;
+      }
+    } else if (now - killed >
+               std::chrono::milliseconds(CFG_EXECUTE_KILL_GRACE_MS)) {
+      if (kill_signal == SIGKILL) {
+        // pipe kept open by a process outside of the group
+        break;
+      }
+      kill_signal = SIGKILL;
+      kill(-pid, kill_signal);
+      killed = now;
+    }
+    if (poll(fds, 2, CFG_EXECUTE_POLL_MS) < 0 && errno != EINTR) {
       break;
     }
+    for (int i = 0; i < 2; i++) {
+      if (fds[i].fd < 0 ||
+          (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) == 0) {
+        continue;
+      }
+      ssize_t size = read(fds[i].fd, buffer.data(), buffer.size());
+      if (size > 0) {
+        CFG_execute_split_lines(partial[i], buffer.data(), (size_t)(size),
+                                deliver);
+      } else if (size == 0 || (errno != EINTR && errno != EAGAIN)) {
+        if (partial[i].size()) {
+          deliver(partial[i]);
+          partial[i].clear();
+        }
+        close(fds[i].fd);
+        fds[i].fd = -1;
+      }
+    }
   }
+  for (int i = 0; i < 2; i++) {
+    if (fds[i].fd >= 0) {
+      close(fds[i].fd);
+    }
+  }
+  int status = 0;
+  while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+  }
+  if (!result.stopped && !result.timed_out) {
+    if (WIFEXITED(status)) {
+      result.exit_code = WEXITSTATUS(status);
+    } else if (WIFSIGNALED(status)) {
+      result.exit_code = 128 + WTERMSIG(status);
+    }
+  }
+#endif
+  result.output_size = capture.total();
+  result.output = capture.result();
+  return result;
+}
 
-  int status = PCLOSE(pipe);
-  int exit_code = WEXITSTATUS(status);
-  return exit_code;
+int CFG_execute_cmd(const std::string& cmd, std::string& output,
+                    std::ostream* outStream, std::atomic<bool>& stopCommand) {
+  CFG_EXECUTE_CMD_ARG arg;
+  arg.out_stream = outStream;
+  arg.stop = &stopCommand;
+  CFG_EXECUTE_CMD_RESULT result = CFG_execute_cmd_ex(cmd, arg);
+  output += result.output;
+  return result.exit_code;
 }
 
 int CFG_execute_cmd_with_callback(
@@ -551,48 +755,21 @@ int CFG_execute_cmd_with_callback(
     std::regex patternToMatch, std::atomic<bool>& stopCommand,
     std::function<void(const std::string&)> progressCallback,
     std::function<void(const std::string&)> generalCallback) {
-#ifdef _WIN32
-#define POPEN _popen
-#define PCLOSE _pclose
-#define WEXITSTATUS
-#else
-#define POPEN popen
-#define PCLOSE pclose
-#endif
-
-  FILE* pipe = POPEN(cmd.c_str(), "r");
-  if (pipe == nullptr) {
-    return -1;
-  }
-
-  // Read the output of the command and store it in the output string.
-  char buffer[1024];
-  std::string newline;
-  while (fgets(buffer, sizeof(buffer), pipe) != nullptr && !stopCommand) {
-    output += buffer;
-    newline = buffer;
+  CFG_EXECUTE_CMD_ARG arg;
+  arg.out_stream = outStream;
+  arg.stop = &stopCommand;
+  arg.line_callback = [&](const std::string& line) {
     if (generalCallback != nullptr) {
-      generalCallback(newline);
-    }
-
-    if (outStream) {
-      *outStream << newline;
+      generalCallback(line);
     }
-
-    if (stopCommand) {
-      break;
-    }
-
     std::smatch matches;
-    if (progressCallback &&
-        std::regex_search(newline, matches, patternToMatch)) {
+    if (progressCallback && std::regex_search(line, matches, patternToMatch)) {
       progressCallback(matches.str());
     }
-  }
-
-  int status = PCLOSE(pipe);
-  int exit_code = WEXITSTATUS(status);
-  return exit_code;
+  };
+  CFG_EXECUTE_CMD_RESULT result = CFG_execute_cmd_ex(cmd, arg);
+  output += result.output;
+  return result.exit_code;
 }
 
 std::filesystem::path CFG_find_file(const std::filesystem::path& filePath,
@@ -950,6 +1127,9 @@ CFG_Python_MGR::~CFG_Python_MGR() {
   for (auto& iter : module_objs) {
     Py_XDECREF((PyObject*)(iter.second));
   }
+  for (auto& iter : code_objs) {
+    Py_XDECREF((PyObject*)(iter.second));
+  }
   Py_Finalize();
 }
 
@@ -991,6 +1171,58 @@ void CFG_Python_MGR::run(std::vector<std::string> commands,
   result_objs = CFG_Python(commands, results, dict_ptr);
 }
 
+void* CFG_Python_MGR::compile(const std::string& command) {
+  CFG_ASSERT(dict_ptr != nullptr);
+  auto iter = code_objs.find(command);
+  if (iter != code_objs.end()) {
+    return iter->second;
+  }
+  // Same mode as PyRun_String() in CFG_Python(). A statement that does not
+  // compile is cached as nullptr and skipped by run_compiled()
+  PyObject* code =
+      Py_CompileString(command.c_str(), "<string>", Py_single_input);
+  code_objs[command] = (void*)(code);
+  return (void*)(code);
+}
+
+void CFG_Python_MGR::bind(const std::string& name, CFG_Python_OBJ value) {
+  CFG_ASSERT(dict_ptr != nullptr);
+  PyObject* object = nullptr;
+  if (value.type == CFG_Python_OBJ::TYPE::BOOL) {
+    object = PyBool_FromLong(value.get_bool());
+  } else if (value.type == CFG_Python_OBJ::TYPE::INT) {
+    object = PyLong_FromUnsignedLong(value.get_u32());
+  } else if (value.type == CFG_Python_OBJ::TYPE::STR) {
+    object = PyUnicode_FromString(value.get_str().c_str());
+  } else {
+    CFG_INTERNAL_ERROR("Does not support binding CFG_Python_OBJ type %d",
+                       value.type);
+  }
+  CFG_ASSERT_MSG(object != nullptr, "Fail to bind Python variable %s",
+                 name.c_str());
+  PyObject* dict = static_cast<PyObject*>(dict_ptr);
+  CFG_ASSERT(PyDict_SetItemString(dict, name.c_str(), object) == 0);
+  Py_DECREF(object);
+}
+
+void CFG_Python_MGR::run_compiled(const std::vector<void*>& codes,
+                                  std::vector<std::string> results) {
+  CFG_ASSERT(dict_ptr != nullptr);
+  PyObject* dict = static_cast<PyObject*>(dict_ptr);
+  for (auto& code : codes) {
+    if (code != nullptr) {
+      PyObject* o = PyEval_EvalCode((PyObject*)(code), dict, dict);
+      if (o != nullptr) {
+        Py_DECREF(o);
+      }
+    }
+  }
+  result_objs.clear();
+  for (auto key : results) {
+    CFG_Python_get_result(dict, key, result_objs);
+  }
+}
+
 std::vector<CFG_Python_OBJ> CFG_Python_MGR::run_file(
     const std::string& module, const std::string& function,
     std::vector<CFG_Python_OBJ> args) {
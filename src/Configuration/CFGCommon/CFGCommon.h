@@ -87,6 +87,12 @@ class CFG_Python_MGR {
   ~CFG_Python_MGR();
   std::string set_file(const std::string& file);
   void run(std::vector<std::string> commands, std::vector<std::string> results);
+  // Compile a statement once, the code object is cached by its source
+  void* compile(const std::string& command);
+  // Set a variable that compiled statements can refer to
+  void bind(const std::string& name, CFG_Python_OBJ value);
+  void run_compiled(const std::vector<void*>& codes,
+                    std::vector<std::string> results);
   std::vector<CFG_Python_OBJ> run_file(const std::string& module,
                                        const std::string& function,
                                        std::vector<CFG_Python_OBJ> args);
@@ -102,6 +108,7 @@ class CFG_Python_MGR {
   void* dict_ptr = nullptr;
   std::map<std::string, CFG_Python_OBJ> result_objs;
   std::map<std::string, void*> module_objs;
+  std::map<std::string, void*> code_objs;
 };
 
 std::string CFG_print(const char* format_string, ...);
@@ -218,6 +225,36 @@ int CFG_compiler_execute_cmd(const std::string& command,
                              const std::string logFile = std::string{},
                              bool appendLog = false);
 
+// Options of CFG_execute_cmd_ex
+struct CFG_EXECUTE_CMD_ARG {
+  // 0 - no timeout
+  uint32_t timeout_ms = 0;
+  // Output keeps the first capture_head and the last capture_tail bytes, the
+  // middle of a huge output is dropped
+  size_t capture_head = 1024 * 1024;
+  size_t capture_tail = 1024 * 1024;
+  // Every stdout/stderr line (with its newline) in the order it is read
+  std::ostream* out_stream = nullptr;
+  std::function<void(const std::string&)> line_callback = nullptr;
+  // Checked while the command runs, the process group is killed when set
+  std::atomic<bool>* stop = nullptr;
+};
+
+struct CFG_EXECUTE_CMD_RESULT {
+  // Exit code, 128 + signal if the command was killed by a signal, -1 if it
+  // couldn't be started, was stopped or timed out
+  int exit_code = -1;
+  bool stopped = false;
+  bool timed_out = false;
+  uint64_t output_size = 0;  // bytes produced, including dropped ones
+  std::string output;        // head and tail of stdout and stderr
+};
+
+// Run command by the shell in its own process group. stdout and stderr are
+// read without blocking, memory use is bounded by the capture size.
+CFG_EXECUTE_CMD_RESULT CFG_execute_cmd_ex(const std::string& cmd,
+                                          const CFG_EXECUTE_CMD_ARG& arg);
+
 int CFG_execute_cmd(const std::string& cmd, std::string& output,
                     std::ostream* outStream, std::atomic<bool>& stopCommand);
 
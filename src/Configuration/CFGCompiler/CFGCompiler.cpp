@@ -28,6 +28,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 using namespace FOEDAG;
 
 static const CFGCompiler* m_CFGCompiler = nullptr;
+// Configuration running on this thread, flows of batch_run each have their own
+static thread_local const CFGCompiler* m_currentCFGCompiler = nullptr;
+
+// The configuration the CFG messages and commands go through
+static const CFGCompiler* currentCFGCompiler() {
+  return m_currentCFGCompiler ? m_currentCFGCompiler : m_CFGCompiler;
+}
 
 static bool programmer_flow(CFGCompiler* cfgcompiler, int argc,
                             const char* argv[]) {
@@ -65,12 +72,15 @@ static void generic_flow(CFGCompiler* cfgcompiler, const std::string& command,
 }
 
 CFGCompiler::CFGCompiler(Compiler* compiler) : m_compiler(compiler) {
+  // Flows of batch_run are only current while they configure
+  if (Project::Scoped()) return;
   m_CFGCompiler = this;
   CFG_set_callback_message_function(Message, ErrorMessage,
                                     ExecuteAndMonitorSystemCommand);
 }
 
 CFGCompiler::~CFGCompiler() {
+  if (m_CFGCompiler != this) return;
   m_CFGCompiler = nullptr;
   CFG_unset_callback_message_function();
 }
@@ -213,8 +223,9 @@ int CFGCompiler::GenericCompile(CFGCompiler* cfgcompiler, bool batchMode) {
 }
 
 void CFGCompiler::Message(const std::string& message, const bool raw) {
-  if (m_CFGCompiler != nullptr && m_CFGCompiler->GetCompiler() != nullptr) {
-    m_CFGCompiler->GetCompiler()->Message(message, "", raw);
+  const CFGCompiler* cfgCompiler = currentCFGCompiler();
+  if (cfgCompiler != nullptr && cfgCompiler->GetCompiler() != nullptr) {
+    cfgCompiler->GetCompiler()->Message(message, "", raw);
   } else {
     if (raw) {
       printf("%s", message.c_str());
@@ -226,8 +237,9 @@ void CFGCompiler::Message(const std::string& message, const bool raw) {
 }
 
 void CFGCompiler::ErrorMessage(const std::string& message, bool append) {
-  if (m_CFGCompiler != nullptr && m_CFGCompiler->GetCompiler() != nullptr) {
-    m_CFGCompiler->GetCompiler()->ErrorMessage(message, append);
+  const CFGCompiler* cfgCompiler = currentCFGCompiler();
+  if (cfgCompiler != nullptr && cfgCompiler->GetCompiler() != nullptr) {
+    cfgCompiler->GetCompiler()->ErrorMessage(message, append);
   } else {
     printf("ERROR: %s\n", message.c_str());
     fflush(stdout);
@@ -237,8 +249,9 @@ void CFGCompiler::ErrorMessage(const std::string& message, bool append) {
 int CFGCompiler::ExecuteAndMonitorSystemCommand(const std::string& command,
                                                 const std::string logFile,
                                                 bool appendLog) {
-  if (m_CFGCompiler != nullptr && m_CFGCompiler->GetCompiler() != nullptr) {
-    return m_CFGCompiler->GetCompiler()->ExecuteAndMonitorSystemCommand(
+  const CFGCompiler* cfgCompiler = currentCFGCompiler();
+  if (cfgCompiler != nullptr && cfgCompiler->GetCompiler() != nullptr) {
+    return cfgCompiler->GetCompiler()->ExecuteAndMonitorSystemCommand(
         command, logFile, appendLog);
   } else {
     std::string output = "";
@@ -256,6 +269,14 @@ int CFGCompiler::ExecuteAndMonitorSystemCommand(const std::string& command,
 */
 bool CFGCompiler::Configure() {
   bool status = false;
+  // Messages of the callbacks go to the compiler of this configuration
+  struct Current {
+    const CFGCompiler* previous{m_currentCFGCompiler};
+    explicit Current(const CFGCompiler* current) {
+      m_currentCFGCompiler = current;
+    }
+    ~Current() { m_currentCFGCompiler = previous; }
+  } current{this};
   if (m_callback_function_map.find(m_cmdarg.command) !=
       m_callback_function_map.end()) {
     try {
@@ -29,6 +29,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Configuration/CFGCommon/CFGCommon.h"
 #include "Configuration/HardwareManager/HardwareManager.h"
 #include "Configuration/HardwareManager/OpenocdHelper.h"
+#include "Configuration/HardwareManager/OpenocdSession.h"
 #include "Configuration/Programmer/Programmer_error_code.h"
 #include "Configuration/Programmer/Programmer_helper.h"
 namespace FOEDAG {
@@ -124,206 +125,98 @@ int OpenocdAdapter::program_fpga(const Device& device,
                                  std::ostream* outStream,
                                  OutputMessageCallback callbackMsg,
                                  ProgressCallback callbackProgress) {
-  int statusCode = ProgrammerErrorCode::NoError;
-  CFG_ASSERT(std::filesystem::exists(m_openocd));
-  std::string openocd_command =
-      create_openocd_command("fpga", device, m_taplist, bitfile, m_openocd);
-
-  // run the command
-  int res = CFG_execute_cmd_with_callback(
-      openocd_command, m_last_output, outStream, std::regex{}, stop, nullptr,
-      [&](const std::string& line) {
-        std::vector<std::string> data{};
-        switch (check_output(line, data)) {
-          case CMD_PROGRESS: {
-            double percent = std::strtod(data[0].c_str(), nullptr);
-            std::ostringstream stream;
-            if (callbackMsg != nullptr) {
-              if (percent < 100) {
-                callbackMsg(data[0]);
-              } else {
-                callbackMsg("99.99");
-              }
-            }
-            if (callbackProgress != nullptr) {
-              if (percent < 100) {
-                callbackProgress(data[0]);
-              } else {
-                callbackProgress("99.99");
-              }
-            }
-            break;
-          }
-          case CMD_ERROR:
-            statusCode = std::stoi(data[0]);
-            break;
-          case CMD_TIMEOUT:
-            statusCode = ProgrammerErrorCode::CmdTimeout;
-            break;
-          case CBUFFER_TIMEOUT:
-            statusCode = ProgrammerErrorCode::BufferTimeout;
-            break;
-          case CONFIG_ERROR:
-            statusCode = ProgrammerErrorCode::ConfigError;
-            break;
-          case CONFIG_SUCCESS:
-            if (callbackMsg != nullptr) callbackMsg("100.00");
-            if (callbackProgress != nullptr) callbackProgress("100.00");
-            break;
-          case UNKNOWN_FIRMWARE:
-            statusCode = ProgrammerErrorCode::UnknownFirmware;
-            break;
-          case FSBL_BOOT_FAILURE:
-            statusCode = ProgrammerErrorCode::FsblBootFail;
-            break;
-          default:
-            // callbackMsg(line);
-            break;
-        }
-      });
-
-  if (statusCode != ProgrammerErrorCode::NoError) {
-    return statusCode;
-  }
-
-  if (res != 0) {
-    statusCode = ProgrammerErrorCode::GeneralCmdError;
-  }
-  return statusCode;
+  return program("fpga", device, bitfile, stop, outStream, callbackMsg,
+                 callbackProgress);
 }
+
 int OpenocdAdapter::program_flash(
     const Device& device, const std::string& bitfile, std::atomic<bool>& stop,
     ProgramFlashOperation modes, std::ostream* outStream,
     OutputMessageCallback callbackMsg, ProgressCallback callbackProgress) {
-  int statusCode = ProgrammerErrorCode::NoError;
-  CFG_ASSERT(std::filesystem::exists(m_openocd));
-  std::string openocd_command =
-      create_openocd_command("flash", device, m_taplist, bitfile, m_openocd);
-  ;
-  // run the command
-  int res = CFG_execute_cmd_with_callback(
-      openocd_command, m_last_output, outStream, std::regex{}, stop, nullptr,
-      [&](const std::string& line) {
-        std::vector<std::string> data{};
-        switch (check_output(line, data)) {
-          case CMD_PROGRESS: {
-            double percent = std::strtod(data[0].c_str(), nullptr);
-            std::ostringstream stream;
-            if (callbackMsg != nullptr) {
-              if (percent < 100) {
-                callbackMsg(data[0]);
-              } else {
-                callbackMsg("99.99");
-              }
-            }
-            if (callbackProgress != nullptr) {
-              if (percent < 100) {
-                callbackProgress(data[0]);
-              } else {
-                callbackProgress("99.99");
-              }
-            }
-            break;
-          }
-          case CMD_ERROR:
-            statusCode = std::stoi(data[0]);
-            break;
-          case CMD_TIMEOUT:
-            statusCode = ProgrammerErrorCode::CmdTimeout;
-            break;
-          case CBUFFER_TIMEOUT:
-            statusCode = ProgrammerErrorCode::BufferTimeout;
-            break;
-          case CONFIG_ERROR:
-            statusCode = ProgrammerErrorCode::ConfigError;
-            break;
-          case CONFIG_SUCCESS:
-            if (callbackMsg != nullptr) callbackMsg("100.00");
-            if (callbackProgress != nullptr) callbackProgress("100.00");
-            break;
-          case UNKNOWN_FIRMWARE:
-            statusCode = ProgrammerErrorCode::UnknownFirmware;
-            break;
-          case FSBL_BOOT_FAILURE:
-            statusCode = ProgrammerErrorCode::FsblBootFail;
-            break;
-          default:
-            // callbackMsg(line);
-            break;
-        }
-      });
-
-  if (statusCode != ProgrammerErrorCode::NoError) {
-    return statusCode;
-  }
-
-  if (res != 0) {
-    statusCode = ProgrammerErrorCode::GeneralCmdError;
-  }
-  return statusCode;
+  return program("flash", device, bitfile, stop, outStream, callbackMsg,
+                 callbackProgress);
 }
+
 int OpenocdAdapter::program_otp(const Device& device,
                                 const std::string& bitfile,
                                 std::atomic<bool>& stop,
                                 std::ostream* outStream,
                                 OutputMessageCallback callbackMsg,
                                 ProgressCallback callbackProgress) {
+  return program("otp", device, bitfile, stop, outStream, callbackMsg,
+                 callbackProgress);
+}
+
+int OpenocdAdapter::program(const std::string& subcmd, const Device& device,
+                            const std::string& bitfile,
+                            std::atomic<bool>& stop, std::ostream* outStream,
+                            OutputMessageCallback callbackMsg,
+                            ProgressCallback callbackProgress) {
   int statusCode = ProgrammerErrorCode::NoError;
   CFG_ASSERT(std::filesystem::exists(m_openocd));
-  std::string openocd_command =
-      create_openocd_command("otp", device, m_taplist, bitfile, m_openocd);
-  // run the openocd_command
-  int res = CFG_execute_cmd_with_callback(
-      openocd_command, m_last_output, outStream, std::regex{}, stop, nullptr,
-      [&](const std::string& line) {
-        std::vector<std::string> data{};
-        switch (check_output(line, data)) {
-          case CMD_PROGRESS: {
-            double percent = std::strtod(data[0].c_str(), nullptr);
-            std::ostringstream stream;
-            if (callbackMsg != nullptr) {
-              if (percent < 100) {
-                callbackMsg(data[0]);
-              } else {
-                callbackMsg("99.99");
-              }
-            }
-            if (callbackProgress != nullptr) {
-              if (percent < 100) {
-                callbackProgress(data[0]);
-              } else {
-                callbackProgress("99.99");
-              }
-            }
-            break;
+  auto checkLine = [&](const std::string& line) {
+    std::vector<std::string> data{};
+    switch (check_output(line, data)) {
+      case CMD_PROGRESS: {
+        double percent = std::strtod(data[0].c_str(), nullptr);
+        if (callbackMsg != nullptr) {
+          if (percent < 100) {
+            callbackMsg(data[0]);
+          } else {
+            callbackMsg("99.99");
+          }
+        }
+        if (callbackProgress != nullptr) {
+          if (percent < 100) {
+            callbackProgress(data[0]);
+          } else {
+            callbackProgress("99.99");
           }
-          case CMD_ERROR:
-            statusCode = std::stoi(data[0]);
-            break;
-          case CMD_TIMEOUT:
-            statusCode = ProgrammerErrorCode::CmdTimeout;
-            break;
-          case CBUFFER_TIMEOUT:
-            statusCode = ProgrammerErrorCode::BufferTimeout;
-            break;
-          case CONFIG_ERROR:
-            statusCode = ProgrammerErrorCode::ConfigError;
-            break;
-          case CONFIG_SUCCESS:
-            if (callbackMsg != nullptr) callbackMsg("100.00");
-            if (callbackProgress != nullptr) callbackProgress("100.00");
-            break;
-          case UNKNOWN_FIRMWARE:
-            statusCode = ProgrammerErrorCode::UnknownFirmware;
-            break;
-          case FSBL_BOOT_FAILURE:
-            statusCode = ProgrammerErrorCode::FsblBootFail;
-            break;
-          default:
-            // callbackMsg(line);
-            break;
         }
-      });
+        break;
+      }
+      case CMD_ERROR:
+        statusCode = std::stoi(data[0]);
+        break;
+      case CMD_TIMEOUT:
+        statusCode = ProgrammerErrorCode::CmdTimeout;
+        break;
+      case CBUFFER_TIMEOUT:
+        statusCode = ProgrammerErrorCode::BufferTimeout;
+        break;
+      case CONFIG_ERROR:
+        statusCode = ProgrammerErrorCode::ConfigError;
+        break;
+      case CONFIG_SUCCESS:
+        if (callbackMsg != nullptr) callbackMsg("100.00");
+        if (callbackProgress != nullptr) callbackProgress("100.00");
+        break;
+      case UNKNOWN_FIRMWARE:
+        statusCode = ProgrammerErrorCode::UnknownFirmware;
+        break;
+      case FSBL_BOOT_FAILURE:
+        statusCode = ProgrammerErrorCode::FsblBootFail;
+        break;
+      default:
+        // callbackMsg(line);
+        break;
+    }
+  };
+
+  // run the command
+  int res{0};
+  m_last_output.clear();
+  const std::string targetConfig =
+      build_tap_config(m_taplist) + build_target_config(device);
+  if (!execute_in_session(device.cable, targetConfig,
+                          create_load_command(subcmd, device, bitfile),
+                          m_last_output, stop, outStream, checkLine, res)) {
+    std::string openocd_command =
+        create_openocd_command(subcmd, device, m_taplist, bitfile, m_openocd);
+    res = CFG_execute_cmd_with_callback(openocd_command, m_last_output,
+                                        outStream, std::regex{}, stop,
+                                        nullptr, checkLine);
+  }
 
   if (statusCode != ProgrammerErrorCode::NoError) {
     return statusCode;
@@ -343,20 +236,25 @@ int OpenocdAdapter::query_fpga_status(const Device& device,
   std::string cmdOutput, outputMsg;
   CFG_ASSERT(std::filesystem::exists(m_openocd));
 
-  ss << " -l /dev/stdout"  //<-- not windows friendly
-     << " -d2";
+  std::string cmd = "gemini status 1 fpga ";
+  const std::string targetConfig =
+      build_tap_config(m_taplist) + build_target_config(device);
 
-  ss << build_cable_config(device.cable) << build_tap_config(m_taplist)
-     << build_target_config(device);
+  int result{0};
+  if (!execute_in_session(device.cable, targetConfig, cmd, cmdOutput,
+                          stopCommand, nullptr, nullptr, result)) {
+    ss << " -l /dev/stdout"  //<-- not windows friendly
+       << " -d2";
 
-  std::string cmd = "gemini status 1 fpga ";
+    ss << build_cable_config(device.cable) << targetConfig;
 
-  ss << " -c \"init\"";
-  ss << " -c \"" << cmd << "\"";
-  ss << " -c \"exit\"";
+    ss << " -c \"init\"";
+    ss << " -c \"" << cmd << "\"";
+    ss << " -c \"exit\"";
 
-  int result = CFG_execute_cmd("OPENOCD_DEBUG_LEVEL=-3 " + m_openocd + ss.str(),
-                               cmdOutput, nullptr, stopCommand);
+    result = CFG_execute_cmd("OPENOCD_DEBUG_LEVEL=-3 " + m_openocd + ss.str(),
+                             cmdOutput, nullptr, stopCommand);
+  }
   outputString = cmdOutput;
   if (result != 0) {
     return ProgrammerErrorCode::GeneralCmdError;  // general cmdline error
@@ -377,6 +275,10 @@ int OpenocdAdapter::execute(const Cable& cable, std::string cmd,
 
   CFG_ASSERT(std::filesystem::exists(m_openocd));
 
+  int res{0};
+  if (execute_in_session(cable, {}, cmd, output, stop, nullptr, nullptr, res))
+    return res;
+
   ss << " -l /dev/stdout"  //<-- not windows friendly
      << " -d2";
   ss << build_cable_config(cable);
@@ -385,9 +287,33 @@ int OpenocdAdapter::execute(const Cable& cable, std::string cmd,
   ss << " -c \"exit\"";
 
   // run the command
-  int res = CFG_execute_cmd("OPENOCD_DEBUG_LEVEL=-3 " + m_openocd + ss.str(),
-                            output, nullptr, stop);
+  res = CFG_execute_cmd("OPENOCD_DEBUG_LEVEL=-3 " + m_openocd + ss.str(),
+                        output, nullptr, stop);
   return res;
 }
 
+bool OpenocdAdapter::execute_in_session(
+    const Cable& cable, const std::string& targetConfig,
+    const std::string& cmd, std::string& output, std::atomic<bool>& stop,
+    std::ostream* outStream,
+    const std::function<void(const std::string&)>& lineCallback,
+    int& result) {
+  if (m_sessions == nullptr) return false;
+  // A lost session is relaunched once, then the command runs without session
+  for (int attempt = 0; attempt < 2; attempt++) {
+    std::string error;
+    auto session = m_sessions->acquire(m_openocd, cable, targetConfig, error);
+    if (!session) {
+      // Warned once per cable, later commands fall back quietly
+      if (!error.empty()) CFG_post_warning(error);
+      return false;
+    }
+    const size_t outputSize = output.size();
+    result = session->execute(cmd, output, stop, outStream, lineCallback);
+    if (result != -1 || stop) return true;
+    output.resize(outputSize);
+  }
+  return false;
+}
+
 }  // namespace FOEDAG
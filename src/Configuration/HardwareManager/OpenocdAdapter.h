@@ -33,6 +33,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Tap.h"
 namespace FOEDAG {
 
+class OpenocdSessionPool;
+
 enum CommandOutputType {
   NOT_OUTPUT = 0,
   CMD_PROGRESS,
@@ -77,10 +79,27 @@ class OpenocdAdapter : public JtagAdapter, public ProgrammingAdapter {
   std::string get_last_output() { return m_last_output; };
 
   void update_taplist(const std::vector<Tap>& taplist);
+  // Run commands in long-lived OpenOCD sessions of the pool instead of one
+  // OpenOCD process per command. Falls back to a process per command if a
+  // session can't be started.
+  void set_session_pool(OpenocdSessionPool* pool) { m_sessions = pool; }
 
  private:
   int execute(const Cable& cable, std::string cmd, std::string& output);
+  int program(const std::string& subcmd, const Device& device,
+              const std::string& bitfile, std::atomic<bool>& stop,
+              std::ostream* outStream, OutputMessageCallback callbackMsg,
+              ProgressCallback callbackProgress);
+  // Return false if the pool has no session for the cable or the session was
+  // lost again after a relaunch, the command runs without session then
+  bool execute_in_session(const Cable& cable, const std::string& targetConfig,
+                          const std::string& cmd, std::string& output,
+                          std::atomic<bool>& stop, std::ostream* outStream,
+                          const std::function<void(const std::string&)>&
+                              lineCallback,
+                          int& result);
   std::string m_openocd;
+  OpenocdSessionPool* m_sessions{nullptr};
   std::vector<Tap> m_taplist;
   std::string m_last_output;
 };
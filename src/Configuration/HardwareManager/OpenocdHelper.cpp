@@ -97,6 +97,13 @@ std::string build_target_config(const Device& device) {
   return ss.str();
 }
 
+std::string create_load_command(const std::string& subcmd,
+                                const Device& device,
+                                const std::string& bitfile) {
+  return "gemini load  1 " + subcmd + " " + bitfile + " -p 1 -d " +
+         (device.type == DeviceType::VIRGO ? "virgo" : "gemini");
+}
+
 std::string create_openocd_command(const std::string& subcmd,
                                    const Device& device,
                                    const std::vector<Tap>& taplist,
@@ -109,8 +116,7 @@ std::string create_openocd_command(const std::string& subcmd,
   ss << build_cable_config(device.cable) << build_tap_config(taplist)
      << build_target_config(device);
 
-  std::string cmd = "gemini load  1 " + subcmd + " " + bitfile + " -p 1 -d " +
-                    (device.type == DeviceType::VIRGO ? "virgo" : "gemini");
+  std::string cmd = create_load_command(subcmd, device, bitfile);
 
   ss << " -c \"init\"";
   ss << " -c \"" << cmd << "\"";
@@ -33,6 +33,9 @@ std::string convert_transport_to_string(TransportType transport,
 std::string build_cable_config(const Cable& cable);
 std::string build_tap_config(const std::vector<Tap>& taplist);
 std::string build_target_config(const Device& device);
+std::string create_load_command(const std::string& subcmd,
+                                const Device& device,
+                                const std::string& bitfile);
 std::string create_openocd_command(const std::string& subcmd,
                                    const Device& device,
                                    const std::vector<Tap>& taplist,
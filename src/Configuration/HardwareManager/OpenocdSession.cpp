@@ -0,0 +1,607 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "OpenocdSession.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+#include "OpenocdHelper.h"
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+#if defined(__GLIBC__) && \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 34))
+#define OPENOCD_SPAWN_CLOSEFROM
+#endif
+#endif
+
+namespace FOEDAG {
+
+using Clock = std::chrono::steady_clock;
+static constexpr auto kStartTimeout = std::chrono::seconds(10);
+static constexpr auto kShutdownTimeout = std::chrono::seconds(2);
+// Log lines of a command are expected right after its result
+static constexpr auto kMarkerTimeout = std::chrono::milliseconds(500);
+static constexpr int kPollInterval = 50;  // ms
+// A session not used for this long is closed
+static constexpr auto kIdleTimeout = std::chrono::minutes(5);
+
+#ifdef _WIN32
+
+TclRpcClient::~TclRpcClient() {}
+bool TclRpcClient::connect(const std::string&, uint16_t) { return false; }
+void TclRpcClient::close() {}
+bool TclRpcClient::send(const std::string&) { return false; }
+bool TclRpcClient::read() { return false; }
+
+OpenocdSession::~OpenocdSession() {}
+
+std::unique_ptr<OpenocdSession> OpenocdSession::launch(const std::string&,
+                                                       const std::string&,
+                                                       std::string& error) {
+  error = "OpenOCD sessions are not supported on this platform";
+  return nullptr;
+}
+
+std::unique_ptr<OpenocdSession> OpenocdSession::attach(const std::string&,
+                                                       uint16_t, int,
+                                                       std::string& error) {
+  error = "OpenOCD sessions are not supported on this platform";
+  return nullptr;
+}
+
+int OpenocdSession::execute(const std::string&, std::string&,
+                            std::atomic<bool>&, std::ostream*,
+                            SessionLineCallback) {
+  return -1;
+}
+
+bool OpenocdSession::alive() { return false; }
+
+void OpenocdSession::close() {}
+
+#else
+
+static void set_nonblocking(int fd) {
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
+
+// Descriptors of the sessions are never inherited by other children, even
+// the ones started by other threads between creation and fcntl
+static int open_socket() {
+#ifdef SOCK_CLOEXEC
+  return ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+#else
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (fd >= 0) fcntl(fd, F_SETFD, FD_CLOEXEC);
+  return fd;
+#endif
+}
+
+static bool open_pipe(int fds[2]) {
+#ifdef __linux__
+  return ::pipe2(fds, O_CLOEXEC) == 0;
+#else
+  if (::pipe(fds) != 0) return false;
+  fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+  fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+  return true;
+#endif
+}
+
+static uint16_t free_local_port() {
+  int fd = open_socket();
+  if (fd < 0) return 0;
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+  socklen_t len = sizeof(addr);
+  uint16_t port{0};
+  if (::bind(fd, (sockaddr*)&addr, sizeof(addr)) == 0 &&
+      ::getsockname(fd, (sockaddr*)&addr, &len) == 0)
+    port = ntohs(addr.sin_port);
+  ::close(fd);
+  return port;
+}
+
+TclRpcClient::~TclRpcClient() { close(); }
+
+bool TclRpcClient::connect(const std::string& host, uint16_t port) {
+  close();
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) return false;
+  int fd = open_socket();
+  if (fd < 0) return false;
+  if (::connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+    ::close(fd);
+    return false;
+  }
+  int one{1};
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#ifdef SO_NOSIGPIPE
+  setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+  set_nonblocking(fd);
+  m_fd = fd;
+  m_buffer.clear();
+  return true;
+}
+
+void TclRpcClient::close() {
+  if (m_fd >= 0) ::close(m_fd);
+  m_fd = -1;
+}
+
+bool TclRpcClient::send(const std::string& cmd) {
+  if (m_fd < 0) return false;
+  const std::string data = cmd + kTerminator;
+#ifdef MSG_NOSIGNAL
+  const int flags{MSG_NOSIGNAL};
+#else
+  const int flags{0};
+#endif
+  size_t sent{0};
+  while (sent < data.size()) {
+    ssize_t n = ::send(m_fd, data.data() + sent, data.size() - sent, flags);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        pollfd pfd{m_fd, POLLOUT, 0};
+        ::poll(&pfd, 1, kPollInterval);
+        continue;
+      }
+      return false;
+    }
+    sent += static_cast<size_t>(n);
+  }
+  return true;
+}
+
+bool TclRpcClient::read() {
+  if (m_fd < 0) return false;
+  char buffer[4096];
+  while (true) {
+    ssize_t n = ::recv(m_fd, buffer, sizeof(buffer), 0);
+    if (n > 0) {
+      m_buffer.append(buffer, static_cast<size_t>(n));
+      continue;
+    }
+    if (n == 0) return false;
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+  }
+}
+
+OpenocdSession::~OpenocdSession() { close(); }
+
+std::unique_ptr<OpenocdSession> OpenocdSession::launch(
+    const std::string& openocd, const std::string& config,
+    std::string& error) {
+  const uint16_t port = free_local_port();
+  if (port == 0) {
+    error = "No free local port for OpenOCD Tcl RPC";
+    return nullptr;
+  }
+  // same invocation as single commands, but stay alive after init
+  const std::string cmdline = "OPENOCD_DEBUG_LEVEL=-3 exec " + openocd +
+                              " -l /dev/stdout -d2" + config +
+                              " -c \"tcl_port " + std::to_string(port) +
+                              "\" -c \"init\"";
+  int pipefd[2];
+  if (!open_pipe(pipefd)) {
+    error = "Failed to create OpenOCD output pipe";
+    return nullptr;
+  }
+  // Spawned rather than forked: the caller has other threads, and OpenOCD
+  // only keeps the output pipe of all the descriptors of this process
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_adddup2(&actions, pipefd[1], STDOUT_FILENO);
+  posix_spawn_file_actions_adddup2(&actions, pipefd[1], STDERR_FILENO);
+#ifdef OPENOCD_SPAWN_CLOSEFROM
+  posix_spawn_file_actions_addclosefrom_np(&actions, STDERR_FILENO + 1);
+#endif
+  posix_spawnattr_t attr;
+  posix_spawnattr_init(&attr);
+  short flags{POSIX_SPAWN_SETPGROUP};
+#ifdef POSIX_SPAWN_CLOEXEC_DEFAULT
+  flags |= POSIX_SPAWN_CLOEXEC_DEFAULT;
+#endif
+  posix_spawnattr_setflags(&attr, flags);
+  // own process group, so the whole tree can be stopped
+  posix_spawnattr_setpgroup(&attr, 0);
+  const char* argv[] = {"sh", "-c", cmdline.c_str(), nullptr};
+  pid_t pid{-1};
+  const int spawned = ::posix_spawn(&pid, "/bin/sh", &actions, &attr,
+                                    const_cast<char* const*>(argv), environ);
+  posix_spawnattr_destroy(&attr);
+  posix_spawn_file_actions_destroy(&actions);
+  if (spawned != 0) {
+    ::close(pipefd[0]);
+    ::close(pipefd[1]);
+    error = "Failed to start OpenOCD";
+    return nullptr;
+  }
+  ::close(pipefd[1]);
+  set_nonblocking(pipefd[0]);
+
+  std::unique_ptr<OpenocdSession> session{new OpenocdSession};
+  session->m_pid = pid;
+  session->m_logFd = pipefd[0];
+  std::string startupLog;
+  bool unused{false};
+  const auto deadline = Clock::now() + kStartTimeout;
+  while (Clock::now() < deadline) {
+    pollfd pfd{session->m_logFd, POLLIN, 0};
+    ::poll(&pfd, 1, kPollInterval);
+    if ((pfd.revents & (POLLIN | POLLHUP)) &&
+        !session->read_log(startupLog, nullptr, nullptr, {}, unused)) {
+      break;  // OpenOCD exited, most likely failed to init the cable
+    }
+    if (session->m_rpc.connect("127.0.0.1", port)) return session;
+  }
+  error = "Failed to start OpenOCD session:\n" + startupLog;
+  return nullptr;
+}
+
+std::unique_ptr<OpenocdSession> OpenocdSession::attach(const std::string& host,
+                                                       uint16_t port,
+                                                       int logFd,
+                                                       std::string& error) {
+  std::unique_ptr<OpenocdSession> session{new OpenocdSession};
+  if (logFd >= 0) {
+    set_nonblocking(logFd);
+    session->m_logFd = logFd;
+  }
+  if (!session->m_rpc.connect(host, port)) {
+    error = "Failed to connect to OpenOCD at " + host + ":" +
+            std::to_string(port);
+    return nullptr;
+  }
+  return session;
+}
+
+bool OpenocdSession::read_log(std::string& output, std::ostream* outStream,
+                              const SessionLineCallback& lineCallback,
+                              const std::string& marker, bool& markerSeen) {
+  char buffer[4096];
+  ssize_t n = ::read(m_logFd, buffer, sizeof(buffer));
+  if (n == 0) return false;
+  if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+  m_logBuffer.append(buffer, static_cast<size_t>(n));
+  size_t begin{0};
+  for (size_t end = m_logBuffer.find('\n'); end != std::string::npos;
+       end = m_logBuffer.find('\n', begin)) {
+    const std::string line = m_logBuffer.substr(begin, end - begin + 1);
+    begin = end + 1;
+    if (!marker.empty() && line.compare(0, marker.size(), marker) == 0) {
+      markerSeen = true;
+      continue;
+    }
+    output += line;
+    if (outStream) *outStream << line;
+    if (lineCallback) lineCallback(line);
+  }
+  m_logBuffer.erase(0, begin);
+  return true;
+}
+
+int OpenocdSession::execute(const std::string& cmd, std::string& output,
+                            std::atomic<bool>& stop, std::ostream* outStream,
+                            SessionLineCallback lineCallback) {
+  if (!alive()) return -1;
+  bool unused{false};
+  if (m_logFd >= 0) {
+    // drop whatever was logged between commands
+    std::string idleLog;
+    pollfd pfd{m_logFd, POLLIN, 0};
+    while (::poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN) &&
+           read_log(idleLog, nullptr, nullptr, {}, unused)) {
+      idleLog.clear();
+    }
+    m_logBuffer.clear();
+  }
+
+  // The result of a command doesn't tell if it failed and the log goes to
+  // stdout, so catch the error code and echo a marker into the log
+  const std::string marker =
+      "@@openocd_session_" + std::to_string(++m_commandId) + "@@";
+  const std::string wrapped = "set _session_rc [catch {" + cmd +
+                              "} _session_out]; echo {" + marker +
+                              "}; format \"%d\\n%s\" $_session_rc "
+                              "$_session_out";
+  if (!m_rpc.send(wrapped)) {
+    terminate();
+    return -1;
+  }
+
+  bool markerSeen = (m_logFd < 0) || !m_markerSupported;
+  bool responded{false};
+  std::string response;
+  Clock::time_point responseTime;
+  while (true) {
+    if (stop) {
+      terminate();
+      return -1;
+    }
+    pollfd pfd[2] = {{responded ? -1 : m_rpc.fd(), POLLIN, 0},
+                     {markerSeen ? -1 : m_logFd, POLLIN, 0}};
+    ::poll(pfd, 2, kPollInterval);
+    if ((pfd[1].revents & (POLLIN | POLLHUP)) &&
+        !read_log(output, outStream, lineCallback, marker, markerSeen)) {
+      ::close(m_logFd);
+      m_logFd = -1;
+      markerSeen = true;
+    }
+    if (pfd[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+      if (!m_rpc.read()) {
+        terminate();
+        return -1;
+      }
+      if (m_rpc.take_response(response)) {
+        responded = true;
+        responseTime = Clock::now();
+      }
+    }
+    if (responded && markerSeen) break;
+    if (responded && Clock::now() - responseTime > kMarkerTimeout) {
+      // echo doesn't reach the log of this OpenOCD, don't wait next time
+      m_markerSupported = false;
+      break;
+    }
+  }
+
+  int result{0};
+  std::string text{response};
+  const size_t eol = response.find('\n');
+  const std::string code = response.substr(0, eol);
+  if (!code.empty() &&
+      code.find_first_not_of("0123456789") == std::string::npos) {
+    result = std::atoi(code.c_str());
+    text = (eol == std::string::npos) ? std::string{}
+                                      : response.substr(eol + 1);
+  }
+  if (!text.empty() && text.back() != '\n') text += '\n';
+  output += text;
+  if (outStream) *outStream << text;
+  return result;
+}
+
+bool OpenocdSession::alive() {
+  if (!m_rpc.connected()) return false;
+  if (m_pid > 0) {
+    int status{0};
+    if (::waitpid(static_cast<pid_t>(m_pid), &status, WNOHANG) ==
+        static_cast<pid_t>(m_pid)) {
+      // OpenOCD is gone, there is nothing left to stop
+      m_pid = -1;
+      terminate();
+      return false;
+    }
+  }
+  return true;
+}
+
+void OpenocdSession::close() {
+  if (m_pid > 0 && m_rpc.send("shutdown")) {
+    const auto deadline = Clock::now() + kShutdownTimeout;
+    while (Clock::now() < deadline) {
+      int status{0};
+      if (::waitpid(static_cast<pid_t>(m_pid), &status, WNOHANG) ==
+          static_cast<pid_t>(m_pid)) {
+        m_pid = -1;
+        break;
+      }
+      std::string log;
+      bool unused{false};
+      pollfd pfd{m_logFd, POLLIN, 0};
+      ::poll(&pfd, 1, kPollInterval);
+      if (pfd.revents & POLLIN) read_log(log, nullptr, nullptr, {}, unused);
+    }
+  }
+  terminate();
+}
+
+void OpenocdSession::terminate() {
+  m_rpc.close();
+  if (m_logFd >= 0) ::close(m_logFd);
+  m_logFd = -1;
+  if (m_pid <= 0) return;
+  const pid_t pid = static_cast<pid_t>(m_pid);
+  m_pid = -1;
+  ::kill(-pid, SIGTERM);
+  const auto deadline = Clock::now() + kShutdownTimeout;
+  int status{0};
+  while (::waitpid(pid, &status, WNOHANG) == 0) {
+    if (Clock::now() > deadline) {
+      ::kill(-pid, SIGKILL);
+      ::waitpid(pid, &status, 0);
+      break;
+    }
+    ::usleep(kPollInterval * 1000);
+  }
+}
+
+#endif
+
+bool TclRpcClient::take_response(std::string& response) {
+  const size_t end = m_buffer.find(kTerminator);
+  if (end == std::string::npos) return false;
+  response = m_buffer.substr(0, end);
+  m_buffer.erase(0, end + 1);
+  return true;
+}
+
+OpenocdSessionPool::OpenocdSessionPool()
+    : OpenocdSessionPool(&OpenocdSession::launch) {}
+
+OpenocdSessionPool::OpenocdSessionPool(const Factory& factory)
+    : m_factory(factory), m_idleTimeout(kIdleTimeout) {}
+
+OpenocdSessionPool::~OpenocdSessionPool() {
+  {
+    std::lock_guard<std::mutex> guard{m_mutex};
+    m_stopping = true;
+  }
+  m_idleChanged.notify_all();
+  if (m_idleThread.joinable()) m_idleThread.join();
+  close_all();
+}
+
+void OpenocdSessionPool::set_idle_timeout(Clock::duration timeout) {
+  std::lock_guard<std::mutex> guard{m_mutex};
+  m_idleTimeout = timeout;
+  m_idleChanged.notify_all();
+}
+
+OpenocdSessionPool::Lease OpenocdSessionPool::acquire(
+    const std::string& openocd, const Cable& cable,
+    const std::string& targetConfig, std::string& error) {
+  Entry* entry{nullptr};
+  {
+    std::lock_guard<std::mutex> guard{m_mutex};
+    auto& item = m_entries[cable.name];
+    if (!item) item = std::make_unique<Entry>();
+    entry = item.get();
+    if (!m_idleThread.joinable())
+      m_idleThread = std::thread{&OpenocdSessionPool::close_idle, this};
+  }
+  std::unique_lock<std::mutex> lock{entry->mutex};
+  const std::string cableConfig = build_cable_config(cable);
+  const bool reuse =
+      entry->session && entry->session->alive() &&
+      entry->openocd == openocd && entry->cableConfig == cableConfig &&
+      (targetConfig.empty() || entry->targetConfig == targetConfig);
+  if (!reuse) {
+    entry->session.reset();
+    m_launchCount++;
+    std::string launchError;
+    entry->session =
+        m_factory(openocd, cableConfig + targetConfig, launchError);
+    if (!entry->session) {
+      if (!entry->launchFailed) error = launchError;
+      entry->launchFailed = true;
+      return {};
+    }
+    entry->launchFailed = false;
+    entry->openocd = openocd;
+    entry->cableConfig = cableConfig;
+    entry->targetConfig = targetConfig;
+    m_idleChanged.notify_all();
+  }
+  return Lease{std::move(lock), entry->session.get(), &entry->lastUsed};
+}
+
+void OpenocdSessionPool::close(const Cable& cable) {
+  Entry* entry{nullptr};
+  {
+    std::lock_guard<std::mutex> guard{m_mutex};
+    auto it = m_entries.find(cable.name);
+    if (it == m_entries.end()) return;
+    entry = it->second.get();
+  }
+  std::lock_guard<std::mutex> lock{entry->mutex};
+  entry->session.reset();
+}
+
+void OpenocdSessionPool::close_released(const std::vector<Cable>& connected) {
+  std::vector<Entry*> released;
+  {
+    std::lock_guard<std::mutex> guard{m_mutex};
+    for (auto& [name, entry] : m_entries) {
+      auto it = std::find_if(
+          connected.begin(), connected.end(),
+          [&name = name](const Cable& cable) { return cable.name == name; });
+      if (it == connected.end()) released.push_back(entry.get());
+    }
+  }
+  for (Entry* entry : released) {
+    std::lock_guard<std::mutex> lock{entry->mutex};
+    entry->session.reset();
+  }
+}
+
+void OpenocdSessionPool::close_idle() {
+  std::unique_lock<std::mutex> guard{m_mutex};
+  while (!m_stopping) {
+    const auto now = Clock::now();
+    // the wake up of a new session may come before the wait, check again
+    // after the timeout in any case
+    auto next = now + m_idleTimeout;
+    std::vector<std::unique_ptr<OpenocdSession>> idle;
+    for (auto& [name, entry] : m_entries) {
+      std::unique_lock<std::mutex> lock{entry->mutex, std::try_to_lock};
+      // a session in use is idle from the release of its lease
+      if (lock && entry->session) {
+        const auto expiry = entry->lastUsed + m_idleTimeout;
+        if (expiry <= now)
+          idle.push_back(std::move(entry->session));
+        else
+          next = std::min(next, expiry);
+      }
+    }
+    if (!idle.empty()) {
+      // OpenOCD takes a while to shut down, don't block the other cables
+      guard.unlock();
+      idle.clear();
+      guard.lock();
+      continue;
+    }
+    m_idleChanged.wait_until(guard, next);
+  }
+}
+
+void OpenocdSessionPool::close_all() {
+  std::lock_guard<std::mutex> guard{m_mutex};
+  for (auto& [name, entry] : m_entries) {
+    std::lock_guard<std::mutex> lock{entry->mutex};
+    entry->session.reset();
+  }
+}
+
+size_t OpenocdSessionPool::size() const {
+  std::lock_guard<std::mutex> guard{m_mutex};
+  size_t count{0};
+  for (const auto& [name, entry] : m_entries) {
+    std::lock_guard<std::mutex> lock{entry->mutex};
+    if (entry->session) count++;
+  }
+  return count;
+}
+
+}  // namespace FOEDAG
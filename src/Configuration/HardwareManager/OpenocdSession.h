@@ -0,0 +1,211 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __OPENOCDSESSION_H__
+#define __OPENOCDSESSION_H__
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Cable.h"
+
+namespace FOEDAG {
+
+using SessionLineCallback = std::function<void(const std::string&)>;
+
+/*!
+ * \brief The TclRpcClient class
+ * Client side of the OpenOCD Tcl RPC protocol: a command is sent as text
+ * terminated by 0x1a and the result comes back terminated the same way.
+ */
+class TclRpcClient {
+ public:
+  static constexpr char kTerminator{'\x1a'};
+
+  ~TclRpcClient();
+  bool connect(const std::string& host, uint16_t port);
+  void close();
+  bool connected() const { return m_fd >= 0; }
+  int fd() const { return m_fd; }
+
+  bool send(const std::string& cmd);
+  // Non blocking read of the available data. Return false if the connection
+  // is closed or broken.
+  bool read();
+  // Pop one complete response if it was received
+  bool take_response(std::string& response);
+
+ private:
+  int m_fd{-1};
+  std::string m_buffer;
+};
+
+/*!
+ * \brief The OpenocdSession class
+ * One long-lived OpenOCD process (or an already running server) driven over
+ * its Tcl RPC port. OpenOCD logs (progress, [RS] status lines) go to its
+ * stdout, which is read through a pipe and passed to the line callback of
+ * the running command. Every command is followed by an echo of a unique
+ * marker, so the log lines of a command are complete when execute returns.
+ */
+class OpenocdSession {
+ public:
+  ~OpenocdSession();
+
+  // Start "openocd <config> -c tcl_port <free port> -c init" and wait until
+  // the RPC port accepts connections. Return nullptr and the OpenOCD output
+  // in error on failure.
+  static std::unique_ptr<OpenocdSession> launch(const std::string& openocd,
+                                                const std::string& config,
+                                                std::string& error);
+  // Connect to a running server. Log lines are read from logFd if it is
+  // valid, the session takes ownership of it.
+  static std::unique_ptr<OpenocdSession> attach(const std::string& host,
+                                                uint16_t port, int logFd,
+                                                std::string& error);
+
+  // Run a Tcl command. Output receives the log lines of the command followed
+  // by its result. Return 0 on success, 1 if the command failed and -1 if
+  // the session is lost or the command was stopped; the session is closed in
+  // the latter case.
+  int execute(const std::string& cmd, std::string& output,
+              std::atomic<bool>& stop, std::ostream* outStream = nullptr,
+              SessionLineCallback lineCallback = nullptr);
+
+  // False once the RPC connection is lost or the launched OpenOCD exited
+  bool alive();
+  void close();
+
+ private:
+  OpenocdSession() = default;
+  bool read_log(std::string& output, std::ostream* outStream,
+                const SessionLineCallback& lineCallback,
+                const std::string& marker, bool& markerSeen);
+  void terminate();
+
+  TclRpcClient m_rpc;
+  int m_logFd{-1};
+  int64_t m_pid{-1};
+  std::string m_logBuffer;
+  bool m_markerSupported{true};
+  uint64_t m_commandId{0};
+};
+
+/*!
+ * \brief The OpenocdSessionPool class
+ * Keeps one session per cable so scan, status and programming commands no
+ * longer pay for adapter init and exit each time. JTAG taps and targets can
+ * only be declared before init, so the session of a cable is restarted when
+ * a command needs a different tap/target configuration; scan runs on
+ * whatever session the cable has. Sessions of different cables are used
+ * concurrently, commands on one cable are serialized. A session that is not
+ * used for the idle timeout is closed, so OpenOCD doesn't hold the cable
+ * after the user is done with it.
+ */
+class OpenocdSessionPool {
+ public:
+  using Clock = std::chrono::steady_clock;
+  // Create a session for the full OpenOCD configuration. The default
+  // factory launches openocd.
+  using Factory = std::function<std::unique_ptr<OpenocdSession>(
+      const std::string& openocd, const std::string& config,
+      std::string& error)>;
+
+  class Lease {
+   public:
+    Lease() = default;
+    Lease(std::unique_lock<std::mutex>&& lock, OpenocdSession* session,
+          Clock::time_point* lastUsed)
+        : m_lock(std::move(lock)), m_session(session), m_lastUsed(lastUsed) {}
+    Lease(Lease&&) = default;
+    Lease& operator=(Lease&&) = delete;
+    // The idle time of the session starts when the lease is released
+    ~Lease() {
+      if (m_lock.owns_lock()) *m_lastUsed = Clock::now();
+    }
+    explicit operator bool() const { return m_session != nullptr; }
+    OpenocdSession* operator->() const { return m_session; }
+
+   private:
+    std::unique_lock<std::mutex> m_lock;
+    OpenocdSession* m_session{nullptr};
+    Clock::time_point* m_lastUsed{nullptr};
+  };
+
+  OpenocdSessionPool();
+  explicit OpenocdSessionPool(const Factory& factory);
+  ~OpenocdSessionPool();
+
+  void set_idle_timeout(Clock::duration timeout);
+
+  // Session of the cable, locked for the lifetime of the lease. Empty
+  // targetConfig accepts any configuration. Return an empty lease if the
+  // session can't be started. error is only set by the first failure of a
+  // cable, until its session starts again.
+  Lease acquire(const std::string& openocd, const Cable& cable,
+                const std::string& targetConfig, std::string& error);
+
+  void close(const Cable& cable);
+  // Close the sessions of the cables that are no longer connected
+  void close_released(const std::vector<Cable>& connected);
+  void close_all();
+  size_t size() const;
+  // Number of sessions started so far
+  uint32_t launch_count() const { return m_launchCount; }
+
+ private:
+  struct Entry {
+    std::mutex mutex;
+    std::unique_ptr<OpenocdSession> session;
+    std::string openocd;
+    std::string cableConfig;
+    std::string targetConfig;
+    bool launchFailed{false};
+    Clock::time_point lastUsed;
+  };
+
+  // Body of the thread closing the idle sessions, runs while m_stopping is
+  // false
+  void close_idle();
+
+  Factory m_factory;
+  mutable std::mutex m_mutex;
+  std::map<std::string, std::unique_ptr<Entry>> m_entries;
+  std::atomic<uint32_t> m_launchCount{0};
+  Clock::duration m_idleTimeout;
+  std::condition_variable m_idleChanged;
+  std::thread m_idleThread;
+  bool m_stopping{false};
+};
+
+}  // namespace FOEDAG
+
+#endif  //__OPENOCDSESSION_H__
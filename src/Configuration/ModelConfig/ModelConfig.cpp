@@ -92,6 +92,17 @@ struct ModelConfig_API_ATTRIBUTE {
   const std::string m_value;
 };
 
+struct ModelConfig_DESIGN_ATTRIBUTE {
+ public:
+  ModelConfig_DESIGN_ATTRIBUTE(const std::string& name,
+                               const std::string& value,
+                               const std::string& reason)
+      : m_name(name), m_value(value), m_reason(reason) {}
+  const std::string m_name;
+  const std::string m_value;
+  const std::string m_reason;
+};
+
 struct ModelConfig_API_SETTING {
  public:
   ModelConfig_API_SETTING() {}
@@ -189,6 +200,7 @@ class ModelConfig_DEVICE {
     CFG_ASSERT(block != nullptr);
     std::vector<uint8_t> mask;
     create_bitfields(block.get(), mask, "", 0);
+    index_bitfields();
     CFG_ASSERT(m_total_bits);
     CFG_ASSERT((m_total_bits + 7) / 8 == mask.size());
     if (m_total_bits % 8) {
@@ -277,7 +289,11 @@ class ModelConfig_DEVICE {
     printf("DEBUG: Design Set Attr 1: %s : %s -> %s\n", instance.c_str(),
            name.c_str(), value.c_str());
 #endif
-    ModelConfig_BITFIELD* bitfield = get_bitfield(instance, name);
+    set_attr(get_bitfield(instance, name), instance, name, value, reason);
+  }
+  void set_attr(ModelConfig_BITFIELD* bitfield, const std::string& instance,
+                const std::string& name, const std::string& value,
+                const std::string& reason) {
     if (bitfield == nullptr) {
       CFG_POST_WARNING("Could not find bitfield '%s' for block instance '%s'",
                        name.c_str(), instance.c_str());
@@ -318,6 +334,28 @@ class ModelConfig_DEVICE {
       set_attr(instance, name, value, reason);
     }
   }
+  void set_attrs(const std::string& instance,
+                 const std::vector<ModelConfig_DESIGN_ATTRIBUTE>& attributes) {
+    // The bitfields of the instance are looked up once for all attributes
+    auto bitfields = m_bitfield_index.find(instance);
+    for (auto& attr : attributes) {
+      if (m_api.find(attr.m_name) != m_api.end()) {
+        set_attr({{"instance", instance},
+                  {"name", attr.m_name},
+                  {"value", attr.m_value}},
+                 attr.m_reason);
+      } else {
+        ModelConfig_BITFIELD* bitfield = nullptr;
+        if (bitfields != m_bitfield_index.end()) {
+          auto iter = bitfields->second.find(attr.m_name);
+          if (iter != bitfields->second.end()) {
+            bitfield = iter->second;
+          }
+        }
+        set_attr(bitfield, instance, attr.m_name, attr.m_value, attr.m_reason);
+      }
+    }
+  }
   void validate_instance(nlohmann::json& instance) {
     CFG_ASSERT(instance.is_object());
     // Check existence
@@ -377,6 +415,8 @@ class ModelConfig_DEVICE {
                        instance.c_str());
       return;
     }
+    std::vector<ModelConfig_DESIGN_ATTRIBUTE> design_attributes;
+    design_attributes.reserve(attributes.size());
     for (auto& iter : attributes.items()) {
       nlohmann::json key = iter.key();
       nlohmann::json value = iter.value();
@@ -393,11 +433,10 @@ class ModelConfig_DEVICE {
       printf("DEBUG: Design Set Attr 0: %s : %s -> %s\n",
              final_instance.c_str(), key_str.c_str(), value_str.c_str());
 #endif
-      set_attr({{"instance", final_instance},
-                {"name", key_str},
-                {"value", value_str}},
-               reason);
+      design_attributes.push_back(
+          ModelConfig_DESIGN_ATTRIBUTE(key_str, value_str, reason));
     }
+    set_attrs(final_instance, design_attributes);
   }
   void set_design_attributes(const std::string& instance,
                              nlohmann::json& attributes,
@@ -484,7 +523,7 @@ class ModelConfig_DEVICE {
     CFG_ASSERT(format == "BIT" || format == "WORD" || format == "DETAIL" ||
                format == "TCL" || format == "BIN");
     uint32_t addr = 0;
-    std::vector<uint8_t> data;
+    std::vector<uint32_t> words;
     std::ofstream file;
     if (format != "BIN") {
       file.open(filename.c_str());
@@ -503,21 +542,25 @@ class ModelConfig_DEVICE {
       }
     }
     if (format == "BIT" || format == "WORD" || format == "BIN") {
-      for (uint32_t i = 0; i < (((m_total_bits + 31) / 32) * 4); i++) {
-        data.push_back(0);
-      }
+      words.resize((m_total_bits + 31) / 32, 0);
     }
     std::string block_name = "";
-    while (addr < m_total_bits) {
-      CFG_ASSERT(m_bitfields.find(addr) != m_bitfields.end());
-      const ModelConfig_BITFIELD* bitfield = m_bitfields.at(addr);
-      CFG_ASSERT(addr == bitfield->m_addr);
-      if (data.size()) {
-        for (uint32_t i = 0; i < bitfield->m_size; i++, addr++) {
-          if (bitfield->m_value & (1 << i)) {
-            data[addr >> 3] |= (1 << (addr & 7));
-          }
+    // Bitfields are sorted by address and cover all the bits without gap
+    for (auto& iter : m_bitfields) {
+      const ModelConfig_BITFIELD* bitfield = iter.second;
+      CFG_ASSERT(addr == iter.first && addr == bitfield->m_addr);
+      if (words.size()) {
+        // A bitfield is at most 32 bits, so it spans at most two words
+        uint32_t value = bitfield->m_value;
+        if (bitfield->m_size < 32) {
+          value &= ((uint32_t)(1) << bitfield->m_size) - 1;
+        }
+        uint32_t shift = addr & 31;
+        words[addr >> 5] |= value << shift;
+        if (shift + bitfield->m_size > 32) {
+          words[(addr >> 5) + 1] |= value >> (32 - shift);
         }
+        addr += bitfield->m_size;
       } else if (format == "DETAIL") {
         if (bitfield->m_block_name != block_name) {
           file << CFG_print("Block %s [%s]\n", bitfield->m_block_name.c_str(),
@@ -545,18 +588,15 @@ class ModelConfig_DEVICE {
       }
     }
     CFG_ASSERT(addr == m_total_bits);
-    if (data.size()) {
+    if (words.size()) {
       if (format == "BIT") {
+        std::string bits(m_total_bits * 2, '\n');
         for (uint32_t i = 0; i < m_total_bits; i++) {
-          if (data[i >> 3] & (1 << (i & 7))) {
-            file << "1\n";
-          } else {
-            file << "0\n";
-          }
+          bits[i * 2] = ((words[i >> 5] >> (i & 31)) & 1) ? '1' : '0';
         }
+        file << bits;
       } else if (format == "WORD") {
-        uint32_t* words = (uint32_t*)(&data[0]);
-        uint32_t word_count = (m_total_bits + 31) / 32;
+        uint32_t word_count = (uint32_t)(words.size());
         for (uint32_t i = 0; i < word_count; i++) {
           file << CFG_print("%08X", words[i]).c_str();
           if ((i + 1) == word_count && (m_total_bits % 32) != 0) {
@@ -568,7 +608,12 @@ class ModelConfig_DEVICE {
           }
         }
       } else {
-        CFG_write_binary_file(filename, &data[0], (m_total_bits + 7) / 8);
+        // Little endian bytes of the words
+        std::vector<uint8_t> data((m_total_bits + 7) / 8);
+        for (size_t i = 0; i < data.size(); i++) {
+          data[i] = (uint8_t)(words[i >> 2] >> ((i & 3) * 8));
+        }
+        CFG_write_binary_file(filename, &data[0], data.size());
       }
     }
     if (file.is_open()) {
@@ -589,31 +634,12 @@ class ModelConfig_DEVICE {
     return status;
   }
   bool is_valid_block(const std::string& instance) {
-    bool valid = false;
-    for (auto& b : m_bitfields) {
-      if (b.second->m_block_name == instance ||
-          b.second->m_user_name == instance) {
-        valid = true;
-        break;
-      }
-    }
-    return valid;
+    return m_block_names.find(instance) != m_block_names.end();
   }
   std::string get_block_name(const std::string& instance) {
-    bool valid = false;
-    std::string block_name = instance;
-    for (auto& b : m_bitfields) {
-      if (b.second->m_user_name == instance) {
-        block_name = b.second->m_block_name;
-        valid = true;
-        break;
-      } else if (b.second->m_block_name == instance) {
-        valid = true;
-        break;
-      }
-    }
-    CFG_ASSERT(valid);
-    return block_name;
+    auto iter = m_block_names.find(instance);
+    CFG_ASSERT(iter != m_block_names.end());
+    return iter->second;
   }
   std::string get_mapped_block_name(const std::string& instance,
                                     const std::string& mapped_location,
@@ -637,16 +663,27 @@ class ModelConfig_DEVICE {
   ModelConfig_BITFIELD* get_bitfield(const std::string& instance,
                                      const std::string& name) {
     ModelConfig_BITFIELD* bitfield = nullptr;
-    for (auto& b : m_bitfields) {
-      if ((b.second->m_block_name == instance ||
-           b.second->m_user_name == instance) &&
-          b.second->m_name == name) {
-        bitfield = b.second;
-        break;
+    auto bitfields = m_bitfield_index.find(instance);
+    if (bitfields != m_bitfield_index.end()) {
+      auto iter = bitfields->second.find(name);
+      if (iter != bitfields->second.end()) {
+        bitfield = iter->second;
       }
     }
     return bitfield;
   }
+  void index_bitfields() {
+    // Bitfields are visited by address, so that the lowest address wins
+    // when a name is both the block name and the user name of two blocks
+    for (auto& b : m_bitfields) {
+      ModelConfig_BITFIELD* bitfield = b.second;
+      for (const std::string* instance :
+           {&bitfield->m_user_name, &bitfield->m_block_name}) {
+        m_block_names.emplace(*instance, bitfield->m_block_name);
+        m_bitfield_index[*instance].emplace(bitfield->m_name, bitfield);
+      }
+    }
+  }
   void add_bitfield(const std::string& block_name, const std::string& user_name,
                     const std::string& bitfield_name, uint32_t addr,
                     uint32_t size, uint32_t default_value,
@@ -711,6 +748,12 @@ class ModelConfig_DEVICE {
   uint32_t m_total_bits = 0;
   uint32_t m_max_attr_name_length = 0;
   std::map<size_t, ModelConfig_BITFIELD*> m_bitfields;
+  // Bitfields by block or user name, then by attribute name
+  std::unordered_map<std::string,
+                     std::unordered_map<std::string, ModelConfig_BITFIELD*>>
+      m_bitfield_index;
+  // Block name by block or user name
+  std::unordered_map<std::string, std::string> m_block_names;
   std::map<std::string, ModelConfig_API*> m_api;
 };
 
@@ -909,7 +952,8 @@ void model_config_entry(CFGCommon_ARG* cmdarg) {
   } else if (cmdarg->raws[0] == "gen_ppdb") {
     CFGArg::parse("model_config|gen_ppdb", cmdarg->raws.size(),
                   &cmdarg->raws[0], flag_options, options, positional_options,
-                  {"is_unittest"}, {"netlist_ppdb", "config_mapping"},
+                  {"is_unittest", "interpret_rules"},
+                  {"netlist_ppdb", "config_mapping"},
                   {"property_json", "pll_workaround"}, 1);
     ModelConfig_IO io(cmdarg, flag_options, options, positional_options[0]);
   } else if (cmdarg->raws[0] == "backdoor") {
@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "ModelConfig_IO.h"
 
+#include <bitset>
 #include <fstream>
 #include <iostream>
 
@@ -70,6 +71,8 @@ ModelConfig_IO::ModelConfig_IO(
                                   : "";
   bool is_unittest = std::find(flag_options.begin(), flag_options.end(),
                                "is_unittest") != flag_options.end();
+  m_interpret_rules = std::find(flag_options.begin(), flag_options.end(),
+                                "interpret_rules") != flag_options.end();
   if (options.find("pll_workaround") != options.end()) {
     m_pll_workaround = options.at("pll_workaround");
   }
@@ -155,6 +158,10 @@ ModelConfig_IO::ModelConfig_IO(
   Destructor
 */
 ModelConfig_IO::~ModelConfig_IO() {
+  for (auto& iter : m_rules) {
+    delete iter.second;
+  }
+  m_rules.clear();
   if (m_python != nullptr) {
     delete m_python;
     m_python = nullptr;
@@ -508,7 +515,7 @@ void ModelConfig_IO::validation(nlohmann::json& instance,
     }
   }
   if (m_config_mapping.contains(key)) {
-    nlohmann::json validation_rules = m_config_mapping[key];
+    nlohmann::json& validation_rules = m_config_mapping[key];
     CFG_ASSERT(validation_rules.is_object());
     if (validation_rules.contains("__seqeunce__")) {
       // Get the locations
@@ -527,22 +534,22 @@ void ModelConfig_IO::validation(nlohmann::json& instance,
         i++;
       }
       // Loop through all the validation checking sequence
-      nlohmann::json sequence = validation_rules["__seqeunce__"];
+      nlohmann::json& sequence = validation_rules["__seqeunce__"];
       CFG_ASSERT(sequence.is_array());
       bool status = true;
-      for (auto seq : sequence) {
+      for (auto& seq : sequence) {
         CFG_ASSERT(seq.is_string());
         std::string seq_name = std::string(seq);
         CFG_ASSERT(validation_rules.contains(seq_name));
-        nlohmann::json validation_info = validation_rules[seq_name];
+        nlohmann::json& validation_info = validation_rules[seq_name];
         CFG_ASSERT(validation_info.is_object());
         CFG_ASSERT(validation_info.contains("__module__"));
         CFG_ASSERT(validation_info.contains("__equation__"));
-        nlohmann::json modules = validation_info["__module__"];
-        nlohmann::json __equation__ = validation_info["__equation__"];
+        nlohmann::json& modules = validation_info["__module__"];
+        nlohmann::json& __equation__ = validation_info["__equation__"];
         CFG_ASSERT(modules.is_array());
         CFG_ASSERT(__equation__.is_array());
-        for (auto m : modules) {
+        for (auto& m : modules) {
           CFG_ASSERT(m.is_string());
           if ((std::string(m) == "__all__" || std::string(m) == module) &&
               is_siblings_match(validation_info,
@@ -595,34 +602,52 @@ void ModelConfig_IO::validation(nlohmann::json& instance,
                 break;
               }
             }
-            std::vector<std::string> equations =
-                get_json_string_list(__equation__, args);
             if (validation_info.contains("__resource__")) {
               CFG_ASSERT(validation_info["__resource__"].is_boolean());
               is_resource = (bool)(validation_info["__resource__"]);
             }
             if (is_resource) {
-              m_python->run(equations, {"__resource_name__", "__location__",
-                                        "__resource__", "__total_resource__"});
+              run_equations(__equation__, args,
+                            {"__resource_name__", "__location__",
+                             "__resource__", "__total_resource__"});
             } else {
-              m_python->run(equations, {"pin_result"});
+              run_equations(__equation__, args, {"pin_result"});
             }
             if (is_resource) {
               CFG_ASSERT(m_python->results().size() == 4);
               std::string name = m_python->result_str("__resource_name__");
               std::string location = m_python->result_str("__location__");
-              uint32_t resource = m_python->result_u32("__resource__");
               uint32_t total = m_python->result_u32("__total_resource__");
+              // Either a list of resource indexes or the legacy 32-bit mask
+              MODEL_RESOURCE_BITSET resource(total);
+              if (m_python->results().at("__resource__").type ==
+                  CFG_Python_OBJ::TYPE::INTS) {
+                for (auto r : m_python->result_u32s("__resource__")) {
+                  resource.set(r);
+                }
+              } else {
+                resource = MODEL_RESOURCE_BITSET::from_mask(
+                    m_python->result_u32("__resource__"), total);
+              }
               if (resource_instances.find(name) == resource_instances.end()) {
                 resource_instances[name] =
                     std::vector<MODEL_RESOURCE_INSTANCE*>({});
               }
               MODEL_RESOURCE_INSTANCE* new_instance =
                   new MODEL_RESOURCE_INSTANCE(
-                      location, resource, total,
+                      location, resource,
                       (uint32_t)(resource_instances[name].size()));
+              MODEL_RESOURCE_ALLOCATION allocation;
               status = allocate_resource(resource_instances[name], new_instance,
-                                         false);
+                                         false, &allocation);
+              POST_DEBUG_MSG(1,
+                             "Resource %s allocation %s in %ld us (%d shifted)",
+                             name.c_str(), status ? "passed" : "failed",
+                             allocation.elapsed_us, allocation.shifted);
+              if (allocation.conflict.size()) {
+                POST_WARN_MSG(1, "Resource %s conflict: %s", name.c_str(),
+                              allocation.conflict.c_str());
+              }
               if (status && validation_info.contains("__if_resource_pass__")) {
                 std::string updated_resource = "__updated_resource__ = {";
                 size_t i = 0;
@@ -635,15 +660,13 @@ void ModelConfig_IO::validation(nlohmann::json& instance,
                                 r->location.c_str(), r->decision);
                 }
                 updated_resource += " }";
-                std::vector<std::string> equations = get_json_string_list(
-                    validation_info["__if_resource_pass__"], args);
-                equations.insert(equations.begin(), updated_resource);
-                m_python->run(equations, {});
+                m_python->run({updated_resource}, {});
+                run_equations(validation_info["__if_resource_pass__"], args,
+                              {});
               }
               if (!status && validation_info.contains("__if_resource_fail__")) {
-                std::vector<std::string> equations = get_json_string_list(
-                    validation_info["__if_resource_fail__"], args);
-                m_python->run(equations, {});
+                run_equations(validation_info["__if_resource_fail__"], args,
+                              {});
               }
               set_validation_msg(status, msg, module, name, locations,
                                  seq_name);
@@ -1715,15 +1738,30 @@ std::vector<std::string> ModelConfig_IO::get_json_string_list(
   std::vector<std::string> string_list;
   for (auto s : strings) {
     CFG_ASSERT(s.is_string());
-    std::string str = std::string(s);
-    for (auto arg : args) {
-      str = CFG_replace_string(str, arg.first, arg.second, false);
-    }
-    string_list.push_back(str);
+    string_list.push_back(
+        ModelConfig_IO_RULE::substitute((std::string)(s), args));
   }
   return string_list;
 }
 
+/*
+  Run validation equations, compiled once per rule unless the rules are
+  interpreted like the other mapping equations
+*/
+void ModelConfig_IO::run_equations(const nlohmann::json& equations,
+                                   std::map<std::string, std::string>& args,
+                                   const std::vector<std::string>& results) {
+  CFG_ASSERT(m_python != nullptr);
+  if (m_interpret_rules) {
+    m_python->run(get_json_string_list(equations, args), results);
+    return;
+  }
+  if (m_rules.find(&equations) == m_rules.end()) {
+    m_rules[&equations] = new ModelConfig_IO_RULE(equations);
+  }
+  m_rules[&equations]->run(m_python, args, results);
+}
+
 /*
   Retrieve args from the instance
 */
@@ -2251,13 +2289,55 @@ void ModelConfig_IO::write_json_data(const std::string& str,
  * Static function
  *
  **********************************/
+/*
+  Call fn(resource) for every possible resource in ascending order until it
+  returns true
+*/
+template <typename FUNCTION>
+static bool for_each_resource(const MODEL_RESOURCE_BITSET& possible,
+                              FUNCTION fn) {
+  for (size_t w = 0; w < possible.words.size(); w++) {
+    uint64_t word = possible.words[w];
+    for (uint32_t b = 0; word != 0; b++, word >>= 1) {
+      if ((word & 1) && fn((uint32_t)(w * 64 + b))) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+static const size_t NO_OWNER = (size_t)(-1);
+
+/*
+  Number of possible resources which are not allocated yet
+*/
+static uint32_t count_free_resource(const MODEL_RESOURCE_BITSET& possible,
+                                    const MODEL_RESOURCE_BITSET& allocated) {
+  uint32_t count = 0;
+  for (size_t w = 0; w < possible.words.size(); w++) {
+    count += (uint32_t)(
+        std::bitset<64>(possible.words[w] & ~allocated.words[w]).count());
+  }
+  return count;
+}
+
 /*
   Entry function to allocate resource
+
+  All instances are decided again in least fortunate order (see
+  decide_resources), which gives the same decisions as before resources were
+  kept in bitsets. That greedy pass can miss an assignment, in that case a
+  maximum matching (Hopcroft-Karp) decides the instances instead. If the
+  matching can not decide every instance either, no assignment exists and
+  the instances reached from an undecided one by augmenting path search are
+  the ones in conflict (they can only use fewer resources than their count).
 */
 bool ModelConfig_IO::allocate_resource(
     std::vector<MODEL_RESOURCE_INSTANCE*>& instances,
-    MODEL_RESOURCE_INSTANCE*& new_instance, bool print_msg) {
-  bool status = false;
+    MODEL_RESOURCE_INSTANCE*& new_instance, bool print_msg,
+    MODEL_RESOURCE_ALLOCATION* allocation) {
+  CFG_TIME begin = CFG_time_begin();
   // Sanity check, all must have been decided except last one
   // All total must be same
   uint32_t total = new_instance->total;
@@ -2269,132 +2349,338 @@ bool ModelConfig_IO::allocate_resource(
   for (auto& inst : instances) {
     inst->backup();
   }
-  uint32_t allocated_resource_track = 0;
-  uint32_t decided_instance_track = 0;
-  std::vector<MODEL_RESOURCE_INSTANCE*> new_instances;
-  bool stop = false;
-  while (!stop) {
-    // Very time figure out which instances has least chance (least fortunate)
-    uint32_t least_possible = (uint32_t)(-1);
-    size_t least_fortunate_instance = (size_t)(-1);
-    bool use_shift_method = false;
-    for (size_t i = 0; i < (instances.size() + 1); i++) {
-      // Only search for instance which has not been decided
-      if ((decided_instance_track & (1 << i)) == 0) {
-        MODEL_RESOURCE_INSTANCE*& inst =
-            i < instances.size() ? instances[i] : new_instance;
-        uint32_t possible_count = 0;
-        for (uint32_t j = 0; j < inst->total; j++) {
-          if (((inst->possible & (1 << j)) != 0) &&
-              ((allocated_resource_track & (1 << j)) == 0)) {
-            possible_count++;
-          }
-        }
-        if (possible_count == 0) {
-          // We cannot find any resource that this instance can useful
-          // We try if we can shift around other instances
-          for (uint32_t j = 0; j < inst->total; j++) {
-            if (inst->possible & (1 << j)) {
-              if (shift_instance_resource(j, allocated_resource_track,
-                                          new_instances, print_msg)) {
-                // shift_instance_resource had updated the decisions of
-                // existing instances and allocated_resource_track
-                inst->decision = j;
-                new_instances.push_back(inst);
-                decided_instance_track |= (1 << i);
-                use_shift_method = true;
-                if (print_msg) {
-                  printf(
-                      "    Decided instance %d to use resource %d (after "
-                      "other "
-                      "shift)\n",
-                      inst->index, inst->decision);
-                }
-                break;
-              }
-            }
-          }
-          stop = !use_shift_method;
-          if (print_msg && stop) {
-            printf("  Cannot find resource for instance %d\n", inst->index);
-          }
-          break;
-        } else {
-          if (possible_count < least_possible) {
-            least_possible = possible_count;
-            least_fortunate_instance = i;
-          }
+  std::vector<MODEL_RESOURCE_INSTANCE*> all_instances = instances;
+  all_instances.push_back(new_instance);
+  bool status = decide_resources(all_instances, print_msg);
+  std::vector<size_t> visited;
+  if (!status) {
+    for (auto& inst : instances) {
+      inst->restore();
+    }
+    std::vector<size_t> owner;
+    status = match_resources(all_instances, print_msg, &owner) ==
+             all_instances.size();
+    if (!status) {
+      // Prefer the new instance when looking for the conflict
+      std::vector<bool> matched(all_instances.size(), false);
+      for (auto i : owner) {
+        if (i != NO_OWNER) {
+          matched[i] = true;
         }
       }
+      size_t unmatched = all_instances.size() - 1;
+      for (size_t i = 0; i < all_instances.size() && matched[unmatched]; i++) {
+        unmatched = i;
+      }
+      uint32_t unused = 0;
+      augment_resource(all_instances, unmatched, owner, unused, &visited,
+                       false);
     }
-    if (!stop && !use_shift_method) {
-      CFG_ASSERT(least_fortunate_instance <= instances.size());
-      MODEL_RESOURCE_INSTANCE*& inst =
-          least_fortunate_instance < instances.size()
-              ? instances[least_fortunate_instance]
-              : new_instance;
-      for (uint32_t j = 0; j < inst->total; j++) {
-        if (((inst->possible & (1 << j)) != 0) &&
-            ((allocated_resource_track & (1 << j)) == 0)) {
-          allocated_resource_track |= (1 << j);
-          decided_instance_track |= (1 << least_fortunate_instance);
-          inst->decision = j;
-          new_instances.push_back(inst);
-          if (print_msg) {
-            printf("  Decided instance %d to use resource %d\n", inst->index,
-                   inst->decision);
-          }
-          break;
-        }
+  }
+  uint32_t shifted = 0;
+  std::string conflict = "";
+  if (status) {
+    for (auto& inst : instances) {
+      if (inst->decision != inst->backup_decision) {
+        shifted++;
       }
     }
-    if (!stop) {
-      if ((instances.size() + 1) == new_instances.size()) {
-        stop = true;
-        status = true;
-        instances.push_back(new_instance);
+    instances.push_back(new_instance);
+  } else {
+    if (visited.size()) {
+      // Hall violation: visited instances vs the resources they can use
+      MODEL_RESOURCE_BITSET usable(total);
+      std::vector<std::string> locations;
+      for (auto i : visited) {
+        locations.push_back(CFG_print("%s(%d)",
+                                      all_instances[i]->location.c_str(),
+                                      all_instances[i]->index));
+        for_each_resource(all_instances[i]->possible, [&usable](uint32_t r) {
+          usable.set(r);
+          return false;
+        });
+      }
+      std::vector<std::string> resources;
+      for_each_resource(usable, [&resources](uint32_t r) {
+        resources.push_back(std::to_string(r));
+        return false;
+      });
+      conflict = CFG_print(
+          "%ld instance(s) %s can only use %ld resource(s) {%s}",
+          visited.size(), CFG_join_strings(locations, " ").c_str(),
+          resources.size(), CFG_join_strings(resources, ",").c_str());
+      if (print_msg) {
+        printf("  Conflict: %s\n", conflict.c_str());
       }
     }
-  }
-  if (!status) {
     delete new_instance;
     new_instance = nullptr;
     for (auto& inst : instances) {
       inst->restore();
     }
   }
+  if (allocation != nullptr) {
+    allocation->conflict = conflict;
+    allocation->shifted = shifted;
+    allocation->elapsed_us = CFG_nano_time_elapse(begin) / 1000;
+  }
   return status;
 }
 
+/*
+  Decide all instances again. Every time the instance which has least chance
+  (least fortunate) takes its first free resource. If an instance has no
+  free resource left, an instance that was already decided is shifted to
+  another free resource to make room for it.
+*/
+bool ModelConfig_IO::decide_resources(
+    std::vector<MODEL_RESOURCE_INSTANCE*>& instances, bool print_msg) {
+  const uint32_t total = instances[0]->total;
+  MODEL_RESOURCE_BITSET allocated(total);
+  std::vector<bool> decided(instances.size(), false);
+  std::vector<MODEL_RESOURCE_INSTANCE*> decided_instances;
+  while (decided_instances.size() < instances.size()) {
+    uint32_t least_possible = (uint32_t)(-1);
+    size_t least_fortunate_instance = NO_OWNER;
+    for (size_t i = 0; i < instances.size(); i++) {
+      // Only search for instance which has not been decided
+      if (decided[i]) {
+        continue;
+      }
+      MODEL_RESOURCE_INSTANCE* inst = instances[i];
+      uint32_t possible_count = count_free_resource(inst->possible, allocated);
+      if (possible_count == 0) {
+        // We cannot find any resource that this instance can use
+        // We try if we can shift around other instances
+        bool shifted = for_each_resource(inst->possible, [&](uint32_t j) {
+          if (!shift_instance_resource(j, allocated, decided_instances,
+                                       print_msg)) {
+            return false;
+          }
+          // shift_instance_resource had updated the decision of an existing
+          // instance and the allocated resources
+          inst->decision = j;
+          decided_instances.push_back(inst);
+          decided[i] = true;
+          if (print_msg) {
+            printf(
+                "    Decided instance %d to use resource %d (after other "
+                "shift)\n",
+                inst->index, inst->decision);
+          }
+          return true;
+        });
+        if (!shifted) {
+          if (print_msg) {
+            printf("  Cannot find resource for instance %d\n", inst->index);
+          }
+          return false;
+        }
+        least_fortunate_instance = NO_OWNER;
+        break;
+      } else if (possible_count < least_possible) {
+        least_possible = possible_count;
+        least_fortunate_instance = i;
+      }
+    }
+    if (least_fortunate_instance != NO_OWNER) {
+      MODEL_RESOURCE_INSTANCE* inst = instances[least_fortunate_instance];
+      for_each_resource(inst->possible, [&](uint32_t j) {
+        if (allocated.test(j)) {
+          return false;
+        }
+        allocated.set(j);
+        decided[least_fortunate_instance] = true;
+        inst->decision = j;
+        decided_instances.push_back(inst);
+        if (print_msg) {
+          printf("  Decided instance %d to use resource %d\n", inst->index,
+                 inst->decision);
+        }
+        return true;
+      });
+    }
+  }
+  return true;
+}
+
 /*
   Move the resource if it is flexible and give opportunity to those that less
   flexible
 */
 bool ModelConfig_IO::shift_instance_resource(
-    uint32_t try_resource, uint32_t& allocated_resource_track,
+    uint32_t try_resource, MODEL_RESOURCE_BITSET& allocated,
     std::vector<MODEL_RESOURCE_INSTANCE*>& instances, bool print_msg) {
-  bool shifted = false;
   for (auto& inst : instances) {
     if (inst->decision == try_resource) {
-      for (uint32_t j = 0; j < inst->total; j++) {
-        if (j != try_resource && ((inst->possible & (1 << j)) != 0) &&
-            ((allocated_resource_track & (1 << j)) == 0)) {
-          if (print_msg) {
-            printf("  Shift instance %d from resource %d to resource %d\n",
-                   inst->index, inst->decision, j);
+      bool shifted = for_each_resource(inst->possible, [&](uint32_t j) {
+        if (j == try_resource || allocated.test(j)) {
+          return false;
+        }
+        if (print_msg) {
+          printf("  Shift instance %d from resource %d to resource %d\n",
+                 inst->index, inst->decision, j);
+        }
+        inst->decision = j;  // new decision made
+        allocated.set(j);
+        return true;
+      });
+      if (shifted) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/*
+  Breadth first search of the shortest alternating path from the given
+  instance to a free resource, instances on the path shift to the next
+  resource of the path. The visited instances are returned, when there is no
+  path they are the instances in conflict.
+*/
+bool ModelConfig_IO::augment_resource(
+    std::vector<MODEL_RESOURCE_INSTANCE*>& instances, size_t new_instance,
+    std::vector<size_t>& owner, uint32_t& shifted, std::vector<size_t>* visited,
+    bool print_msg) {
+  std::vector<size_t> reached_by(owner.size(), NO_OWNER);
+  std::vector<bool> queued(instances.size(), false);
+  std::vector<size_t> queue = {new_instance};
+  queued[new_instance] = true;
+  size_t free_resource = NO_OWNER;
+  for (size_t q = 0; q < queue.size() && free_resource == NO_OWNER; q++) {
+    size_t i = queue[q];
+    if (visited != nullptr) {
+      visited->push_back(i);
+    }
+    for_each_resource(instances[i]->possible, [&](uint32_t r) {
+      if (reached_by[r] != NO_OWNER) {
+        return false;
+      }
+      reached_by[r] = i;
+      if (owner[r] == NO_OWNER) {
+        free_resource = r;
+        return true;
+      }
+      if (!queued[owner[r]]) {
+        queued[owner[r]] = true;
+        queue.push_back(owner[r]);
+      }
+      return false;
+    });
+  }
+  if (free_resource == NO_OWNER) {
+    return false;
+  }
+  size_t r = free_resource;
+  while (true) {
+    size_t i = reached_by[r];
+    uint32_t previous = instances[i]->decision;
+    if (i != new_instance && print_msg) {
+      printf("  Shift instance %d from resource %d to resource %d\n",
+             instances[i]->index, previous, (uint32_t)(r));
+    }
+    instances[i]->decision = (uint32_t)(r);
+    owner[r] = i;
+    if (i == new_instance) {
+      break;
+    }
+    shifted++;
+    r = previous;
+  }
+  return true;
+}
+
+/*
+  Hopcroft-Karp maximum matching. Instances which can't get a resource keep
+  their decision.
+*/
+size_t ModelConfig_IO::match_resources(
+    std::vector<MODEL_RESOURCE_INSTANCE*>& instances, bool print_msg,
+    std::vector<size_t>* resource_owner) {
+  if (instances.empty()) {
+    return 0;
+  }
+  const size_t count = instances.size();
+  const uint32_t total = instances[0]->total;
+  for (auto& inst : instances) {
+    CFG_ASSERT(total == inst->total);
+  }
+  const size_t nil = count;
+  const uint32_t infinite = (uint32_t)(-1);
+  std::vector<size_t> owner(total, nil);
+  std::vector<uint32_t> decision(count, infinite);
+  std::vector<uint32_t> distance(count + 1, infinite);
+  auto bfs = [&]() {
+    std::vector<size_t> queue;
+    for (size_t i = 0; i < count; i++) {
+      distance[i] = decision[i] == infinite ? 0 : infinite;
+      if (distance[i] == 0) {
+        queue.push_back(i);
+      }
+    }
+    distance[nil] = infinite;
+    for (size_t q = 0; q < queue.size(); q++) {
+      size_t i = queue[q];
+      if (distance[i] >= distance[nil]) {
+        continue;
+      }
+      for_each_resource(instances[i]->possible, [&](uint32_t r) {
+        size_t next = owner[r];
+        if (distance[next] == infinite) {
+          distance[next] = distance[i] + 1;
+          if (next != nil) {
+            queue.push_back(next);
           }
-          inst->decision = j;  // new decision made
-          allocated_resource_track |= (1 << j);
-          shifted = true;
-          break;
         }
+        return false;
+      });
+    }
+    return distance[nil] != infinite;
+  };
+  std::function<bool(size_t)> dfs = [&](size_t i) {
+    bool found = for_each_resource(instances[i]->possible, [&](uint32_t r) {
+      size_t next = owner[r];
+      if (next == nil || (distance[next] == distance[i] + 1 && dfs(next))) {
+        owner[r] = i;
+        decision[i] = r;
+        return true;
       }
-      if (shifted) {
-        break;
+      return false;
+    });
+    if (!found) {
+      distance[i] = infinite;
+    }
+    return found;
+  };
+  size_t matched = 0;
+  while (bfs()) {
+    for (size_t i = 0; i < count; i++) {
+      if (decision[i] == infinite && dfs(i)) {
+        matched++;
+      }
+    }
+  }
+  for (size_t i = 0; i < count; i++) {
+    if (decision[i] != infinite) {
+      instances[i]->decision = decision[i];
+      if (print_msg) {
+        printf("  Decided instance %d to use resource %d\n",
+               instances[i]->index, decision[i]);
+      }
+    } else if (print_msg) {
+      printf("  Cannot find resource for instance %d\n", instances[i]->index);
+    }
+  }
+  if (resource_owner != nullptr) {
+    resource_owner->assign(total, NO_OWNER);
+    for (uint32_t r = 0; r < total; r++) {
+      if (owner[r] != nil) {
+        (*resource_owner)[r] = owner[r];
       }
     }
   }
-  return shifted;
+  return matched;
 }
 
 }  // namespace FOEDAG
@@ -29,6 +29,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <vector>
 
 #include "ModelConfig_IO_resource.h"
+#include "ModelConfig_IO_rule.h"
 #include "nlohmann_json/json.hpp"
 
 struct CFGCommon_ARG;
@@ -49,28 +50,73 @@ enum ARG_PROPERTY {
 };
 // clang-format on
 
+// Dynamic bitset of the resources an instance can use
+struct MODEL_RESOURCE_BITSET {
+  MODEL_RESOURCE_BITSET(uint32_t s) : size(s), words((s + 63) / 64, 0) {}
+  void set(uint32_t i) {
+    CFG_ASSERT(i < size);
+    words[i >> 6] |= (uint64_t)(1) << (i & 63);
+  }
+  bool test(uint32_t i) const {
+    return i < size && ((words[i >> 6] >> (i & 63)) & 1) != 0;
+  }
+  bool any() const {
+    for (auto w : words) {
+      if (w) {
+        return true;
+      }
+    }
+    return false;
+  }
+  // From the legacy 32-bit mask
+  static MODEL_RESOURCE_BITSET from_mask(uint32_t mask, uint32_t size) {
+    CFG_ASSERT(size <= 32);
+    if (size != 32) {
+      CFG_ASSERT(mask < (uint32_t)(1 << size));
+    }
+    MODEL_RESOURCE_BITSET bitset(size);
+    for (uint32_t i = 0; i < size; i++) {
+      if (mask & ((uint32_t)(1) << i)) {
+        bitset.set(i);
+      }
+    }
+    return bitset;
+  }
+  uint32_t size = 0;
+  std::vector<uint64_t> words;
+};
+
 struct MODEL_RESOURCE_INSTANCE {
   MODEL_RESOURCE_INSTANCE(const std::string& l, uint32_t p, uint32_t t,
                           uint32_t i)
-      : location(l), possible(p), total(t), index(i) {
-    CFG_ASSERT(possible != 0);
+      : MODEL_RESOURCE_INSTANCE(l, MODEL_RESOURCE_BITSET::from_mask(p, t), i) {
+  }
+  MODEL_RESOURCE_INSTANCE(const std::string& l, const MODEL_RESOURCE_BITSET& p,
+                          uint32_t i)
+      : location(l), possible(p), total(p.size), index(i) {
+    CFG_ASSERT(possible.any());
     CFG_ASSERT(total != 0);
-    CFG_ASSERT(total <= 32);
     CFG_ASSERT(index < total);
-    if (total != 32) {
-      CFG_ASSERT(possible < (uint32_t)(1 << total));
-    }
   }
   void backup() { backup_decision = decision; }
   void restore() { decision = backup_decision; }
   const std::string location = 0;
-  const uint32_t possible = 0;
+  const MODEL_RESOURCE_BITSET possible;
   const uint32_t total = 0;
   const uint32_t index = 0;
   uint32_t decision = 0;
   uint32_t backup_decision = 0;
 };
 
+// Details of an allocation, for messages
+struct MODEL_RESOURCE_ALLOCATION {
+  // Instances which compete for too few resources if allocation failed
+  std::string conflict = "";
+  // Number of existing instances moved to other resource
+  uint32_t shifted = 0;
+  uint64_t elapsed_us = 0;
+};
+
 typedef std::map<std::string, std::vector<MODEL_RESOURCE_INSTANCE*>>
     MODEL_RESOURCES;
 
@@ -162,6 +208,9 @@ class ModelConfig_IO {
                           const std::string& seq_name, bool skip = false);
   std::vector<std::string> get_json_string_list(
       const nlohmann::json& strings, std::map<std::string, std::string>& args);
+  void run_equations(const nlohmann::json& equations,
+                     std::map<std::string, std::string>& args,
+                     const std::vector<std::string>& results);
   void retrieve_instance_args(nlohmann::json& instance,
                               std::map<std::string, std::string>& args);
   void define_args(nlohmann::json define,
@@ -211,21 +260,35 @@ class ModelConfig_IO {
  public:
   static bool allocate_resource(
       std::vector<MODEL_RESOURCE_INSTANCE*>& instances,
-      MODEL_RESOURCE_INSTANCE*& new_instance, bool print_msg);
+      MODEL_RESOURCE_INSTANCE*& new_instance, bool print_msg,
+      MODEL_RESOURCE_ALLOCATION* allocation = nullptr);
+  // Decide all instances from scratch (Hopcroft-Karp maximum matching).
+  // Return the number of instances which got a resource.
+  static size_t match_resources(
+      std::vector<MODEL_RESOURCE_INSTANCE*>& instances, bool print_msg,
+      std::vector<size_t>* resource_owner = nullptr);
 
  private:
+  static bool decide_resources(std::vector<MODEL_RESOURCE_INSTANCE*>& instances,
+                               bool print_msg);
   static bool shift_instance_resource(
-      uint32_t try_resource, uint32_t& allocated_resource_track,
+      uint32_t try_resource, MODEL_RESOURCE_BITSET& allocated,
       std::vector<MODEL_RESOURCE_INSTANCE*>& instances, bool print_msg);
+  static bool augment_resource(std::vector<MODEL_RESOURCE_INSTANCE*>& instances,
+                               size_t new_instance, std::vector<size_t>& owner,
+                               uint32_t& shifted, std::vector<size_t>* visited,
+                               bool print_msg);
 
  protected:
   CFG_Python_MGR* m_python = nullptr;
   std::string m_pll_workaround = "";
+  bool m_interpret_rules = false;
   nlohmann::json m_instances;
   nlohmann::json m_config_mapping;
   std::map<std::string, std::string> m_global_args;
   ModelConfig_IO_RESOURCE* m_resource = nullptr;
   std::vector<ModelConfig_IO_MSG*> m_messages;
+  std::map<const nlohmann::json*, ModelConfig_IO_RULE*> m_rules;
 };
 
 }  // namespace FOEDAG
@@ -0,0 +1,311 @@
+/*
+Copyright 2023 The Foedag team
+
+GPL License
+
+Copyright (c) 2023 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ModelConfig_IO_rule.h"
+
+#include <algorithm>
+
+namespace FOEDAG {
+
+// Integer an INT arg is replaced with when comparing the syntax tree
+const uint32_t g_int_sentinel = 1000000007;
+
+ModelConfig_IO_RULE::ModelConfig_IO_RULE(const nlohmann::json& equations) {
+  CFG_ASSERT(equations.is_array());
+  for (auto& e : equations) {
+    CFG_ASSERT(e.is_string());
+    m_equations.push_back((std::string)(e));
+  }
+}
+
+ModelConfig_IO_RULE::~ModelConfig_IO_RULE() {
+  for (auto& iter : m_variants) {
+    delete iter.second;
+  }
+  m_variants.clear();
+}
+
+/*
+  Run the equations with the args, this is equivalent to running the
+  substituted equations one by one
+*/
+void ModelConfig_IO_RULE::run(CFG_Python_MGR* python,
+                              const std::map<std::string, std::string>& args,
+                              const std::vector<std::string>& results) {
+  CFG_ASSERT(python != nullptr);
+  std::vector<std::string> names;
+  for (auto& arg : args) {
+    if (is_used(arg.first)) {
+      names.push_back(arg.first);
+    }
+  }
+  // Segments assume the value of an arg does not carry another arg name,
+  // which substitution would replace again
+  bool delimited = true;
+  for (auto& name : names) {
+    const std::string& value = args.at(name);
+    for (auto& arg : args) {
+      if (value.find(arg.first) != std::string::npos) {
+        delimited = false;
+        break;
+      }
+    }
+  }
+  std::vector<void*> codes;
+  if (delimited) {
+    ModelConfig_IO_VARIANT* variant = get_variant(python, names);
+    for (auto& line : variant->lines) {
+      bool bound = line.code != nullptr;
+      for (auto& arg : line.args) {
+        if (!is_bindable(args.at(variant->names[arg.first]), arg.second)) {
+          bound = false;
+          break;
+        }
+      }
+      if (bound) {
+        for (auto& arg : line.args) {
+          const std::string& value = args.at(variant->names[arg.first]);
+          if (arg.second == CFG_Python_OBJ::TYPE::INT) {
+            python->bind(get_variable(arg.first, arg.second),
+                         CFG_Python_OBJ((uint32_t)(std::stoul(value))));
+          } else {
+            python->bind(get_variable(arg.first, arg.second),
+                         CFG_Python_OBJ(value));
+          }
+        }
+        codes.push_back(line.code);
+      } else {
+        codes.push_back(python->compile(substitute(line.text, args)));
+      }
+    }
+  } else {
+    for (auto& equation : m_equations) {
+      codes.push_back(python->compile(substitute(equation, args)));
+    }
+  }
+  python->run_compiled(codes, results);
+}
+
+/*
+  Replace every arg name by its value, one arg after another
+*/
+std::string ModelConfig_IO_RULE::substitute(
+    const std::string& equation,
+    const std::map<std::string, std::string>& args) {
+  std::string str = equation;
+  for (auto& arg : args) {
+    str = CFG_replace_string(str, arg.first, arg.second, false);
+  }
+  return str;
+}
+
+bool ModelConfig_IO_RULE::is_used(const std::string& name) {
+  auto iter = m_used_names.find(name);
+  if (iter != m_used_names.end()) {
+    return iter->second;
+  }
+  bool used = false;
+  for (auto& equation : m_equations) {
+    if (equation.find(name) != std::string::npos) {
+      used = true;
+      break;
+    }
+  }
+  m_used_names[name] = used;
+  return used;
+}
+
+/*
+  Split the equations at the arg names and compile them
+*/
+ModelConfig_IO_VARIANT* ModelConfig_IO_RULE::get_variant(
+    CFG_Python_MGR* python, const std::vector<std::string>& names) {
+  std::string key = "";
+  for (auto& name : names) {
+    key = CFG_print("%s%s\n", key.c_str(), name.c_str());
+  }
+  auto iter = m_variants.find(key);
+  if (iter != m_variants.end()) {
+    return iter->second;
+  }
+  ModelConfig_IO_VARIANT* variant = new ModelConfig_IO_VARIANT;
+  variant->names = names;
+  for (auto& equation : m_equations) {
+    variant->lines.push_back(ModelConfig_IO_LINE(equation));
+    compile_line(python, names, variant->lines.back());
+  }
+  m_variants[key] = variant;
+  return variant;
+}
+
+void ModelConfig_IO_RULE::compile_line(CFG_Python_MGR* python,
+                                       const std::vector<std::string>& names,
+                                       ModelConfig_IO_LINE& line) {
+  // Same order and same search as substitute()
+  std::vector<ModelConfig_IO_SEGMENT> segments = {
+      ModelConfig_IO_SEGMENT(line.text, -1)};
+  for (size_t i = 0; i < names.size(); i++) {
+    std::vector<ModelConfig_IO_SEGMENT> splits;
+    for (auto& segment : segments) {
+      if (segment.arg >= 0) {
+        splits.push_back(segment);
+        continue;
+      }
+      size_t start = 0;
+      size_t index = segment.text.find(names[i]);
+      while (index != std::string::npos) {
+        splits.push_back(ModelConfig_IO_SEGMENT(
+            segment.text.substr(start, index - start), -1));
+        splits.push_back(ModelConfig_IO_SEGMENT("", (int)(i)));
+        start = index + names[i].size();
+        index = segment.text.find(names[i], start);
+      }
+      splits.push_back(ModelConfig_IO_SEGMENT(segment.text.substr(start), -1));
+    }
+    segments.swap(splits);
+  }
+  // An arg quoted on both sides is a string literal, otherwise it is
+  // expected to be an integer
+  std::vector<CFG_Python_OBJ::TYPE> types(segments.size(),
+                                          CFG_Python_OBJ::TYPE::UNKNOWN);
+  for (size_t i = 0; i < segments.size(); i++) {
+    if (segments[i].arg < 0) {
+      continue;
+    }
+    types[i] = CFG_Python_OBJ::TYPE::INT;
+    if (i > 0 && i + 1 < segments.size()) {
+      const std::string& before = segments[i - 1].text;
+      const std::string& after = segments[i + 1].text;
+      if (before.size() && after.size() && before.back() == after.front() &&
+          (before.back() == '\'' || before.back() == '"')) {
+        types[i] = CFG_Python_OBJ::TYPE::STR;
+      }
+    }
+  }
+  // Source with sentinel values, and source with variables
+  std::string source = "";
+  std::string bound_source = "";
+  std::map<std::string, std::string> sentinels;
+  for (size_t i = 0; i < segments.size(); i++) {
+    if (segments[i].arg < 0) {
+      std::string text = segments[i].text;
+      source += text;
+      if (i + 1 < segments.size() &&
+          types[i + 1] == CFG_Python_OBJ::TYPE::STR) {
+        text.pop_back();
+      }
+      if (i > 0 && types[i - 1] == CFG_Python_OBJ::TYPE::STR) {
+        if (text.empty()) {
+          // Two quoted args share a quote, keep the substitution
+          line.args.clear();
+          return;
+        }
+        text.erase(0, 1);
+      }
+      bound_source += text;
+      continue;
+    }
+    std::string variable = get_variable(segments[i].arg, types[i]);
+    std::string constant = "";
+    if (types[i] == CFG_Python_OBJ::TYPE::STR) {
+      source += variable;
+      constant = CFG_print("Constant(value='%s')", variable.c_str());
+    } else {
+      std::string sentinel = std::to_string(g_int_sentinel + segments[i].arg);
+      source += sentinel;
+      constant = CFG_print("Constant(value=%s)", sentinel.c_str());
+    }
+    bound_source += variable;
+    sentinels[constant] =
+        CFG_print("Name(id='%s', ctx=Load())", variable.c_str());
+    std::pair<int, CFG_Python_OBJ::TYPE> arg(segments[i].arg, types[i]);
+    if (std::find(line.args.begin(), line.args.end(), arg) ==
+        line.args.end()) {
+      line.args.push_back(arg);
+    }
+  }
+  if (line.args.empty()) {
+    line.code = python->compile(line.text);
+    return;
+  }
+  // Variables are only used if the syntax tree is the same as the one of
+  // the substituted source, except at the args
+  std::string ast = get_ast(python, source);
+  std::string bound_ast = get_ast(python, bound_source);
+  if (ast.empty() || bound_ast.empty()) {
+    line.args.clear();
+    return;
+  }
+  for (auto& sentinel : sentinels) {
+    ast = CFG_replace_string(ast, sentinel.first, sentinel.second, false);
+  }
+  if (ast == bound_ast) {
+    line.code = python->compile(bound_source);
+  } else {
+    line.args.clear();
+  }
+}
+
+std::string ModelConfig_IO_RULE::get_ast(CFG_Python_MGR* python,
+                                         const std::string& source) {
+  python->bind("__mcio_source__", CFG_Python_OBJ(source));
+  python->run({"try:\n"
+               "  __mcio_ast__ = __import__('ast')\n"
+               "  __mcio_ast__ = __mcio_ast__.dump(__mcio_ast__.parse("
+               "__mcio_source__, mode='single'))\n"
+               "except Exception:\n"
+               "  __mcio_ast__ = ''\n"},
+              {"__mcio_ast__"});
+  return python->result_str("__mcio_ast__");
+}
+
+/*
+  A value is bound only if substitution would produce the same literal
+*/
+bool ModelConfig_IO_RULE::is_bindable(const std::string& value,
+                                      CFG_Python_OBJ::TYPE type) {
+  if (type == CFG_Python_OBJ::TYPE::INT) {
+    if (value.empty() || value.size() > 9 ||
+        (value.size() > 1 && value[0] == '0')) {
+      return false;
+    }
+    for (auto c : value) {
+      if (c < '0' || c > '9') {
+        return false;
+      }
+    }
+    return true;
+  }
+  for (auto c : value) {
+    if (c < 0x20 || c > 0x7E || c == '\'' || c == '"' || c == '\\') {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string ModelConfig_IO_RULE::get_variable(int arg,
+                                              CFG_Python_OBJ::TYPE type) {
+  return CFG_print("__mcio_%s%d__",
+                   type == CFG_Python_OBJ::TYPE::INT ? "int" : "str", arg);
+}
+
+}  // namespace FOEDAG
@@ -0,0 +1,96 @@
+/*
+Copyright 2023 The Foedag team
+
+GPL License
+
+Copyright (c) 2023 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MODEL_CONFIG_IO_RULE_H
+#define MODEL_CONFIG_IO_RULE_H
+
+#include <Configuration/CFGCommon/CFGCommon.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "nlohmann_json/json.hpp"
+
+namespace FOEDAG {
+
+struct ModelConfig_IO_SEGMENT {
+  ModelConfig_IO_SEGMENT(const std::string& t, int a) : text(t), arg(a) {}
+  const std::string text = "";
+  // Index to the variant names, or -1 if the segment is plain text
+  const int arg = -1;
+};
+
+struct ModelConfig_IO_LINE {
+  ModelConfig_IO_LINE(const std::string& t) : text(t) {}
+  const std::string text = "";
+  // Compiled code where args are Python variables, nullptr if the line can
+  // only be run after substitution
+  void* code = nullptr;
+  // Arg index and how it is bound (STR or INT)
+  std::vector<std::pair<int, CFG_Python_OBJ::TYPE>> args;
+};
+
+struct ModelConfig_IO_VARIANT {
+  // Arg names that show up in the equations, in args order
+  std::vector<std::string> names;
+  std::vector<ModelConfig_IO_LINE> lines;
+};
+
+/*
+  Equations of a mapping rule, compiled once and run for every instance.
+
+  Mapping equations refer to the args by substituting their names textually,
+  i.e. "pin_result = '__location0__' in g_all_pins". A line where every arg
+  is a whole string literal or a bare integer is compiled once with the args
+  as variables, and the instance values are bound before the run. The other
+  lines fall back to substitution, and their code is cached by source.
+*/
+class ModelConfig_IO_RULE {
+ public:
+  ModelConfig_IO_RULE(const nlohmann::json& equations);
+  ~ModelConfig_IO_RULE();
+  void run(CFG_Python_MGR* python,
+           const std::map<std::string, std::string>& args,
+           const std::vector<std::string>& results);
+  static std::string substitute(const std::string& equation,
+                                const std::map<std::string, std::string>& args);
+
+ private:
+  bool is_used(const std::string& name);
+  ModelConfig_IO_VARIANT* get_variant(CFG_Python_MGR* python,
+                                      const std::vector<std::string>& names);
+  void compile_line(CFG_Python_MGR* python,
+                    const std::vector<std::string>& names,
+                    ModelConfig_IO_LINE& line);
+  std::string get_ast(CFG_Python_MGR* python, const std::string& source);
+  static bool is_bindable(const std::string& value, CFG_Python_OBJ::TYPE type);
+  static std::string get_variable(int arg, CFG_Python_OBJ::TYPE type);
+
+ private:
+  std::vector<std::string> m_equations;
+  std::map<std::string, bool> m_used_names;
+  std::map<std::string, ModelConfig_IO_VARIANT*> m_variants;
+};
+
+}  // namespace FOEDAG
+
+#endif
@@ -21,6 +21,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "Programmer.h"
 
+#include <cstdlib>  // for std::atexit
+#include <mutex>    // for std::call_once
 #include <numeric>  // for std::accumulate
 #include <sstream>  // for std::stringstream
 #include <thread>   // for std::this_thread::sleep_for
@@ -29,6 +31,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "CFGCommon/CFGCommon.h"
 #include "Configuration/HardwareManager/HardwareManager.h"
 #include "Configuration/HardwareManager/OpenocdAdapter.h"
+#include "Configuration/HardwareManager/OpenocdSession.h"
 #include "ProgrammerGuiInterface.h"
 #include "ProgrammerTool.h"
 #include "Programmer_error_code.h"
@@ -39,6 +42,24 @@ namespace FOEDAG {
 // openOCDPath used by library
 static std::string libOpenOcdExecPath;
 
+// one OpenOCD per cable, kept alive between programmer commands
+static OpenocdSessionPool openocdSessions;
+
+// Pool of the programmer, its sessions are closed when the process exits
+static OpenocdSessionPool* sessionPool() {
+  static std::once_flag exitHook;
+  std::call_once(exitHook, []() { std::atexit(CloseOpenocdSessions); });
+  return &openocdSessions;
+}
+
+// Cables found by the hardware manager, the sessions of the cables that were
+// unplugged are closed
+static std::vector<Cable> connectedCables(HardwareManager& hardware_manager) {
+  std::vector<Cable> cables = hardware_manager.get_cables();
+  openocdSessions.close_released(cables);
+  return cables;
+}
+
 static std::map<Cable, uint32_t, CompareCable> cableSpeedMap = {};
 
 uint32_t GetCableSpeedFromMap(const Cable& cable) {
@@ -73,6 +94,7 @@ void programmer_entry(CFGCommon_ARG* cmdarg) {
   }
   // setup hardware manager and its depencencies
   OpenocdAdapter openOcd{cmdarg->toolPath.string()};
+  openOcd.set_session_pool(sessionPool());
   HardwareManager hardware_manager{&openOcd};
 
   std::string subCmd = arg->get_sub_arg_name();
@@ -238,7 +260,7 @@ void programmer_entry(CFGCommon_ARG* cmdarg) {
         }
       } else {
         // fild all devices
-        auto cables = hardware_manager.get_cables();
+        auto cables = connectedCables(hardware_manager);
         if (cables.empty()) {
           CFG_POST_ERR("No cable is connected.");
           return;
@@ -255,7 +277,7 @@ void programmer_entry(CFGCommon_ARG* cmdarg) {
     } else if (subCmd == "list_cable") {
       auto list_cable_arg =
           static_cast<const CFGArg_PROGRAMMER_LIST_CABLE*>(arg->get_sub_arg());
-      auto cables = hardware_manager.get_cables();
+      auto cables = connectedCables(hardware_manager);
       processCableList(cables, list_cable_arg->verbose);
       if (!cables.empty()) {
         std::string cableNamesTclOuput =
@@ -530,6 +552,8 @@ int InitLibrary(std::string openOCDPath) {
   return ProgrammerErrorCode::NoError;
 }
 
+void CloseOpenocdSessions() { openocdSessions.close_all(); }
+
 std::string GetErrorMessage(int errorCode) {
   auto it = ErrorMessages.find(errorCode);
   if (it != ErrorMessages.end()) {
@@ -540,14 +564,16 @@ std::string GetErrorMessage(int errorCode) {
 
 int GetAvailableCables(std::vector<Cable>& cables) {
   OpenocdAdapter openOcd{libOpenOcdExecPath};
+  openOcd.set_session_pool(sessionPool());
   HardwareManager hardware_manager{&openOcd};
   cables.clear();
-  cables = hardware_manager.get_cables();
+  cables = connectedCables(hardware_manager);
   return ProgrammerErrorCode::NoError;
 }
 
 int ListDevices(const Cable& cable, std::vector<Device>& devices) {
   OpenocdAdapter openOcd{libOpenOcdExecPath};
+  openOcd.set_session_pool(sessionPool());
   HardwareManager hardware_manager{&openOcd};
   if (!hardware_manager.is_cable_exists(cable.name)) {
     return ProgrammerErrorCode::CableNotFound;
@@ -563,6 +589,7 @@ int ListDevices(const Cable& cable, std::vector<Device>& devices) {
 int GetFpgaStatus(const Cable& cable, const Device& device,
                   CfgStatus& cfgStatus, std::string& statusOutputPrint) {
   OpenocdAdapter openOcd{libOpenOcdExecPath};
+  openOcd.set_session_pool(sessionPool());
   HardwareManager hardware_manager{&openOcd};
   ProgrammerTool programmer{&openOcd};
   Device detectedDevice;
@@ -581,6 +608,7 @@ int ProgramFpga(const Cable& cable, const Device& device,
                 OutputMessageCallback callbackMsg /*=nullptr*/,
                 ProgressCallback callbackProgress /*=nullptr*/) {
   OpenocdAdapter openOcd{libOpenOcdExecPath};
+  openOcd.set_session_pool(sessionPool());
   HardwareManager hardware_manager{&openOcd};
   Device detectedDevice;
   std::vector<Tap> taplist{};
@@ -602,6 +630,7 @@ int ProgramOTP(const Cable& cable, const Device& device,
                OutputMessageCallback callbackMsg /*=nullptr*/,
                ProgressCallback callbackProgress /*=nullptr*/) {
   OpenocdAdapter openOcd{libOpenOcdExecPath};
+  openOcd.set_session_pool(sessionPool());
   HardwareManager hardware_manager{&openOcd};
   Device detectedDevice;
   std::vector<Tap> taplist{};
@@ -626,6 +655,7 @@ int ProgramFlash(const Cable& cable, const Device& device,
                  OutputMessageCallback callbackMsg /*=nullptr*/,
                  ProgressCallback callbackProgress /*=nullptr*/) {
   OpenocdAdapter openOcd{libOpenOcdExecPath};
+  openOcd.set_session_pool(sessionPool());
   HardwareManager hardware_manager{&openOcd};
   Device detectedDevice;
   std::vector<Tap> taplist{};
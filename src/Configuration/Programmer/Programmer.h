@@ -75,6 +75,12 @@ void programmer_entry(CFGCommon_ARG* cmdarg);
  */
 int InitLibrary(std::string openOCDPath);
 
+/**
+ * Stops the OpenOCD sessions kept alive between operations and releases the
+ * cables, e.g. before the cables are used by another tool.
+ */
+void CloseOpenocdSessions();
+
 /**
  * Returns a string containing the error message for the given error code.
  *
@@ -25,6 +25,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 namespace FOEDAG {
 
+static constexpr int kMaxCachedFiles{4096};
+
 LineParser::Result FileNameParser::handleLine(const QString &message,
                                               OutputFormat format) {
   // use static to fix use-static-qregularexpression clazy warning
@@ -36,9 +38,7 @@ LineParser::Result FileNameParser::handleLine(const QString &message,
     const int cap{1};
     QString file = regExpMatch.captured(cap);
     file = file.trimmed();
-    const QFileInfo fileInfo{file};
-    const QString filePath =
-        fileInfo.exists() ? fileInfo.absoluteFilePath() : file;
+    const QString filePath = resolvePath(file);
     const QString line = regExpMatch.captured(2);
     LinkSpec link{regExpMatch.capturedStart(cap),
                   regExpMatch.capturedLength(cap),
@@ -53,9 +53,7 @@ LineParser::Result FileNameParser::handleLine(const QString &message,
   if (regExpMatch.hasMatch()) {
     QString file = regExpMatch.captured(1);
     file = file.trimmed();
-    const QFileInfo fileInfo{file};
-    const QString filePath =
-        fileInfo.exists() ? fileInfo.absoluteFilePath() : file;
+    const QString filePath = resolvePath(file);
     const QString line = "-1";
     LinkSpec link{regExpMatch.capturedStart(1), regExpMatch.capturedLength(1),
                   addLinkSpecForAbsoluteFilePath(filePath, line)};
@@ -64,4 +62,17 @@ LineParser::Result FileNameParser::handleLine(const QString &message,
   return Result{Status::NotHandled};
 }
 
+void FileNameParser::reset() { m_filePaths.clear(); }
+
+QString FileNameParser::resolvePath(const QString &file) {
+  auto cached = m_filePaths.constFind(file);
+  if (cached != m_filePaths.cend()) return cached.value();
+  const QFileInfo fileInfo{file};
+  const QString filePath =
+      fileInfo.exists() ? fileInfo.absoluteFilePath() : file;
+  if (m_filePaths.size() >= kMaxCachedFiles) m_filePaths.clear();
+  m_filePaths.insert(file, filePath);
+  return filePath;
+}
+
 }  // namespace FOEDAG
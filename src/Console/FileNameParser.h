@@ -20,6 +20,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #pragma once
 
+#include <QHash>
+
 #include "OutputFormatter.h"
 
 namespace FOEDAG {
@@ -28,6 +30,14 @@ class FileNameParser : public LineParser {
  public:
   FileNameParser() = default;
   Result handleLine(const QString &message, OutputFormat format) override;
+  void reset() override;
+
+ private:
+  QString resolvePath(const QString &file);
+
+  // Resolved paths of the files found since the last reset. Tools print the
+  // same files over and over, this saves a file system lookup per line
+  QHash<QString, QString> m_filePaths;
 };
 
 }  // namespace FOEDAG
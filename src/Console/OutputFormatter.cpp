@@ -30,7 +30,15 @@ Q_GLOBAL_STATIC_WITH_ARGS(QString, linkSep, {"::"})
 
 OutputFormatter::OutputFormatter() {}
 
-OutputFormatter::~OutputFormatter() { qDeleteAll(m_parsers); }
+OutputFormatter::~OutputFormatter() {
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_stop = true;
+  }
+  m_changed.notify_all();
+  if (m_worker.joinable()) m_worker.join();
+  qDeleteAll(m_parsers);
+}
 
 void OutputFormatter::appendMessage(const QString &message,
                                     OutputFormat format) {
@@ -38,31 +46,99 @@ void OutputFormatter::appendMessage(const QString &message,
   if (!textEdit()) return;
   if (format < 0 || format >= Count) return;
 
-  m_messageBuffer.append(message);
-  int index = m_messageBuffer.indexOf('\n', Qt::CaseInsensitive);
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_queue.push_back(Message{message, format});
+  }
+  if (!m_worker.joinable()) m_worker = std::thread{&OutputFormatter::run, this};
+  m_changed.notify_all();
+}
+
+void OutputFormatter::flush(bool wait) {
+  FormattedTexts texts;
+  {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    if (wait)
+      m_changed.wait(lock, [this]() { return m_queue.empty() && !m_parsing; });
+    texts.swap(m_parsed);
+  }
+  if (texts.empty() || !textEdit()) return;
+
+  textEdit()->moveCursor(QTextCursor::End);
+  QTextCursor cursor = textEdit()->textCursor();
+  cursor.beginEditBlock();
+  for (auto const &output : texts) {
+    cursor.insertText(output.text, output.format);
+  }
+  cursor.endEditBlock();
+}
+
+bool OutputFormatter::hasPending() const {
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return !m_queue.empty() || m_parsing || !m_parsed.empty();
+}
+
+void OutputFormatter::run() {
+  std::unique_lock<std::mutex> lock{m_mutex};
+  while (true) {
+    m_changed.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+    if (m_stop) return;
+    std::deque<Message> messages;
+    messages.swap(m_queue);
+    m_parsing = true;
+    lock.unlock();
+
+    FormattedTexts texts;
+    {
+      std::lock_guard<std::mutex> parsersLock{m_parsersMutex};
+      for (const auto &message : messages) parseMessage(message, texts);
+    }
+
+    lock.lock();
+    for (auto &text : texts) addText(m_parsed, text.text, text.format);
+    m_parsing = false;
+    m_changed.notify_all();
+  }
+}
+
+void OutputFormatter::parseMessage(const Message &message,
+                                   FormattedTexts &texts) {
+  m_messageBuffer.append(message.text);
+  int start = 0;
+  int index = m_messageBuffer.indexOf('\n', start, Qt::CaseInsensitive);
   while (index != -1) {  // perform parsing line by line
-    auto line = m_messageBuffer.mid(0, index + 1);
+    auto line = m_messageBuffer.mid(start, index + 1 - start);
 
     LineParser::Status status{LineParser::Status::NotHandled};
     for (auto parser : m_parsers) {
-      auto res = parser->handleLine(line, format);
+      auto res = parser->handleLine(line, message.format);
       if (res.status == LineParser::Status::Done) {
         status = res.status;
-        auto outputFormats = parseResults(line, format, res.linkSpecs);
+        auto outputFormats = parseResults(line, message.format, res.linkSpecs);
         for (auto const &output : outputFormats) {
-          textEdit()->textCursor().insertText(output.text, output.format);
+          addText(texts, output.text, output.format);
         }
         break;  // break, when one of the parsers was success to parse line
       }
     }
 
     if (status == LineParser::Status::NotHandled) {
-      textEdit()->textCursor().insertText(line, m_formats[format]);
+      addText(texts, line, m_formats[message.format]);
     }
 
-    m_messageBuffer.remove(0, index + 1);
-    index = m_messageBuffer.indexOf('\n', Qt::CaseInsensitive);
+    start = index + 1;
+    index = m_messageBuffer.indexOf('\n', start, Qt::CaseInsensitive);
   }
+  m_messageBuffer.remove(0, start);
+}
+
+void OutputFormatter::addText(FormattedTexts &texts, const QString &text,
+                              const QTextCharFormat &format) {
+  // Lines sharing a format are inserted at once
+  if (!texts.empty() && texts.back().format == format)
+    texts.back().text.append(text);
+  else
+    texts.push_back(FormattedText{text, format});
 }
 
 const std::vector<LineParser *> &OutputFormatter::parsers() const {
@@ -70,15 +146,23 @@ const std::vector<LineParser *> &OutputFormatter::parsers() const {
 }
 
 void OutputFormatter::setParsers(const std::vector<LineParser *> &newParsers) {
+  std::lock_guard<std::mutex> lock{m_parsersMutex};
   qDeleteAll(m_parsers);
   m_parsers = newParsers;
 }
 
 void OutputFormatter::addParser(LineParser *parser) {
+  std::lock_guard<std::mutex> lock{m_parsersMutex};
   m_parsers.push_back(parser);
 }
 
+void OutputFormatter::resetParsers() {
+  std::lock_guard<std::mutex> lock{m_parsersMutex};
+  for (auto parser : m_parsers) parser->reset();
+}
+
 void OutputFormatter::initFormats() {
+  std::lock_guard<std::mutex> lock{m_parsersMutex};
   m_formats[Regular].setForeground(Qt::black);
   m_formats[Output].setForeground(Qt::blue);
   m_formats[Error].setForeground(Qt::red);
@@ -133,6 +217,8 @@ void OutputFormatter::setTextEdit(QTextEdit *newTextEdit) {
 
 LineParser::~LineParser() {}
 
+void LineParser::reset() {}
+
 QString addLinkSpecForAbsoluteFilePath(const QString filePath,
                                        const QString &line) {
   return filePath + *linkSep() + line;
@@ -21,6 +21,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #pragma once
 
 #include <QTextCharFormat>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 class QTextEdit;
@@ -63,6 +67,10 @@ class LineParser {
   };
 
   virtual Result handleLine(const QString &message, OutputFormat format) = 0;
+  /*!
+   * \brief reset. Drop the state kept between lines, like cached lookups
+   */
+  virtual void reset();
 };
 
 class FormattedText {
@@ -73,13 +81,28 @@ class FormattedText {
   QTextCharFormat format;
 };
 
+/*!
+ * \brief The OutputFormatter class
+ * Lines are parsed on a worker thread, the text edit is only touched by
+ * flush() which inserts everything parsed so far in one edit block.
+ */
 class OutputFormatter {
   using FormattedTexts = std::vector<FormattedText>;
 
  public:
   OutputFormatter();
   ~OutputFormatter();
+  /*!
+   * \brief appendMessage. Queue \param message for parsing. Nothing is
+   * written until flush()
+   */
   void appendMessage(const QString &message, OutputFormat format);
+  /*!
+   * \brief flush. Write the parsed lines to the text edit. If \param wait is
+   * true, the queued messages are parsed first
+   */
+  void flush(bool wait = true);
+  bool hasPending() const;
 
   const std::vector<LineParser *> &parsers() const;
   /*!
@@ -92,21 +115,41 @@ class OutputFormatter {
    * pointer
    */
   void addParser(LineParser *parser);
+  void resetParsers();
 
   void setTextEdit(QTextEdit *newTextEdit);
   QTextEdit *textEdit() const;
 
  private:
+  struct Message {
+    QString text;
+    OutputFormat format;
+  };
   void initFormats();
+  void run();
+  void parseMessage(const Message &message, FormattedTexts &texts);
   FormattedTexts parseResults(const QString &text, OutputFormat format,
                               const LineParser::LinkSpecs &links) const;
   static QTextCharFormat linkedText(const QTextCharFormat &inputFormat,
                                     const QString &href);
+  static void addText(FormattedTexts &texts, const QString &text,
+                      const QTextCharFormat &format);
 
  private:
   std::vector<LineParser *> m_parsers;
   std::vector<QTextCharFormat> m_formats{Count};
-  QTextEdit *m_textEdit;
+  QTextEdit *m_textEdit{nullptr};
+  // Used by the worker only
   QString m_messageBuffer;
+  // Guards the parsers and formats used by the worker
+  std::mutex m_parsersMutex;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_changed;
+  std::deque<Message> m_queue;
+  FormattedTexts m_parsed;
+  bool m_parsing{false};
+  bool m_stop{false};
+  std::thread m_worker;
 };
 }  // namespace FOEDAG
@@ -10,6 +10,7 @@
 #include <QScrollBar>
 #include <QStack>
 #include <QTextBlock>
+#include <algorithm>
 
 #include "Compiler/Log.h"
 #include "ConsoleDefines.h"
@@ -21,6 +22,9 @@ namespace FOEDAG {
 
 Q_GLOBAL_STATIC_WITH_ARGS(QString, linkSep, {"::"})
 
+// About 30 frames per second
+static constexpr int kRenderInterval{33};
+
 TclConsoleWidget::TclConsoleWidget(TclInterp *interp,
                                    std::unique_ptr<ConsoleInterface> iConsole,
                                    TclConsoleBuffer *buffer, QWidget *parent)
@@ -32,6 +36,9 @@ TclConsoleWidget::TclConsoleWidget(TclInterp *interp,
   connect(m_errorBuffer, &TclConsoleBuffer::ready, this,
           &TclConsoleWidget::putError);
   m_formatter.setTextEdit(this);
+  m_renderTimer.setInterval(kRenderInterval);
+  connect(&m_renderTimer, &QTimer::timeout, this,
+          [this]() { renderOutput(false); });
   if (m_console) {
     connect(m_console.get(), &ConsoleInterface::done, this,
             &TclConsoleWidget::commandDone);
@@ -60,14 +67,19 @@ TclConsoleBuffer *TclConsoleWidget::getErrorBuffer() { return m_errorBuffer; }
 const char *TclConsoleWidget::consoleObjectName() { return "TclConsole"; }
 
 void TclConsoleWidget::clearText() {
+  renderOutput(true);
   clear();
   displayPrompt();
 }
 
-void TclConsoleWidget::showPrompt() { displayPrompt(); }
+void TclConsoleWidget::showPrompt() {
+  renderOutput(true);
+  displayPrompt();
+}
 
 QString TclConsoleWidget::interpretCommand(const QString &command, int *res) {
   if (!command.isEmpty()) {
+    renderOutput(true);
     setUndoRedoEnabled(false);
     setState(State::IN_PROGRESS);
     QString prepareCommand = command;
@@ -159,6 +171,8 @@ void TclConsoleWidget::putError(const QString &str) {
 }
 
 void TclConsoleWidget::commandDone() {
+  renderOutput(true);
+  m_formatter.resetParsers();
   if (!hasPrompt()) displayPrompt();
   setState(State::IDLE);
 }
@@ -166,12 +180,31 @@ void TclConsoleWidget::commandDone() {
 void FOEDAG::TclConsoleWidget::putMessage(const QString &message,
                                           OutputFormat format) {
   if (!message.isEmpty()) {
-    moveCursor(QTextCursor::End);
     LOG_OUTPUT(message);
     m_formatter.appendMessage(message, format);
+    if (!m_renderTimer.isActive()) m_renderTimer.start();
   }
 }
 
+void TclConsoleWidget::renderOutput(bool wait) {
+  m_formatter.flush(wait);
+  trimScrollback();
+  if (!m_formatter.hasPending()) m_renderTimer.stop();
+}
+
+void TclConsoleWidget::trimScrollback() {
+  if (m_scrollback <= 0) return;
+  const int excess = document()->blockCount() - m_scrollback;
+  if (excess <= 0) return;
+  QTextCursor cursor{document()};
+  cursor.beginEditBlock();
+  cursor.movePosition(QTextCursor::NextBlock, QTextCursor::KeepAnchor, excess);
+  cursor.removeSelectedText();
+  cursor.endEditBlock();
+  // Keep the edition zone on the prompt line
+  promptParagraph = std::max(promptParagraph - excess, 0);
+}
+
 void TclConsoleWidget::handleLink(const QPoint &p) {
   const QString anchor{anchorAt(p)};
   if (!anchor.isEmpty()) {
@@ -354,6 +387,13 @@ void TclConsoleWidget::addParser(LineParser *parser) {
   m_formatter.addParser(parser);
 }
 
+void TclConsoleWidget::setScrollback(int lines) {
+  m_scrollback = std::max(lines, 0);
+  trimScrollback();
+}
+
+int TclConsoleWidget::scrollback() const { return m_scrollback; }
+
 void TclConsoleWidget::setState(const State &state) {
   if (m_state != state) {
     m_state = state;
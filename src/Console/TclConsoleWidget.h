@@ -2,6 +2,7 @@
 
 #include <QPlainTextEdit>
 #include <QTextBlock>
+#include <QTimer>
 #include <memory>
 #include <ostream>
 
@@ -48,6 +49,12 @@ class TclConsoleWidget : public QConsole {
    */
   void addParser(LineParser *parser);
 
+  /*!
+   * \brief setScrollback. Keep at most \param lines lines, 0 for no limit
+   */
+  void setScrollback(int lines);
+  int scrollback() const;
+
  public slots:
   void clearText();
   void showPrompt();
@@ -74,6 +81,13 @@ class TclConsoleWidget : public QConsole {
 
  private:
   void putMessage(const QString &message, OutputFormat format);
+  /*!
+   * \brief renderOutput. Write the formatted output to the console, called
+   * at a fixed rate while output comes. With \param wait all the output is
+   * written, needed before the console writes anything else
+   */
+  void renderOutput(bool wait);
+  void trimScrollback();
   void setState(const State &state);
   void handleLink(const QPoint &p);
   void registerCommands(TclInterp *interp);
@@ -95,6 +109,8 @@ class TclConsoleWidget : public QConsole {
   bool m_linkActivated{true};
   Qt::MouseButton m_mouseButtonPressed{Qt::NoButton};
   OutputFormatter m_formatter;
+  QTimer m_renderTimer;
+  int m_scrollback{100000};
 };
 
 }  // namespace FOEDAG
@@ -58,6 +58,8 @@ StateCheck::~StateCheck() {
 
 void StateCheck::setCommandCount(uint count) { m_commandCount = count; }
 
+void StateCheck::setMaxBlockCount(int count) { m_maxBlockCount = count; }
+
 void StateCheck::testFail(const QString &message) {
   if (!message.isEmpty()) qDebug().noquote() << message;
   ::exit(1);
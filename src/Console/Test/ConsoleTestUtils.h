@@ -42,6 +42,7 @@ class StateCheck : public QObject {
   TclConsoleWidget* m_console;
   bool m_pass{false};
   uint m_commandCount{1};
+  int m_maxBlockCount{0};
 
  public:
   StateCheck(const QString& textToCheck, FOEDAG::TclConsoleWidget* console)
@@ -58,6 +59,11 @@ class StateCheck : public QObject {
    */
   void checkStateQueue() { emit check(FOEDAG::State::IDLE); }
   void setCommandCount(uint count);
+  /*!
+   * \brief setMaxBlockCount. Also check the console keeps at most \a count
+   * blocks, 0 for no check
+   */
+  void setMaxBlockCount(int count);
 
  signals:
   void check(FOEDAG::State);
@@ -70,7 +76,13 @@ class StateCheck : public QObject {
         return;
       }
       QString consoleText = m_console->toPlainText();
-      if (consoleText != m_text) {
+      const int blockCount = m_console->document()->blockCount();
+      if (m_maxBlockCount > 0 && blockCount > m_maxBlockCount) {
+        qDebug() << "FAILED";
+        qDebug() << "Expected at most" << m_maxBlockCount << "blocks, got"
+                 << blockCount;
+        testFail("");
+      } else if (consoleText != m_text) {
         qDebug() << "FAILED";
         qDebug() << "Expected: " << m_text;
         qDebug() << "Actual:   " << consoleText;
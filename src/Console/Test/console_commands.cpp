@@ -101,6 +101,20 @@ debug test
   return TCL_OK;
 }
 
+TCL_COMMAND(console_scrollback) {
+  FOEDAG::TclConsoleWidget *console = FOEDAG::InitConsole(clientData);
+  console->setScrollback(5);
+  // the second command is typed at the prompt left after trimming
+  QString script =
+      "for {set i 0} {$i < 20} {incr i} {debug line$i}\n"
+      "debug done\n";
+  const QString pt = console->getPrompt();
+  QString res = "line18\nline19\n" + pt + "debug done\ndone\n" + pt;
+  CHECK_EXPECTED_FOR_FEW_COMMANDS(script, res, 2)
+  check->setMaxBlockCount(5);
+  return TCL_OK;
+}
+
 TCL_COMMAND(debug) {
   QWidget *w = static_cast<QWidget *>(clientData);
   FOEDAG::TclConsoleWidget *console = w->findChild<FOEDAG::TclConsoleWidget *>(
@@ -48,6 +48,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Compiler/WorkerThread.h"
 #include "MainWindow/Session.h"
 #include "NewProject/ProjectManager/project_manager.h"
+#include "PortIndex.h"
 #include "ProjNavigator/tcl_command_integration.h"
 #include "Utils/FileUtils.h"
 #include "Utils/ProcessUtils.h"
@@ -199,6 +200,17 @@ std::vector<Bus> DesignQuery::GetBuses(int portType, bool& portsParsed) const {
   return ports;
 }
 
+std::pair<std::shared_ptr<const PortIndex>, std::string>
+DesignQuery::LoadPortIndex() const {
+  auto result = PortIndex::Load(GetHierInfoPath().string());
+  if (result.first && !result.second.empty()) {
+    for (const auto& warning : StringUtils::tokenize(result.second, "\n"))
+      m_compiler->Message("WARNING: " + warning);
+    result.second.clear();
+  }
+  return result;
+}
+
 void DesignQuery::SetReadSdc(bool read_sdc) { m_read_sdc = read_sdc; }
 
 bool DesignQuery::RegisterCommands(TclInterpreter* interp, bool batchMode) {
@@ -1083,59 +1095,28 @@ bool DesignQuery::RegisterCommands(TclInterpreter* interp, bool batchMode) {
       return TCL_OK;
     }
 
-    if (const auto& [ok, message] = designQuery->LoadHierInfo(); !ok) {
+    const auto [index, message] = designQuery->LoadPortIndex();
+    if (!index) {
       Tcl_AppendResult(interp, message.c_str(), nullptr);
       return TCL_ERROR;
     }
 
-    static const int PortsOutput{2};
-    static const int PortsInput{1};
-    bool portsParsed{true};
-    auto designPorts =
-        designQuery->GetPorts(PortsInput | PortsOutput, portsParsed);
-    if (!portsParsed) {
-      Tcl_AppendResult(interp, "Failed to parse json file", nullptr);
-      return TCL_ERROR;
-    }
-
     StringVector get_ports;
     for (int i = 1; i < argc; i++) {
       std::string arg{argv[i]};
       arg = StringUtils::replaceAll(arg, "@*@", "*");
       if (arg == "*") {
-        get_ports = designPorts;
+        get_ports = index->ports();
         break;
       }
-      auto buses = designQuery->GetBuses(PortsInput | PortsOutput, portsParsed);
-      if (!portsParsed) {
-        Tcl_AppendResult(interp, "Failed to parse json file", nullptr);
-        return TCL_ERROR;
-      }
-      const std::regex portRegex{R"((.+)\[(\d+)\])"};
       StringVector portsList = StringUtils::tokenize(arg, " ", true);
       for (const auto& port : portsList) {
-        if (std::regex_match(port, portRegex)) {
-          // handle buses
-          std::smatch sm;
-          std::regex_search(port, sm, portRegex);
-          auto busName = sm[1].str();
-          auto bitNumber = StringUtils::to_number<int>(sm[2].str()).first;
-          auto findBus = std::find_if(
-              buses.begin(), buses.end(), [busName, bitNumber](const Bus& bus) {
-                return (bus.name == busName) && (bitNumber >= bus.lsb) &&
-                       (bitNumber <= bus.msb);
-              });
-          if (findBus != buses.end()) get_ports.push_back(port);
+        if (index->hasBusBit(port)) {
+          get_ports.push_back(port);
         } else if (StringUtils::contains(port, '*')) {
-          auto regexpr = StringUtils::replaceAll(port, "*", ".+");
-          const std::regex regexp{regexpr};
-          for (const auto& existingPort : designPorts) {
-            if (std::regex_match(existingPort, regexp))
-              get_ports.push_back(existingPort);
-          }
-        } else {
-          if (StringUtils::contains(designPorts, port))
-            get_ports.push_back(port);
+          get_ports += index->match(port);
+        } else if (index->hasPort(port)) {
+          get_ports.push_back(port);
         }
       }
     }
@@ -1150,18 +1131,13 @@ bool DesignQuery::RegisterCommands(TclInterpreter* interp, bool batchMode) {
                        const char* argv[]) -> int {
     DesignQuery* designQuery = static_cast<DesignQuery*>(clientData);
     if (!designQuery || !designQuery->m_compiler) return TCL_ERROR;
-    if (const auto& [ok, message] = designQuery->LoadHierInfo(); !ok) {
+    const auto [index, message] = designQuery->LoadPortIndex();
+    if (!index) {
       Tcl_AppendResult(interp, message.c_str(), nullptr);
       return TCL_ERROR;
     }
-    static const int PortsInput{1};
-    bool portsParsed{true};
-    auto ports = designQuery->GetPorts(PortsInput, portsParsed);
-    if (!portsParsed) {
-      Tcl_AppendResult(interp, "Failed to parse json file", nullptr);
-      return TCL_ERROR;
-    }
-    Tcl_AppendResult(interp, StringUtils::join(ports, " ").c_str(), nullptr);
+    Tcl_AppendResult(interp, StringUtils::join(index->inputs(), " ").c_str(),
+                     nullptr);
     return TCL_OK;
   };
   interp->registerCmd("all_inputs", all_inputs, this, 0);
@@ -1170,18 +1146,13 @@ bool DesignQuery::RegisterCommands(TclInterpreter* interp, bool batchMode) {
                         const char* argv[]) -> int {
     DesignQuery* designQuery = static_cast<DesignQuery*>(clientData);
     if (!designQuery || !designQuery->m_compiler) return TCL_ERROR;
-    if (const auto& [ok, message] = designQuery->LoadHierInfo(); !ok) {
+    const auto [index, message] = designQuery->LoadPortIndex();
+    if (!index) {
       Tcl_AppendResult(interp, message.c_str(), nullptr);
       return TCL_ERROR;
     }
-    static const int PortsOutput{2};
-    bool portsParsed{true};
-    auto ports = designQuery->GetPorts(PortsOutput, portsParsed);
-    if (!portsParsed) {
-      Tcl_AppendResult(interp, "Failed to parse json file", nullptr);
-      return TCL_ERROR;
-    }
-    Tcl_AppendResult(interp, StringUtils::join(ports, " ").c_str(), nullptr);
+    Tcl_AppendResult(interp, StringUtils::join(index->outputs(), " ").c_str(),
+                     nullptr);
 
     return TCL_OK;
   };
@@ -25,6 +25,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -34,6 +35,7 @@ namespace FOEDAG {
 
 class TclInterpreter;
 class Compiler;
+class PortIndex;
 
 struct Bus {
   std::string name{};
@@ -54,6 +56,9 @@ class DesignQuery {
   std::filesystem::path GetPortInfoPath() const;
   std::pair<bool, std::string> LoadPortInfo();
   std::pair<bool, std::string> LoadHierInfo();
+  // Port index of hier_info.json, reparsed only when the file changed
+  std::pair<std::shared_ptr<const PortIndex>, std::string> LoadPortIndex()
+      const;
 
   std::vector<std::string> GetPorts(int portType, bool& portsParsed) const;
   std::vector<Bus> GetBuses(int portType, bool& portsParsed) const;
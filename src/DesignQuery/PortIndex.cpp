@@ -0,0 +1,210 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "PortIndex.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <algorithm>
+#include <map>
+
+#include "Utils/StringUtils.h"
+#include "nlohmann_json/json.hpp"
+
+using json = nlohmann::ordered_json;
+
+namespace FOEDAG {
+
+GlobMatcher::GlobMatcher(const std::string& pattern) {
+  std::string part;
+  for (char c : pattern) {
+    if (c == '*') {
+      m_parts.push_back(part);
+      part.clear();
+    } else {
+      part.push_back(c);
+    }
+  }
+  m_parts.push_back(part);
+}
+
+bool GlobMatcher::match(const std::string& text) const {
+  const auto& first = m_parts.front();
+  if (m_parts.size() == 1) return text == first;
+  const auto& last = m_parts.back();
+  if (text.compare(0, first.size(), first) != 0) return false;
+  size_t pos = first.size();
+  for (size_t i = 1; i < m_parts.size() - 1; i++) {
+    // each star takes at least one character
+    pos = text.find(m_parts[i], pos + 1);
+    if (pos == std::string::npos) return false;
+    pos += m_parts[i].size();
+  }
+  if (text.size() < pos + 1 + last.size()) return false;
+  return text.compare(text.size() - last.size(), last.size(), last) == 0;
+}
+
+namespace {
+struct CacheEntry {
+  qint64 mtime{-1};
+  qint64 size{-1};
+  QByteArray hash;
+  std::shared_ptr<const PortIndex> index;
+};
+std::mutex cacheMutex;
+std::map<std::string, CacheEntry> cache;
+}  // namespace
+
+std::pair<std::shared_ptr<const PortIndex>, std::string> PortIndex::Load(
+    const std::string& file) {
+  const QString fileName = QString::fromStdString(file);
+  QFileInfo info{fileName};
+  if (!info.exists())
+    return {nullptr,
+            StringUtils::format(R"(Unable to locate file "%")", file)};
+  const qint64 mtime = info.lastModified().toMSecsSinceEpoch();
+  const qint64 size = info.size();
+  std::lock_guard<std::mutex> lock{cacheMutex};
+  auto& entry = cache[file];
+  if (entry.index && entry.mtime == mtime && entry.size == size)
+    return {entry.index, {}};
+
+  QFile f{fileName};
+  if (!f.open(QFile::ReadOnly))
+    return {nullptr, StringUtils::format("Can't open file %", file)};
+  const QByteArray content = f.readAll();
+  QByteArray hash = QCryptographicHash::hash(content, QCryptographicHash::Md5);
+  entry.mtime = mtime;
+  entry.size = size;
+  if (entry.index && entry.hash == hash) return {entry.index, {}};
+  auto result = Parse(content.toStdString(), file);
+  entry.hash = result.first ? hash : QByteArray{};
+  entry.index = result.first;
+  return result;
+}
+
+void PortIndex::ClearCache() {
+  std::lock_guard<std::mutex> lock{cacheMutex};
+  cache.clear();
+}
+
+std::pair<std::shared_ptr<const PortIndex>, std::string> PortIndex::Parse(
+    const std::string& content, const std::string& file) {
+  auto index = std::make_shared<PortIndex>();
+  try {
+    const json data = json::parse(content);
+    // hier_info.json keeps groups in "hierTree", port_info.json is an array
+    const json& groups = data.is_object() ? data.at("hierTree") : data;
+    for (const auto& group : groups) {
+      index->m_groups.emplace_back();
+      const auto& ports = group.at("ports");
+      index->m_groups.back().reserve(ports.size());
+      for (const auto& p : ports) {
+        Port port;
+        port.name = p.at("name");
+        port.direction = p.at("direction");
+        port.type = p.value("type", std::string{});
+        // A port without range is one bit wide
+        const auto range = p.find("range");
+        if (range != p.end()) {
+          port.msb = range->at("msb");
+          port.lsb = range->at("lsb");
+        }
+        index->add(port);
+      }
+    }
+  } catch (json::parse_error& e) {
+    return {nullptr,
+            StringUtils::format("Json Error: %\nFile: %\nByte position of "
+                                "error: %",
+                                e.what(), file, std::to_string(e.byte))};
+  } catch (std::exception& e) {
+    return {nullptr, StringUtils::format("Failed to parse file %: %", file,
+                                         e.what())};
+  }
+  index->m_ports = index->m_inputs;
+  index->m_ports.insert(index->m_ports.end(), index->m_outputs.begin(),
+                        index->m_outputs.end());
+  return {index, StringUtils::join(index->m_warnings, "\n")};
+}
+
+void PortIndex::add(const Port& port) {
+  const bool input = port.direction == "Input";
+  if (!input && port.direction != "Output") {
+    m_groups.back().push_back(port);
+    return;
+  }
+  auto [name, added] = m_names.emplace(port.name, port.direction);
+  if (added) {
+    (input ? m_inputs : m_outputs).push_back(port.name);
+  } else if (name->second != port.direction) {
+    // The first declaration wins, the netlist is still usable
+    m_warnings.push_back(StringUtils::format(
+        "port % is declared as % and %, keeping %", port.name, name->second,
+        port.direction, name->second));
+    return;
+  }
+  m_groups.back().push_back(port);
+  // A port listed again is merged, its bus covers all listed bits
+  auto bus = m_buses.find(port.name);
+  if (bus != m_buses.end()) {
+    bus->second.first = std::min(bus->second.first, port.lsb);
+    bus->second.second = std::max(bus->second.second, port.msb);
+  } else if (port.isBus()) {
+    m_buses.emplace(port.name, std::make_pair(port.lsb, port.msb));
+  }
+}
+
+bool PortIndex::hasPort(const std::string& name) const {
+  return m_names.count(name) != 0;
+}
+
+bool PortIndex::hasBusBit(const std::string& name) const {
+  // name[<digits>]
+  if (name.size() < 4 || name.back() != ']') return false;
+  auto open = name.rfind('[');
+  if (open == std::string::npos || open == 0 || open + 2 >= name.size())
+    return false;
+  auto digits = name.substr(open + 1, name.size() - open - 2);
+  if (!std::all_of(digits.begin(), digits.end(),
+                   [](char c) { return c >= '0' && c <= '9'; }))
+    return false;
+  auto [bit, ok] = StringUtils::to_number<int>(digits);
+  if (!ok) return false;
+  auto bus = m_buses.find(name.substr(0, open));
+  if (bus == m_buses.end()) return false;
+  return bit >= bus->second.first && bit <= bus->second.second;
+}
+
+std::vector<std::string> PortIndex::match(const std::string& pattern) const {
+  std::lock_guard<std::mutex> lock{m_matchMutex};
+  auto it = m_matches.find(pattern);
+  if (it != m_matches.end()) return it->second;
+  const GlobMatcher glob{pattern};
+  std::vector<std::string> result;
+  for (const auto& port : m_ports)
+    if (glob.match(port)) result.push_back(port);
+  m_matches.emplace(pattern, result);
+  return result;
+}
+
+}  // namespace FOEDAG
@@ -0,0 +1,104 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace FOEDAG {
+
+/*!
+ * \brief The GlobMatcher class
+ * Port name pattern where '*' stands for one or more characters, all other
+ * characters match literally. The pattern is split once into its literal
+ * parts, matching needs no regex.
+ */
+class GlobMatcher {
+ public:
+  explicit GlobMatcher(const std::string& pattern);
+  bool match(const std::string& text) const;
+
+ private:
+  std::vector<std::string> m_parts;  // literals between stars
+};
+
+/*!
+ * \brief The PortIndex class
+ * Ports of a parsed hier_info.json ("hierTree" object) or port_info.json
+ * (array of port groups). The index is immutable once parsed and cached per
+ * file: it is rebuilt only if the file content changed, a touched file with
+ * the same content reuses the previous index. A port listed more than once is
+ * merged. A port listed with different directions keeps its first direction,
+ * the later declarations are dropped with a warning.
+ */
+class PortIndex {
+ public:
+  struct Port {
+    std::string name;
+    std::string direction;
+    std::string type;
+    int msb{0};
+    int lsb{0};
+    bool isBus() const { return msb != lsb; }
+  };
+  using Group = std::vector<Port>;
+
+  // Cached index of the file, file may be a Qt resource. The string is the
+  // error without index, otherwise the parse warnings, one per line. Warnings
+  // are only returned when the file is parsed, not when the cache is hit
+  static std::pair<std::shared_ptr<const PortIndex>, std::string> Load(
+      const std::string& file);
+  static std::pair<std::shared_ptr<const PortIndex>, std::string> Parse(
+      const std::string& content, const std::string& file = {});
+  static void ClearCache();
+
+  const std::vector<Group>& groups() const { return m_groups; }
+  // Input and output ports in file order, inout ports are not included
+  const std::vector<std::string>& inputs() const { return m_inputs; }
+  const std::vector<std::string>& outputs() const { return m_outputs; }
+  // Inputs followed by outputs
+  const std::vector<std::string>& ports() const { return m_ports; }
+
+  bool hasPort(const std::string& name) const;
+  // True if name is a bit "bus[i]" within the range of an input/output bus
+  bool hasBusBit(const std::string& name) const;
+  // Ports matching the glob pattern, memoised per pattern
+  std::vector<std::string> match(const std::string& pattern) const;
+
+ private:
+  void add(const Port& port);
+
+  std::vector<Group> m_groups;
+  std::vector<std::string> m_inputs;
+  std::vector<std::string> m_outputs;
+  std::vector<std::string> m_ports;
+  std::vector<std::string> m_warnings;
+  std::unordered_map<std::string, std::string> m_names;  // direction
+  std::unordered_map<std::string, std::pair<int, int>> m_buses;  // lsb, msb
+  mutable std::mutex m_matchMutex;
+  mutable std::unordered_map<std::string, std::vector<std::string>> m_matches;
+};
+
+}  // namespace FOEDAG
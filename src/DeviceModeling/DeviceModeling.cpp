@@ -61,7 +61,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QDebug>
 #include <QProcess>
+#include <QStandardPaths>
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
 #include <ctime>
 #include <exception>
 #include <filesystem>
@@ -95,6 +98,183 @@ std::filesystem::path DeviceModeling::GetProjDir() const {
   return dir;
 }
 
+// Sources a device model file. Every file it sources is traced, so that a
+// snapshot of the model can be checked against all of them. The global
+// variables and the procs the files set are returned as a script that sets
+// them again.
+static int source_device_model(Tcl_Interp* interp, const std::string& file,
+                               std::vector<std::string>& devices,
+                               std::vector<std::string>& sources,
+                               std::string& variables) {
+  static const char* script = R"(apply {{file} {
+  set skip {errorInfo errorCode env __device_model_file
+            __device_model_sources __device_model_variables}
+  set procs {apply {{} {
+    set result [dict create]
+    set queue [list ::]
+    while {[llength $queue]} {
+      set queue [lassign $queue ns]
+      lappend queue {*}[namespace children $ns]
+      foreach name [info procs [string trimright $ns :]::*] {
+        set params {}
+        foreach arg [info args $name] {
+          if {[info default $name $arg value]} {
+            lappend params [list $arg $value]
+          } else {
+            lappend params $arg
+          }
+        }
+        dict set result $name [list $params [info body $name]]
+      }
+    }
+    return $result
+  }}}
+  set procsBefore [{*}$procs]
+  set before [dict create]
+  foreach name [info globals] {
+    if {[array exists ::$name]} {
+      dict set before $name [list array [array get ::$name]]
+    } elseif {[info exists ::$name]} {
+      dict set before $name [list scalar [set ::$name]]
+    }
+  }
+  set trace {apply {{cmd op} {
+    lappend ::__device_model_sources [file normalize [lindex $cmd end]]
+  }}}
+  set ::__device_model_sources {}
+  trace add execution source enter $trace
+  set code [catch {uplevel #0 [list source $file]} msg opts]
+  trace remove execution source enter $trace
+  set ::__device_model_variables {}
+  foreach name [info globals] {
+    if {$name in $skip} continue
+    if {[array exists ::$name]} {
+      set value [list array [array get ::$name]]
+      set command [list array set ::$name [array get ::$name]]
+    } elseif {[info exists ::$name]} {
+      set value [list scalar [set ::$name]]
+      set command [list set ::$name [set ::$name]]
+    } else {
+      continue
+    }
+    if {![dict exists $before $name] || [dict get $before $name] ne $value} {
+      append ::__device_model_variables $command \n
+    }
+  }
+  dict for {name definition} [{*}$procs] {
+    if {[dict exists $procsBefore $name] &&
+        [dict get $procsBefore $name] eq $definition} continue
+    set ns [namespace qualifiers $name]
+    if {$ns ne ""} {
+      append ::__device_model_variables [list namespace eval $ns {}] \n
+    }
+    append ::__device_model_variables [list proc $name {*}$definition] \n
+  }
+  return -options $opts $msg
+}} $::__device_model_file)";
+  device_modeler& modeler = Model::get_modler();
+  std::vector<std::string> before = modeler.device_names();
+  Tcl_SetVar(interp, "::__device_model_file", file.c_str(), TCL_GLOBAL_ONLY);
+  int code = Tcl_Eval(interp, script);
+  const char* traced =
+      Tcl_GetVar(interp, "::__device_model_sources", TCL_GLOBAL_ONLY);
+  int count = 0;
+  const char** paths = nullptr;
+  if (traced && Tcl_SplitList(nullptr, traced, &count, &paths) == TCL_OK) {
+    sources.assign(paths, paths + count);
+    Tcl_Free((char*)paths);
+  }
+  const char* set =
+      Tcl_GetVar(interp, "::__device_model_variables", TCL_GLOBAL_ONLY);
+  variables = set ? set : "";
+  Tcl_UnsetVar(interp, "::__device_model_file", TCL_GLOBAL_ONLY);
+  Tcl_UnsetVar(interp, "::__device_model_sources", TCL_GLOBAL_ONLY);
+  Tcl_UnsetVar(interp, "::__device_model_variables", TCL_GLOBAL_ONLY);
+  std::sort(sources.begin(), sources.end());
+  sources.erase(std::unique(sources.begin(), sources.end()), sources.end());
+  if (code != TCL_OK) return code;
+
+  // The snapshot holds the devices the file defines and the current device
+  for (const std::string& name : modeler.device_names()) {
+    if (!std::binary_search(before.begin(), before.end(), name)) {
+      devices.push_back(name);
+    }
+  }
+  auto current = modeler.get_current_device();
+  if (current && std::find(devices.begin(), devices.end(),
+                           current->device_name()) == devices.end()) {
+    devices.push_back(current->device_name());
+  }
+  return TCL_OK;
+}
+
+// Device snapshots live in the user cache dir, overridden by
+// FOEDAG_DEVICE_CACHE. Empty if snapshots are disabled
+static std::filesystem::path device_snapshot_dir() {
+  if (const char* env = std::getenv("FOEDAG_DEVICE_CACHE")) {
+    return std::filesystem::path{env};
+  }
+  QString cache =
+      QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+  if (cache.isEmpty()) return {};
+  return std::filesystem::path{cache.toStdString()} / "foedag" /
+         "device_models";
+}
+
+// The snapshot of a device model file, named after the hash of its full
+// path. Empty if snapshots are disabled
+static std::string device_snapshot_path(const std::string& file) {
+  std::filesystem::path dir = device_snapshot_dir();
+  if (dir.empty()) return {};
+  const std::string full = FileUtils::GetFullPath(file).string();
+  std::ostringstream name;
+  name << std::filesystem::path{file}.stem().string() << "_" << std::hex
+       << device_snapshot::hash_bytes(full.data(), full.size()) << ".snapshot";
+  return (dir / name.str()).string();
+}
+
+// The snapshot given by -snapshot, the one in the user cache otherwise
+static std::string device_snapshot_path(int argc, const char* argv[]) {
+  device_modeler& modeler = Model::get_modler();
+  std::string snapshot = modeler.get_argument_value("-snapshot", argc, argv);
+  if (snapshot.empty()) {
+    snapshot = device_snapshot_path(
+        modeler.get_argument_value("-file", argc, argv, true));
+  }
+  return snapshot;
+}
+
+// Loads the device model file from its snapshot when it is valid. Otherwise
+// sources the file and writes the snapshot
+static int load_device_model(Tcl_Interp* interp, Compiler* compiler,
+                             const std::string& file,
+                             const std::string& snapshot) {
+  device_modeler& modeler = Model::get_modler();
+  std::string reason;
+  std::string variables;
+  if (!snapshot.empty() && FileUtils::FileExists(snapshot)) {
+    if (modeler.load_snapshot(snapshot, reason, true, &variables)) {
+      compiler->Message("Loaded device model from " + snapshot);
+      return Tcl_Eval(interp, variables.c_str());
+    }
+    compiler->Message("Ignoring device snapshot " + snapshot + ": " + reason);
+  }
+  std::vector<std::string> devices;
+  std::vector<std::string> sources;
+  int code = source_device_model(interp, file, devices, sources, variables);
+  if (code != TCL_OK || snapshot.empty()) return code;
+  try {
+    std::error_code ec;
+    std::filesystem::create_directories(
+        std::filesystem::path{snapshot}.parent_path(), ec);
+    modeler.write_snapshot(snapshot, devices, sources, variables);
+  } catch (const std::exception& ex) {
+    // The model is loaded, only the next start up is slower
+    compiler->Message(std::string("WARNING: ") + ex.what());
+  }
+  return TCL_OK;
+}
+
 bool DeviceModeling::RegisterCommands(TclInterpreter* interp, bool batchMode) {
   auto test_device_modeling_tcl = [](void* clientData, Tcl_Interp* interp,
                                      int argc, const char* argv[]) -> int {
@@ -882,6 +1062,107 @@ bool DeviceModeling::RegisterCommands(TclInterpreter* interp, bool batchMode) {
   };
   interp->registerCmd("get_logic_location", get_logic_location, this, 0);
 
+  auto get_logic_address_bulk = [](void* clientData, Tcl_Interp* interp,
+                                   int argc, const char* argv[]) -> int {
+    DeviceModeling* device_modeling = (DeviceModeling*)clientData;
+    Compiler* compiler = device_modeling->GetCompiler();
+    bool status = false;
+    try {
+      Tcl_Obj* resultList = Tcl_NewListObj(0, NULL);
+      auto addresses =
+          Model::get_modler().get_logic_address_bulk(argc, argv);
+      // Append each address to the list.
+      for (auto n : addresses) {
+        Tcl_ListObjAppendElement(interp, resultList, Tcl_NewIntObj(n));
+      }
+      Tcl_SetObjResult(interp, resultList);
+      status = true;
+    } catch (const std::exception& ex) {
+      compiler->ErrorMessage(ex.what());
+    } catch (...) {
+      compiler->ErrorMessage("Unknown Exception");
+    }
+
+    return (status) ? TCL_OK : TCL_ERROR;
+  };
+  interp->registerCmd("get_logic_address_bulk", get_logic_address_bulk,
+                      this, 0);
+
+  auto set_logic_address_bulk = [](void* clientData, Tcl_Interp* interp,
+                                   int argc, const char* argv[]) -> int {
+    DeviceModeling* device_modeling = (DeviceModeling*)clientData;
+    Compiler* compiler = device_modeling->GetCompiler();
+    bool status = false;
+    try {
+      status = Model::get_modler().set_logic_address_bulk(argc, argv);
+    } catch (const std::exception& ex) {
+      compiler->ErrorMessage(ex.what());
+    } catch (...) {
+      compiler->ErrorMessage("Unknown Exception");
+    }
+    return (status) ? TCL_OK : TCL_ERROR;
+  };
+  interp->registerCmd("set_logic_address_bulk", set_logic_address_bulk,
+                      this, 0);
+
+  auto get_phy_address_bulk = [](void* clientData, Tcl_Interp* interp,
+                                 int argc, const char* argv[]) -> int {
+    DeviceModeling* device_modeling = (DeviceModeling*)clientData;
+    Compiler* compiler = device_modeling->GetCompiler();
+    bool status = false;
+    try {
+      Tcl_Obj* resultList = Tcl_NewListObj(0, NULL);
+      auto addresses =
+          Model::get_modler().get_phy_address_bulk(argc, argv);
+      // Append each address to the list.
+      for (auto n : addresses) {
+        Tcl_ListObjAppendElement(interp, resultList, Tcl_NewIntObj(n));
+      }
+      Tcl_SetObjResult(interp, resultList);
+      status = true;
+    } catch (const std::exception& ex) {
+      compiler->ErrorMessage(ex.what());
+    } catch (...) {
+      compiler->ErrorMessage("Unknown Exception");
+    }
+
+    return (status) ? TCL_OK : TCL_ERROR;
+  };
+  interp->registerCmd("get_phy_address_bulk", get_phy_address_bulk, this, 0);
+
+  auto set_phy_address_bulk = [](void* clientData, Tcl_Interp* interp,
+                                 int argc, const char* argv[]) -> int {
+    DeviceModeling* device_modeling = (DeviceModeling*)clientData;
+    Compiler* compiler = device_modeling->GetCompiler();
+    bool status = false;
+    try {
+      status = Model::get_modler().set_phy_address_bulk(argc, argv);
+    } catch (const std::exception& ex) {
+      compiler->ErrorMessage(ex.what());
+    } catch (...) {
+      compiler->ErrorMessage("Unknown Exception");
+    }
+    return (status) ? TCL_OK : TCL_ERROR;
+  };
+  interp->registerCmd("set_phy_address_bulk", set_phy_address_bulk, this, 0);
+
+  auto set_logic_location_bulk = [](void* clientData, Tcl_Interp* interp,
+                                    int argc, const char* argv[]) -> int {
+    DeviceModeling* device_modeling = (DeviceModeling*)clientData;
+    Compiler* compiler = device_modeling->GetCompiler();
+    bool status = false;
+    try {
+      status = Model::get_modler().set_logic_location_bulk(argc, argv);
+    } catch (const std::exception& ex) {
+      compiler->ErrorMessage(ex.what());
+    } catch (...) {
+      compiler->ErrorMessage("Unknown Exception");
+    }
+    return (status) ? TCL_OK : TCL_ERROR;
+  };
+  interp->registerCmd("set_logic_location_bulk", set_logic_location_bulk,
+                      this, 0);
+
   auto get_net_sink_set = [](void* clientData, Tcl_Interp* interp, int argc,
                              const char* argv[]) -> int {
     // TODO: Implement this API
@@ -1159,5 +1440,74 @@ bool DeviceModeling::RegisterCommands(TclInterpreter* interp, bool batchMode) {
   };
   interp->registerCmd("set_phy_address", set_phy_address, this, 0);
 
+  auto load_device_model_cmd = [](void* clientData, Tcl_Interp* interp,
+                                  int argc, const char* argv[]) -> int {
+    DeviceModeling* device_modeling = (DeviceModeling*)clientData;
+    Compiler* compiler = device_modeling->GetCompiler();
+    int code = TCL_ERROR;
+    try {
+      device_modeler& modeler = Model::get_modler();
+      std::string file = modeler.get_argument_value("-file", argc, argv, true);
+      code = load_device_model(interp, compiler, file,
+                               device_snapshot_path(argc, argv));
+    } catch (const std::exception& ex) {
+      compiler->ErrorMessage(ex.what());
+      code = TCL_ERROR;
+    } catch (...) {
+      compiler->ErrorMessage("Unknown Exception");
+      code = TCL_ERROR;
+    }
+    return code;
+  };
+  interp->registerCmd("load_device_model", load_device_model_cmd, this, 0);
+
+  auto device_snapshot = [](void* clientData, Tcl_Interp* interp, int argc,
+                            const char* argv[]) -> int {
+    DeviceModeling* device_modeling = (DeviceModeling*)clientData;
+    Compiler* compiler = device_modeling->GetCompiler();
+    int code = TCL_ERROR;
+    try {
+      device_modeler& modeler = Model::get_modler();
+      std::string file = modeler.get_argument_value("-file", argc, argv, true);
+      std::string snapshot = device_snapshot_path(argc, argv);
+      if (snapshot.empty()) {
+        throw std::invalid_argument(
+            "Device snapshots are disabled, give -snapshot <path>");
+      }
+      if (modeler.argument_exists("-build", argc, argv)) {
+        std::vector<std::string> devices;
+        std::vector<std::string> sources;
+        std::string variables;
+        code = source_device_model(interp, file, devices, sources, variables);
+        if (code != TCL_OK) return code;
+        std::error_code ec;
+        std::filesystem::create_directories(
+            std::filesystem::path{snapshot}.parent_path(), ec);
+        modeler.write_snapshot(snapshot, devices, sources, variables);
+        compiler->Message("Wrote device snapshot " + snapshot);
+      } else if (modeler.argument_exists("-verify", argc, argv)) {
+        std::string reason;
+        bool valid = modeler.load_snapshot(snapshot, reason, false);
+        if (!valid) {
+          compiler->Message("Device snapshot " + snapshot +
+                            " is not valid: " + reason);
+        }
+        Tcl_SetObjResult(interp, Tcl_NewIntObj(valid));
+        code = TCL_OK;
+      } else {
+        throw std::invalid_argument(
+            "device_snapshot expects -build or -verify");
+      }
+    } catch (const std::exception& ex) {
+      compiler->ErrorMessage(ex.what());
+      code = TCL_ERROR;
+    } catch (...) {
+      compiler->ErrorMessage("Unknown Exception");
+      code = TCL_ERROR;
+    }
+    return code;
+  };
+  interp->registerCmd("device_snapshot", device_snapshot, this, 0);
+
   return true;
 }
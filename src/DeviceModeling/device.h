@@ -223,4 +223,6 @@ class device : public device_block {
                              ///< unchanged
   std::unordered_map<std::string, std::string>
       user_to_rtl_map_;  ///< Mapping the user names to the RTL names
+
+  friend class device_snapshot;
 };
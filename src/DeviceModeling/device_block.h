@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "device_port.h"
+#include "device_symbol.h"
 #include "rs_expression.h"
 #include "rs_parameter.h"
 #include "speedlog.h"
@@ -129,7 +130,7 @@ class device_block {
    *
    * @return A non-const reference to the map of device ports.
    */
-  std::unordered_map<std::string, std::shared_ptr<device_port>> &ports() {
+  device_symbol_map<std::shared_ptr<device_port>> &ports() {
     return ports_map_;
   }
 
@@ -140,8 +141,7 @@ class device_block {
    *
    * @return A const reference to the map of device ports.
    */
-  const std::unordered_map<std::string, std::shared_ptr<device_port>> &ports()
-      const {
+  const device_symbol_map<std::shared_ptr<device_port>> &ports() const {
     return ports_map_;
   }
 
@@ -189,8 +189,7 @@ class device_block {
    *
    * @return A non-const reference to the map of device signals.
    */
-  std::unordered_map<std::string, std::shared_ptr<device_signal>>
-      &device_signals() {
+  device_symbol_map<std::shared_ptr<device_signal>> &device_signals() {
     return signals_map_;
   }
 
@@ -201,7 +200,7 @@ class device_block {
    *
    * @return A const reference to the map of device signals.
    */
-  const std::unordered_map<std::string, std::shared_ptr<device_signal>>
+  const device_symbol_map<std::shared_ptr<device_signal>>
       &device_signals() const {
     return signals_map_;
   }
@@ -249,7 +248,7 @@ class device_block {
    * @brief Get a reference to the nets map.
    * @return A reference to the nets map.
    */
-  std::unordered_map<std::string, std::shared_ptr<device_net>> &nets() {
+  device_symbol_map<std::shared_ptr<device_net>> &nets() {
     return nets_map_;
   }
 
@@ -257,8 +256,7 @@ class device_block {
    * @brief Get a const reference to the nets map.
    * @return A const reference to the nets map.
    */
-  const std::unordered_map<std::string, std::shared_ptr<device_net>> &nets()
-      const {
+  const device_symbol_map<std::shared_ptr<device_net>> &nets() const {
     return nets_map_;
   }
 
@@ -266,8 +264,7 @@ class device_block {
    * @brief Get a reference to the double parameters map.
    * @return A reference to the double parameters map.
    */
-  std::unordered_map<std::string, std::shared_ptr<Parameter<double>>>
-      &double_parameters() {
+  device_symbol_map<std::shared_ptr<Parameter<double>>> &double_parameters() {
     return double_parameters_map_;
   }
 
@@ -275,7 +272,7 @@ class device_block {
    * @brief Get a const reference to the double parameters map.
    * @return A const reference to the double parameters map.
    */
-  const std::unordered_map<std::string, std::shared_ptr<Parameter<double>>>
+  const device_symbol_map<std::shared_ptr<Parameter<double>>>
       &double_parameters() const {
     return double_parameters_map_;
   }
@@ -334,8 +331,7 @@ class device_block {
    * @brief Get a reference to the int parameters map.
    * @return A reference to the int parameters map.
    */
-  std::unordered_map<std::string, std::shared_ptr<Parameter<int>>>
-      &int_parameters() {
+  device_symbol_map<std::shared_ptr<Parameter<int>>> &int_parameters() {
     return int_parameters_map_;
   }
 
@@ -343,7 +339,7 @@ class device_block {
    * @brief Get a const reference to the int parameters map.
    * @return A const reference to the int parameters map.
    */
-  const std::unordered_map<std::string, std::shared_ptr<Parameter<int>>>
+  const device_symbol_map<std::shared_ptr<Parameter<int>>>
       &int_parameters() const {
     return int_parameters_map_;
   }
@@ -401,7 +397,7 @@ class device_block {
    * @brief Get a reference to the string parameters map.
    * @return A reference to the string parameters map.
    */
-  std::unordered_map<std::string, std::shared_ptr<Parameter<std::string>>>
+  device_symbol_map<std::shared_ptr<Parameter<std::string>>>
       &string_parameters() {
     return string_parameters_map_;
   }
@@ -410,7 +406,7 @@ class device_block {
    * @brief Get a const reference to the string parameters map.
    * @return A const reference to the string parameters map.
    */
-  const std::unordered_map<std::string, std::shared_ptr<Parameter<std::string>>>
+  const device_symbol_map<std::shared_ptr<Parameter<std::string>>>
       &string_parameters() const {
     return string_parameters_map_;
   }
@@ -469,8 +465,7 @@ class device_block {
    * @brief Get a reference to the attributes map.
    * @return A reference to the attributes map.
    */
-  std::unordered_map<std::string, std::shared_ptr<Parameter<int>>>
-      &attributes() {
+  device_symbol_map<std::shared_ptr<Parameter<int>>> &attributes() {
     return attributes_map_;
   }
 
@@ -478,8 +473,7 @@ class device_block {
    * @brief Get a const reference to the attributes map.
    * @return A const reference to the attributes map.
    */
-  const std::unordered_map<std::string, std::shared_ptr<Parameter<int>>>
-      &attributes() const {
+  const device_symbol_map<std::shared_ptr<Parameter<int>>> &attributes() const {
     return attributes_map_;
   }
 
@@ -540,8 +534,7 @@ class device_block {
    * @brief Get a reference to the instance map.
    * @return A reference to the instance map.
    */
-  std::unordered_map<std::string, std::shared_ptr<device_block_instance>>
-      &instances() {
+  device_symbol_map<std::shared_ptr<device_block_instance>> &instances() {
     return instance_map_;
   }
 
@@ -549,7 +542,7 @@ class device_block {
    * @brief Get a const reference to the instance map.
    * @return A const reference to the instance map.
    */
-  const std::unordered_map<std::string, std::shared_ptr<device_block_instance>>
+  const device_symbol_map<std::shared_ptr<device_block_instance>>
       &instances() const {
     return instance_map_;
   }
@@ -607,8 +600,7 @@ class device_block {
    * @brief Get a reference to the constraint map.
    * @return A reference to the constraint map.
    */
-  std::unordered_map<std::string, std::shared_ptr<rs_expression<int>>>
-      &constraints() {
+  device_symbol_map<std::shared_ptr<rs_expression<int>>> &constraints() {
     return constraint_map_;
   }
 
@@ -616,7 +608,7 @@ class device_block {
    * @brief Get a const reference to the constraint map.
    * @return A const reference to the constraint map.
    */
-  const std::unordered_map<std::string, std::shared_ptr<rs_expression<int>>>
+  const device_symbol_map<std::shared_ptr<rs_expression<int>>>
       &constraints() const {
     return constraint_map_;
   }
@@ -714,7 +706,7 @@ class device_block {
    * @brief Get a reference to the block map.
    * @return A reference to the block map.
    */
-  std::unordered_map<std::string, std::shared_ptr<device_block>> &blocks() {
+  device_symbol_map<std::shared_ptr<device_block>> &blocks() {
     return block_map_;
   }
 
@@ -722,8 +714,7 @@ class device_block {
    * @brief Get a const reference to the block map.
    * @return A const reference to the block map.
    */
-  const std::unordered_map<std::string, std::shared_ptr<device_block>> &blocks()
-      const {
+  const device_symbol_map<std::shared_ptr<device_block>> &blocks() const {
     return block_map_;
   }
 
@@ -789,7 +780,7 @@ class device_block {
    * @brief Get a reference to the double parameter types map.
    * @return A reference to the double parameter types map.
    */
-  std::unordered_map<std::string, std::shared_ptr<ParameterType<double>>>
+  device_symbol_map<std::shared_ptr<ParameterType<double>>>
       &double_parameter_types() {
     return double_parameter_types_map_;
   }
@@ -798,7 +789,7 @@ class device_block {
    * @brief Get a const reference to the double parameter types map.
    * @return A const reference to the double parameter types map.
    */
-  const std::unordered_map<std::string, std::shared_ptr<ParameterType<double>>>
+  const device_symbol_map<std::shared_ptr<ParameterType<double>>>
       &double_parameter_types() const {
     return double_parameter_types_map_;
   }
@@ -863,7 +854,7 @@ class device_block {
    * @brief Get a reference to the int parameter types map.
    * @return A reference to the int parameter types map.
    */
-  std::unordered_map<std::string, std::shared_ptr<ParameterType<int>>>
+  device_symbol_map<std::shared_ptr<ParameterType<int>>>
       &int_parameter_types() {
     return int_parameter_types_map_;
   }
@@ -872,7 +863,7 @@ class device_block {
    * @brief Get a const reference to the int parameter types map.
    * @return A const reference to the int parameter types map.
    */
-  const std::unordered_map<std::string, std::shared_ptr<ParameterType<int>>>
+  const device_symbol_map<std::shared_ptr<ParameterType<int>>>
       &int_parameter_types() const {
     return int_parameter_types_map_;
   }
@@ -932,7 +923,7 @@ class device_block {
    * @brief Get a reference to the string parameter types map.
    * @return A reference to the string parameter types map.
    */
-  std::unordered_map<std::string, std::shared_ptr<ParameterType<std::string>>>
+  device_symbol_map<std::shared_ptr<ParameterType<std::string>>>
       &string_parameter_types() {
     return string_parameter_types_map_;
   }
@@ -941,8 +932,7 @@ class device_block {
    * @brief Get a const reference to the string parameter types map.
    * @return A const reference to the string parameter types map.
    */
-  const std::unordered_map<std::string,
-                           std::shared_ptr<ParameterType<std::string>>>
+  const device_symbol_map<std::shared_ptr<ParameterType<std::string>>>
       &string_parameter_types() const {
     return string_parameter_types_map_;
   }
@@ -1434,55 +1424,49 @@ class device_block {
   std::string block_type_ = "block";
 
   /// Map holding all the ports of the device block.
-  std::unordered_map<std::string, std::shared_ptr<device_port>> ports_map_;
+  device_symbol_map<std::shared_ptr<device_port>> ports_map_;
 
   /// Map holding all the signals of the device block.
-  std::unordered_map<std::string, std::shared_ptr<device_signal>> signals_map_;
+  device_symbol_map<std::shared_ptr<device_signal>> signals_map_;
 
   /// Map holding all the nets of the device block.
-  std::unordered_map<std::string, std::shared_ptr<device_net>> nets_map_;
+  device_symbol_map<std::shared_ptr<device_net>> nets_map_;
 
   /// Map holding all the double parameters of the device block.
-  std::unordered_map<std::string, std::shared_ptr<Parameter<double>>>
-      double_parameters_map_;
+  device_symbol_map<std::shared_ptr<Parameter<double>>> double_parameters_map_;
 
   /// Map holding all the integer parameters of the device block.
-  std::unordered_map<std::string, std::shared_ptr<Parameter<int>>>
-      int_parameters_map_;
+  device_symbol_map<std::shared_ptr<Parameter<int>>> int_parameters_map_;
 
   /// Map holding all the string parameters of the device block.
-  std::unordered_map<std::string, std::shared_ptr<Parameter<std::string>>>
+  device_symbol_map<std::shared_ptr<Parameter<std::string>>>
       string_parameters_map_;
 
   /// Map holding all the attributes of the device block.
-  std::unordered_map<std::string, std::shared_ptr<Parameter<int>>>
-      attributes_map_;
+  device_symbol_map<std::shared_ptr<Parameter<int>>> attributes_map_;
 
   /// Map holding all the instances of the device block.
-  std::unordered_map<std::string, std::shared_ptr<device_block_instance>>
-      instance_map_;
+  device_symbol_map<std::shared_ptr<device_block_instance>> instance_map_;
 
   /// Map holding all the constraints of the device block.
-  std::unordered_map<std::string, std::shared_ptr<rs_expression<int>>>
-      constraint_map_;
+  device_symbol_map<std::shared_ptr<rs_expression<int>>> constraint_map_;
 
   /// Map holding all the ParameterType<int> instances, representing enum types.
-  std::unordered_map<std::string, std::shared_ptr<ParameterType<int>>>
-      enum_types_;
+  device_symbol_map<std::shared_ptr<ParameterType<int>>> enum_types_;
 
   /// Map holding all the block definitions of the device block.
-  std::unordered_map<std::string, std::shared_ptr<device_block>> block_map_;
+  device_symbol_map<std::shared_ptr<device_block>> block_map_;
 
   /// Map holding all the double parameter types of the device block.
-  std::unordered_map<std::string, std::shared_ptr<ParameterType<double>>>
+  device_symbol_map<std::shared_ptr<ParameterType<double>>>
       double_parameter_types_map_;
 
   /// Map holding all the int parameter types of the device block.
-  std::unordered_map<std::string, std::shared_ptr<ParameterType<int>>>
+  device_symbol_map<std::shared_ptr<ParameterType<int>>>
       int_parameter_types_map_;
 
   /// Map holding all the string parameter types of the device block.
-  std::unordered_map<std::string, std::shared_ptr<ParameterType<std::string>>>
+  device_symbol_map<std::shared_ptr<ParameterType<std::string>>>
       string_parameter_types_map_;
 
   /// Vector of instance references
@@ -1499,4 +1483,5 @@ class device_block {
   std::unordered_map<std::string, std::string> property_map_;
 
   friend class device_block_factory;
+  friend class device_snapshot;
 };
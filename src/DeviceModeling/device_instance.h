@@ -11,6 +11,7 @@
 #pragma once
 
 #include "device_block.h"
+#include "device_symbol.h"
 #include "speedlog.h"
 
 /**
@@ -32,42 +33,77 @@ class device_block_instance {
       : instaciated_block_ptr_(instaciated_block_ptr) {
     if (!instaciated_block_ptr_) return;
     instaciated_block_ptr_->set_was_instanciated();
-    for (const auto &pr : instaciated_block_ptr_->attributes()) {
+    // The names are interned by the block already
+    const auto &attributes = instaciated_block_ptr_->attributes();
+    for (const auto &pr : attributes) {
       if (pr.second->get_type()->has_default_value())
-        this->attributes_[pr.first] =
-            pr.second->get_type()->get_default_value();
+        this->attributes_.append(attributes.symbol(pr),
+                                 pr.second->get_type()->get_default_value());
     }
-    for (const auto &pr : instaciated_block_ptr_->int_parameters()) {
+    const auto &int_params = instaciated_block_ptr_->int_parameters();
+    for (const auto &pr : int_params) {
       if (pr.second->get_type()->has_default_value())
-        this->int_params_[pr.first] =
-            pr.second->get_type()->get_default_value();
+        this->int_params_.append(int_params.symbol(pr),
+                                 pr.second->get_type()->get_default_value());
     }
-    for (const auto &pr : instaciated_block_ptr_->double_parameters()) {
+    const auto &double_params = instaciated_block_ptr_->double_parameters();
+    for (const auto &pr : double_params) {
       if (pr.second->get_type()->has_default_value())
-        this->double_params_[pr.first] =
-            pr.second->get_type()->get_default_value();
+        this->double_params_.append(
+            double_params.symbol(pr),
+            pr.second->get_type()->get_default_value());
     }
-    for (const auto &pr : instaciated_block_ptr_->string_parameters()) {
+    const auto &string_params = instaciated_block_ptr_->string_parameters();
+    for (const auto &pr : string_params) {
       if (pr.second->get_type()->has_default_value())
-        this->string_params_[pr.first] =
-            pr.second->get_type()->get_default_value();
+        this->string_params_.append(
+            string_params.symbol(pr),
+            pr.second->get_type()->get_default_value());
     }
-    for (const auto &pr : instaciated_block_ptr_->instances()) {
-      this->instance_map_[pr.first] =
-          std::make_shared<device_block_instance>(*pr.second);
+    // Sub-instances, ports and nets are allocated in one array each, the
+    // shared pointers handed out share the control block of their array.
+    // The arrays never grow after reserve(), so the addresses are stable.
+    const auto &instances = instaciated_block_ptr_->instances();
+    auto instance_arena =
+        std::make_shared<std::vector<device_block_instance>>();
+    instance_arena->reserve(instances.size());
+    instance_map_.reserve(instances.size());
+    for (const auto &pr : instances) {
+      instance_arena->emplace_back(*pr.second);
+      this->instance_map_.append(
+          instances.symbol(pr),
+          std::shared_ptr<device_block_instance>(instance_arena,
+                                                 &instance_arena->back()));
     }
-    for (const auto &pr : instaciated_block_ptr_->ports()) {
-      this->ports_map_[pr.first] = std::make_shared<device_port>(*pr.second);
-      ports_map_[pr.first]->set_enclosing_instance(this);
+    const auto &ports = instaciated_block_ptr_->ports();
+    auto port_arena = std::make_shared<std::vector<device_port>>();
+    port_arena->reserve(ports.size());
+    ports_map_.reserve(ports.size());
+    for (const auto &pr : ports) {
+      port_arena->emplace_back(*pr.second);
+      port_arena->back().set_enclosing_instance(this);
+      this->ports_map_.append(
+          ports.symbol(pr),
+          std::shared_ptr<device_port>(port_arena, &port_arena->back()));
     }
-    for (const auto &pr : instaciated_block_ptr_->nets()) {
-      // create nets without their driver and sinks until full
-      // elaboration
-      this->nets_map_[pr.first] = std::make_shared<device_net>(pr.first);
-      if (ports_map_[pr.first])
-        ports_map_[pr.first]->set_enclosing_instance(this);
-      // std::cout << "Port Net :: " << pr.first << std::endl;
+    // create nets without their driver and sinks until full elaboration
+    const auto &nets = instaciated_block_ptr_->nets();
+    auto net_arena = std::make_shared<std::vector<device_net>>();
+    net_arena->reserve(nets.size());
+    nets_map_.reserve(nets.size());
+    for (const auto &pr : nets) {
+      net_arena->emplace_back(pr.first);
+      this->nets_map_.append(
+          nets.symbol(pr),
+          std::shared_ptr<device_net>(net_arena, &net_arena->back()));
     }
+    attributes_.sort();
+    int_params_.sort();
+    double_params_.sort();
+    string_params_.sort();
+    instance_map_.sort();
+    ports_map_.sort();
+    nets_map_.sort();
   }
   /**
    * @brief Copy constructor.
@@ -226,14 +262,18 @@ class device_block_instance {
    * @return Shared pointer to the device block instance if found; nullptr
    * otherwise.
    */
-  std::shared_ptr<device_block_instance> findInstanceByName(std::string &name) {
-    if (instance_map_.find(name) != end(instance_map_))
-      return instance_map_[name];
-    return nullptr;
+  std::shared_ptr<device_block_instance> findInstanceByName(
+      const std::string &name) {
+    auto instance = instance_map_.find_by_name(name);
+    return instance ? *instance : nullptr;
   }
   std::shared_ptr<device_net> get_net(const std::string &n) {
-    if (nets_map_.find(n) != end(nets_map_)) return nets_map_[n];
-    return nullptr;
+    auto net = nets_map_.find_by_name(n);
+    return net ? *net : nullptr;
+  }
+  std::shared_ptr<device_port> get_port(const std::string &n) {
+    auto port = ports_map_.find_by_name(n);
+    return port ? *port : nullptr;
   }
 
  private:
@@ -246,16 +286,18 @@ class device_block_instance {
   std::shared_ptr<device_block> instaciated_block_ptr_ = nullptr;
   std::string instance_name_ = "__default_instance_name__";
   std::string io_bank_ = "__default_io_bank_name__";
-  std::unordered_map<std::string, int> attributes_;
-  std::unordered_map<std::string, int> int_params_;
-  std::unordered_map<std::string, double> double_params_;
-  std::unordered_map<std::string, std::string> string_params_;
-  /// Map holding all the instances of the current instance.
-  std::unordered_map<std::string, std::shared_ptr<device_block_instance>>
-      instance_map_;
-  std::unordered_map<std::string, std::shared_ptr<device_port>> ports_map_;
-  /// Map holding all the nets of the device block.
-  std::unordered_map<std::string, std::shared_ptr<device_net>> nets_map_;
+  // The tables below are keyed by the interned names of device_symbol_pool
+  device_symbol_table<int> attributes_;
+  device_symbol_table<int> int_params_;
+  device_symbol_table<double> double_params_;
+  device_symbol_table<std::string> string_params_;
+  /// Table holding all the instances of the current instance.
+  device_symbol_table<std::shared_ptr<device_block_instance>> instance_map_;
+  device_symbol_table<std::shared_ptr<device_port>> ports_map_;
+  /// Table holding all the nets of the device block.
+  device_symbol_table<std::shared_ptr<device_net>> nets_map_;
+
+  friend class device_snapshot;
 };
 
 // Logging
@@ -24,6 +24,7 @@
 #include "Configuration/CFGCommon/CFGCommon.h"
 #include "Utils/StringUtils.h"
 #include "device.h"
+#include "device_snapshot.h"
 #include "speedlog.h"
 
 /**
@@ -56,7 +57,10 @@ class device_modeler {
   bool add_device(const std::string &name, std::shared_ptr<device> device) {
     std::string key = name;
     auto result = (devices_.find(key) == end(devices_));
-    if (result) devices_[key] = device;
+    if (result) {
+      devices_[key] = device;
+      invalidate_instance_path_index();
+    }
     return result;
   }
 
@@ -96,6 +100,7 @@ class device_modeler {
       throw std::invalid_argument(s.c_str());
     }
     std::string name = argv[1];
+    invalidate_instance_path_index();
     current_device_ = get_device(name);
     if (!current_device_) {
       current_device_ = std::make_shared<device>(name);
@@ -123,6 +128,7 @@ class device_modeler {
     std::string name = argv[1];
     if (devices_.find(name) != devices_.end()) {
       devices_.erase(name);
+      invalidate_instance_path_index();
     }
     return true;
   }
@@ -166,8 +172,89 @@ class device_modeler {
   }
   void reset_current_device() {
     current_device_ = nullptr;  // method to reset the state
+    invalidate_instance_path_index();
   }
   std::shared_ptr<device> get_current_device() { return current_device_; }
+
+  /**
+   * @brief Get the names of all the devices, sorted.
+   */
+  std::vector<std::string> device_names() const {
+    std::vector<std::string> names;
+    names.reserve(devices_.size());
+    for (const auto &pr : devices_) names.push_back(pr.first);
+    std::sort(names.begin(), names.end());
+    return names;
+  }
+
+  /**
+   * @brief Write devices to a snapshot file.
+   * @param path The snapshot file.
+   * @param names The names of the devices to write.
+   * @param sources The files the devices were built from, a snapshot is only
+   * used while they are unchanged.
+   * @param variables Tcl script setting the global variables of the sources.
+   * @throws std::runtime_error if a device doesn't exist or a file can't be
+   * read or written.
+   */
+  void write_snapshot(const std::string &path,
+                      const std::vector<std::string> &names,
+                      const std::vector<std::string> &sources,
+                      const std::string &variables = {}) {
+    device_snapshot::contents snapshot;
+    snapshot.variables = variables;
+    for (const std::string &name : names) {
+      auto dev = get_device(name);
+      if (!dev) throw std::runtime_error("No device named " + name);
+      snapshot.devices.push_back(dev);
+      if (dev == current_device_) snapshot.current_device = name;
+    }
+    for (const std::string &source : sources) {
+      snapshot.sources.push_back(device_snapshot::make_source(source));
+    }
+    device_snapshot::write(path, snapshot);
+  }
+
+  /**
+   * @brief Load the devices of a snapshot file, replacing the devices with
+   * the same names. The current device of the snapshot becomes current.
+   * @param path The snapshot file.
+   * @param reason Set to the reason why the snapshot can't be used.
+   * @param install False to only check that the snapshot can be used.
+   * @param variables Set to the Tcl script setting the global variables of
+   * the sources.
+   * @return True if the snapshot is valid and its source files unchanged.
+   */
+  bool load_snapshot(const std::string &path, std::string &reason,
+                     bool install = true, std::string *variables = nullptr) {
+    std::string bytes;
+    if (!device_snapshot::read_file(path, bytes)) {
+      reason = "Could not read " + path;
+      return false;
+    }
+    device_snapshot::contents snapshot;
+    try {
+      // Sources are checked first to skip decoding stale snapshots
+      if (!device_snapshot::sources_unchanged(
+              device_snapshot::decode_sources(bytes), reason)) {
+        return false;
+      }
+      snapshot = device_snapshot::decode(bytes);
+    } catch (const std::runtime_error &e) {
+      reason = e.what();
+      return false;
+    }
+    if (variables) *variables = snapshot.variables;
+    if (!install) return true;
+    for (const auto &dev : snapshot.devices) {
+      devices_[dev->device_name()] = dev;
+    }
+    if (!snapshot.current_device.empty()) {
+      current_device_ = get_device(snapshot.current_device);
+    }
+    invalidate_instance_path_index();
+    return true;
+  }
   std::vector<std::string> split_string_by_space(
       const std::string &inputString) {
     std::vector<std::string> result;
@@ -362,6 +449,7 @@ class device_modeler {
     return true;
   }
   bool define_block(int argc, const char **argv) {
+    invalidate_instance_path_index();
     if (!current_device_) {
       std::string dname = "__auto_generated_device__";
       current_device_ = std::make_shared<device>(dname);
@@ -1046,6 +1134,11 @@ class device_modeler {
     if ("" != logic_location_z) {
       logic_location_z_i = convert_string_to_integer(logic_location_z);
     }
+    // Overwriting an instance drops it, names resolved to it must go too
+    if (parent_block->instances().find(name) !=
+        parent_block->instances().end()) {
+      invalidate_instance_path_index();
+    }
     parent_block->instance_vector().push_back(
         std::make_shared<device_block_instance>(
             block, parent_block->instance_vector().size(), logic_location_x_i,
@@ -2541,6 +2634,141 @@ class device_modeler {
     return true;
   }
 
+  /**
+   * @brief Retrieves the logical addresses of a list of instances.
+   *
+   * @param argc The number of command-line arguments.
+   * @param argv An array of command-line arguments.
+   * @return The logical addresses, in the order of the instances.
+   * @throws std::runtime_error if the instance list is missing or if one of
+   * the instances cannot be found.
+   *
+   * @details
+   * The command-line arguments must include "-insts" followed by a list of
+   * hierarchical instance names separated by spaces.
+   */
+  std::vector<int> get_logic_address_bulk(int argc, const char **argv) {
+    std::vector<int> ret;
+    for (device_block_instance *inst :
+         get_instances_argument("get_logic_address_bulk", argc, argv)) {
+      ret.push_back(inst->get_logic_address());
+    }
+    return ret;
+  }
+
+  /**
+   * @brief Sets the logical addresses of a list of instances.
+   *
+   * @param argc The number of command-line arguments.
+   * @param argv An array of command-line arguments.
+   * @return True if the addresses were set.
+   * @throws std::runtime_error if a list is missing, if the lists differ in
+   * length, if an address is not an integer or if one of the instances cannot
+   * be found. Nothing is set in that case.
+   *
+   * @details
+   * The command-line arguments must include "-insts" followed by a list of
+   * hierarchical instance names and "-addresses" followed by a list of as
+   * many addresses, both separated by spaces.
+   */
+  bool set_logic_address_bulk(int argc, const char **argv) {
+    std::vector<device_block_instance *> insts =
+        get_instances_argument("set_logic_address_bulk", argc, argv);
+    std::vector<int> addresses = get_integers_argument(
+        "set_logic_address_bulk", "-addresses", insts.size(), argc, argv);
+    for (size_t i = 0; i < insts.size(); ++i) {
+      insts[i]->set_logic_address(addresses[i]);
+    }
+    return true;
+  }
+
+  /**
+   * @brief Retrieves the physical addresses of a list of instances.
+   *
+   * @param argc The number of command-line arguments.
+   * @param argv An array of command-line arguments.
+   * @return The physical addresses, in the order of the instances.
+   * @throws std::runtime_error if the instance list is missing or if one of
+   * the instances cannot be found.
+   *
+   * @details
+   * The command-line arguments must include "-insts" followed by a list of
+   * hierarchical instance names separated by spaces.
+   */
+  std::vector<int> get_phy_address_bulk(int argc, const char **argv) {
+    std::vector<int> ret;
+    for (device_block_instance *inst :
+         get_instances_argument("get_phy_address_bulk", argc, argv)) {
+      ret.push_back(inst->get_phy_address());
+    }
+    return ret;
+  }
+
+  /**
+   * @brief Sets the physical addresses of a list of instances.
+   *
+   * @param argc The number of command-line arguments.
+   * @param argv An array of command-line arguments.
+   * @return True if the addresses were set.
+   * @throws std::runtime_error if a list is missing, if the lists differ in
+   * length, if an address is not an integer or if one of the instances cannot
+   * be found. Nothing is set in that case.
+   *
+   * @details
+   * The command-line arguments must include "-insts" followed by a list of
+   * hierarchical instance names and "-addresses" followed by a list of as
+   * many addresses, both separated by spaces.
+   */
+  bool set_phy_address_bulk(int argc, const char **argv) {
+    std::vector<device_block_instance *> insts =
+        get_instances_argument("set_phy_address_bulk", argc, argv);
+    std::vector<int> addresses = get_integers_argument(
+        "set_phy_address_bulk", "-addresses", insts.size(), argc, argv);
+    for (size_t i = 0; i < insts.size(); ++i) {
+      insts[i]->set_phy_address(addresses[i]);
+    }
+    return true;
+  }
+
+  /**
+   * @brief Sets the logical locations of a list of instances.
+   *
+   * @param argc The number of command-line arguments.
+   * @param argv An array of command-line arguments.
+   * @return True if the locations were set.
+   * @throws std::runtime_error if the instance list or all the axis lists are
+   * missing, if the lists differ in length, if a coordinate is not an integer
+   * or if one of the instances cannot be found. Nothing is set in that case.
+   *
+   * @details
+   * The command-line arguments must include "-insts" followed by a list of
+   * hierarchical instance names and at least one of "-x", "-y" or "-z", each
+   * followed by a list of as many coordinates. Lists are separated by spaces
+   * and the axes that are not given are left unchanged.
+   */
+  bool set_logic_location_bulk(int argc, const char **argv) {
+    const std::string cmd = "set_logic_location_bulk";
+    std::vector<device_block_instance *> insts =
+        get_instances_argument(cmd, argc, argv);
+    std::vector<int> loc_x =
+        get_integers_argument(cmd, "-x", insts.size(), argc, argv, false);
+    std::vector<int> loc_y =
+        get_integers_argument(cmd, "-y", insts.size(), argc, argv, false);
+    std::vector<int> loc_z =
+        get_integers_argument(cmd, "-z", insts.size(), argc, argv, false);
+    if (loc_x.empty() && loc_y.empty() && loc_z.empty() && !insts.empty()) {
+      throw std::runtime_error(
+          "At least one of (-x, -y, or -z) must be provided for command " +
+          cmd);
+    }
+    for (size_t i = 0; i < insts.size(); ++i) {
+      if (!loc_x.empty()) insts[i]->set_logic_location_x(loc_x[i]);
+      if (!loc_y.empty()) insts[i]->set_logic_location_y(loc_y[i]);
+      if (!loc_z.empty()) insts[i]->set_logic_location_z(loc_z[i]);
+    }
+    return true;
+  }
+
   /**
    * @brief Defines a new block chain in a specified device.
    *
@@ -2713,12 +2941,27 @@ class device_modeler {
    * determines the root device or block. It then attempts to find the
    * corresponding instance in the instance tree. If the instance is not found,
    * nullptr is returned.
+   *
+   * Every resolved name, and each of its prefixes naming an instance, is kept
+   * in instance_path_index_, so the device scripts that address the same
+   * instances over and over pay for the walk only once per name.
    */
   device_block_instance *find_instance_from_hierarchical_name(
       const std::string &instance_name) {
+    auto hit = instance_path_index_.find(instance_name);
+    if (hit != instance_path_index_.end()) {
+      return hit->second;
+    }
+    if (!current_device_) {
+      throw std::runtime_error("No current device");
+    }
+
     // Split the instance name into its hierarchical components.
     std::vector<std::string> xmr_refs =
         FOEDAG::StringUtils::tokenize(instance_name, ".", false);
+    if (xmr_refs.empty()) {
+      return nullptr;
+    }
 
     // Determine the root device or block.
     std::string curr = current_device_->device_name();
@@ -2741,6 +2984,8 @@ class device_modeler {
     // Attempt to find the corresponding instance in the instance tree.
     unsigned int idx = 1;
     device_block_instance *inst = nullptr;
+    // End of the components resolved so far within instance_name.
+    size_t prefix_end = xmr_refs[0].size();
 
     if (!root_block) {
       // First component might be an instance name.
@@ -2752,12 +2997,19 @@ class device_modeler {
             "named either a device or a block in the current device");
       }
 
-      inst = root_block->get_instance(xmr_refs[idx++]).get();
+      inst = root_block->get_instance(xmr_refs[idx]).get();
+      prefix_end += 1 + xmr_refs[idx++].size();
     }
 
-    while (inst && idx < xmr_refs.size()) {
+    while (inst) {
+      instance_path_index_.emplace(instance_name.substr(0, prefix_end), inst);
+      if (idx >= xmr_refs.size()) {
+        // The name may carry a trailing separator
+        instance_path_index_.emplace(instance_name, inst);
+        break;
+      }
       inst = inst->findInstanceByName(xmr_refs[idx]).get();
-      ++idx;
+      prefix_end += 1 + xmr_refs[idx++].size();
     }
 
     return inst;
@@ -2906,6 +3158,68 @@ class device_modeler {
   }
 
  private:
+  /**
+   * @brief Resolves the instances listed after "-insts".
+   *
+   * @param cmd The name of the command, for the error messages.
+   * @return The instances, in the order of the list.
+   * @throws std::runtime_error if the list is missing or if one of the
+   * instances cannot be found.
+   */
+  std::vector<device_block_instance *> get_instances_argument(
+      const std::string &cmd, int argc, const char **argv) {
+    if (argc < 3) {
+      throw std::runtime_error("Need at least 3 arguments for command " + cmd);
+    }
+    std::vector<std::string> names =
+        split_string_by_space(get_argument_value("-insts", argc, argv, true));
+    std::vector<device_block_instance *> insts;
+    insts.reserve(names.size());
+    for (const std::string &name : names) {
+      device_block_instance *inst = find_instance_from_hierarchical_name(name);
+      if (!inst) {
+        throw std::runtime_error("Could not find instance " + name);
+      }
+      insts.push_back(inst);
+    }
+    return insts;
+  }
+
+  /**
+   * @brief Converts the list of integers following an argument.
+   *
+   * @param cmd The name of the command, for the error messages.
+   * @param arg_name The name of the argument.
+   * @param count The expected number of values.
+   * @param required Whether the argument must be given.
+   * @return The values, empty if the argument is optional and not given.
+   * @throws std::runtime_error if a required argument is missing, if the
+   * number of values differs from count or if a value is not an integer.
+   */
+  std::vector<int> get_integers_argument(const std::string &cmd,
+                                         const std::string &arg_name,
+                                         size_t count, int argc,
+                                         const char **argv,
+                                         bool required = true) {
+    std::vector<std::string> values = split_string_by_space(
+        get_argument_value(arg_name, argc, argv, required));
+    std::vector<int> ret;
+    if (values.empty() && !required) {
+      return ret;
+    }
+    if (values.size() != count) {
+      throw std::runtime_error("Command " + cmd + " got " +
+                               std::to_string(values.size()) + " values for " +
+                               arg_name + " but " + std::to_string(count) +
+                               " instances");
+    }
+    ret.reserve(values.size());
+    for (const std::string &value : values) {
+      ret.push_back(convert_string_to_integer(value));
+    }
+    return ret;
+  }
+
   int convert_string_to_integer(const std::string &str) {
     int value = 0;
     try {
@@ -2941,6 +3255,15 @@ class device_modeler {
     return value;
   }
 
+  /**
+   * @brief Forgets the resolved hierarchical names.
+   *
+   * Called whenever an instance may be replaced or a name may resolve from a
+   * different root, i.e. on any change of the devices, of the current device,
+   * of the blocks or when an instance is overwritten.
+   */
+  void invalidate_instance_path_index() { instance_path_index_.clear(); }
+
   std::shared_ptr<device> current_device_ =
       nullptr;  ///< The current device being worked on.
   /**
@@ -2953,4 +3276,11 @@ class device_modeler {
    * The keys are a combination of the device name and version.
    */
   std::unordered_map<std::string, std::shared_ptr<device>> devices_;
+
+  /**
+   * @brief Instances by the hierarchical names already resolved, see
+   * find_instance_from_hierarchical_name.
+   */
+  std::unordered_map<std::string, device_block_instance *>
+      instance_path_index_;
 };
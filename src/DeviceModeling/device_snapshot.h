@@ -0,0 +1,1145 @@
+/**
+ * @file device_snapshot.h
+ * @brief Binary snapshots of the device models built by device_modeler.
+ * @version 1.0
+ * @date 2024-06-7
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * @details A snapshot holds complete devices (blocks, ports, signals, nets,
+ * parameter types, parameters, attributes, constraints, enumerations,
+ * instances, chains, properties and name mappings) together with the paths
+ * and the content hashes of the files they were built from, so a snapshot is
+ * only used while these files are unchanged.
+ *
+ * Layout, all integers little endian:
+ *   magic | version | sources | variables | payload size | payload hash |
+ *   payload
+ * The payload starts with a table of all the strings, then holds one table
+ * per kind of object. Objects refer to each other and to the strings by
+ * their index in these tables, so shared objects stay shared once loaded.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "device.h"
+#include "device_symbol.h"
+
+/**
+ * @class device_snapshot
+ * @brief Encodes devices into snapshots and decodes them back.
+ */
+class device_snapshot {
+ public:
+  /// Bumped whenever the layout or the contents of the snapshots change.
+  static constexpr uint32_t VERSION = 3;
+
+  /**
+   * @brief A file the devices of a snapshot were built from.
+   */
+  struct source_file {
+    std::string path;
+    uint64_t hash = 0;
+  };
+
+  /**
+   * @brief The contents of a snapshot.
+   */
+  struct contents {
+    std::vector<source_file> sources;
+    std::vector<std::shared_ptr<device>> devices;
+    /// The device to make current once loaded, may be empty.
+    std::string current_device;
+    /// Tcl script setting the global variables and procs the sources set.
+    std::string variables;
+  };
+
+  /**
+   * @brief 64 bits FNV-1a hash of a buffer.
+   */
+  static uint64_t hash_bytes(const char *data, size_t size) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; ++i) {
+      hash ^= static_cast<unsigned char>(data[i]);
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
+
+  /**
+   * @brief Reads a whole file.
+   *
+   * @return False if the file could not be read.
+   */
+  static bool read_file(const std::string &path, std::string &bytes) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+    std::streamoff size = file.tellg();
+    if (size < 0) return false;
+    bytes.resize(static_cast<size_t>(size));
+    file.seekg(0);
+    return static_cast<bool>(file.read(&bytes[0], size));
+  }
+
+  /**
+   * @brief Describes a source file by its current content.
+   *
+   * @throws std::runtime_error if the file can't be read.
+   */
+  static source_file make_source(const std::string &path) {
+    std::string bytes;
+    if (!read_file(path, bytes)) {
+      throw std::runtime_error("Could not read the device model file " + path);
+    }
+    return source_file{path, hash_bytes(bytes.data(), bytes.size())};
+  }
+
+  /**
+   * @brief Checks the source files still have the content they were hashed
+   * with.
+   *
+   * @param reason Set to the first difference found.
+   * @return True if all the files are unchanged.
+   */
+  static bool sources_unchanged(const std::vector<source_file> &sources,
+                                std::string &reason) {
+    for (const source_file &source : sources) {
+      std::string bytes;
+      if (!read_file(source.path, bytes)) {
+        reason = "Could not read " + source.path;
+        return false;
+      }
+      if (hash_bytes(bytes.data(), bytes.size()) != source.hash) {
+        reason = source.path + " changed since the snapshot was built";
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Encodes devices and the files they come from.
+   */
+  static std::string encode(const contents &snapshot) {
+    encoder enc;
+    std::string payload = enc.encode(snapshot);
+    writer header;
+    header.put_bytes(MAGIC, sizeof(MAGIC));
+    header.put_u32(VERSION);
+    header.put_u32(static_cast<uint32_t>(snapshot.sources.size()));
+    for (const source_file &source : snapshot.sources) {
+      header.put_string(source.path);
+      header.put_u64(source.hash);
+    }
+    header.put_string(snapshot.variables);
+    header.put_u64(payload.size());
+    header.put_u64(hash_bytes(payload.data(), payload.size()));
+    return header.bytes() + payload;
+  }
+
+  /**
+   * @brief Decodes the source files of a snapshot, without the devices.
+   *
+   * @throws std::runtime_error if the bytes are not a snapshot of this
+   * version.
+   */
+  static std::vector<source_file> decode_sources(const std::string &bytes) {
+    reader in(bytes.data(), bytes.size());
+    return read_header(in);
+  }
+
+  /**
+   * @brief Decodes a snapshot.
+   *
+   * @throws std::runtime_error if the bytes are not a valid snapshot of this
+   * version.
+   */
+  static contents decode(const std::string &bytes) {
+    reader in(bytes.data(), bytes.size());
+    contents snapshot;
+    snapshot.sources = read_header(in, &snapshot.variables);
+    uint64_t size = in.get_u64();
+    uint64_t hash = in.get_u64();
+    if (size != in.remaining()) {
+      throw std::runtime_error("Truncated device snapshot");
+    }
+    if (hash != hash_bytes(in.position(), in.remaining())) {
+      throw std::runtime_error("Corrupted device snapshot");
+    }
+    decoder dec(in);
+    dec.decode(snapshot);
+    return snapshot;
+  }
+
+  /**
+   * @brief Writes a snapshot file.
+   *
+   * @throws std::runtime_error if the file can't be written.
+   */
+  static void write(const std::string &path, const contents &snapshot) {
+    std::string bytes = encode(snapshot);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file || !file.write(bytes.data(), bytes.size())) {
+      throw std::runtime_error("Could not write the device snapshot " + path);
+    }
+  }
+
+ private:
+  static constexpr char MAGIC[8] = {'F', 'D', 'E', 'V', 'S', 'N', 'P', '\n'};
+  /// Index standing for a null pointer.
+  static constexpr uint32_t NONE = 0xFFFFFFFF;
+
+  class writer {
+   public:
+    void put_bytes(const char *data, size_t size) { bytes_.append(data, size); }
+    void put_u8(uint8_t value) { bytes_.push_back(static_cast<char>(value)); }
+    void put_u32(uint32_t value) {
+      for (int i = 0; i < 4; ++i) put_u8(static_cast<uint8_t>(value >> 8 * i));
+    }
+    void put_u64(uint64_t value) {
+      for (int i = 0; i < 8; ++i) put_u8(static_cast<uint8_t>(value >> 8 * i));
+    }
+    void put_i32(int32_t value) { put_u32(static_cast<uint32_t>(value)); }
+    void put_f64(double value) {
+      uint64_t bits = 0;
+      std::memcpy(&bits, &value, sizeof(bits));
+      put_u64(bits);
+    }
+    void put_string(const std::string &value) {
+      put_u32(static_cast<uint32_t>(value.size()));
+      put_bytes(value.data(), value.size());
+    }
+    const std::string &bytes() const { return bytes_; }
+
+   private:
+    std::string bytes_;
+  };
+
+  class reader {
+   public:
+    reader(const char *data, size_t size) : pos_(data), end_(data + size) {}
+    void get_bytes(char *data, size_t size) {
+      require(size);
+      std::memcpy(data, pos_, size);
+      pos_ += size;
+    }
+    uint8_t get_u8() {
+      require(1);
+      return static_cast<uint8_t>(*pos_++);
+    }
+    uint32_t get_u32() {
+      uint32_t value = 0;
+      for (int i = 0; i < 4; ++i) value |= uint32_t(get_u8()) << 8 * i;
+      return value;
+    }
+    uint64_t get_u64() {
+      uint64_t value = 0;
+      for (int i = 0; i < 8; ++i) value |= uint64_t(get_u8()) << 8 * i;
+      return value;
+    }
+    int32_t get_i32() { return static_cast<int32_t>(get_u32()); }
+    double get_f64() {
+      uint64_t bits = get_u64();
+      double value = 0;
+      std::memcpy(&value, &bits, sizeof(value));
+      return value;
+    }
+    std::string get_string() {
+      uint32_t size = get_u32();
+      require(size);
+      std::string value(pos_, size);
+      pos_ += size;
+      return value;
+    }
+    /// Count of a table, each entry taking at least min_entry_size bytes.
+    uint32_t get_count(size_t min_entry_size = 1) {
+      uint32_t count = get_u32();
+      require(size_t(count) * min_entry_size);
+      return count;
+    }
+    const char *position() const { return pos_; }
+    size_t remaining() const { return static_cast<size_t>(end_ - pos_); }
+
+   private:
+    void require(size_t size) const {
+      if (size > remaining()) {
+        throw std::runtime_error("Truncated device snapshot");
+      }
+    }
+    const char *pos_;
+    const char *end_;
+  };
+
+  /**
+   * @brief Indexes the objects of one kind in the order they are met.
+   */
+  template <typename T>
+  class object_table {
+   public:
+    uint32_t id(T *object) {
+      if (!object) return NONE;
+      auto it = ids_.emplace(object, static_cast<uint32_t>(objects_.size()));
+      if (it.second) objects_.push_back(object);
+      return it.first->second;
+    }
+    size_t size() const { return objects_.size(); }
+    T *operator[](size_t index) const { return objects_[index]; }
+
+   private:
+    std::unordered_map<T *, uint32_t> ids_;
+    std::vector<T *> objects_;
+  };
+
+  /// Entries of a map sorted by key, so that snapshots are reproducible.
+  template <typename M>
+  static std::vector<const typename M::value_type *> sorted(const M &map) {
+    std::vector<const typename M::value_type *> entries;
+    entries.reserve(map.size());
+    for (const auto &entry : map) entries.push_back(&entry);
+    std::sort(entries.begin(), entries.end(),
+              [](const auto *a, const auto *b) { return a->first < b->first; });
+    return entries;
+  }
+
+  static std::vector<source_file> read_header(
+      reader &in, std::string *variables = nullptr) {
+    char magic[sizeof(MAGIC)];
+    in.get_bytes(magic, sizeof(magic));
+    if (std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+      throw std::runtime_error("Not a device snapshot");
+    }
+    uint32_t version = in.get_u32();
+    if (version != VERSION) {
+      throw std::runtime_error("Device snapshot version " +
+                               std::to_string(version) + ", expected " +
+                               std::to_string(VERSION));
+    }
+    std::vector<source_file> sources(in.get_count(12));
+    for (source_file &source : sources) {
+      source.path = in.get_string();
+      source.hash = in.get_u64();
+    }
+    std::string script = in.get_string();
+    if (variables) *variables = std::move(script);
+    return sources;
+  }
+
+  /// Values of the instance of a block that differ from one instance to
+  /// another, with those of the nested instances.
+  struct instance_state {
+    uint32_t child_name = NONE;
+    int32_t id = -1;
+    int32_t location_x = -1;
+    int32_t location_y = -1;
+    int32_t location_z = -1;
+    int32_t logic_address = -1;
+    int32_t phy_address = -1;
+    uint32_t name = NONE;
+    uint32_t io_bank = NONE;
+    std::vector<instance_state> children;
+  };
+
+  class encoder {
+   public:
+    std::string encode(const contents &snapshot) {
+      for (const auto &dev : snapshot.devices) blocks_.id(dev.get());
+      collect();
+      for (size_t i = 0; i < instances_.size(); ++i) {
+        for (const auto &pr : instances_[i]->nets_map_) {
+          owned_nets_.emplace(pr.second.get(), std::make_pair(i, pr.first));
+        }
+      }
+
+      put_types(int_types_);
+      put_types(double_types_);
+      put_types(string_types_);
+      put_parameters(int_params_, int_types_);
+      put_parameters(double_params_, double_types_);
+      put_parameters(string_params_, string_types_);
+      out_.put_u32(static_cast<uint32_t>(expressions_.size()));
+      for (size_t i = 0; i < expressions_.size(); ++i) {
+        rs_expression<int> *expr = expressions_[i];
+        put_str(expr->get_expression_string());
+        out_.put_u8(expr->is_evaluated_);
+        out_.put_i32(expr->is_evaluated_ ? expr->value_ : 0);
+      }
+      out_.put_u32(static_cast<uint32_t>(blocks_.size()));
+      for (size_t i = 0; i < blocks_.size(); ++i) {
+        device *dev = dynamic_cast<device *>(blocks_[i]);
+        out_.put_u8(dev != nullptr);
+        put_str(dev ? dev->device_name() : blocks_[i]->block_name());
+      }
+      put_nets();
+      out_.put_u32(static_cast<uint32_t>(ports_.size()));
+      for (size_t i = 0; i < ports_.size(); ++i) {
+        device_port *port = ports_[i];
+        put_str(port->get_name());
+        out_.put_u8(port->is_input());
+        out_.put_u32(signals_.id(port->get_signal()));
+        out_.put_u32(blocks_.id(port->get_block()));
+      }
+      for (size_t i = 0; i < blocks_.size(); ++i) put_block(blocks_[i]);
+      out_.put_u32(static_cast<uint32_t>(instances_.size()));
+      for (size_t i = 0; i < instances_.size(); ++i) {
+        out_.put_u32(blocks_.id(instances_[i]->instaciated_block_ptr_.get()));
+        put_instance_state(instances_[i]);
+      }
+      for (size_t i = 0; i < blocks_.size(); ++i) {
+        device_block *block = blocks_[i];
+        put_map(block->instance_map_, instances_);
+        out_.put_u32(static_cast<uint32_t>(block->instance_vector_.size()));
+        for (const auto &inst : block->instance_vector_) {
+          out_.put_u32(instances_.id(inst.get()));
+        }
+      }
+      out_.put_u32(static_cast<uint32_t>(snapshot.devices.size()));
+      for (const auto &dev : snapshot.devices) {
+        out_.put_u32(blocks_.id(dev.get()));
+      }
+      put_str(snapshot.current_device);
+
+      writer payload;
+      payload.put_u32(static_cast<uint32_t>(strings_.size()));
+      for (const std::string *str : strings_) payload.put_string(*str);
+      payload.put_bytes(out_.bytes().data(), out_.bytes().size());
+      return payload.bytes();
+    }
+
+   private:
+    /// Indexes everything reachable from the devices.
+    void collect() {
+      size_t block = 0, inst = 0, signal = 0, net = 0;
+      bool grown = true;
+      while (grown) {
+        grown = false;
+        for (; block < blocks_.size(); ++block, grown = true) {
+          collect_block(blocks_[block]);
+        }
+        for (; inst < instances_.size(); ++inst, grown = true) {
+          blocks_.id(instances_[inst]->instaciated_block_ptr_.get());
+        }
+        for (; signal < signals_.size(); ++signal, grown = true) {
+          for (const auto &n : signals_[signal]->get_net_vector()) {
+            nets_.id(n.get());
+          }
+        }
+        for (; net < nets_.size(); ++net, grown = true) {
+          signals_.id(nets_[net]->get_signal());
+          nets_.id(nets_[net]->get_source().get());
+          for (device_net *sink : sorted_sinks(nets_[net])) nets_.id(sink);
+        }
+      }
+    }
+
+    void collect_block(device_block *block) {
+      for (const auto *pr : sorted(block->ports_map_)) {
+        device_port *port = pr->second.get();
+        if (!port) continue;
+        ports_.id(port);
+        signals_.id(port->get_signal());
+        blocks_.id(port->get_block());
+      }
+      for (const auto *pr : sorted(block->signals_map_)) {
+        signals_.id(pr->second.get());
+      }
+      for (const auto *pr : sorted(block->nets_map_)) {
+        nets_.id(pr->second.get());
+      }
+      collect_parameters(block->int_parameters_map_, int_params_, int_types_);
+      collect_parameters(block->double_parameters_map_, double_params_,
+                         double_types_);
+      collect_parameters(block->string_parameters_map_, string_params_,
+                         string_types_);
+      collect_parameters(block->attributes_map_, int_params_, int_types_);
+      for (const auto *pr : sorted(block->constraint_map_)) {
+        expressions_.id(pr->second.get());
+      }
+      for (const auto *pr : sorted(block->enum_types_)) {
+        int_types_.id(pr->second.get());
+      }
+      for (const auto *pr : sorted(block->block_map_)) {
+        blocks_.id(pr->second.get());
+      }
+      for (const auto *pr : sorted(block->int_parameter_types_map_)) {
+        int_types_.id(pr->second.get());
+      }
+      for (const auto *pr : sorted(block->double_parameter_types_map_)) {
+        double_types_.id(pr->second.get());
+      }
+      for (const auto *pr : sorted(block->string_parameter_types_map_)) {
+        string_types_.id(pr->second.get());
+      }
+      for (const auto *pr : sorted(block->instance_map_)) {
+        instances_.id(pr->second.get());
+      }
+      for (const auto &inst : block->instance_vector_) {
+        instances_.id(inst.get());
+      }
+      for (const auto *pr : sorted(block->block_chains_)) {
+        for (const auto &b : pr->second) blocks_.id(b.get());
+      }
+    }
+
+    template <typename T>
+    void collect_parameters(
+        const device_symbol_map<std::shared_ptr<Parameter<T>>> &map,
+        object_table<Parameter<T>> &params,
+        object_table<ParameterType<T>> &types) {
+      for (const auto *pr : sorted(map)) {
+        if (!pr->second) continue;
+        params.id(pr->second.get());
+        types.id(pr->second->type_ptr_.get());
+      }
+    }
+
+    /// The sinks of a net by name, std::set orders them by address.
+    static std::vector<device_net *> sorted_sinks(device_net *net) {
+      std::vector<device_net *> sinks;
+      for (const auto &sink : net->get_sink_set()) sinks.push_back(sink.get());
+      std::sort(sinks.begin(), sinks.end(), [](device_net *a, device_net *b) {
+        if (!a || !b) return b != nullptr;
+        return a->get_net_name() < b->get_net_name();
+      });
+      return sinks;
+    }
+
+    void put_str(const std::string &str) {
+      auto it =
+          string_ids_.emplace(str, static_cast<uint32_t>(strings_.size()));
+      if (it.second) strings_.push_back(&it.first->first);
+      out_.put_u32(it.first->second);
+    }
+
+    void put_value(int value) { out_.put_i32(value); }
+    void put_value(double value) { out_.put_f64(value); }
+    void put_value(const std::string &value) { put_str(value); }
+
+    template <typename T>
+    void put_types(const object_table<ParameterType<T>> &types) {
+      out_.put_u32(static_cast<uint32_t>(types.size()));
+      for (size_t i = 0; i < types.size(); ++i) {
+        const ParameterType<T> *type = types[i];
+        out_.put_u8(type->lower_bound_.has_value() |
+                    type->upper_bound_.has_value() << 1 |
+                    type->default_value_.has_value() << 2 |
+                    type->size_.has_value() << 3);
+        if (type->lower_bound_) put_value(*type->lower_bound_);
+        if (type->upper_bound_) put_value(*type->upper_bound_);
+        if (type->default_value_) put_value(*type->default_value_);
+        if (type->size_) out_.put_u64(*type->size_);
+        out_.put_u32(static_cast<uint32_t>(type->enum_values_.size()));
+        for (const auto *pr : sorted(type->enum_values_)) {
+          put_str(pr->first);
+          out_.put_u32(pr->second);
+        }
+      }
+    }
+
+    template <typename T>
+    void put_parameters(const object_table<Parameter<T>> &params,
+                        object_table<ParameterType<T>> &types) {
+      out_.put_u32(static_cast<uint32_t>(params.size()));
+      for (size_t i = 0; i < params.size(); ++i) {
+        const Parameter<T> *param = params[i];
+        put_str(param->name_);
+        put_value(param->value_);
+        out_.put_u32(types.id(param->type_ptr_.get()));
+        out_.put_u8(param->address_.has_value() |
+                    param->size_.has_value() << 1);
+        if (param->address_) out_.put_u32(*param->address_);
+        if (param->size_) out_.put_u32(*param->size_);
+      }
+    }
+
+    void put_nets() {
+      out_.put_u32(static_cast<uint32_t>(nets_.size()));
+      for (size_t i = 0; i < nets_.size(); ++i) {
+        auto owner = owned_nets_.find(nets_[i]);
+        if (owner == owned_nets_.end()) {
+          out_.put_u32(NONE);
+          put_str(nets_[i]->get_net_name());
+        } else {
+          out_.put_u32(static_cast<uint32_t>(owner->second.first));
+          put_str(device_symbol_pool::instance().name(owner->second.second));
+        }
+      }
+      out_.put_u32(static_cast<uint32_t>(signals_.size()));
+      for (size_t i = 0; i < signals_.size(); ++i) {
+        device_signal *signal = signals_[i];
+        put_str(signal->get_name());
+        out_.put_u32(static_cast<uint32_t>(signal->get_net_vector().size()));
+        for (const auto &n : signal->get_net_vector()) {
+          out_.put_u32(nets_.id(n.get()));
+        }
+      }
+      for (size_t i = 0; i < nets_.size(); ++i) {
+        device_net *net = nets_[i];
+        out_.put_u32(signals_.id(net->get_signal()));
+        out_.put_u32(nets_.id(net->get_source().get()));
+        std::vector<device_net *> sinks = sorted_sinks(net);
+        out_.put_u32(static_cast<uint32_t>(sinks.size()));
+        for (device_net *sink : sinks) out_.put_u32(nets_.id(sink));
+      }
+    }
+
+    template <typename V, typename T>
+    void put_map(const device_symbol_map<std::shared_ptr<V>> &map,
+                 object_table<T> &table) {
+      out_.put_u32(static_cast<uint32_t>(map.size()));
+      for (const auto *pr : sorted(map)) {
+        put_str(pr->first);
+        out_.put_u32(table.id(pr->second.get()));
+      }
+    }
+
+    void put_strings(const std::unordered_map<std::string, std::string> &map) {
+      out_.put_u32(static_cast<uint32_t>(map.size()));
+      for (const auto *pr : sorted(map)) {
+        put_str(pr->first);
+        put_str(pr->second);
+      }
+    }
+
+    void put_block(device_block *block) {
+      if (device *dev = dynamic_cast<device *>(block)) {
+        put_str(dev->schema_version_);
+        put_str(dev->device_version_);
+        std::vector<std::string> used(dev->instanciated_blocks_.begin(),
+                                      dev->instanciated_blocks_.end());
+        std::sort(used.begin(), used.end());
+        out_.put_u32(static_cast<uint32_t>(used.size()));
+        for (const std::string &name : used) put_str(name);
+        put_strings(dev->user_to_rtl_map_);
+      }
+      put_str(block->block_name_);
+      put_str(block->block_type_);
+      out_.put_i32(block->max_set_);
+      for (int i = 0; i <= block->max_set_; i += 8) {
+        uint8_t byte = 0;
+        for (int bit = 0; bit < 8 && i + bit <= block->max_set_; ++bit) {
+          if (block->memory_.test(i + bit)) byte |= 1 << bit;
+        }
+        out_.put_u8(byte);
+      }
+      out_.put_u8(block->was_instanciated_);
+      put_strings(block->modelToCustMap_);
+      put_strings(block->custToModelMap_);
+      put_map(block->ports_map_, ports_);
+      put_map(block->signals_map_, signals_);
+      put_map(block->nets_map_, nets_);
+      put_map(block->int_parameters_map_, int_params_);
+      put_map(block->double_parameters_map_, double_params_);
+      put_map(block->string_parameters_map_, string_params_);
+      put_map(block->attributes_map_, int_params_);
+      put_map(block->constraint_map_, expressions_);
+      put_map(block->enum_types_, int_types_);
+      put_map(block->block_map_, blocks_);
+      put_map(block->int_parameter_types_map_, int_types_);
+      put_map(block->double_parameter_types_map_, double_types_);
+      put_map(block->string_parameter_types_map_, string_types_);
+      out_.put_u32(static_cast<uint32_t>(block->block_chains_.size()));
+      for (const auto *pr : sorted(block->block_chains_)) {
+        put_str(pr->first);
+        out_.put_u32(static_cast<uint32_t>(pr->second.size()));
+        for (const auto &b : pr->second) out_.put_u32(blocks_.id(b.get()));
+      }
+      out_.put_u32(static_cast<uint32_t>(block->instance_chains_.size()));
+      for (const auto *pr : sorted(block->instance_chains_)) {
+        put_str(pr->first);
+        out_.put_u32(static_cast<uint32_t>(pr->second.size()));
+        for (const std::string &name : pr->second) put_str(name);
+      }
+      put_strings(block->property_map_);
+    }
+
+    /// Whether an instance and the ones it contains hold their initial
+    /// values, such nested instances are left out of the snapshot.
+    static bool is_default(const device_block_instance *inst) {
+      static const device_block_instance initial;
+      if (inst->instance_id_ != initial.instance_id_ ||
+          inst->logic_location_x_ != initial.logic_location_x_ ||
+          inst->logic_location_y_ != initial.logic_location_y_ ||
+          inst->logic_location_z_ != initial.logic_location_z_ ||
+          inst->logic_address_ != initial.logic_address_ ||
+          inst->phy_address_ != initial.phy_address_ ||
+          inst->instance_name_ != initial.instance_name_ ||
+          inst->io_bank_ != initial.io_bank_) {
+        return false;
+      }
+      for (const auto &pr : inst->instance_map_) {
+        if (pr.second && !is_default(pr.second.get())) return false;
+      }
+      return true;
+    }
+
+    void put_instance_state(const device_block_instance *inst) {
+      out_.put_i32(inst->instance_id_);
+      out_.put_i32(inst->logic_location_x_);
+      out_.put_i32(inst->logic_location_y_);
+      out_.put_i32(inst->logic_location_z_);
+      out_.put_i32(inst->logic_address_);
+      out_.put_i32(inst->phy_address_);
+      put_str(inst->instance_name_);
+      put_str(inst->io_bank_);
+      device_symbol_pool &pool = device_symbol_pool::instance();
+      std::vector<std::pair<const std::string *, device_block_instance *>>
+          children;
+      for (const auto &pr : inst->instance_map_) {
+        if (pr.second && !is_default(pr.second.get())) {
+          children.emplace_back(&pool.name(pr.first), pr.second.get());
+        }
+      }
+      std::sort(children.begin(), children.end(),
+                [](const auto &a, const auto &b) {
+                  return *a.first < *b.first;
+                });
+      out_.put_u32(static_cast<uint32_t>(children.size()));
+      for (const auto &child : children) {
+        put_str(*child.first);
+        put_instance_state(child.second);
+      }
+    }
+
+    writer out_;
+    std::unordered_map<std::string, uint32_t> string_ids_;
+    std::vector<const std::string *> strings_;
+    object_table<device_block> blocks_;
+    object_table<device_block_instance> instances_;
+    object_table<device_port> ports_;
+    object_table<device_signal> signals_;
+    object_table<device_net> nets_;
+    object_table<ParameterType<int>> int_types_;
+    object_table<ParameterType<double>> double_types_;
+    object_table<ParameterType<std::string>> string_types_;
+    object_table<Parameter<int>> int_params_;
+    object_table<Parameter<double>> double_params_;
+    object_table<Parameter<std::string>> string_params_;
+    object_table<rs_expression<int>> expressions_;
+    /// Nets allocated by an instance, by instance index and net name.
+    std::unordered_map<device_net *, std::pair<size_t, device_symbol>>
+        owned_nets_;
+  };
+
+  class decoder {
+   public:
+    explicit decoder(reader &in) : in_(in) {}
+
+    void decode(contents &snapshot) {
+      strings_.resize(in_.get_count(4));
+      for (std::string &str : strings_) str = in_.get_string();
+
+      get_types(int_types_);
+      get_types(double_types_);
+      get_types(string_types_);
+      get_parameters(int_params_, int_types_);
+      get_parameters(double_params_, double_types_);
+      get_parameters(string_params_, string_types_);
+      expressions_.resize(in_.get_count(9));
+      for (auto &expr : expressions_) {
+        expr = std::make_shared<rs_expression<int>>(get_str());
+        bool evaluated = in_.get_u8();
+        int value = in_.get_i32();
+        if (evaluated) expr->set_value(value);
+      }
+      blocks_.resize(in_.get_count(5));
+      for (auto &block : blocks_) {
+        bool is_device = in_.get_u8();
+        std::string name = get_str();
+        if (is_device) {
+          block = std::make_shared<device>(name);
+        } else {
+          block = std::make_shared<device_block>(name);
+        }
+      }
+      get_nets();
+      ports_.resize(in_.get_count(13));
+      for (auto &port : ports_) {
+        port = std::make_shared<device_port>();
+        port->set_name(get_str());
+        port->set_direction(in_.get_u8());
+        port->set_signal(get_raw(signals_));
+        port->set_block(get_raw(blocks_));
+      }
+      for (auto &block : blocks_) get_block(block.get());
+
+      instance_records_.resize(in_.get_count(40));
+      for (auto &record : instance_records_) {
+        record.block = get_index(blocks_.size());
+        get_instance_state(record.state);
+      }
+      instances_.resize(instance_records_.size());
+      block_instances_.resize(blocks_.size());
+      for (auto &lists : block_instances_) {
+        lists.map.resize(in_.get_count(8));
+        for (auto &entry : lists.map) {
+          entry.first = get_str();
+          entry.second = get_index(instances_.size());
+        }
+        lists.vector.resize(in_.get_count(4));
+        for (uint32_t &index : lists.vector) {
+          index = get_index(instances_.size());
+        }
+      }
+      snapshot.devices.resize(in_.get_count(4));
+      for (auto &dev : snapshot.devices) {
+        dev = std::dynamic_pointer_cast<device>(
+            blocks_[get_index(blocks_.size(), false)]);
+        if (!dev) throw std::runtime_error("Bad device in device snapshot");
+      }
+      snapshot.current_device = get_str();
+
+      for (size_t i = 0; i < blocks_.size(); ++i) build_instances(i);
+      link_nets();
+    }
+
+   private:
+    struct instance_record {
+      uint32_t block = NONE;
+      instance_state state;
+    };
+    struct instance_lists {
+      std::vector<std::pair<std::string, uint32_t>> map;
+      std::vector<uint32_t> vector;
+    };
+    struct net_links {
+      uint32_t source = NONE;
+      std::vector<uint32_t> sinks;
+    };
+    enum class build_state { pending, building, done };
+
+    uint32_t get_index(size_t size, bool nullable = true) {
+      uint32_t index = in_.get_u32();
+      if ((index == NONE && nullable) || index < size) return index;
+      throw std::runtime_error("Bad index in device snapshot");
+    }
+
+    const std::string &get_str() {
+      return strings_[get_index(strings_.size(), false)];
+    }
+
+    template <typename T>
+    std::shared_ptr<T> get_shared(const std::vector<std::shared_ptr<T>> &v) {
+      uint32_t index = get_index(v.size());
+      return index == NONE ? nullptr : v[index];
+    }
+
+    template <typename T>
+    T *get_raw(const std::vector<T *> &v) {
+      uint32_t index = get_index(v.size());
+      return index == NONE ? nullptr : v[index];
+    }
+
+    template <typename T>
+    T *get_raw(const std::vector<std::shared_ptr<T>> &v) {
+      return get_shared(v).get();
+    }
+
+    void get_value(int &value) { value = in_.get_i32(); }
+    void get_value(double &value) { value = in_.get_f64(); }
+    void get_value(std::string &value) { value = get_str(); }
+
+    template <typename T>
+    void get_types(std::vector<std::shared_ptr<ParameterType<T>>> &types) {
+      types.resize(in_.get_count(5));
+      for (auto &type : types) {
+        type = std::make_shared<ParameterType<T>>();
+        uint8_t flags = in_.get_u8();
+        T value{};
+        if (flags & 1) get_value(value), type->lower_bound_ = value;
+        if (flags & 2) get_value(value), type->upper_bound_ = value;
+        if (flags & 4) get_value(value), type->default_value_ = value;
+        if (flags & 8) type->size_ = static_cast<size_t>(in_.get_u64());
+        uint32_t count = in_.get_count(8);
+        for (uint32_t i = 0; i < count; ++i) {
+          const std::string &key = get_str();
+          type->enum_values_[key] = in_.get_u32();
+        }
+      }
+    }
+
+    template <typename T>
+    void get_parameters(
+        std::vector<std::shared_ptr<Parameter<T>>> &params,
+        const std::vector<std::shared_ptr<ParameterType<T>>> &types) {
+      params.resize(in_.get_count(9));
+      for (auto &param : params) {
+        param = std::make_shared<Parameter<T>>();
+        param->name_ = get_str();
+        get_value(param->value_);
+        param->type_ptr_ = get_shared(types);
+        uint8_t flags = in_.get_u8();
+        if (flags & 1) param->address_ = in_.get_u32();
+        if (flags & 2) param->size_ = in_.get_u32();
+      }
+    }
+
+    void get_nets() {
+      nets_.resize(in_.get_count(8));
+      owned_nets_.resize(nets_.size());
+      for (size_t i = 0; i < nets_.size(); ++i) {
+        uint32_t owner = in_.get_u32();
+        const std::string &name = get_str();
+        if (owner == NONE) {
+          nets_[i] = std::make_shared<device_net>(name);
+        } else {
+          owned_nets_[i] = std::make_pair(owner, name);
+        }
+      }
+      // Signals are owned through raw pointers by the ports and the nets,
+      // the blocks listing them in their signal map share their ownership
+      signals_.resize(in_.get_count(8));
+      shared_signals_.resize(signals_.size());
+      for (auto &signal : signals_) {
+        signal = new device_signal(get_str(), 0);
+        uint32_t count = in_.get_count(4);
+        for (uint32_t i = 0; i < count; ++i) {
+          signal->add_net(get_net(get_index(nets_.size())));
+        }
+      }
+      links_.resize(nets_.size());
+      for (size_t i = 0; i < nets_.size(); ++i) {
+        device_signal *signal = get_raw(signals_);
+        if (nets_[i]) nets_[i]->set_signal(signal);
+        links_[i].source = get_index(nets_.size());
+        links_[i].sinks.resize(in_.get_count(4));
+        for (uint32_t &sink : links_[i].sinks) {
+          sink = get_index(nets_.size());
+        }
+      }
+    }
+
+    /// A net, those of the instances only exist once the instances are.
+    std::shared_ptr<device_net> get_net(uint32_t index) {
+      if (index == NONE) return nullptr;
+      if (!nets_[index]) {
+        throw std::runtime_error(
+            "Device snapshot refers to an instance net before the instances");
+      }
+      return nets_[index];
+    }
+
+    std::shared_ptr<device_signal> get_shared_signal() {
+      uint32_t index = get_index(signals_.size());
+      if (index == NONE) return nullptr;
+      if (!shared_signals_[index]) {
+        shared_signals_[index] =
+            std::shared_ptr<device_signal>(signals_[index]);
+      }
+      return shared_signals_[index];
+    }
+
+    void get_strings(std::unordered_map<std::string, std::string> &map) {
+      uint32_t count = in_.get_count(8);
+      map.reserve(count);
+      for (uint32_t i = 0; i < count; ++i) {
+        const std::string &key = get_str();
+        map[key] = get_str();
+      }
+    }
+
+    template <typename V, typename T>
+    void get_map(device_symbol_map<std::shared_ptr<V>> &map,
+                 const std::vector<std::shared_ptr<T>> &table) {
+      map.clear();
+      uint32_t count = in_.get_count(8);
+      map.reserve(count);
+      for (uint32_t i = 0; i < count; ++i) {
+        const std::string &key = get_str();
+        map[key] = get_shared(table);
+      }
+    }
+
+    void get_block(device_block *block) {
+      if (device *dev = dynamic_cast<device *>(block)) {
+        dev->schema_version_ = get_str();
+        dev->device_version_ = get_str();
+        uint32_t count = in_.get_count(4);
+        for (uint32_t i = 0; i < count; ++i) {
+          dev->instanciated_blocks_.insert(get_str());
+        }
+        get_strings(dev->user_to_rtl_map_);
+      }
+      block->block_name_ = get_str();
+      block->block_type_ = get_str();
+      block->max_set_ = in_.get_i32();
+      if (block->max_set_ < -1 ||
+          block->max_set_ >= static_cast<int>(block->memory_.size())) {
+        throw std::runtime_error("Bad attribute memory in device snapshot");
+      }
+      for (int i = 0; i <= block->max_set_; i += 8) {
+        uint8_t byte = in_.get_u8();
+        for (int bit = 0; bit < 8 && i + bit <= block->max_set_; ++bit) {
+          if (byte & (1 << bit)) block->memory_.set(i + bit);
+        }
+      }
+      block->was_instanciated_ = in_.get_u8();
+      get_strings(block->modelToCustMap_);
+      get_strings(block->custToModelMap_);
+      get_map(block->ports_map_, ports_);
+      uint32_t count = in_.get_count(8);
+      block->signals_map_.reserve(count);
+      for (uint32_t i = 0; i < count; ++i) {
+        const std::string &key = get_str();
+        block->signals_map_[key] = get_shared_signal();
+      }
+      count = in_.get_count(8);
+      block->nets_map_.reserve(count);
+      for (uint32_t i = 0; i < count; ++i) {
+        const std::string &key = get_str();
+        block->nets_map_[key] = get_net(get_index(nets_.size()));
+      }
+      get_map(block->int_parameters_map_, int_params_);
+      get_map(block->double_parameters_map_, double_params_);
+      get_map(block->string_parameters_map_, string_params_);
+      get_map(block->attributes_map_, int_params_);
+      get_map(block->constraint_map_, expressions_);
+      get_map(block->enum_types_, int_types_);
+      get_map(block->block_map_, blocks_);
+      get_map(block->int_parameter_types_map_, int_types_);
+      get_map(block->double_parameter_types_map_, double_types_);
+      get_map(block->string_parameter_types_map_, string_types_);
+      count = in_.get_count(8);
+      for (uint32_t i = 0; i < count; ++i) {
+        auto &chain = block->block_chains_[get_str()];
+        chain.resize(in_.get_count(4));
+        for (auto &b : chain) b = get_shared(blocks_);
+      }
+      count = in_.get_count(8);
+      for (uint32_t i = 0; i < count; ++i) {
+        auto &chain = block->instance_chains_[get_str()];
+        chain.resize(in_.get_count(4));
+        for (std::string &name : chain) name = get_str();
+      }
+      get_strings(block->property_map_);
+    }
+
+    void get_instance_state(instance_state &state) {
+      state.id = in_.get_i32();
+      state.location_x = in_.get_i32();
+      state.location_y = in_.get_i32();
+      state.location_z = in_.get_i32();
+      state.logic_address = in_.get_i32();
+      state.phy_address = in_.get_i32();
+      state.name = get_index(strings_.size(), false);
+      state.io_bank = get_index(strings_.size(), false);
+      state.children.resize(in_.get_count(36));
+      for (instance_state &child : state.children) {
+        child.child_name = get_index(strings_.size(), false);
+        get_instance_state(child);
+      }
+    }
+
+    void apply_instance_state(device_block_instance &inst,
+                              const instance_state &state) {
+      inst.instance_id_ = state.id;
+      inst.logic_location_x_ = state.location_x;
+      inst.logic_location_y_ = state.location_y;
+      inst.logic_location_z_ = state.location_z;
+      inst.logic_address_ = state.logic_address;
+      inst.phy_address_ = state.phy_address;
+      inst.instance_name_ = strings_[state.name];
+      inst.io_bank_ = strings_[state.io_bank];
+      for (const instance_state &child : state.children) {
+        auto sub = inst.findInstanceByName(strings_[child.child_name]);
+        if (!sub) {
+          throw std::runtime_error("Device snapshot has no instance " +
+                                   strings_[child.child_name]);
+        }
+        apply_instance_state(*sub, child);
+      }
+    }
+
+    /// Creates the instances held by a block. An instance copies the
+    /// instances of its own block, so these are created first.
+    void build_instances(size_t block) {
+      if (block_states_.empty()) {
+        block_states_.resize(blocks_.size(), build_state::pending);
+      }
+      if (block_states_[block] == build_state::done) return;
+      if (block_states_[block] == build_state::building) {
+        throw std::runtime_error("Recursive instantiation in device snapshot");
+      }
+      block_states_[block] = build_state::building;
+      const instance_lists &lists = block_instances_[block];
+      for (const auto &entry : lists.map) build_instance(entry.second);
+      for (uint32_t index : lists.vector) build_instance(index);
+      device_block *target = blocks_[block].get();
+      for (const auto &entry : lists.map) {
+        target->instance_map_[entry.first] =
+            entry.second == NONE ? nullptr : instances_[entry.second];
+      }
+      for (uint32_t index : lists.vector) {
+        target->instance_vector_.push_back(
+            index == NONE ? nullptr : instances_[index]);
+      }
+      block_states_[block] = build_state::done;
+    }
+
+    void build_instance(uint32_t index) {
+      if (index == NONE || instances_[index]) return;
+      const instance_record &record = instance_records_[index];
+      std::shared_ptr<device_block> block;
+      if (record.block != NONE) {
+        build_instances(record.block);
+        block = blocks_[record.block];
+      }
+      instances_[index] = std::make_shared<device_block_instance>(block);
+      apply_instance_state(*instances_[index], record.state);
+    }
+
+    void link_nets() {
+      for (size_t i = 0; i < nets_.size(); ++i) {
+        if (nets_[i]) continue;
+        const auto &owner = owned_nets_[i];
+        if (owner.first >= instances_.size() || !instances_[owner.first]) {
+          throw std::runtime_error("Bad instance net in device snapshot");
+        }
+        nets_[i] = instances_[owner.first]->get_net(owner.second);
+        if (!nets_[i]) {
+          throw std::runtime_error("Device snapshot has no instance net " +
+                                   owner.second);
+        }
+      }
+      for (size_t i = 0; i < nets_.size(); ++i) {
+        if (links_[i].source != NONE) {
+          nets_[i]->set_source(nets_[links_[i].source]);
+        }
+        for (uint32_t sink : links_[i].sinks) {
+          if (sink != NONE) nets_[i]->add_sink(nets_[sink]);
+        }
+      }
+    }
+
+    reader &in_;
+    std::vector<std::string> strings_;
+    std::vector<std::shared_ptr<ParameterType<int>>> int_types_;
+    std::vector<std::shared_ptr<ParameterType<double>>> double_types_;
+    std::vector<std::shared_ptr<ParameterType<std::string>>> string_types_;
+    std::vector<std::shared_ptr<Parameter<int>>> int_params_;
+    std::vector<std::shared_ptr<Parameter<double>>> double_params_;
+    std::vector<std::shared_ptr<Parameter<std::string>>> string_params_;
+    std::vector<std::shared_ptr<rs_expression<int>>> expressions_;
+    std::vector<std::shared_ptr<device_block>> blocks_;
+    std::vector<std::shared_ptr<device_net>> nets_;
+    std::vector<std::pair<uint32_t, std::string>> owned_nets_;
+    std::vector<net_links> links_;
+    std::vector<device_signal *> signals_;
+    std::vector<std::shared_ptr<device_signal>> shared_signals_;
+    std::vector<std::shared_ptr<device_port>> ports_;
+    std::vector<instance_record> instance_records_;
+    std::vector<std::shared_ptr<device_block_instance>> instances_;
+    std::vector<instance_lists> block_instances_;
+    std::vector<build_state> block_states_;
+  };
+};
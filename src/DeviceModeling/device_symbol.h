@@ -0,0 +1,304 @@
+/**
+ * @file device_symbol.h
+ * @brief Interned names and flat tables keyed by them.
+ * @version 1.0
+ * @date 2024-06-7
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// Identifier of an interned name, see device_symbol_pool.
+typedef uint32_t device_symbol;
+
+/**
+ * @class device_symbol_pool
+ * @brief Process wide pool of the names used by the device models.
+ *
+ * Every distinct name is stored once and identified by a small integer, so
+ * the many instances of a block share the names of their ports, nets and
+ * parameters instead of holding copies of them.
+ */
+class device_symbol_pool {
+ public:
+  /**
+   * @brief The pool used by the device models.
+   */
+  static device_symbol_pool &instance() {
+    static device_symbol_pool pool;
+    return pool;
+  }
+
+  /**
+   * @brief Returns the symbol of a name, adding the name if it is new.
+   */
+  device_symbol intern(const std::string &name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = symbols_.find(name);
+    if (it != symbols_.end()) return it->second;
+    device_symbol symbol = static_cast<device_symbol>(names_.size());
+    names_.push_back(name);
+    symbols_.emplace(names_.back(), symbol);
+    return symbol;
+  }
+
+  /**
+   * @brief Looks a name up without adding it.
+   *
+   * @param name The name to look for.
+   * @param symbol Set to the symbol of the name when it is found.
+   * @return True if the name was interned before, false otherwise.
+   */
+  bool find(const std::string &name, device_symbol &symbol) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = symbols_.find(name);
+    if (it == symbols_.end()) return false;
+    symbol = it->second;
+    return true;
+  }
+
+  /**
+   * @brief The name of a symbol. The reference stays valid for the lifetime
+   * of the pool.
+   */
+  const std::string &name(device_symbol symbol) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return names_.at(symbol);
+  }
+
+  /**
+   * @brief Number of the interned names.
+   */
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return names_.size();
+  }
+
+ private:
+  device_symbol_pool() = default;
+
+  mutable std::mutex mutex_;
+  /// The names, a deque keeps their addresses stable for the views below.
+  std::deque<std::string> names_;
+  std::unordered_map<std::string_view, device_symbol> symbols_;
+};
+
+/**
+ * @class device_symbol_table
+ * @brief A flat table of values sorted by symbol.
+ *
+ * Entries are appended while the owner is built, then sort() is called once.
+ * Lookups are binary searches over a contiguous vector, which costs far less
+ * memory than a hash map of strings for the small tables of an instance.
+ *
+ * @tparam V The type of the values.
+ */
+template <typename V>
+class device_symbol_table {
+ public:
+  typedef std::pair<device_symbol, V> entry;
+  typedef typename std::vector<entry>::iterator iterator;
+  typedef typename std::vector<entry>::const_iterator const_iterator;
+
+  void reserve(size_t size) { entries_.reserve(size); }
+
+  /**
+   * @brief Appends an entry, sort() must be called before the next lookup.
+   */
+  void append(device_symbol symbol, V value) {
+    entries_.emplace_back(symbol, std::move(value));
+  }
+
+  /**
+   * @brief Sorts the entries appended so far.
+   */
+  void sort() {
+    std::sort(entries_.begin(), entries_.end(),
+              [](const entry &a, const entry &b) { return a.first < b.first; });
+  }
+
+  const V *find(device_symbol symbol) const {
+    auto it = std::lower_bound(
+        entries_.begin(), entries_.end(), symbol,
+        [](const entry &e, device_symbol s) { return e.first < s; });
+    if (it == entries_.end() || it->first != symbol) return nullptr;
+    return &it->second;
+  }
+  V *find(device_symbol symbol) {
+    return const_cast<V *>(
+        static_cast<const device_symbol_table &>(*this).find(symbol));
+  }
+
+  /**
+   * @brief Looks a value up by name, names never interned are not in the
+   * table.
+   */
+  const V *find_by_name(const std::string &name) const {
+    device_symbol symbol = 0;
+    if (!device_symbol_pool::instance().find(name, symbol)) return nullptr;
+    return find(symbol);
+  }
+  V *find_by_name(const std::string &name) {
+    return const_cast<V *>(
+        static_cast<const device_symbol_table &>(*this).find_by_name(name));
+  }
+
+  size_t size() const { return entries_.size(); }
+  bool empty() const { return entries_.empty(); }
+  iterator begin() { return entries_.begin(); }
+  iterator end() { return entries_.end(); }
+  const_iterator begin() const { return entries_.begin(); }
+  const_iterator end() const { return entries_.end(); }
+
+ private:
+  std::vector<entry> entries_;
+};
+
+/**
+ * @class device_symbol_map
+ * @brief Map of interned names to values, in place of an
+ * std::unordered_map<std::string, V>.
+ *
+ * The entries are held in insertion order in one vector and their names are
+ * references to the strings of the pool, so a block holds no copy of the
+ * names and no node per entry. Small maps are searched linearly over the
+ * symbols, larger ones through an index. Entries look like the pairs of a
+ * standard map: first is the name and second the value.
+ *
+ * @tparam V The type of the values.
+ */
+template <typename V>
+class device_symbol_map {
+ public:
+  typedef std::pair<const std::string &, V> value_type;
+  typedef typename std::vector<value_type>::iterator iterator;
+  typedef typename std::vector<value_type>::const_iterator const_iterator;
+
+  device_symbol_map() = default;
+  device_symbol_map(const device_symbol_map &) = default;
+  device_symbol_map(device_symbol_map &&) = default;
+  /// The names are references, entries are not assignable.
+  device_symbol_map &operator=(device_symbol_map other) {
+    entries_.swap(other.entries_);
+    symbols_.swap(other.symbols_);
+    index_.swap(other.index_);
+    return *this;
+  }
+
+  iterator find(const std::string &name) {
+    return begin() + position(name);
+  }
+  const_iterator find(const std::string &name) const {
+    return begin() + position(name);
+  }
+  size_t count(const std::string &name) const {
+    return position(name) != entries_.size() ? 1 : 0;
+  }
+
+  /**
+   * @brief The value of a name, a default value is added if the name is new.
+   */
+  V &operator[](const std::string &name) {
+    device_symbol_pool &pool = device_symbol_pool::instance();
+    device_symbol symbol = pool.intern(name);
+    size_t pos = position(symbol);
+    if (pos == entries_.size()) {
+      entries_.emplace_back(std::piecewise_construct,
+                            std::forward_as_tuple(pool.name(symbol)),
+                            std::forward_as_tuple());
+      symbols_.push_back(symbol);
+      if (!index_.empty()) {
+        index_.emplace(symbol, static_cast<uint32_t>(pos));
+      } else if (entries_.size() > LINEAR_SIZE) {
+        reindex();
+      }
+    }
+    return entries_[pos].second;
+  }
+
+  /**
+   * @brief Removes a name, the entries after it keep their order.
+   */
+  size_t erase(const std::string &name) {
+    size_t pos = position(name);
+    if (pos == entries_.size()) return 0;
+    std::vector<value_type> entries;
+    entries.reserve(entries_.size() - 1);
+    for (size_t i = 0; i < entries_.size(); ++i) {
+      if (i != pos) entries.push_back(std::move(entries_[i]));
+    }
+    entries_.swap(entries);
+    symbols_.erase(symbols_.begin() + pos);
+    reindex();
+    return 1;
+  }
+
+  /**
+   * @brief The symbol of the name of an entry of this map.
+   */
+  device_symbol symbol(const value_type &entry) const {
+    return symbols_[&entry - entries_.data()];
+  }
+
+  void reserve(size_t size) {
+    entries_.reserve(size);
+    symbols_.reserve(size);
+  }
+  void clear() {
+    entries_.clear();
+    symbols_.clear();
+    index_.clear();
+  }
+  size_t size() const { return entries_.size(); }
+  bool empty() const { return entries_.empty(); }
+  iterator begin() { return entries_.begin(); }
+  iterator end() { return entries_.end(); }
+  const_iterator begin() const { return entries_.begin(); }
+  const_iterator end() const { return entries_.end(); }
+
+ private:
+  /// Maps up to this size have no index.
+  static constexpr size_t LINEAR_SIZE = 16;
+
+  size_t position(const std::string &name) const {
+    device_symbol symbol = 0;
+    if (!device_symbol_pool::instance().find(name, symbol)) {
+      return entries_.size();
+    }
+    return position(symbol);
+  }
+  size_t position(device_symbol symbol) const {
+    if (index_.empty()) {
+      return std::find(symbols_.begin(), symbols_.end(), symbol) -
+             symbols_.begin();
+    }
+    auto it = index_.find(symbol);
+    return it != index_.end() ? it->second : entries_.size();
+  }
+  void reindex() {
+    index_.clear();
+    if (symbols_.size() <= LINEAR_SIZE) return;
+    index_.reserve(symbols_.size());
+    for (size_t i = 0; i < symbols_.size(); ++i) {
+      index_.emplace(symbols_[i], static_cast<uint32_t>(i));
+    }
+  }
+
+  std::vector<value_type> entries_;
+  /// The symbols of the entries, in the same order.
+  std::vector<device_symbol> symbols_;
+  std::unordered_map<device_symbol, uint32_t> index_;
+};
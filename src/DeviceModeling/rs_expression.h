@@ -27,6 +27,8 @@ class rs_expression {
   bool is_evaluated_;   ///< Indicates whether the expression has been
                         ///< successfully evalua
 
+  friend class device_snapshot;
+
  public:
   /**
    * @brief Default constructor.
@@ -14,7 +14,11 @@
 #include <cmath>
 #include <cstdio>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "exprtk.hpp"
 #include "speedlog.h"
@@ -89,74 +93,216 @@ class rs_expression_evaluator {
     E ret_val = static_cast<E>(s_ptr->value());
     return ret_val;
   }
+  /**
+   * @brief An expression compiled once by exprtk, with its own symbol table.
+   *
+   * The variables of the symbol table are bound to the caller values right
+   * before each evaluation. Evaluations of the same compiled expression are
+   * serialized, different expressions are evaluated in parallel.
+   */
+  class compiled_expression {
+    exprtk::symbol_table<T> symbol_table_;
+    exprtk::expression<T> expression_;
+    std::vector<std::string> symbols_;
+    std::vector<T *> slots_;
+    bool valid_ = false;
+    std::mutex mutex_;
+
+   public:
+    explicit compiled_expression(const std::string &expression_str) {
+      typedef exprtk::parser<T> parser_t;
+      typedef exprtk::parser_error::type error_t;
+      typedef typename parser_t::settings_store settings_t;
+      expression_.register_symbol_table(symbol_table_);
+      parser_t parser(settings_t(settings_t::compile_all_opts +
+                                 settings_t::e_disable_usr_on_rsrvd)
+                          .disable_all_base_functions()
+                          .disable_all_control_structures());
+      parser.enable_unknown_symbol_resolver();
+      parser.dec().collect_variables() = true;
+      parser.dec().collect_functions() = true;
+      if (!parser.compile(expression_str, expression_)) {
+        for (std::size_t i = 0; i < parser.error_count(); ++i) {
+          error_t error = parser.get_error(i);
+          spdlog::error(
+              "Error: {} Position: {} Type: [{}] Message: {} Expression: {}",
+              i, error.token.position,
+              exprtk::parser_error::to_str(error.mode).c_str(),
+              error.diagnostic.c_str(), expression_str.c_str());
+        }
+        return;
+      }
+
+      typedef
+          typename parser_t::dependent_entity_collector::symbol_t dec_symbol_t;
+      std::deque<dec_symbol_t> symbol_list;
+      parser.dec().symbols(symbol_list);
+      // allow only variables and the function not()
+      for (auto &s : symbol_list) {
+        if (exprtk::details::imatch(s.first, "not")) continue;
+        if (parser_t::e_st_function == s.second) {
+          spdlog::error("Error: call to function '{}' not allowed.\n",
+                        s.first.c_str());
+          return;
+        }
+        auto s_ptr = symbol_table_.get_variable(s.first);
+        if (!s_ptr) continue;
+        symbols_.push_back(s.first);
+        slots_.push_back(&s_ptr->ref());
+      }
+      valid_ = true;
+    }
+    compiled_expression(const compiled_expression &) = delete;
+    compiled_expression &operator=(const compiled_expression &) = delete;
+
+    /**
+     * @brief Checks whether the expression compiled and uses only allowed
+     * symbols.
+     */
+    bool is_valid() const { return valid_; }
+    /**
+     * @brief The variables of the expression.
+     */
+    const std::vector<std::string> &symbols() const { return symbols_; }
+    /**
+     * @brief Evaluates the expression with the given symbol values.
+     *
+     * @param value_map A map of symbol names and their corresponding values.
+     * @param result A reference to store the result of the expression.
+     * @return False if the expression is invalid or a symbol has no value.
+     */
+    bool evaluate(const map<string, E> &value_map, E &result) {
+      if (!valid_) return false;
+      std::lock_guard<std::mutex> lock(mutex_);
+      return evaluate_locked(value_map, result);
+    }
+    /**
+     * @brief Evaluates the expression once per value map.
+     *
+     * @param value_maps The symbol values of each evaluation.
+     * @param results The results, in the order of the value maps.
+     * @return False if any of the evaluations failed.
+     */
+    bool evaluate(const std::vector<map<string, E>> &value_maps,
+                  std::vector<E> &results) {
+      results.assign(value_maps.size(), E(0));
+      if (!valid_) return false;
+      bool success = true;
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (std::size_t i = 0; i < value_maps.size(); ++i) {
+        success = evaluate_locked(value_maps[i], results[i]) && success;
+      }
+      return success;
+    }
+
+   private:
+    bool evaluate_locked(const map<string, E> &value_map, E &result) {
+      for (std::size_t i = 0; i < symbols_.size(); ++i) {
+        auto it = value_map.find(symbols_[i]);
+        if (end(value_map) == it) {
+          spdlog::error("Error: missing value of symbol '{}'.\n",
+                        symbols_[i].c_str());
+          return false;
+        }
+        *slots_[i] = T(it->second);
+      }
+      result = static_cast<E>(expression_.value());
+      return true;
+    }
+  };
+  typedef std::shared_ptr<compiled_expression> compiled_expression_ptr;
+
+ private:
+  struct expression_cache {
+    std::mutex mutex;
+    std::unordered_map<std::string, compiled_expression_ptr> entries;
+  };
+  static expression_cache &get_cache() {
+    static expression_cache cache;
+    return cache;
+  }
+
+ public:
+  /**
+   * @brief Maximum number of expressions kept compiled. The cache is dropped
+   * as a whole when it is full.
+   */
+  static constexpr std::size_t CACHE_MAX_SIZE = 4096;
+
+  /**
+   * @brief Returns the compiled form of an expression string, compiling it
+   * only the first time it is requested. Safe to call from several threads.
+   *
+   * @param expression_str The expression string to compile.
+   * @return The compiled expression, check is_valid() before using it.
+   */
+  static compiled_expression_ptr compile(const std::string &expression_str) {
+    expression_cache &cache = get_cache();
+    {
+      std::lock_guard<std::mutex> lock(cache.mutex);
+      auto it = cache.entries.find(expression_str);
+      if (it != cache.entries.end()) return it->second;
+    }
+    // compile outside of the lock, a concurrent compilation of the same
+    // string is harmless and the first inserted one is kept
+    auto compiled = std::make_shared<compiled_expression>(expression_str);
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    if (cache.entries.size() >= CACHE_MAX_SIZE) cache.entries.clear();
+    return cache.entries.emplace(expression_str, compiled).first->second;
+  }
+  /**
+   * @brief Drops all the compiled expressions.
+   */
+  static void clear_cache() {
+    expression_cache &cache = get_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.entries.clear();
+  }
+  /**
+   * @brief Number of the compiled expressions currently cached.
+   */
+  static std::size_t cache_size() {
+    expression_cache &cache = get_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    return cache.entries.size();
+  }
   /**
    * @brief Evaluates the expression using the provided symbol values and stores
    * the result in the given reference.
    *
    * @param expression_str The expression string to evaluate.
    * @param value_map A map of symbol names and their corresponding values.
+   * Every symbol of the expression must have a value.
    * @param result A reference to store the result of the evaluated expression.
    * @return True if the expression is successfully evaluated, false otherwise.
    */
   static bool evaluate_expression(const std::string &expression_str,
-                                  map<string, E> &value_map, E &result) {
-    typedef exprtk::symbol_table<T> symbol_table_t;
-    typedef exprtk::expression<T> expression_t;
-    typedef exprtk::parser<T> parser_t;
-    typedef exprtk::parser_error::type error_t;
-    typedef typename parser_t::settings_store settings_t;
-    symbol_table_t symbol_table;
-    expression_t expression;
-    expression.register_symbol_table(symbol_table);
-    parser_t parser(settings_t(settings_t::compile_all_opts +
-                               settings_t::e_disable_usr_on_rsrvd)
-                        .disable_all_base_functions()
-                        .disable_all_control_structures());
-    parser.enable_unknown_symbol_resolver();
-    parser.dec().collect_variables() = true;
-    parser.dec().collect_functions() = true;
-    if (!parser.compile(expression_str, expression)) {
-      for (std::size_t i = 0; i < parser.error_count(); ++i) {
-        error_t error = parser.get_error(i);
-        spdlog::error(
-            "Error: {} Position: {} Type: [{}] Message: {} Expression: {}", i,
-            error.token.position,
-            exprtk::parser_error::to_str(error.mode).c_str(),
-            error.diagnostic.c_str(), expression_str.c_str());
-      }
+                                  const map<string, E> &value_map, E &result) {
+    compiled_expression_ptr compiled = compile(expression_str);
+    if (!compiled->evaluate(value_map, result)) {
+      spdlog::error("Error: failed to evaluate expression {}\n",
+                    expression_str.c_str());
       return false;
     }
-
-    typedef
-        typename parser_t::dependent_entity_collector::symbol_t dec_symbol_t;
-    std::deque<dec_symbol_t> symbol_list;
-    parser.dec().symbols(symbol_list);
-    // allow only variables and the function not()
-    for (std::size_t i = 0; i < symbol_list.size(); ++i) {
-      if (exprtk::details::imatch(symbol_list[i].first, "not")) {
-        symbol_list.erase(symbol_list.begin() + i);
-
-        if (i >= symbol_list.size()) break;
-      }
-      if (parser_t::e_st_function == symbol_list[i].second) {
-        spdlog::error("Error: call to function '{}' not allowed.\n",
-                      symbol_list[i].first.c_str());
-        return false;
-      }
-    }
-
-    for (auto &s : symbol_list) {
-      // DBG spdlog::info("Symbol {} \n", (s.first).c_str());
-      auto it = value_map.find(s.first);
-      if (end(value_map) != it) continue;
-      cout << "Enter the missing value of symbol " << s.first << ": ";
-      cin >> value_map[s.first];
-    }
-    for (auto &s : value_map) {
-      spdlog::info("{}  : {}", s.first, s.second);
-      set_symbol(s.first, symbol_table, s.second);
+    return true;
+  }
+  /**
+   * @brief Evaluates the expression once per value map, compiling it once.
+   *
+   * @param expression_str The expression string to evaluate.
+   * @param value_maps The symbol values of each evaluation.
+   * @param results The results, in the order of the value maps.
+   * @return True if all the evaluations succeeded, false otherwise.
+   */
+  static bool evaluate_batch(const std::string &expression_str,
+                             const std::vector<map<string, E>> &value_maps,
+                             std::vector<E> &results) {
+    compiled_expression_ptr compiled = compile(expression_str);
+    if (!compiled->evaluate(value_maps, results)) {
+      spdlog::error("Error: failed to evaluate expression {}\n",
+                    expression_str.c_str());
+      return false;
     }
-    result = static_cast<E>(expression.value());
     return true;
   }
   /**
@@ -170,52 +316,9 @@ class rs_expression_evaluator {
    */
   static bool symbols_of_expression(const std::string &expression_str,
                                     std::set<std::string> &res) {
-    typedef exprtk::symbol_table<T> symbol_table_t;
-    typedef exprtk::expression<T> expression_t;
-    typedef exprtk::parser<T> parser_t;
-    typedef exprtk::parser_error::type error_t;
-    typedef typename parser_t::settings_store settings_t;
-    symbol_table_t symbol_table;
-    expression_t expression;
-    expression.register_symbol_table(symbol_table);
-    parser_t parser(settings_t(settings_t::compile_all_opts +
-                               settings_t::e_disable_usr_on_rsrvd)
-                        .disable_all_base_functions()
-                        .disable_all_control_structures());
-    parser.enable_unknown_symbol_resolver();
-    parser.dec().collect_variables() = true;
-    parser.dec().collect_functions() = true;
-    if (!parser.compile(expression_str, expression)) {
-      for (std::size_t i = 0; i < parser.error_count(); ++i) {
-        error_t error = parser.get_error(i);
-        spdlog::error(
-            "Error: {} Position: {} Type: [{}] Message: {} Expression: {}", i,
-            error.token.position,
-            exprtk::parser_error::to_str(error.mode).c_str(),
-            error.diagnostic.c_str(), expression_str.c_str());
-      }
-      return false;
-    }
-
-    typedef
-        typename parser_t::dependent_entity_collector::symbol_t dec_symbol_t;
-    std::deque<dec_symbol_t> symbol_list;
-    parser.dec().symbols(symbol_list);
-    // allow only variables and the function not()
-    for (std::size_t i = 0; i < symbol_list.size(); ++i) {
-      if (exprtk::details::imatch(symbol_list[i].first, "not")) {
-        symbol_list.erase(symbol_list.begin() + i);
-        if (i >= symbol_list.size()) break;
-      }
-      if (parser_t::e_st_function == symbol_list[i].second) {
-        spdlog::error("Error: call to function '{}' not allowed.\n",
-                      symbol_list[i].first.c_str());
-        return false;
-      }
-    }
-    for (auto &s : symbol_list) {
-      res.insert(s.first);
-    }
+    compiled_expression_ptr compiled = compile(expression_str);
+    if (!compiled->is_valid()) return false;
+    res.insert(compiled->symbols().begin(), compiled->symbols().end());
     return true;
   }
   /**
@@ -239,7 +342,7 @@ class rs_expression_evaluator {
    * @param value_map A map of symbol names and their corresponding values.
    * @return True if the expression is successfully evaluated, false otherwise.
    */
-  bool evaluate(map<string, E> &value_map) {
+  bool evaluate(const map<string, E> &value_map) {
     return evaluated_ = evaluate_expression(expr_str_, value_map, value_);
   }
   /**
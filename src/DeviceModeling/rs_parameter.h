@@ -31,6 +31,8 @@ class Parameter {
   std::optional<unsigned> address_;
   std::optional<unsigned> size_;
 
+  friend class device_snapshot;
+
  public:
   /**
    * @brief Construct a new Parameter object
@@ -69,6 +69,8 @@ class ParameterType {
    */
   std::unordered_map<std::string, unsigned int> enum_values_;
 
+  friend class device_snapshot;
+
  public:
   /**
    * @brief Default constructor.
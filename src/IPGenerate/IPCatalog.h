@@ -23,6 +23,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <map>
 #include <string>
@@ -279,18 +280,40 @@ class IPDefinition {
     m_filePath = filePath;
     m_connections = connections;
     m_parameters = parameters;
+    m_loader = nullptr;
   }
   ~IPDefinition() {}
   IPType Type() const { return m_type; }
   const std::string& Name() const { return m_name; }
-  const std::string& BuildName() const { return m_build_name; }
-  const std::vector<Connector*>& Connections() const { return m_connections; }
+  const std::string& BuildName() const {
+    load();
+    return m_build_name;
+  }
+  const std::vector<Connector*>& Connections() const {
+    load();
+    return m_connections;
+  }
   const std::filesystem::path FilePath() const { return m_filePath; }
-  const std::vector<Value*> Parameters() const { return m_parameters; }
-  bool Valid() const { return m_valid; }
+  const std::vector<Value*> Parameters() const {
+    load();
+    return m_parameters;
+  }
+  bool Valid() const {
+    load();
+    return m_valid;
+  }
   void Valid(bool valid) { m_valid = valid; }
+  // Completes an invalid definition the first time it is used
+  void Loader(const std::function<void()>& loader) { m_loader = loader; }
 
  private:
+  void load() const {
+    if (!m_loader) return;
+    std::function<void()> loader{nullptr};
+    loader.swap(m_loader);
+    loader();
+  }
+
   IPType m_type;
   std::string m_name;
   std::string m_build_name;
@@ -298,6 +321,7 @@ class IPDefinition {
   std::vector<Connector*> m_connections;
   std::vector<Value*> m_parameters;
   bool m_valid{true};
+  mutable std::function<void()> m_loader{nullptr};
 };
 
 class IPInstance {
@@ -26,6 +26,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QDebug>
 #include <QProcess>
+#include <atomic>
 #include <chrono>
 #include <ctime>
 #include <filesystem>
@@ -35,6 +36,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "Compiler/Log.h"
 #include "Compiler/WorkerThread.h"
+#include "IPGenerate/IPCatalogIndex.h"
 #include "MainWindow/Session.h"
 #include "Utils/FileUtils.h"
 #include "Utils/StringUtils.h"
@@ -68,13 +70,13 @@ bool IPCatalogBuilder::buildLiteXCatalog(
     bool namesOnly) {
   bool result = true;
   if (FileUtils::FileExists(litexIPgenPath)) {
-    int foundCount = 0;
     std::filesystem::path execPath = litexIPgenPath;
     if (!std::filesystem::is_directory(execPath)) {
       execPath = execPath.parent_path();
     }
     m_compiler->Message("IP Catalog, browsing directory for IP generator(s): " +
                         execPath.string());
+    std::vector<std::filesystem::path> generators;
     for (const std::filesystem::path& entry :
          std::filesystem::recursive_directory_iterator(
              execPath,
@@ -82,16 +84,40 @@ bool IPCatalogBuilder::buildLiteXCatalog(
       const std::string& exec_name = entry.string();
       if (exec_name.find("__init__.py") != std::string::npos) continue;
       if (exec_name.find("_gen.py") != std::string::npos) {
-        foundCount++;
-        bool res = namesOnly ? buildLiteXIPFromGeneratorInternal(catalog, entry)
-                             : buildLiteXIPFromGenerator(catalog, entry);
-        if (res == false) {
-          result = false;
-        }
+        generators.push_back(entry);
       }
     }
-    std::string msg =
-        std::string("IP Catalog, found ") + std::to_string(foundCount) + " IPs";
+
+    // Json templates of unchanged generators come from the catalog index,
+    // python only runs for the other ones
+    IPCatalogIndex index{IPCatalogIndex::defaultIndexFile()};
+    std::filesystem::path pythonPath = findPythonPath(false);
+    std::vector<std::string> templates(generators.size());
+    std::vector<bool> indexed(generators.size(), false);
+    std::vector<size_t> stale;
+    for (size_t i = 0; i < generators.size(); i++) {
+      indexed[i] = index.lookup(generators[i], pythonPath.string(),
+                                templates[i]);
+      if (!indexed[i]) stale.push_back(i);
+    }
+    if (!namesOnly && !stale.empty()) {
+      pythonPath = findPythonPath(true);
+      result &= queryGenerators(catalog, pythonPath, generators, stale,
+                                templates, indexed, index);
+    }
+    index.save();
+
+    // Definitions are completed on first use
+    for (size_t i = 0; i < generators.size(); i++) {
+      if (indexed[i]) {
+        buildLiteXIPFromIndex(catalog, generators[i], templates[i],
+                              pythonPath);
+      } else if (namesOnly) {
+        result &= buildLiteXIPFromGeneratorInternal(catalog, generators[i]);
+      }
+    }
+    std::string msg = std::string("IP Catalog, found ") +
+                      std::to_string(generators.size()) + " IPs";
     m_compiler->Message(msg);
   } else {
     result = false;
@@ -101,6 +127,55 @@ bool IPCatalogBuilder::buildLiteXCatalog(
   return result;
 }
 
+bool IPCatalogBuilder::queryGenerators(
+    IPCatalog* catalog, const std::filesystem::path& pythonPath,
+    const std::vector<std::filesystem::path>& generators,
+    const std::vector<size_t>& stale, std::vector<std::string>& templates,
+    std::vector<bool>& indexed, IPCatalogIndex& index) {
+  // Generators are independent, they run on a pool of threads
+  std::vector<int> status(stale.size(), 0);
+  std::vector<std::string> output(stale.size());
+  std::atomic<size_t> next{0};
+  auto worker = [&]() {
+    for (size_t i = next++; i < stale.size(); i = next++) {
+      StringVector args{generators[stale[i]].string(), "--json-template"};
+      std::ostringstream help;
+      status[i] =
+          FileUtils::ExecuteSystemCommand(pythonPath.string(), args, &help)
+              .code;
+      output[i] = help.str();
+    }
+  };
+  const size_t threadCount = std::min<size_t>(
+      std::max(1u, std::thread::hardware_concurrency()), stale.size());
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < threadCount; i++) threads.emplace_back(worker);
+  for (auto& thread : threads) thread.join();
+
+  bool result = true;
+  for (size_t i = 0; i < stale.size(); i++) {
+    const std::filesystem::path& generator = generators[stale[i]];
+    if (status[i]) {
+      m_compiler->ErrorMessage("IP Catalog, no IP information for " +
+                               generator.string() + "\n" + output[i]);
+      result = false;
+      continue;
+    }
+    json jopts = json::parse(output[i], nullptr, false);
+    if (jopts.is_discarded() || jopts.empty()) {
+      // Not indexed, the error is reported while building the definition
+      std::string command = pythonPath.string() + " " + generator.string() +
+                            " --json-template";
+      result &= buildLiteXIPFromJson(catalog, generator, output[i], command);
+      continue;
+    }
+    index.update(generator, pythonPath.string(), output[i]);
+    templates[stale[i]] = output[i];
+    indexed[stale[i]] = true;
+  }
+  return result;
+}
+
 static std::string& rtrim(std::string& str, char c) {
   auto it1 = std::find_if(str.rbegin(), str.rend(),
                           [c](char ch) { return (ch == c); });
@@ -108,6 +183,24 @@ static std::string& rtrim(std::string& str, char c) {
   return str;
 }
 
+// IP name is the generator name without _gen, followed by the version
+static std::string getIPName(const std::filesystem::path& generator) {
+  std::filesystem::path basepath = FileUtils::Basename(generator);
+  std::string basename = basepath.string();
+  std::string IPName = rtrim(basename, '.');
+
+  // Remove _gen from IPName
+  std::string suffix = "_gen";
+  if (StringUtils::endsWith(IPName, suffix)) {
+    IPName.erase(IPName.length() - suffix.length());
+  }
+
+  // Add version number to IPName
+  auto info = FOEDAG::getIpInfoFromPath(generator);
+  IPName += "_" + info.version;
+  return IPName;
+}
+
 std::vector<std::string> JsonArrayToStringVector(
     const json& jsonArray, bool removeOuterQuotes = true) {
   std::vector<std::string> vals{};
@@ -131,31 +224,40 @@ std::vector<std::string> JsonArrayToStringVector(
   return vals;
 }
 
-bool IPCatalogBuilder::buildLiteXIPFromGenerator(
-    IPCatalog* catalog, const std::filesystem::path& pythonConverterScript) {
+std::filesystem::path IPCatalogBuilder::findPythonPath(bool report) {
   // Find path to litex enabled python interpreter
   std::filesystem::path pythonPath = IPCatalog::getPythonPath();
   if (pythonPath.empty()) {
     std::filesystem::path python3Path = FileUtils::LocateExecFile("python3");
     if (python3Path.empty()) {
-      m_compiler->ErrorMessage(
-          "IP Catalog, unable to find python interpreter in local "
-          "environment, trying to use system copy 'python3'. Some IP Catalog "
-          "features might not work with this "
-          "interpreter.\n");
+      if (report) {
+        m_compiler->ErrorMessage(
+            "IP Catalog, unable to find python interpreter in local "
+            "environment, trying to use system copy 'python3'. Some IP "
+            "Catalog features might not work with this "
+            "interpreter.\n");
+      }
 
       // don't specify a path and hope the system finds something in its path
       pythonPath = "python3";
     } else {
       pythonPath = python3Path;
-      m_compiler->ErrorMessage(
-          "IP Catalog, unable to find python interpreter in local "
-          "environment, using system copy '" +
-          python3Path.string() +
-          "'. Some IP Catalog features might not work with this "
-          "interpreter.\n");
+      if (report) {
+        m_compiler->ErrorMessage(
+            "IP Catalog, unable to find python interpreter in local "
+            "environment, using system copy '" +
+            python3Path.string() +
+            "'. Some IP Catalog features might not work with this "
+            "interpreter.\n");
+      }
     }
   }
+  return pythonPath;
+}
+
+bool IPCatalogBuilder::buildLiteXIPFromGenerator(
+    IPCatalog* catalog, const std::filesystem::path& pythonConverterScript) {
+  std::filesystem::path pythonPath = findPythonPath(true);
 
   std::ostringstream help;
   std::string command = pythonPath.string() + " " +
@@ -199,19 +301,7 @@ bool IPCatalogBuilder::buildLiteXIPFromJson(
     return false;
   }
 
-  std::filesystem::path basepath = FileUtils::Basename(pythonConverterScript);
-  std::string basename = basepath.string();
-  std::string IPName = rtrim(basename, '.');
-
-  // Remove _gen from IPName
-  std::string suffix = "_gen";
-  if (StringUtils::endsWith(IPName, suffix)) {
-    IPName.erase(IPName.length() - suffix.length());
-  }
-
-  // Add version number to IPName
-  auto info = FOEDAG::getIpInfoFromPath(pythonConverterScript);
-  IPName += "_" + info.version;
+  std::string IPName = getIPName(pythonConverterScript);
 
   std::vector<Value*> parameters;
   std::vector<Connector*> connections;
@@ -301,19 +391,7 @@ bool IPCatalogBuilder::buildLiteXIPFromGeneratorInternal(
   std::ostringstream help;
   std::string command;
 
-  std::filesystem::path basepath = FileUtils::Basename(pythonConverterScript);
-  std::string basename = basepath.string();
-  std::string IPName = rtrim(basename, '.');
-
-  // Remove _gen from IPName
-  std::string suffix = "_gen";
-  if (StringUtils::endsWith(IPName, suffix)) {
-    IPName.erase(IPName.length() - suffix.length());
-  }
-
-  // Add version number to IPName
-  auto info = FOEDAG::getIpInfoFromPath(pythonConverterScript);
-  IPName += "_" + info.version;
+  std::string IPName = getIPName(pythonConverterScript);
 
   IPDefinition* def =
       new IPDefinition(IPDefinition::IPType::LiteXGenerator, IPName,
@@ -322,3 +400,24 @@ bool IPCatalogBuilder::buildLiteXIPFromGeneratorInternal(
   catalog->addIP(def);
   return result;
 }
+
+void IPCatalogBuilder::buildLiteXIPFromIndex(
+    IPCatalog* catalog, const std::filesystem::path& pythonConverterScript,
+    const std::string& jsonStr, const std::filesystem::path& pythonPath) {
+  std::string IPName = getIPName(pythonConverterScript);
+  IPDefinition* def = catalog->Definition(IPName);
+  if (def == nullptr) {
+    def = new IPDefinition(IPDefinition::IPType::LiteXGenerator, IPName,
+                           std::string{}, pythonConverterScript, {}, {});
+    catalog->addIP(def);
+  }
+  def->Valid(false);
+  std::string command = pythonPath.string() + " " +
+                        pythonConverterScript.string() + " --json-template";
+  Compiler* compiler = m_compiler;
+  def->Loader([compiler, catalog, pythonConverterScript, jsonStr, command]() {
+    IPCatalogBuilder builder{compiler};
+    builder.buildLiteXIPFromJson(catalog, pythonConverterScript, jsonStr,
+                                 command);
+  });
+}
@@ -31,6 +31,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 namespace FOEDAG {
 class Compiler;
+class IPCatalogIndex;
 
 class IPCatalogBuilder {
  public:
@@ -52,6 +53,19 @@ class IPCatalogBuilder {
  protected:
   bool buildLiteXIPFromGeneratorInternal(
       IPCatalog* catalog, const std::filesystem::path& pythonConverterScript);
+  // Definition built from the indexed json template when first used
+  void buildLiteXIPFromIndex(IPCatalog* catalog,
+                             const std::filesystem::path& pythonConverterScript,
+                             const std::string& jsonStr,
+                             const std::filesystem::path& pythonPath);
+  // Runs the stale generators in parallel and indexes their json template
+  bool queryGenerators(IPCatalog* catalog,
+                       const std::filesystem::path& pythonPath,
+                       const std::vector<std::filesystem::path>& generators,
+                       const std::vector<size_t>& stale,
+                       std::vector<std::string>& templates,
+                       std::vector<bool>& indexed, IPCatalogIndex& index);
+  std::filesystem::path findPythonPath(bool report);
   Compiler* m_compiler = nullptr;
 };
 
@@ -0,0 +1,145 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "IPCatalogIndex.h"
+
+#include <QCoreApplication>
+#include <fstream>
+#include <iomanip>
+
+#include "Compiler/FingerprintDatabase.h"
+#include "IPGenerate/IPGenerator.h"
+#include "Utils/FileUtils.h"
+#include "nlohmann_json/json.hpp"
+
+using json = nlohmann::ordered_json;
+
+namespace FOEDAG {
+
+static constexpr int kIndexVersion{1};
+
+IPCatalogIndex::IPCatalogIndex(const std::filesystem::path& indexFile)
+    : m_indexFile(indexFile) {}
+
+std::filesystem::path IPCatalogIndex::defaultIndexFile() {
+  auto cache = IPGenerator::GetUserCachePath();
+  if (cache.empty()) return {};
+  return cache / "ip_catalog_index.json";
+}
+
+bool IPCatalogIndex::lookup(const std::filesystem::path& generator,
+                            const std::string& python, std::string& jsonStr) {
+  load();
+  auto it = m_entries.find(FileUtils::GetFullPath(generator).string());
+  if (it == m_entries.end() || it->second.python != python) return false;
+  int64_t mtime{-1};
+  uint64_t size{0};
+  if (!stamp(generator, mtime, size)) return false;
+  Entry& entry = it->second;
+  if (entry.mtime != mtime || entry.size != size) {
+    // Touched generator, still up to date if the content is the same
+    auto hash =
+        FingerprintDatabase::textHash(FileUtils::GetFileContent(generator));
+    if (hash != entry.hash) return false;
+    entry.mtime = mtime;
+    entry.size = size;
+    m_modified = true;
+  }
+  jsonStr = entry.json;
+  return true;
+}
+
+void IPCatalogIndex::update(const std::filesystem::path& generator,
+                            const std::string& python,
+                            const std::string& jsonStr) {
+  load();
+  Entry entry;
+  if (!stamp(generator, entry.mtime, entry.size)) return;
+  entry.hash =
+      FingerprintDatabase::textHash(FileUtils::GetFileContent(generator));
+  entry.python = python;
+  entry.json = jsonStr;
+  m_entries[FileUtils::GetFullPath(generator).string()] = entry;
+  m_modified = true;
+}
+
+bool IPCatalogIndex::save() {
+  if (!m_modified) return true;
+  if (m_indexFile.empty()) return false;
+  json data;
+  data["version"] = kIndexVersion;
+  json generators = json::object();
+  for (const auto& [path, entry] : m_entries) {
+    generators[path] = {{"mtime", entry.mtime},
+                        {"size", entry.size},
+                        {"hash", entry.hash},
+                        {"python", entry.python},
+                        {"json", entry.json}};
+  }
+  data["generators"] = generators;
+  std::error_code ec;
+  std::filesystem::create_directories(m_indexFile.parent_path(), ec);
+  // Written aside and renamed, other processes only read complete indexes
+  auto tmp = m_indexFile;
+  tmp += ".tmp" + std::to_string(QCoreApplication::applicationPid());
+  std::ofstream stream{tmp};
+  if (!stream.good()) return false;
+  stream << std::setw(2) << data;
+  stream.close();
+  std::filesystem::rename(tmp, m_indexFile, ec);
+  if (ec) {
+    std::filesystem::remove(tmp, ec);
+    return false;
+  }
+  m_modified = false;
+  return true;
+}
+
+void IPCatalogIndex::load() {
+  if (m_loaded) return;
+  m_loaded = true;
+  if (m_indexFile.empty() || !FileUtils::FileExists(m_indexFile)) return;
+  std::ifstream stream{m_indexFile};
+  json data = json::parse(stream, nullptr, false);
+  if (data.is_discarded() || !data.is_object() ||
+      data.value("version", 0) != kIndexVersion)
+    return;  // unreadable or outdated index, every generator is queried
+  const json generators = data.value("generators", json::object());
+  for (const auto& [path, entry] : generators.items()) {
+    m_entries[path] = Entry{entry.value("mtime", int64_t{-1}),
+                            entry.value("size", uint64_t{0}),
+                            entry.value("hash", std::string{}),
+                            entry.value("python", std::string{}),
+                            entry.value("json", std::string{})};
+  }
+}
+
+bool IPCatalogIndex::stamp(const std::filesystem::path& file, int64_t& mtime,
+                           uint64_t& size) {
+  std::error_code ec;
+  size = std::filesystem::file_size(file, ec);
+  if (ec) return false;
+  auto time = std::filesystem::last_write_time(file, ec);
+  if (ec) return false;
+  mtime = time.time_since_epoch().count();
+  return true;
+}
+
+}  // namespace FOEDAG
@@ -0,0 +1,72 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+
+namespace FOEDAG {
+
+/*!
+ * \brief The IPCatalogIndex class
+ * On-disk index of the IP catalog: the json template printed by every LiteX
+ * IP generator, so that python is only started for new or modified
+ * generators. An entry is keyed by the generator path and is up to date as
+ * long as the generator content and the python interpreter are the same.
+ * Generator content is only hashed again when its mtime or size changed.
+ */
+class IPCatalogIndex {
+ public:
+  IPCatalogIndex() = default;
+  explicit IPCatalogIndex(const std::filesystem::path& indexFile);
+
+  // Default index file, in the user level IP cache. Empty if disabled
+  static std::filesystem::path defaultIndexFile();
+  const std::filesystem::path& indexFile() const { return m_indexFile; }
+
+  // Json template of the generator if its entry is up to date
+  bool lookup(const std::filesystem::path& generator,
+              const std::string& python, std::string& jsonStr);
+  void update(const std::filesystem::path& generator,
+              const std::string& python, const std::string& jsonStr);
+  bool save();
+
+ private:
+  struct Entry {
+    int64_t mtime{-1};
+    uint64_t size{0};
+    std::string hash;
+    std::string python;
+    std::string json;
+  };
+  void load();
+  static bool stamp(const std::filesystem::path& file, int64_t& mtime,
+                    uint64_t& size);
+
+  std::filesystem::path m_indexFile;
+  std::map<std::string, Entry> m_entries;
+  bool m_loaded{false};
+  bool m_modified{false};
+};
+
+}  // namespace FOEDAG
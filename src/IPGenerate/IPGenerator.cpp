@@ -24,8 +24,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#include <QCoreApplication>
 #include <QDebug>
 #include <QProcess>
+#include <QStandardPaths>
+#include <atomic>
 #include <chrono>
 #include <ctime>
 #include <filesystem>
@@ -34,6 +37,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <thread>
 
 #include "Compiler/Compiler.h"
+#include "Compiler/FingerprintDatabase.h"
 #include "Compiler/Log.h"
 #include "Compiler/WorkerThread.h"
 #include "IPGenerate/IPCatalog.h"
@@ -43,6 +47,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Utils/StringUtils.h"
 
 extern FOEDAG::Session* GlobalSession;
+extern const char* release_version;
+extern const char* foedag_git_hash;
 using namespace FOEDAG;
 using Time = std::chrono::high_resolution_clock;
 using ms = std::chrono::milliseconds;
@@ -74,8 +80,7 @@ bool IPGenerator::RegisterCommands(TclInterpreter* interp, bool batchMode) {
     }
     std::filesystem::path the_path = expandedFile;
     if (!the_path.is_absolute()) {
-      const auto& path = std::filesystem::current_path();
-      expandedFile = path / expandedFile;
+      expandedFile = compiler->WorkingDir() / expandedFile;
     }
     auto fn = [compiler, expandedFile]() -> bool {
       return compiler->BuildLiteXIPCatalog(expandedFile.lexically_normal());
@@ -425,6 +430,49 @@ void IPGenerator::DeleteIPInstance(const std::string& moduleName) {
   DeleteIPInstance(GetIPInstance(moduleName));
 }
 
+namespace {
+// LiteX IP which generator has to run
+struct IPGenerateJob {
+  IPInstance* instance{nullptr};
+  std::string key{};
+  std::filesystem::path jsonFile{};
+  std::filesystem::path logFile{};
+  std::filesystem::path workingDir{};
+  int status{0};
+  int64_t duration{0};
+};
+
+// Stands for the generator build_dir in IPs saved to the user cache
+constexpr const char* kCachedBuildDir{"${FOEDAG_IP_BUILD_DIR}"};
+
+// Copy a file or directory tree, replacing 'from' by 'to' in file contents
+void CopyReplacing(const std::filesystem::path& source,
+                   const std::filesystem::path& target,
+                   const std::string& from, const std::string& to,
+                   std::error_code& ec) {
+  if (std::filesystem::is_directory(source, ec)) {
+    std::filesystem::create_directories(target, ec);
+    for (const auto& entry : std::filesystem::directory_iterator(source, ec)) {
+      if (ec) return;
+      CopyReplacing(entry.path(), target / entry.path().filename(), from, to,
+                    ec);
+      if (ec) return;
+    }
+    return;
+  }
+  if (ec) return;
+  const std::string content = FileUtils::GetFileContent(source);
+  if (content.find(from) == std::string::npos) {
+    std::filesystem::copy_file(
+        source, target, std::filesystem::copy_options::overwrite_existing, ec);
+    return;
+  }
+  std::ofstream out{target, std::ios::binary | std::ios::trunc};
+  out << StringUtils::replaceAll(content, from, to);
+  if (!out) ec = std::make_error_code(std::errc::io_error);
+}
+}  // namespace
+
 bool IPGenerator::Generate() {
   bool status = true;
   Compiler* compiler = GetCompiler();
@@ -445,6 +493,10 @@ bool IPGenerator::Generate() {
     instances = m_instances;
   }
 
+  // IPs are prepared one by one, the generators are independent of each
+  // other and run on a pool of threads afterwards
+  std::vector<IPGenerateJob> jobs{};
+  std::filesystem::path pythonPath{};
   for (IPInstance* inst : instances) {
     // Create output directory
     const std::filesystem::path& out_path = inst->OutputFile();
@@ -458,76 +510,41 @@ bool IPGenerator::Generate() {
         break;
       }
       case IPDefinition::IPType::LiteXGenerator: {
-        const std::filesystem::path executable = def->FilePath();
         std::filesystem::path jsonFile = GetCachePath(inst);
-        std::stringstream previousbuffer;
+        std::string previous{};
         if (FileUtils::FileExists(jsonFile)) {
-          std::ifstream previous(jsonFile);
-          std::stringstream buffer;
-          previousbuffer << previous.rdbuf();
+          previous = FileUtils::GetFileContent(jsonFile);
         }
 
-        // Create directory path if it doesn't exist otherwise the following
-        // ofstream command will fail
-        FileUtils::MkDirs(jsonFile.parent_path());
-        std::ofstream jsonF(jsonFile);
-        jsonF << "{" << std::endl;
-        for (const auto& param : inst->Parameters()) {
-          std::string value;
-          // The configure_ip command loses type info because we go from full
-          // json meta data provided by the ip_catalog generators to a single
-          // -Pname=val argument in a tcl command line. As such, we'll use the
-          // ip catalog's definition for parameter type info
-          auto catalogParam = GetCatalogParam(inst, param.Name());
-          if (catalogParam) {
-            switch (catalogParam->GetType()) {
-              case Value::Type::ParamIpVal: {
-                value = param.GetSValue();
-                auto type = ((IPParameter*)catalogParam)->GetParamType();
-                if (type == IPParameter::ParamType::FilePath ||
-                    type == IPParameter::ParamType::String) {
-                  value = "\"" + value + "\"";
-                }
-                break;
-              }
-              case Value::Type::ParamString:
-                value = param.GetSValue();
-                value = "\"" + value + "\"";
-                break;
-              case Value::Type::ParamInt:
-                value = param.GetSValue();
-                break;
-              case Value::Type::ConstInt:
-                value = param.GetSValue();
-            }
-          }
-          jsonF << "   \"" << param.Name() << "\": " << value << ","
-                << std::endl;
-        }
-        jsonF << "   \"build_dir\": " << inst->OutputFile().parent_path() << ","
-              << std::endl;
-        jsonF << "   \"build_name\": " << inst->OutputFile().filename() << ","
-              << std::endl;
-        jsonF << "   \"build\": true," << std::endl;
-        jsonF << "   \"json\": \"" << jsonFile.filename().string() << "\","
-              << std::endl;
-        jsonF << "   \"json_template\": false" << std::endl;
-        jsonF << "}" << std::endl;
-        jsonF.close();
-        std::stringstream newbuffer;
-        if (FileUtils::FileExists(jsonFile)) {
-          std::ifstream newfile(jsonFile);
-          std::stringstream buffer;
-          newbuffer << newfile.rdbuf();
-        }
-        if (newbuffer.str() == previousbuffer.str()) {
+        std::filesystem::path buildDir = GetGeneratorBuildDir(inst);
+        std::ostringstream json;
+        json << "{" << std::endl;
+        json << GetParamsJson(inst);
+        json << "   \"build_dir\": " << buildDir << "," << std::endl;
+        json << "   \"build_name\": " << inst->OutputFile().filename() << ","
+             << std::endl;
+        json << "   \"build\": true," << std::endl;
+        json << "   \"json\": \"" << jsonFile.filename().string() << "\","
+             << std::endl;
+        json << "   \"json_template\": false" << std::endl;
+        json << "}" << std::endl;
+        if (json.str() == previous) {
           m_compiler->Message("IP Generate, reusing IP " +
                               GetBuildDir(inst).string());
           continue;
         }
 
+        // Create directory path if it doesn't exist otherwise the following
+        // ofstream command will fail
+        FileUtils::MkDirs(jsonFile.parent_path());
+        std::ofstream jsonF(jsonFile, std::ios::binary);
+        jsonF << json.str();
+        jsonF.close();
+
         // Find path to litex enabled python interpreter
-        std::filesystem::path pythonPath = IPCatalog::getPythonPath();
+        if (pythonPath.empty()) {
+          pythonPath = IPCatalog::getPythonPath();
+        }
         if (pythonPath.empty()) {
           std::filesystem::path python3Path =
               FileUtils::LocateExecFile("python3");
@@ -547,24 +564,195 @@ bool IPGenerator::Generate() {
           }
         }
 
-        StringVector args{executable.string(), "--build", "--json",
-                          FileUtils::GetFullPath(jsonFile).string()};
-        std::ostringstream help;
+        IPGenerateJob job;
+        job.instance = inst;
+        job.key = GetContentKey(inst, pythonPath);
+        job.jsonFile = FileUtils::GetFullPath(jsonFile);
+        job.logFile = GetLogPath(inst);
+        job.workingDir = job.jsonFile.parent_path();
+        if (!job.key.empty() && RestoreFromUserCache(inst, job.key)) {
+          m_compiler->Message("IP Generate, restored IP " +
+                              GetBuildDir(inst).string() + " from " +
+                              (GetUserCachePath() / job.key).string());
+          continue;
+        }
         m_compiler->Message("IP Generate, generating IP " +
                             GetBuildDir(inst).string());
-        if (FileUtils::ExecuteSystemCommand(pythonPath.string(), args, &help)
-                .code) {
-          m_compiler->ErrorMessage("IP Generate, " + help.str());
-          return false;
-        }
-
+        jobs.push_back(job);
         break;
       }
     }
   }
+
+  std::atomic<size_t> next{0};
+  auto worker = [&jobs, &next, &pythonPath]() {
+    for (size_t index = next++; index < jobs.size(); index = next++) {
+      IPGenerateJob& job = jobs[index];
+      const std::filesystem::path executable =
+          job.instance->Definition()->FilePath();
+      StringVector args{executable.string(), "--build", "--json",
+                        job.jsonFile.string()};
+      std::ofstream log{job.logFile};
+      auto start = Time::now();
+      job.status = FileUtils::ExecuteSystemCommand(pythonPath.string(), args,
+                                                   &log, -1,
+                                                   job.workingDir.string())
+                       .code;
+      job.duration =
+          std::chrono::duration_cast<ms>(Time::now() - start).count();
+    }
+  };
+  const size_t threadCount = std::min<size_t>(m_jobs, jobs.size());
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < threadCount; i++) threads.emplace_back(worker);
+  for (auto& thread : threads) thread.join();
+
+  for (const auto& job : jobs) {
+    if (job.status != 0) {
+      m_compiler->ErrorMessage("IP Generate, " +
+                               FileUtils::GetFileContent(job.logFile));
+      // Don't reuse the failed IP on next generate
+      FileUtils::removeFile(job.jsonFile);
+      status = false;
+      continue;
+    }
+    m_compiler->Message("IP Generate, generated IP " +
+                        GetBuildDir(job.instance).string() + " in " +
+                        std::to_string(job.duration) +
+                        " ms, log: " + job.logFile.string());
+    if (!job.key.empty()) SaveToUserCache(job.instance, job.key);
+  }
   return status;
 }
 
+std::string IPGenerator::GetParamsJson(IPInstance* instance) {
+  std::ostringstream json;
+  for (const auto& param : instance->Parameters()) {
+    std::string value;
+    // The configure_ip command loses type info because we go from full
+    // json meta data provided by the ip_catalog generators to a single
+    // -Pname=val argument in a tcl command line. As such, we'll use the
+    // ip catalog's definition for parameter type info
+    auto catalogParam = GetCatalogParam(instance, param.Name());
+    if (catalogParam) {
+      switch (catalogParam->GetType()) {
+        case Value::Type::ParamIpVal: {
+          value = param.GetSValue();
+          auto type = ((IPParameter*)catalogParam)->GetParamType();
+          if (type == IPParameter::ParamType::FilePath ||
+              type == IPParameter::ParamType::String) {
+            value = "\"" + value + "\"";
+          }
+          break;
+        }
+        case Value::Type::ParamString:
+          value = param.GetSValue();
+          value = "\"" + value + "\"";
+          break;
+        case Value::Type::ParamInt:
+          value = param.GetSValue();
+          break;
+        case Value::Type::ConstInt:
+          value = param.GetSValue();
+      }
+    }
+    json << "   \"" << param.Name() << "\": " << value << "," << std::endl;
+  }
+  return json.str();
+}
+
+std::string IPGenerator::GetContentKey(
+    IPInstance* instance, const std::filesystem::path& pythonPath) {
+  const std::filesystem::path executable = instance->Definition()->FilePath();
+  if (!FileUtils::FileIsRegular(executable)) return {};
+  // build_dir is left out, it only tells where the project is. Generated
+  // files embedding it are rewritten when saved to and restored from the
+  // user cache
+  std::ostringstream content;
+  content << "script: "
+          << FingerprintDatabase::textHash(
+                 FileUtils::GetFileContent(executable))
+          << std::endl;
+  content << "python: " << pythonPath.string() << std::endl;
+  content << "version: " << release_version << " " << foedag_git_hash
+          << std::endl;
+  content << "build_name: " << instance->OutputFile().filename() << std::endl;
+  content << GetParamsJson(instance);
+  return FingerprintDatabase::textHash(content.str());
+}
+
+std::filesystem::path IPGenerator::GetGeneratorBuildDir(
+    IPInstance* instance) const {
+  // The generator runs in the IP build dir, build_dir is absolute so that a
+  // relative -out_file still resolves from the compiler working dir
+  std::filesystem::path buildDir = instance->OutputFile().parent_path();
+  return buildDir.empty() ? m_compiler->WorkingDir()
+                          : m_compiler->WorkingDir() / buildDir;
+}
+
+std::filesystem::path IPGenerator::GetUserCachePath() {
+  if (const char* env = std::getenv("FOEDAG_IP_CACHE")) {
+    return std::filesystem::path{env};
+  }
+  QString cache =
+      QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+  if (cache.isEmpty()) return {};
+  return std::filesystem::path{cache.toStdString()} / "foedag" / "ip_cache";
+}
+
+bool IPGenerator::RestoreFromUserCache(IPInstance* instance,
+                                       const std::string& key) {
+  const std::filesystem::path userCache = GetUserCachePath();
+  const std::filesystem::path buildDir = GetBuildDir(instance);
+  if (userCache.empty() || buildDir.empty()) return false;
+  const std::filesystem::path entry = userCache / key;
+  if (!FileUtils::FileIsDirectory(entry)) return false;
+  std::error_code ec;
+  CopyReplacing(entry, buildDir, kCachedBuildDir,
+                GetGeneratorBuildDir(instance).string(), ec);
+  return !ec;
+}
+
+void IPGenerator::SaveToUserCache(IPInstance* instance,
+                                  const std::string& key) {
+  const std::filesystem::path userCache = GetUserCachePath();
+  const std::filesystem::path buildDir = GetBuildDir(instance);
+  if (userCache.empty() || buildDir.empty()) return;
+  const std::filesystem::path entry = userCache / key;
+  if (FileUtils::FileExists(entry)) return;
+  // The cache json and the log belong to the project, nothing is cached if
+  // the generator didn't write its output into the build dir
+  const std::filesystem::path jsonFile = GetCachePath(instance);
+  const std::filesystem::path logFile = GetLogPath(instance);
+  bool generated{false};
+  std::error_code ec;
+  for (const auto& file :
+       std::filesystem::recursive_directory_iterator(buildDir, ec)) {
+    if (file.is_regular_file() && file.path() != jsonFile &&
+        file.path() != logFile) {
+      generated = true;
+      break;
+    }
+  }
+  if (ec || !generated) return;
+  // Filled aside and renamed, other processes only see complete entries
+  const std::filesystem::path tmp =
+      userCache /
+      (key + ".tmp" + std::to_string(QCoreApplication::applicationPid()));
+  std::filesystem::remove_all(tmp, ec);
+  std::filesystem::create_directories(tmp, ec);
+  if (ec) return;
+  const std::string generatorBuildDir = GetGeneratorBuildDir(instance).string();
+  for (const auto& file : std::filesystem::directory_iterator(buildDir, ec)) {
+    if (ec) break;
+    if (file.path() == jsonFile || file.path() == logFile) continue;
+    CopyReplacing(file.path(), tmp / file.path().filename(), generatorBuildDir,
+                  kCachedBuildDir, ec);
+  }
+  if (!ec) std::filesystem::rename(tmp, entry, ec);
+  if (ec) std::filesystem::remove_all(tmp, ec);
+}
+
 std::pair<bool, std::string> IPGenerator::IsSimulateIpSupported(
     const std::string& name) const {
   auto it =
@@ -719,6 +907,13 @@ std::filesystem::path IPGenerator::GetMetaPath(
   return ipPath;
 }
 
+// Output of the last generator run of this IP
+std::filesystem::path IPGenerator::GetLogPath(IPInstance* instance) const {
+  std::filesystem::path buildDir = GetBuildDir(instance);
+  if (buildDir.empty()) return {};
+  return buildDir / (instance->ModuleName() + "_generate.log");
+}
+
 // This will return a vector of paths to ./*.json and ./src/* in a given IP
 // instance's build dir
 std::vector<std::filesystem::path> IPGenerator::GetDesignFiles(
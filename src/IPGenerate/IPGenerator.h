@@ -22,10 +22,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef IPGENERATOR_H
 #define IPGENERATOR_H
 
+#include <algorithm>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "IPGenerate/IPCatalog.h"
@@ -39,7 +42,9 @@ class IPInstance;
 class IPGenerator {
  public:
   IPGenerator(IPCatalog* catalog, Compiler* compiler)
-      : m_catalog(catalog), m_compiler(compiler) {}
+      : m_catalog(catalog),
+        m_compiler(compiler),
+        m_jobs(std::max(1u, std::thread::hardware_concurrency())) {}
   virtual ~IPGenerator() {}
   IPCatalog* Catalog() { return m_catalog; }
   Compiler* GetCompiler() { return m_compiler; }
@@ -57,11 +62,23 @@ class IPGenerator {
     m_instances.erase(m_instances.begin(), m_instances.end());
   }
   bool Generate();
+  // Number of IPs generated concurrently
+  void Jobs(uint32_t jobs) { m_jobs = jobs; }
+  uint32_t Jobs() const { return m_jobs; }
+  // Content key of a LiteX IP: generator script, parameters, build name and
+  // tool version. Empty if the generator script can't be read
+  std::string GetContentKey(IPInstance* instance,
+                            const std::filesystem::path& pythonPath);
+  // User level cache of generated IPs shared across projects, overridden by
+  // FOEDAG_IP_CACHE. Empty if the cache is disabled
+  static std::filesystem::path GetUserCachePath();
   std::pair<bool, std::string> IsSimulateIpSupported(
       const std::string& name) const;
   void SimulateIp(const std::string& name);
   std::pair<bool, std::string> OpenWaveForm(const std::string& name);
   std::filesystem::path GetBuildDir(IPInstance* instance) const;
+  // Absolute build_dir passed to the LiteX generator
+  std::filesystem::path GetGeneratorBuildDir(IPInstance* instance) const;
   std::filesystem::path GetSimDir(IPInstance* instance) const;
   std::filesystem::path GetSimArtifactsDir(IPInstance* instance) const;
   std::filesystem::path GetCachePath(IPInstance* instance) const;
@@ -74,14 +91,19 @@ class IPGenerator {
   std::vector<std::filesystem::path> GetDesignAndCacheFiles(
       IPInstance* instance);
   std::vector<std::filesystem::path> GetCacheFiles(IPInstance* instance);
+  std::filesystem::path GetLogPath(IPInstance* instance) const;
 
  protected:
   std::pair<bool, std::string> SimulateIpTcl(const std::string& name);
+  std::string GetParamsJson(IPInstance* instance);
+  bool RestoreFromUserCache(IPInstance* instance, const std::string& key);
+  void SaveToUserCache(IPInstance* instance, const std::string& key);
 
  protected:
   IPCatalog* m_catalog = nullptr;
   Compiler* m_compiler = nullptr;
   std::vector<IPInstance*> m_instances;
+  uint32_t m_jobs{1};
 };
 
 }  // namespace FOEDAG
@@ -34,7 +34,9 @@ FilterCriteriaConf::FilterCriteriaConf(const QString& criteria,
                                        bool caseSensetive, bool useRegExp)
     : m_criteria(criteria),
       m_caseSensetive(caseSensetive),
-      m_useRegExp(useRegExp) {}
+      m_useRegExp(useRegExp) {
+  compileRegExp();
+}
 
 bool FilterCriteriaConf::set(const FilterCriteriaConf& rhs) {
   bool is_changed = false;
@@ -50,7 +52,26 @@ bool FilterCriteriaConf::set(const FilterCriteriaConf& rhs) {
     m_useRegExp = rhs.m_useRegExp;
     is_changed = true;
   }
+  if (is_changed) {
+    compileRegExp();
+  }
   return is_changed;
 }
 
+bool FilterCriteriaConf::match(const QString& line) const {
+  if (m_useRegExp) {
+    return m_regExp.match(line).hasMatch();
+  }
+  return line.contains(m_criteria, caseSensetive());
+}
+
+void FilterCriteriaConf::compileRegExp() {
+  if (m_useRegExp) {
+    m_regExp.setPattern(m_criteria);
+    m_regExp.optimize();
+  } else {
+    m_regExp = QRegularExpression{};
+  }
+}
+
 }  // namespace FOEDAG
@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <QRegularExpression>
 #include <QString>
 
 namespace FOEDAG {
@@ -55,10 +56,17 @@ class FilterCriteriaConf {
 
   bool isSet() const { return !m_criteria.isEmpty(); }
 
+  // Checks the line against the criteria, the regular expression is compiled
+  // once per criteria change
+  bool match(const QString& line) const;
+
  private:
   QString m_criteria;
   bool m_caseSensetive = false;
   bool m_useRegExp = false;
+  QRegularExpression m_regExp;
+
+  void compileRegExp();
 };
 
 }  // namespace FOEDAG
\ No newline at end of file
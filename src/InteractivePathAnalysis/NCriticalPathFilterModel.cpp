@@ -30,6 +30,32 @@
 
 namespace FOEDAG {
 
+NCriticalPathFilterModel::~NCriticalPathFilterModel() {
+  stopBackgroundFilter();
+}
+
+void NCriticalPathFilterModel::setSourceModel(QAbstractItemModel* model) {
+  if (model == sourceModel()) {
+    return;
+  }
+  if (sourceModel()) {
+    disconnect(sourceModel(), nullptr, this, nullptr);
+  }
+  QSortFilterProxyModel::setSourceModel(model);
+  resetBackgroundFilter();
+  if (model) {
+    connect(model, &QAbstractItemModel::modelReset, this,
+            &NCriticalPathFilterModel::resetBackgroundFilter);
+    connect(model, &QAbstractItemModel::rowsInserted, this,
+            [this](const QModelIndex& parent) {
+              // only the paths are filtered, they are on the top level
+              if (!parent.isValid()) {
+                resetBackgroundFilter();
+              }
+            });
+  }
+}
+
 bool NCriticalPathFilterModel::setFilterCriteria(
     const FilterCriteriaConf& inputCriteriaConf,
     const FilterCriteriaConf& outputCriteriaConf) {
@@ -38,11 +64,113 @@ bool NCriticalPathFilterModel::setFilterCriteria(
 
   bool isChanged = isInputCriteriaChanged || isOutoutCriteriaChanged;
   if (isChanged) {
-    invalidateFilter();
+    if (isBackgroundFilterRequired()) {
+      // the previous result stays applied until the new one is ready
+      startBackgroundFilter();
+    } else {
+      stopBackgroundFilter();
+      m_acceptedRows.clear();
+      m_hasAcceptedRows = false;
+      invalidateFilter();
+    }
   }
   return isChanged;
 }
 
+bool NCriticalPathFilterModel::isBackgroundFilterRequired() const {
+  return sourceModel() &&
+         (m_inputCriteriaConf.isSet() || m_outputCriteriaConf.isSet()) &&
+         (sourceModel()->rowCount() >= BACKGROUND_FILTER_ROWS_MIN);
+}
+
+void NCriticalPathFilterModel::resetBackgroundFilter() {
+  stopBackgroundFilter();
+  m_acceptedRows.clear();
+  m_hasAcceptedRows = false;
+  if (isBackgroundFilterRequired()) {
+    startBackgroundFilter();
+  }
+}
+
+void NCriticalPathFilterModel::startBackgroundFilter() {
+  stopBackgroundFilter();
+
+  // Items belong to the GUI thread, the worker gets its own copy of the lines
+  const int rowsNum = sourceModel()->rowCount();
+  QStringList startPointLines;
+  QStringList endPointLines;
+  std::vector<char> isPath(rowsNum, 0);
+  startPointLines.reserve(rowsNum);
+  endPointLines.reserve(rowsNum);
+  for (int row = 0; row < rowsNum; ++row) {
+    NCriticalPathItem* item = static_cast<NCriticalPathItem*>(
+        sourceModel()->index(row, 0).internalPointer());
+    if (item && item->isPath()) {
+      isPath[row] = 1;
+      startPointLines.append(item->startPointLine());
+      endPointLines.append(item->endPointLine());
+    } else {
+      startPointLines.append(QString{});
+      endPointLines.append(QString{});
+    }
+  }
+
+  const int generation = m_filterGeneration.load();
+  m_filterThread = QThread::create(
+      [this, generation, inputCriteriaConf = m_inputCriteriaConf,
+       outputCriteriaConf = m_outputCriteriaConf,
+       startPointLines = std::move(startPointLines),
+       endPointLines = std::move(endPointLines), isPath = std::move(isPath),
+       chunkRows = static_cast<std::size_t>(BACKGROUND_FILTER_CHUNK_ROWS)]() {
+        std::vector<char> acceptedRows(isPath.size(), 1);
+        for (std::size_t row = 0; row < isPath.size(); ++row) {
+          if ((row % chunkRows == 0) &&
+              (generation != m_filterGeneration.load())) {
+            return;  // the result isn't needed anymore
+          }
+          if (isPath[row]) {
+            acceptedRows[row] = meetsCriteria(
+                inputCriteriaConf, outputCriteriaConf,
+                startPointLines.at(row), endPointLines.at(row));
+          }
+        }
+        QMetaObject::invokeMethod(
+            this,
+            [this, generation, acceptedRows]() mutable {
+              if (generation != m_filterGeneration.load()) {
+                return;
+              }
+              m_acceptedRows = std::move(acceptedRows);
+              m_hasAcceptedRows = true;
+              invalidateFilter();
+              emit backgroundFilterFinished();
+            },
+            Qt::QueuedConnection);
+      });
+  m_filterThread->start();
+}
+
+void NCriticalPathFilterModel::stopBackgroundFilter() {
+  // a result coming from the running thread is dropped
+  m_filterGeneration++;
+  if (m_filterThread) {
+    m_filterThread->wait();
+    delete m_filterThread;
+    m_filterThread = nullptr;
+  }
+}
+
+bool NCriticalPathFilterModel::meetsCriteria(
+    const FilterCriteriaConf& inputCriteriaConf,
+    const FilterCriteriaConf& outputCriteriaConf,
+    const QString& startPointLine, const QString& endPointLine) {
+  bool inputMeetsCriteria =
+      !inputCriteriaConf.isSet() || inputCriteriaConf.match(startPointLine);
+  bool outputMeetsCriteria =
+      !outputCriteriaConf.isSet() || outputCriteriaConf.match(endPointLine);
+  return inputMeetsCriteria && outputMeetsCriteria;
+}
+
 bool NCriticalPathFilterModel::filterAcceptsRow(
     int sourceRow, const QModelIndex& sourceParentIndex) const {
   QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParentIndex);
@@ -55,30 +183,15 @@ bool NCriticalPathFilterModel::filterAcceptsRow(
     return true;  // we don't apply filter on path segments for now
   }
 
-  bool inputMeetsCriteria = true;
-  if (m_inputCriteriaConf.isSet()) {
-    if (m_inputCriteriaConf.useRegExp()) {
-      QRegularExpression pattern(m_inputCriteriaConf.criteria());
-      return pattern.match(item->startPointLine()).hasMatch();
-    } else {
-      inputMeetsCriteria = item->startPointLine().contains(
-          m_inputCriteriaConf.criteria(), m_inputCriteriaConf.caseSensetive());
-    }
+  if (m_hasAcceptedRows && !sourceParentIndex.isValid() &&
+      (sourceRow < static_cast<int>(m_acceptedRows.size()))) {
+    return m_acceptedRows[sourceRow];
   }
-
-  bool outputMeetsCriteria = true;
-  if (m_outputCriteriaConf.isSet()) {
-    if (m_outputCriteriaConf.useRegExp()) {
-      QRegularExpression pattern(m_outputCriteriaConf.criteria());
-      return pattern.match(item->endPointLine()).hasMatch();
-    } else {
-      outputMeetsCriteria =
-          item->endPointLine().contains(m_outputCriteriaConf.criteria(),
-                                        m_outputCriteriaConf.caseSensetive());
-    }
+  if (isBackgroundFilterRequired()) {
+    return true;  // the path stays visible until the result is ready
   }
-
-  return inputMeetsCriteria && outputMeetsCriteria;
+  return meetsCriteria(m_inputCriteriaConf, m_outputCriteriaConf,
+                       item->startPointLine(), item->endPointLine());
 }
 
 void NCriticalPathFilterModel::clear() { resetFilterCriteria(); }
@@ -87,4 +200,4 @@ void NCriticalPathFilterModel::resetFilterCriteria() {
   setFilterCriteria(FilterCriteriaConf{}, FilterCriteriaConf{});
 }
 
-}  // namespace FOEDAG
\ No newline at end of file
+}  // namespace FOEDAG
\ No newline at end of file
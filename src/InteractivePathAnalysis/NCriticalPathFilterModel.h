@@ -27,22 +27,44 @@
 #pragma once
 
 #include <QSortFilterProxyModel>
+#include <QThread>
+#include <atomic>
+#include <vector>
 
 #include "FilterCriteriaConf.h"
 
 namespace FOEDAG {
+
+/**
+ * @brief Filter of the critical paths by their start and end points.
+ *
+ * When the source model holds many paths, the criteria are evaluated in a
+ * background thread. Until the result arrives the paths stay visible, then
+ * the filter is applied at once.
+ */
 class NCriticalPathFilterModel final : public QSortFilterProxyModel {
   Q_OBJECT
 
+  // number of top level source rows starting from which filtering goes to the
+  // background thread
+  const int BACKGROUND_FILTER_ROWS_MIN = 10000;
+  // how often the background thread checks if its result is still needed
+  const int BACKGROUND_FILTER_CHUNK_ROWS = 1024;
+
  public:
   explicit NCriticalPathFilterModel(QObject* parent = nullptr)
       : QSortFilterProxyModel(parent) {}
-  ~NCriticalPathFilterModel() override final = default;
+  ~NCriticalPathFilterModel() override final;
+
+  void setSourceModel(QAbstractItemModel* model) override final;
 
   bool setFilterCriteria(const FilterCriteriaConf& inputCriteria,
                          const FilterCriteriaConf& outputCriteria);
   void clear();
 
+ signals:
+  void backgroundFilterFinished();
+
  protected:
   bool filterAcceptsRow(
       int sourceRow, const QModelIndex& sourceParentIndex) const override final;
@@ -51,7 +73,20 @@ class NCriticalPathFilterModel final : public QSortFilterProxyModel {
   FilterCriteriaConf m_inputCriteriaConf;
   FilterCriteriaConf m_outputCriteriaConf;
 
+  QThread* m_filterThread = nullptr;
+  std::atomic<int> m_filterGeneration{0};
+  std::vector<char> m_acceptedRows;  // result of the background filter
+  bool m_hasAcceptedRows = false;
+
   void resetFilterCriteria();
+  bool isBackgroundFilterRequired() const;
+  void startBackgroundFilter();
+  void stopBackgroundFilter();
+  void resetBackgroundFilter();
+  static bool meetsCriteria(const FilterCriteriaConf& inputCriteriaConf,
+                            const FilterCriteriaConf& outputCriteriaConf,
+                            const QString& startPointLine,
+                            const QString& endPointLine);
 };
 
 }  // namespace FOEDAG
@@ -78,12 +78,53 @@ void NCriticalPathItem::deleteChildItems() {
     qDeleteAll(m_childItems);
     m_childItems.clear();
   }
+  m_pendingChildren.reset();
 }
 
 void NCriticalPathItem::appendChild(NCriticalPathItem* item) {
+  item->m_row = m_childItems.size();
   m_childItems.append(item);
 }
 
+void NCriticalPathItem::appendPendingChild(const QString& data,
+                                           const QString& val1,
+                                           const QString& val2, Type type,
+                                           int id, bool isSelectable) {
+  if (!m_pendingChildren) {
+    m_pendingChildren = std::make_unique<PendingChildren>();
+  }
+  m_pendingChildren->data.append(data);
+  m_pendingChildren->val1.append(val1);
+  m_pendingChildren->val2.append(val2);
+  m_pendingChildren->types.append(type);
+  m_pendingChildren->ids.append(id);
+  m_pendingChildren->isSelectable.append(isSelectable);
+}
+
+int NCriticalPathItem::pendingChildCount() const {
+  return m_pendingChildren ? m_pendingChildren->data.size() : 0;
+}
+
+void NCriticalPathItem::fetchPendingChildren(std::size_t lineCharsMaxNum) {
+  if (!m_pendingChildren) {
+    return;
+  }
+  const PendingChildren& pending = *m_pendingChildren;
+  m_childItems.reserve(m_childItems.size() + pending.data.size());
+  for (int i = 0; i < pending.data.size(); ++i) {
+    NCriticalPathItem* item = new NCriticalPathItem(
+        pending.data.at(i), pending.val1.at(i), pending.val2.at(i),
+        pending.types.at(i), pending.ids.at(i), m_id,
+        pending.isSelectable.at(i));
+    if (lineCharsMaxNum > 0) {
+      item->limitLineCharsNum(lineCharsMaxNum);
+    }
+    item->setParent(this);
+    appendChild(item);
+  }
+  m_pendingChildren.reset();
+}
+
 NCriticalPathItem* NCriticalPathItem::child(int row) {
   if ((row < 0) || (row >= m_childItems.size())) {
     return nullptr;
@@ -102,14 +143,7 @@ QVariant NCriticalPathItem::data(int column) const {
   return m_itemData.at(column);
 }
 
-int NCriticalPathItem::row() const {
-  if (m_parentItem) {
-    return m_parentItem->m_childItems.indexOf(
-        const_cast<NCriticalPathItem*>(this));
-  }
-
-  return 0;
-}
+int NCriticalPathItem::row() const { return m_parentItem ? m_row : 0; }
 
 bool NCriticalPathItem::limitLineCharsNum(std::size_t lineCharsMaxNum) {
   bool processData = false;
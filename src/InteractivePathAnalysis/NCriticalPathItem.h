@@ -27,8 +27,11 @@
 #pragma once
 
 #include <QString>
+#include <QStringList>
 #include <QVariant>
 #include <QVector>
+#include <memory>
+#include <optional>
 
 namespace FOEDAG {
 
@@ -44,6 +47,19 @@ class NCriticalPathItem {
 
   enum Type { PATH, PATH_ELEMENT, OTHER };
 
+  /**
+   * @brief Children of a path not turned into items yet, one column per
+   * item property. Items are created when the path is expanded or selected.
+   */
+  struct PendingChildren {
+    QStringList data;
+    QStringList val1;
+    QStringList val2;
+    QVector<Type> types;
+    QVector<int> ids;
+    QVector<bool> isSelectable;
+  };
+
   NCriticalPathItem();
   explicit NCriticalPathItem(const QString& data, const QString& val1,
                              const QString& val2, Type type, int id, int pathId,
@@ -63,6 +79,13 @@ class NCriticalPathItem {
 
   void appendChild(NCriticalPathItem* child);
 
+  void appendPendingChild(const QString& data, const QString& val1,
+                          const QString& val2, Type type, int id,
+                          bool isSelectable);
+  int pendingChildCount() const;
+  // Create items of the pending children, line chars limit is applied if set
+  void fetchPendingChildren(std::size_t lineCharsMaxNum = 0);
+
   int id() const { return m_id; }
   int pathIndex() const { return m_pathId; }
   Type type() const { return m_type; }
@@ -86,8 +109,10 @@ class NCriticalPathItem {
   std::optional<std::size_t> m_appliedLineCharsMaxNumOpt;
 
   QVector<NCriticalPathItem*> m_childItems;
+  std::unique_ptr<PendingChildren> m_pendingChildren;
   QVector<QVariant> m_itemData;
   NCriticalPathItem* m_parentItem = nullptr;
+  int m_row = 0;
   QString m_startPointLine;
   QString m_endPointLine;
 };
@@ -170,6 +170,41 @@ int NCriticalPathModel::rowCount(const QModelIndex& parent) const {
   return parentItem->childCount();
 }
 
+bool NCriticalPathModel::hasChildren(const QModelIndex& parent) const {
+  if (!parent.isValid()) {
+    return m_rootItem->childCount() > 0;
+  }
+  if (parent.column() > 0) {
+    return false;
+  }
+  NCriticalPathItem* parentItem =
+      static_cast<NCriticalPathItem*>(parent.internalPointer());
+  return (parentItem->childCount() > 0) ||
+         (parentItem->pendingChildCount() > 0);
+}
+
+bool NCriticalPathModel::canFetchMore(const QModelIndex& parent) const {
+  if (!parent.isValid() || (parent.column() > 0)) {
+    return false;
+  }
+  NCriticalPathItem* parentItem =
+      static_cast<NCriticalPathItem*>(parent.internalPointer());
+  return parentItem->pendingChildCount() > 0;
+}
+
+void NCriticalPathModel::fetchMore(const QModelIndex& parent) {
+  if (!canFetchMore(parent)) {
+    return;
+  }
+  NCriticalPathItem* parentItem =
+      static_cast<NCriticalPathItem*>(parent.internalPointer());
+  int first = parentItem->childCount();
+  int last = first + parentItem->pendingChildCount() - 1;
+  beginInsertRows(parent, first, last);
+  parentItem->fetchPendingChildren(m_lineCharsMaxNum);
+  endInsertRows();
+}
+
 void NCriticalPathModel::loadFromString(QString rawData) {
   NCriticalPathModelLoader* modelLoader =
       new NCriticalPathModelLoader(std::move(rawData));
@@ -183,9 +218,17 @@ void NCriticalPathModel::loadItems(
     const ItemsHelperStructPtr& itemsHelperStructPtr) {
   clear();
 
-  for (const auto& [item, rootItem] : itemsHelperStructPtr->items) {
-    insertNewItem(rootItem ? rootItem : m_rootItem, item);
+  // Children of the paths are created on demand, see fetchMore()
+  const std::vector<NCriticalPathItem*>& items = itemsHelperStructPtr->items;
+  if (!items.empty()) {
+    beginInsertRows(QModelIndex(), 0, static_cast<int>(items.size()) - 1);
+    for (NCriticalPathItem* item : items) {
+      item->setParent(m_rootItem);
+      m_rootItem->appendChild(item);
+    }
+    endInsertRows();
   }
+  itemsHelperStructPtr->items.clear();
 
   m_inputNodes = std::move(itemsHelperStructPtr->inputNodes);
   m_outputNodes = std::move(itemsHelperStructPtr->outputNodes);
@@ -196,39 +239,6 @@ void NCriticalPathModel::loadItems(
   SimpleLogger::instance().debug("load model finished");
 }
 
-int NCriticalPathModel::findRow(NCriticalPathItem* item) const {
-  NCriticalPathItem* parentItem = item->parentItem();
-  if (item && parentItem) {
-    for (int row = 0; row < parentItem->childCount(); ++row) {
-      if (parentItem->child(row) == item) {
-        return row;
-      }
-    }
-  }
-  return -1;  // Return -1 if item is the root or not found
-}
-
-int NCriticalPathModel::findColumn(NCriticalPathItem*) const {
-  return 0;  // assuming a single-column tree structure
-}
-
-void NCriticalPathModel::insertNewItem(NCriticalPathItem* parentItem,
-                                       NCriticalPathItem* newItem) {
-  newItem->setParent(parentItem);
-  int row = parentItem->childCount();
-  QModelIndex parentIndex;
-  if (parentItem != m_rootItem) {
-    int parentRow = findRow(parentItem);
-    int parentColumn = findColumn(parentItem);
-    parentIndex = createIndex(parentRow, parentColumn,
-                              const_cast<NCriticalPathItem*>(parentItem));
-  }
-
-  beginInsertRows(parentIndex, row, row);
-  parentItem->appendChild(newItem);
-  endInsertRows();
-}
-
 void NCriticalPathModel::limitLineCharsNum(std::size_t lineCharsMaxNum) {
   if (lineCharsMaxNum < LINE_CHAR_NUM_MIN) {
     lineCharsMaxNum = LINE_CHAR_NUM_MIN;
@@ -250,6 +260,7 @@ void NCriticalPathModel::applyLineCharsNum() {
       if (pathItem->limitLineCharsNum(m_lineCharsMaxNum)) {
         hasChanges = true;
       }
+      // pending children get the limit when they are fetched
       for (int eRow = 0; eRow < pathItem->childCount(); ++eRow) {
         NCriticalPathItem* elementItem = pathItem->child(eRow);
         if (elementItem->limitLineCharsNum(m_lineCharsMaxNum)) {
@@ -65,6 +65,10 @@ class NCriticalPathModel final : public QAbstractItemModel {
   int rowCount(const QModelIndex& parent = QModelIndex()) const override final;
   int columnCount(
       const QModelIndex& parent = QModelIndex()) const override final;
+  bool hasChildren(
+      const QModelIndex& parent = QModelIndex()) const override final;
+  bool canFetchMore(const QModelIndex& parent) const override final;
+  void fetchMore(const QModelIndex& parent) override final;
 
   bool isSelectable(const QModelIndex& index) const;
 
@@ -87,10 +91,6 @@ class NCriticalPathModel final : public QAbstractItemModel {
                               // requests into one
   std::size_t m_lineCharsMaxNum = 0;
 
-  void insertNewItem(NCriticalPathItem* parentItem, NCriticalPathItem* newItem);
-  int findRow(NCriticalPathItem*) const;
-  int findColumn(NCriticalPathItem*) const;
-
   void applyLineCharsNum();
 };
 
@@ -52,12 +52,10 @@ void NCriticalPathModelLoader::run() {
   }
 #endif
 
-  QList<QString> lines_ = m_rawData.split("\n");
-  std::vector<std::string> lines;
-  lines.reserve(lines_.size());
-  for (const QString& line : std::as_const(lines_)) {
-    lines.push_back(line.toStdString());
-  }
+  // One conversion of the whole report, lines are views into it
+  const std::string report = m_rawData.toStdString();
+  const std::vector<std::string_view> lines =
+      NCriticalPathReportParser::splitLines(report);
 
   std::vector<GroupPtr> groups = NCriticalPathReportParser::parseReport(lines);
 
@@ -124,8 +122,7 @@ void NCriticalPathModelLoader::createItems(
 
           currentPathItem = new NCriticalPathItem(data, val1, val2, type, id,
                                                   pathId, isSelectable);
-          itemsHelperStructPtr->items.emplace_back(
-              std::make_pair(currentPathItem, nullptr));
+          itemsHelperStructPtr->items.emplace_back(currentPathItem);
         } else if (role == SEGMENT) {
           if (currentPathItem) {
             NCriticalPathItem::Type type{NCriticalPathItem::PATH_ELEMENT};
@@ -146,10 +143,8 @@ void NCriticalPathModelLoader::createItems(
 
             int id = isSelectable ? selectableSegmentCounter : -1;
 
-            NCriticalPathItem* newItem = new NCriticalPathItem(
-                data, val1, val2, type, id, pathId, isSelectable);
-            itemsHelperStructPtr->items.emplace_back(
-                std::make_pair(newItem, currentPathItem));
+            currentPathItem->appendPendingChild(data, val1, val2, type, id,
+                                                isSelectable);
 
             segmentCounter++;
           } else {
@@ -159,13 +154,10 @@ void NCriticalPathModelLoader::createItems(
           if (currentPathItem) {
             NCriticalPathItem::Type type{NCriticalPathItem::OTHER};
             int id = -1;
-            int pathId = currentPathItem->id();
             bool isSelectable = false;
 
-            NCriticalPathItem* newItem = new NCriticalPathItem(
-                data, val1, val2, type, id, pathId, isSelectable);
-            itemsHelperStructPtr->items.emplace_back(
-                std::make_pair(newItem, currentPathItem));
+            currentPathItem->appendPendingChild(data, val1, val2, type, id,
+                                                isSelectable);
           } else {
             qCritical() << "path item is null";
           }
@@ -203,8 +195,7 @@ void NCriticalPathModelLoader::createItems(
 
           NCriticalPathItem* newItem = new NCriticalPathItem(
               data, val1, val2, type, id, pathId, isSelectable);
-          itemsHelperStructPtr->items.emplace_back(
-              std::make_pair(newItem, nullptr));
+          itemsHelperStructPtr->items.emplace_back(newItem);
         }
       }
     }
@@ -37,7 +37,8 @@ namespace FOEDAG {
 class NCriticalPathItem;
 
 struct ItemsHelperStruct {
-  std::vector<std::pair<NCriticalPathItem*, NCriticalPathItem*>> items;
+  // top level items, children of the paths are pending in the path items
+  std::vector<NCriticalPathItem*> items;
   std::map<QString, int> inputNodes;
   std::map<QString, int> outputNodes;
 };
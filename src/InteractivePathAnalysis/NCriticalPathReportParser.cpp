@@ -26,143 +26,285 @@
 
 #include "NCriticalPathReportParser.h"
 
-#include <iostream>
-#include <regex>
-#include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <thread>
 
 namespace FOEDAG {
 
-std::vector<GroupPtr> NCriticalPathReportParser::parseReport(
-    const std::vector<std::string>& lines) {
-  static std::regex pathPattern(R"(^\#Path (\d+)$)");
-  static std::regex startPointPattern(
-      R"(^Startpoint: (\w+(?:\[\d+\])?(\.\w+(?:\[\d+\])?)?))");
-  static std::regex endPointPattern(
-      R"(^Endpoint\s+: (\w+(?:\[\d+\])?(\.\w+(?:\[\d+\])?)?))");
-  static std::regex slackPattern(R"(^slack\s+\(VIOLATED\)\s+(-?\d+\.\d+)$)");
+namespace {
 
-  std::vector<GroupPtr> groups;
-  GroupPtr currentGroup = std::make_shared<Group>();
+constexpr std::string_view END_OF_REPORT{"#End of timing report"};
+constexpr std::string_view METADATA_BEGIN{"#RPT METADATA:"};
+// Smaller reports are parsed in the calling thread
+constexpr std::size_t MIN_PATHS_PER_CHUNK = 256;
 
-  bool isInsideSegment = false;
+bool isWordChar(char c) {
+  return ((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')) ||
+         ((c >= '0') && (c <= '9')) || (c == '_');
+}
+bool isDigit(char c) { return (c >= '0') && (c <= '9'); }
+bool isSpace(char c) {
+  return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\v') ||
+         (c == '\f') || (c == '\r');
+}
 
-  Role prevRole = Role::OTHER;
-  bool isEndReportReached = false;
-  for (const std::string& line : lines) {
-    bool isMultiColumn = true;
-    bool isEndPathElement = false;
+std::size_t skip(std::string_view line, std::size_t pos,
+                 bool (*predicate)(char)) {
+  while ((pos < line.size()) && predicate(line[pos])) pos++;
+  return pos;
+}
 
-    Role currentRole = Role::OTHER;
-    bool hasMatch = false;
-    if (line == "") {
-      currentRole = prevRole;
-      isMultiColumn = false;
-      hasMatch = true;
+// "[\d+]" at pos, return position after it or pos
+std::size_t skipIndex(std::string_view line, std::size_t pos) {
+  if ((pos < line.size()) && (line[pos] == '[')) {
+    std::size_t digitsEnd = skip(line, pos + 1, isDigit);
+    if ((digitsEnd > pos + 1) && (digitsEnd < line.size()) &&
+        (line[digitsEnd] == ']')) {
+      return digitsEnd + 1;
     }
+  }
+  return pos;
+}
 
-    if (!hasMatch) {
-      if (std::smatch m; std::regex_search(line, m, pathPattern)) {
-        if (m.size() > 1) {
-          groups.push_back(currentGroup);
-          currentGroup = std::make_shared<Group>();
-          currentGroup->pathInfo.index = std::atoi(m[1].str().c_str());
-          // std::cout << "\n\npath#" << m[1] << std::endl;
-          currentRole = Role::PATH;
-
-          isMultiColumn = false;
-          hasMatch = true;
-        }
-      }
-    }
+// \w+(?:\[\d+\])?(\.\w+(?:\[\d+\])?)? at pos, return its end or pos
+std::size_t skipPinName(std::string_view line, std::size_t pos) {
+  std::size_t end = skip(line, pos, isWordChar);
+  if (end == pos) {
+    return pos;
+  }
+  end = skipIndex(line, end);
+  if ((end + 1 < line.size()) && (line[end] == '.') &&
+      isWordChar(line[end + 1])) {
+    end = skipIndex(line, skip(line, end + 1, isWordChar));
+  }
+  return end;
+}
 
-    if (!hasMatch) {
-      if (std::smatch m; std::regex_search(line, m, slackPattern)) {
-        if (m.size() > 1) {
-          std::string val = m[1].str();
-          currentGroup->pathInfo.slack = val;
-          // std::cout << "slack=" << m[1] << std::endl;
-          hasMatch = true;
-        }
-      }
-    }
+// ^#Path (\d+)$
+bool matchPath(std::string_view line, int& index) {
+  constexpr std::string_view prefix{"#Path "};
+  if ((line.size() <= prefix.size()) ||
+      (line.compare(0, prefix.size(), prefix) != 0) ||
+      (skip(line, prefix.size(), isDigit) != line.size())) {
+    return false;
+  }
+  index = 0;
+  std::from_chars(line.data() + prefix.size(), line.data() + line.size(),
+                  index);
+  return true;
+}
 
-    if (!hasMatch) {
-      if (std::smatch m; std::regex_search(line, m, startPointPattern)) {
-        if (m.size() > 1) {
-          currentGroup->pathInfo.start = m[1].str();
-          // std::cout << "startpoint=" << m[1] << std::endl;
-          currentRole = Role::PATH;
-          hasMatch = true;
-        }
-      }
-    }
+// ^slack\s+\(VIOLATED\)\s+(-?\d+\.\d+)$
+bool matchSlack(std::string_view line, std::string_view& slack) {
+  constexpr std::string_view prefix{"slack"};
+  constexpr std::string_view violated{"(VIOLATED)"};
+  if (line.compare(0, prefix.size(), prefix) != 0) {
+    return false;
+  }
+  std::size_t pos = skip(line, prefix.size(), isSpace);
+  if ((pos == prefix.size()) ||
+      (line.compare(pos, violated.size(), violated) != 0)) {
+    return false;
+  }
+  std::size_t valueBegin = skip(line, pos + violated.size(), isSpace);
+  if (valueBegin == pos + violated.size()) {
+    return false;
+  }
+  pos = valueBegin;
+  if ((pos < line.size()) && (line[pos] == '-')) pos++;
+  std::size_t intEnd = skip(line, pos, isDigit);
+  if ((intEnd == pos) || (intEnd >= line.size()) || (line[intEnd] != '.')) {
+    return false;
+  }
+  std::size_t fracEnd = skip(line, intEnd + 1, isDigit);
+  if ((fracEnd == intEnd + 1) || (fracEnd != line.size())) {
+    return false;
+  }
+  slack = line.substr(valueBegin);
+  return true;
+}
 
-    if (!hasMatch) {
-      if (std::smatch m; std::regex_search(line, m, endPointPattern)) {
-        if (m.size() > 1) {
-          currentGroup->pathInfo.end = m[1].str();
-          // std::cout << "endpoint=" << m[1] << std::endl;
-          currentRole = Role::PATH;
-          hasMatch = true;
-        }
-      }
+// ^Startpoint: (pin name)
+bool matchStartPoint(std::string_view line, std::string_view& name) {
+  constexpr std::string_view prefix{"Startpoint: "};
+  if (line.compare(0, prefix.size(), prefix) != 0) {
+    return false;
+  }
+  std::size_t end = skipPinName(line, prefix.size());
+  name = line.substr(prefix.size(), end - prefix.size());
+  return !name.empty();
+}
+
+// ^Endpoint\s+: (pin name)
+bool matchEndPoint(std::string_view line, std::string_view& name) {
+  constexpr std::string_view prefix{"Endpoint"};
+  if (line.compare(0, prefix.size(), prefix) != 0) {
+    return false;
+  }
+  std::size_t pos = skip(line, prefix.size(), isSpace);
+  if ((pos == prefix.size()) || (line.compare(pos, 2, ": ") != 0)) {
+    return false;
+  }
+  pos += 2;
+  std::size_t end = skipPinName(line, pos);
+  name = line.substr(pos, end - pos);
+  return !name.empty();
+}
+
+std::vector<std::string_view> toViews(const std::vector<std::string>& lines) {
+  return std::vector<std::string_view>(lines.begin(), lines.end());
+}
+
+// istringstream >> int: leading spaces and an optional sign
+bool readInt(std::string_view line, std::size_t& pos, int& value) {
+  pos = skip(line, pos, isSpace);
+  if ((pos < line.size()) && (line[pos] == '+')) pos++;
+  auto [ptr, ec] =
+      std::from_chars(line.data() + pos, line.data() + line.size(), value);
+  if (ec != std::errc{}) {
+    return false;
+  }
+  pos = ptr - line.data();
+  return true;
+}
+
+bool readChar(std::string_view line, std::size_t& pos, char& c) {
+  pos = skip(line, pos, isSpace);
+  if (pos >= line.size()) {
+    return false;
+  }
+  c = line[pos++];
+  return true;
+}
+
+}  // namespace
+
+std::vector<GroupPtr> NCriticalPathReportParser::parseReport(
+    const std::vector<std::string>& lines) {
+  return parseReport(toViews(lines));
+}
+
+std::vector<GroupPtr> NCriticalPathReportParser::parseReport(
+    const std::vector<std::string_view>& lines, uint32_t jobs) {
+  // Chunks start at "#Path N" lines, nothing after the end of the report is
+  // parsed
+  std::vector<std::size_t> pathLines;
+  std::size_t end = lines.size();
+  for (std::size_t i = 0; i < lines.size(); i++) {
+    const std::string_view& line = lines[i];
+    if (line.empty() || (line[0] != '#')) {
+      continue;
     }
+    int index;
+    if (matchPath(line, index)) {
+      pathLines.push_back(i);
+    } else if (line == END_OF_REPORT) {
+      end = i + 1;
+      break;
+    }
+  }
 
-    //    if (!hasMatch) {
-    //        if (std::smatch m; std::regex_search(line, m, pathTypePattern)) {
-    //            currentRole = Role::PATH;
-    //            hasMatch = true;
-    //        }
-    //    }
-
-    if (!hasMatch) {
-      if (line.at(0) == '|') {
-        if (!isInsideSegment) {
-          isInsideSegment = true;
-        }
-        currentRole = Role::SEGMENT;
-        hasMatch = true;
-      }
+  if (jobs == 0) {
+    jobs = std::max(1u, std::thread::hardware_concurrency());
+  }
+  const std::size_t chunkNum = std::min<std::size_t>(
+      jobs * 4, pathLines.size() / MIN_PATHS_PER_CHUNK);
+  if ((jobs == 1) || (chunkNum < 2)) {
+    std::vector<GroupPtr> groups;
+    parseChunk(lines, 0, end, true, groups);
+    return groups;
+  }
+
+  std::vector<std::size_t> bounds{0};
+  for (std::size_t i = 1; i < chunkNum; i++) {
+    bounds.push_back(pathLines[i * pathLines.size() / chunkNum]);
+  }
+  bounds.push_back(end);
+
+  std::vector<std::vector<GroupPtr>> chunkGroups(chunkNum);
+  std::atomic<size_t> next{0};
+  auto worker = [&]() {
+    for (size_t chunk = next++; chunk < chunkNum; chunk = next++) {
+      parseChunk(lines, bounds[chunk], bounds[chunk + 1], chunk == 0,
+                 chunkGroups[chunk]);
     }
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < std::min<size_t>(jobs, chunkNum); i++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) thread.join();
 
-    if (!hasMatch) {
-      if ((line.find('[') != std::string::npos) &&
-          (line.find(']') != std::string::npos)) {
-        // std::cout << "segment=" << m[1] << std::endl;
+  std::vector<GroupPtr> groups;
+  for (auto& chunk : chunkGroups) {
+    groups.insert(groups.end(), std::make_move_iterator(chunk.begin()),
+                  std::make_move_iterator(chunk.end()));
+  }
+  return groups;
+}
 
-        currentRole = Role::SEGMENT;
+void NCriticalPathReportParser::parseChunk(
+    const std::vector<std::string_view>& lines, std::size_t begin,
+    std::size_t end, bool isFirst, std::vector<GroupPtr>& groups) {
+  GroupPtr currentGroup = std::make_shared<Group>();
 
-        isEndPathElement = true;
-        isInsideSegment = false;
-        hasMatch = true;
-      }
-    }
+  Role prevRole = Role::OTHER;
+  bool isEndReportReached = false;
+  for (std::size_t i = begin; i < end; i++) {
+    const std::string_view& line = lines[i];
+    bool isMultiColumn = true;
+    bool isEndPathElement = false;
 
-    if (!hasMatch) {
-      if (line == "#End of timing report") {
-        currentRole = Role::OTHER;
+    Role currentRole = Role::OTHER;
+    int pathIndex;
+    std::string_view value;
+    if (line.empty()) {
+      currentRole = prevRole;
+      isMultiColumn = false;
+    } else if (matchPath(line, pathIndex)) {
+      // Other chunks start with a path, the group before it belongs to the
+      // previous chunk
+      if (isFirst || (i != begin)) {
         groups.push_back(currentGroup);
-        currentGroup = std::make_shared<Group>();
-        isMultiColumn = false;
-        isEndReportReached = true;
-        hasMatch = true;
       }
+      currentGroup = std::make_shared<Group>();
+      currentGroup->pathInfo.index = pathIndex;
+      currentRole = Role::PATH;
+      isMultiColumn = false;
+    } else if (matchSlack(line, value)) {
+      currentGroup->pathInfo.slack = value;
+    } else if (matchStartPoint(line, value)) {
+      currentGroup->pathInfo.start = value;
+      currentRole = Role::PATH;
+    } else if (matchEndPoint(line, value)) {
+      currentGroup->pathInfo.end = value;
+      currentRole = Role::PATH;
+    } else if (line[0] == '|') {
+      currentRole = Role::SEGMENT;
+    } else if ((line.find('[') != std::string_view::npos) &&
+               (line.find(']') != std::string_view::npos)) {
+      currentRole = Role::SEGMENT;
+      isEndPathElement = true;
+    } else if (line == END_OF_REPORT) {
+      currentRole = Role::OTHER;
+      groups.push_back(currentGroup);
+      currentGroup = std::make_shared<Group>();
+      isMultiColumn = false;
+      isEndReportReached = true;
     }
 
-    (void)(hasMatch);  // suprass unused warning
-
     if (currentRole != currentGroup->currentElement->currentRole()) {
       currentGroup->getNextCurrentElement();
     }
 
-    if (currentGroup) {
-      currentGroup->currentElement->lines.emplace_back(
-          Line{line, currentRole, isMultiColumn});
-    }
+    currentGroup->currentElement->lines.emplace_back(
+        Line{std::string{line}, currentRole, isMultiColumn});
 
     if (isEndPathElement) {
       currentGroup->getNextCurrentElement();
-      isEndPathElement = false;
     }
 
     if (isEndReportReached) {
@@ -172,31 +314,49 @@ std::vector<GroupPtr> NCriticalPathReportParser::parseReport(
     prevRole = currentRole;
   }
 
-  if (currentGroup) {
-    groups.push_back(currentGroup);
-  }
-
-  return groups;
+  groups.push_back(currentGroup);
 }
 
 void NCriticalPathReportParser::parseMetaData(
     const std::vector<std::string>& lines,
     std::map<int, std::pair<int, int>>& metadata) {
+  parseMetaData(toViews(lines), metadata);
+}
+
+void NCriticalPathReportParser::parseMetaData(
+    const std::vector<std::string_view>& lines,
+    std::map<int, std::pair<int, int>>& metadata) {
   int pathIndex = -1;
   int offsetIndex = -1;
   int numElements = -1;
   char delim = '/';
   for (auto it = lines.rbegin(); it != lines.rend(); ++it) {
-    std::istringstream iss(*it);
-    if (iss >> pathIndex >> delim >> offsetIndex >> delim >> numElements &&
-        delim == '/') {
+    // "pathIndex/offsetIndex/numElements"
+    std::size_t pos = 0;
+    if (readInt(*it, pos, pathIndex) && readChar(*it, pos, delim) &&
+        readInt(*it, pos, offsetIndex) && readChar(*it, pos, delim) &&
+        readInt(*it, pos, numElements) && (delim == '/')) {
       metadata[pathIndex] = std::make_pair(offsetIndex, numElements);
     } else {
-      if (*it == "#RPT METADATA:") {
+      if (*it == METADATA_BEGIN) {
         break;
       }
     }
   }
 }
 
+std::vector<std::string_view> NCriticalPathReportParser::splitLines(
+    std::string_view text) {
+  std::vector<std::string_view> lines;
+  lines.reserve(std::count(text.begin(), text.end(), '\n') + 1);
+  std::size_t begin = 0;
+  for (std::size_t end = text.find('\n'); end != std::string_view::npos;
+       end = text.find('\n', begin)) {
+    lines.push_back(text.substr(begin, end - begin));
+    begin = end + 1;
+  }
+  lines.push_back(text.substr(begin));
+  return lines;
+}
+
 }  // namespace FOEDAG
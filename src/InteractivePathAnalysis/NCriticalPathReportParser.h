@@ -26,9 +26,11 @@
 
 #pragma once
 
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace FOEDAG {
@@ -86,13 +88,31 @@ using GroupPtr = std::shared_ptr<Group>;
  *
  * This parser is designed to process the Critical Path Report output generated
  * by VPR (Versatile Place and Route) tool.
+ *
+ * Lines are classified by hand written matchers, no regular expressions. A
+ * path only depends on its own lines, so big reports are split at "#Path N"
+ * lines and the chunks are parsed concurrently; the groups are the same as
+ * with a sequential parse.
  */
 class NCriticalPathReportParser {
  public:
   static std::vector<GroupPtr> parseReport(
       const std::vector<std::string>& lines);
+  // jobs == 0 uses one thread per core
+  static std::vector<GroupPtr> parseReport(
+      const std::vector<std::string_view>& lines, uint32_t jobs = 0);
   static void parseMetaData(const std::vector<std::string>& lines,
                             std::map<int, std::pair<int, int>>& metadata);
+  static void parseMetaData(const std::vector<std::string_view>& lines,
+                            std::map<int, std::pair<int, int>>& metadata);
+
+  // Split at '\n', views point into text
+  static std::vector<std::string_view> splitLines(std::string_view text);
+
+ private:
+  static void parseChunk(const std::vector<std::string_view>& lines,
+                         std::size_t begin, std::size_t end, bool isFirst,
+                         std::vector<GroupPtr>& groups);
 };
 
 }  // namespace FOEDAG
@@ -363,6 +363,9 @@ void NCriticalPathView::updateChildrenSelectionFor(
 
   // collect range of selectionIndexes for path elemenets to be selected or
   // deselected
+  if (m_sourceModel->canFetchMore(sourcePathIndex)) {
+    m_sourceModel->fetchMore(sourcePathIndex);
+  }
 
   QModelIndex sourceTopLeftIndex = m_sourceModel->index(0, 0, sourcePathIndex);
   QModelIndex sourceBottomRightIndex = m_sourceModel->index(
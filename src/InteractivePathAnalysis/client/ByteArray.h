@@ -66,21 +66,30 @@ class ByteArray : public std::vector<uint8_t> {
   void append(uint8_t b) { push_back(b); }
 
   std::optional<std::size_t> findSequence(const char* sequence,
-                                          std::size_t sequenceSize) {
-    const std::size_t mSize = size();
-    if (mSize >= sequenceSize) {
-      for (std::size_t i = 0; i <= mSize - sequenceSize; ++i) {
-        bool found = true;
-        for (std::size_t j = 0; j < sequenceSize; ++j) {
-          if (at(i + j) != sequence[j]) {
-            found = false;
-            break;
-          }
-        }
-        if (found) {
-          return i;
-        }
+                                          std::size_t sequenceSize) const {
+    return findSequence(data(), size(), sequence, sequenceSize);
+  }
+
+  // memchr for the first byte of the sequence, then compare the rest
+  static std::optional<std::size_t> findSequence(const uint8_t* data,
+                                                 std::size_t size,
+                                                 const char* sequence,
+                                                 std::size_t sequenceSize) {
+    if (sequenceSize == 0) {
+      return 0;
+    }
+    const uint8_t* pos = data;
+    const uint8_t* last = data + size;
+    while (static_cast<std::size_t>(last - pos) >= sequenceSize) {
+      pos = static_cast<const uint8_t*>(
+          std::memchr(pos, sequence[0], last - pos - sequenceSize + 1));
+      if (!pos) {
+        break;
       }
+      if (std::memcmp(pos + 1, sequence + 1, sequenceSize - 1) == 0) {
+        return pos - data;
+      }
+      ++pos;
     }
     return std::nullopt;
   }
@@ -100,6 +109,39 @@ class ByteArray : public std::vector<uint8_t> {
     }
     return sum;
   }
+
+  // Continue the byte sum of a body received in pieces
+  static uint32_t calcCheckSum(uint32_t sum, const uint8_t* data,
+                               std::size_t size) {
+    for (std::size_t i = 0; i < size; ++i) {
+      sum += data[i];
+    }
+    return sum;
+  }
+};
+
+/**
+ * @brief Non owning view over bytes of a ByteArray or a TelegramBuffer
+ */
+class ByteView {
+ public:
+  ByteView() = default;
+  ByteView(const uint8_t* data, std::size_t size)
+      : m_data(data), m_size(size) {}
+
+  const uint8_t* data() const { return m_data; }
+  std::size_t size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+  const uint8_t* begin() const { return m_data; }
+  const uint8_t* end() const { return m_data + m_size; }
+
+  std::string to_string() const {
+    return std::string(reinterpret_cast<const char*>(m_data), m_size);
+  }
+
+ private:
+  const uint8_t* m_data{nullptr};
+  std::size_t m_size{0};
 };
 
 }  // namespace comm
@@ -26,22 +26,20 @@
 
 #include "ConvertUtils.h"
 
+#include <charconv>
 #include <iomanip>
 #include <sstream>
 
 namespace FOEDAG {
 
-std::optional<int> tryConvertToInt(const std::string& str) {
-  std::optional<int> result;
-
-  std::istringstream iss(str);
-  int intValue;
-  if (iss >> intValue) {
-    if (iss.eof()) {
-      result = intValue;
-    }
+std::optional<int> tryConvertToInt(std::string_view str) {
+  int intValue = 0;
+  const char* end = str.data() + str.size();
+  auto [ptr, ec] = std::from_chars(str.data(), end, intValue);
+  if ((ec != std::errc{}) || (ptr != end)) {
+    return std::nullopt;
   }
-  return result;
+  return intValue;
 }
 
 namespace {
@@ -30,12 +30,13 @@
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <string_view>
 
 namespace FOEDAG {
 
 const std::size_t DEFAULT_PRINT_STRING_MAX_NUM = 100;
 
-std::optional<int> tryConvertToInt(const std::string&);
+std::optional<int> tryConvertToInt(std::string_view);
 std::string getPrettyDurationStrFromMs(int64_t durationMs);
 std::string getPrettySizeStrFromBytesNum(int64_t bytesNum);
 std::string getTruncatedMiddleStr(
@@ -69,44 +69,32 @@ void GateIO::startConnectionWatcher() { m_socket.startConnectionWatcher(); }
 void GateIO::stopConnectionWatcher() { m_socket.stopConnectionWatcher(); }
 
 void GateIO::handleResponse(const QByteArray& bytes, bool isCompressed) {
-  static const std::string echoData{comm::TELEGRAM_ECHO_BODY};
-
-  std::string rawData{bytes.begin(), bytes.end()};
-
-  bool isEchoTelegram = false;
-  if (rawData.size() == echoData.size()) {
-    if (rawData == echoData) {
-      sendRequest(
-          m_echoTelegram,
-          comm::TELEGRAM_ECHO_BODY);  // please don't change initiator else from
-                                      // comm::TELEGRAM_ECHO_BODY here in order
-                                      // to properly exclude such kind of
-                                      // request from statistics
-      isEchoTelegram = true;
-    }
-  }
-  if (!isEchoTelegram) {
-    std::optional<std::string> decompressedTelegramOpt;
+  static const std::string_view echoData{comm::TELEGRAM_ECHO_BODY};
+
+  m_jobStatusStat.trackDecompression(m_socket.decompressStat());
+
+  std::string_view rawData{bytes.constData(),
+                           static_cast<std::size_t>(bytes.size())};
+  if (rawData == echoData) {
+    // please don't change initiator else from comm::TELEGRAM_ECHO_BODY here
+    // in order to properly exclude such kind of request from statistics
+    sendRequest(m_echoTelegram, comm::TELEGRAM_ECHO_BODY);
+  } else {
+    // Bodies are normally inflated by the socket already
+    std::string decompressed;
 #ifndef FORCE_DISABLE_ZLIB_TELEGRAM_COMPRESSION
-    if (isCompressed) {
-      decompressedTelegramOpt = tryDecompress(rawData);
+    if (isCompressed && m_codec.decompress(rawData.data(), rawData.size(),
+                                           decompressed)) {
+      rawData = decompressed;
     }
 #endif
-    if (!decompressedTelegramOpt) {
-      decompressedTelegramOpt = std::move(rawData);
-      rawData.clear();
-    }
-
-    const std::string& telegram = decompressedTelegramOpt.value();
 
-    std::optional<int> jobIdOpt =
-        comm::TelegramParser::tryExtractFieldJobId(telegram);
-    std::optional<int> cmdOpt =
-        comm::TelegramParser::tryExtractFieldCmd(telegram);
-    std::optional<int> statusOpt =
-        comm::TelegramParser::tryExtractFieldStatus(telegram);
-    std::optional<std::string> dataOpt;
-    comm::TelegramParser::tryExtractFieldData(telegram, dataOpt);
+    const comm::TelegramParser::Response response =
+        comm::TelegramParser::decodeResponse(rawData);
+    const std::optional<int>& jobIdOpt = response.jobId;
+    const std::optional<int>& cmdOpt = response.cmd;
+    const std::optional<int>& statusOpt = response.status;
+    const std::string_view dataView = response.data.value_or("");
 
     bool isResponseConsistent = true;
     if (!jobIdOpt) {
@@ -124,19 +112,14 @@ void GateIO::handleResponse(const QByteArray& bytes, bool isCompressed) {
           "bad response telegram, missing required field", comm::KEY_STATUS);
       isResponseConsistent = false;
     }
-    if (!dataOpt) {
-      dataOpt = "";
-    }
-
     if (isResponseConsistent) {
       int jobId = jobIdOpt.value();
 
       int cmd = cmdOpt.value();
       bool status = statusOpt.value();
-      QString data{dataOpt.value().c_str()};
 
       std::optional<std::pair<int64_t, int64_t>> measurementOpt =
-          m_jobStatusStat.trackJobFinish(jobId, status, data.size());
+          m_jobStatusStat.trackJobFinish(jobId, status, dataView.size());
       if (measurementOpt) {
         const auto [sizeBytes, durationMs] = measurementOpt.value();
         SimpleLogger::instance().log(
@@ -150,7 +133,9 @@ void GateIO::handleResponse(const QByteArray& bytes, bool isCompressed) {
       if (status) {
         switch (cmd) {
           case comm::CMD_GET_PATH_LIST_ID:
-            emit pathListDataReceived(data);
+            // The only copy of the payload
+            emit pathListDataReceived(QString::fromUtf8(
+                dataView.data(), static_cast<qsizetype>(dataView.size())));
             break;
           case comm::CMD_DRAW_PATH_ID:
             emit highLightModeReceived();
@@ -159,7 +144,7 @@ void GateIO::handleResponse(const QByteArray& bytes, bool isCompressed) {
       } else {
         SimpleLogger::instance().error(
             "unable to perform cmd on server, error",
-            getTruncatedMiddleStr(data.toStdString()).c_str());
+            getTruncatedMiddleStr(std::string{dataView}).c_str());
       }
     } else {
       m_jobStatusStat.trackResponseBroken();
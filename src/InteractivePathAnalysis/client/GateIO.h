@@ -37,6 +37,7 @@
 #include "../SimpleLogger.h"
 #include "ConvertUtils.h"
 #include "TcpSocket.h"
+#include "ZlibUtils.h"
 
 namespace FOEDAG {
 
@@ -114,6 +115,10 @@ class GateIO : public QObject {
 
     int pendingJobsNum() const { return m_pendingJobs.size(); }
 
+    void trackDecompression(const ZlibCodec::Stat& stat) {
+      m_decompressStat = stat;
+    }
+
     void show(bool skipIfWasShown) {
       std::stringstream ss;
       ss << "*** requests[total:" << m_requestCounter << ",inprogress:[";
@@ -125,6 +130,12 @@ class GateIO : public QObject {
          << "], responses[broken:" << m_brokenResponseCounter << "]"
          << ", max size:" << getPrettySizeStrFromBytesNum(m_maxSize)
          << ", max duration:" << getPrettyDurationStrFromMs(m_maxDurationMs);
+      if (m_decompressStat.durationUs > 0) {
+        ss << ", unzip:"
+           << getPrettySizeStrFromBytesNum(m_decompressStat.outBytes) << " at "
+           << m_decompressStat.outBytes / m_decompressStat.durationUs
+           << " MB/s";
+      }
 
       std::string candidate = ss.str();
 
@@ -149,6 +160,7 @@ class GateIO : public QObject {
 
     int64_t m_maxSize = 0;
     int64_t m_maxDurationMs = 0;
+    ZlibCodec::Stat m_decompressStat;
 
     std::string m_prevShown;
   };
@@ -184,6 +196,7 @@ class GateIO : public QObject {
   QTimer m_statShowTimer;
 
   const comm::TelegramFrame m_echoTelegram;
+  ZlibCodec m_codec;
 
   void sendRequest(const comm::TelegramFrame& frame, const QString& initiator);
   void handleResponse(const QByteArray&, bool isCompressed);
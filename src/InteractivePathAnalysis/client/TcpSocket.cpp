@@ -50,6 +50,28 @@ TcpSocket::TcpSocket() {
   QObject::connect(&m_socket, &QAbstractSocket::errorOccurred, this,
                    &TcpSocket::handleError);
 #endif
+
+#ifndef FORCE_DISABLE_ZLIB_TELEGRAM_COMPRESSION
+  m_telegramBuff.setBodyChunkVisitor([this](const comm::TelegramHeader& header,
+                                            comm::ByteView chunk,
+                                            bool firstChunk) {
+    if (firstChunk) {
+      // New frame, the state left by a dropped or failed one is discarded
+      m_inflateOk = false;
+    }
+    if (!header.isBodyCompressed()) {
+      return;
+    }
+    if (firstChunk) {
+      m_codec.beginDecompress(header.bodyBytesNum());
+      m_inflateOk = true;
+    }
+    if (m_inflateOk) {
+      m_inflateOk = m_codec.decompressChunk(
+          reinterpret_cast<const char*>(chunk.data()), chunk.size());
+    }
+  });
+#endif
 }
 
 TcpSocket::~TcpSocket() {
@@ -119,18 +141,28 @@ void TcpSocket::handleStateChanged(QAbstractSocket::SocketState state) {
 
 void TcpSocket::handleDataReady() {
   QByteArray bytes = m_socket.readAll();
-  m_telegramBuff.append(comm::ByteArray{
-      bytes.constData(), static_cast<std::size_t>(bytes.size())});
-
-  std::vector<comm::TelegramFramePtr> telegramFrames =
-      m_telegramBuff.takeTelegramFrames();
-  for (const comm::TelegramFramePtr& telegramFrame : telegramFrames) {
-    QByteArray bytes(reinterpret_cast<const char*>(telegramFrame->body.data()),
-                     telegramFrame->body.size());
-    SimpleLogger::instance().log("received",
-                                 telegramFrame->header.info().c_str());
-    emit dataRecieved(bytes, telegramFrame->header.isBodyCompressed());
-  }
+  m_telegramBuff.append(bytes.constData(),
+                        static_cast<std::size_t>(bytes.size()));
+
+  // The body is copied once, straight from the telegram buffer or from the
+  // codec that inflated it on the fly
+  m_telegramBuff.takeTelegramFrames(
+      [this](const comm::TelegramHeader& header, comm::ByteView body) {
+        SimpleLogger::instance().log("received", header.info().c_str());
+        const bool inflateOk = m_inflateOk;
+        m_inflateOk = false;
+        if (header.isBodyCompressed() && inflateOk &&
+            m_codec.decompressFinished()) {
+          std::string inflated = m_codec.takeDecompressed();
+          emit dataRecieved(QByteArray(inflated.data(),
+                                       static_cast<qsizetype>(inflated.size())),
+                            false);
+          return;
+        }
+        QByteArray bytes(reinterpret_cast<const char*>(body.data()),
+                         static_cast<qsizetype>(body.size()));
+        emit dataRecieved(bytes, header.isBodyCompressed());
+      });
 
   std::vector<std::string> errors;
   m_telegramBuff.takeErrors(errors);
@@ -141,6 +173,7 @@ void TcpSocket::handleDataReady() {
 
 void TcpSocket::handleError(QAbstractSocket::SocketError error) {
   m_telegramBuff.clear();
+  m_inflateOk = false;
   SimpleLogger::instance().debug("socket error", m_socket.errorString(), error);
 }
 
@@ -33,6 +33,7 @@
 #include <QTimer>
 
 #include "TelegramBuffer.h"
+#include "ZlibUtils.h"
 
 namespace FOEDAG {
 
@@ -89,6 +90,10 @@ class TcpSocket : public QObject {
   bool isConnected() const;
   bool write(const QByteArray&);
 
+  const ZlibCodec::Stat& decompressStat() const {
+    return m_codec.decompressStat();
+  }
+
  signals:
   void connectedChanged(bool);
   void dataRecieved(QByteArray, bool isCompressed);
@@ -100,6 +105,10 @@ class TcpSocket : public QObject {
   bool m_serverIsRunning = false;
   QTimer m_connectionWatcher;
   comm::TelegramBuffer m_telegramBuff;
+  // Compressed bodies are inflated while they are received, the state is
+  // reset at the start of every frame
+  ZlibCodec m_codec;
+  bool m_inflateOk = false;
 
   bool ensureConnected();
 
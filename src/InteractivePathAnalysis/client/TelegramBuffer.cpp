@@ -26,73 +26,122 @@
 
 #include "TelegramBuffer.h"
 
+#include <algorithm>
 #include <optional>
 
 namespace FOEDAG {
 
 namespace comm {
 
+void TelegramBuffer::clear() {
+  m_rawBuffer.clear();
+  m_readPos = 0;
+  m_headerOpt.reset();
+  m_bodyBytesSummed = 0;
+  m_bodyCheckSum = 0;
+}
+
 void TelegramBuffer::append(const ByteArray& bytes) {
-  m_rawBuffer.append(bytes);
+  append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+void TelegramBuffer::append(const char* data, std::size_t size) {
+  compact();
+  m_rawBuffer.insert(m_rawBuffer.end(), reinterpret_cast<const uint8_t*>(data),
+                     reinterpret_cast<const uint8_t*>(data + size));
+}
+
+void TelegramBuffer::compact() {
+  if (m_readPos == 0) {
+    return;
+  }
+  if (m_readPos == m_rawBuffer.size()) {
+    m_rawBuffer.clear();
+    m_readPos = 0;
+  } else if (m_readPos >= pendingSize()) {
+    // The moved bytes are fewer than the consumed ones, amortized linear
+    m_rawBuffer.erase(m_rawBuffer.begin(), m_rawBuffer.begin() + m_readPos);
+    m_readPos = 0;
+  }
 }
 
 bool TelegramBuffer::checkRawBuffer() {
-  std::optional<std::size_t> signatureStartIndexOpt = m_rawBuffer.findSequence(
-      TelegramHeader::SIGNATURE, TelegramHeader::SIGNATURE_SIZE);
+  std::optional<std::size_t> signatureStartIndexOpt =
+      ByteArray::findSequence(pendingData(), pendingSize(),
+                              TelegramHeader::SIGNATURE,
+                              TelegramHeader::SIGNATURE_SIZE);
   if (signatureStartIndexOpt) {
-    std::size_t signatureStartIndex{signatureStartIndexOpt.value()};
-    if (signatureStartIndex != 0) {
-      m_rawBuffer.erase(m_rawBuffer.begin(),
-                        m_rawBuffer.begin() + signatureStartIndex);
-    }
+    m_readPos += signatureStartIndexOpt.value();
     return true;
   }
+  // Drop the rubbish, only a partial signature at the end may be kept
+  if (pendingSize() >= TelegramHeader::SIGNATURE_SIZE) {
+    m_readPos = m_rawBuffer.size() - (TelegramHeader::SIGNATURE_SIZE - 1);
+  }
   return false;
 }
 
-void TelegramBuffer::takeTelegramFrames(
-    std::vector<comm::TelegramFramePtr>& result) {
-  if (m_rawBuffer.size() <= TelegramHeader::size()) {
-    return;
-  }
-
+void TelegramBuffer::takeTelegramFrames(const FrameVisitor& visitor) {
   bool mayContainFullTelegram = true;
   while (mayContainFullTelegram) {
     mayContainFullTelegram = false;
     if (!m_headerOpt) {
-      if (checkRawBuffer()) {
-        TelegramHeader header(m_rawBuffer);
-        if (header.isValid()) {
-          m_headerOpt = std::move(header);
-        }
+      if ((pendingSize() < TelegramHeader::size()) || !checkRawBuffer() ||
+          (pendingSize() < TelegramHeader::size())) {
+        break;
       }
+      TelegramHeader header(pendingData(), pendingSize());
+      if (!header.isValid()) {
+        // Look for the next signature
+        m_readPos++;
+        mayContainFullTelegram = true;
+        continue;
+      }
+      m_headerOpt = std::move(header);
+      m_bodyBytesSummed = 0;
+      m_bodyCheckSum = 0;
     }
 
-    if (m_headerOpt) {
-      const TelegramHeader& header = m_headerOpt.value();
-      std::size_t wholeTelegramSize =
-          TelegramHeader::size() + header.bodyBytesNum();
-      if (m_rawBuffer.size() >= wholeTelegramSize) {
-        ByteArray data(m_rawBuffer.begin() + TelegramHeader::size(),
-                       m_rawBuffer.begin() + wholeTelegramSize);
-        uint32_t actualCheckSum = data.calcCheckSum();
-        if (actualCheckSum == header.bodyCheckSum()) {
-          TelegramFramePtr telegramFramePtr = std::make_shared<TelegramFrame>(
-              TelegramFrame{header, std::move(data)});
-          data.clear();
-          result.push_back(telegramFramePtr);
-        } else {
-          m_errors.push_back("wrong checkSums " +
-                             std::to_string(actualCheckSum) + " for " +
-                             header.info() + " , drop this chunk");
-        }
-        m_rawBuffer.erase(m_rawBuffer.begin(),
-                          m_rawBuffer.begin() + wholeTelegramSize);
-        m_headerOpt.reset();
-        mayContainFullTelegram = true;
+    const TelegramHeader& header = m_headerOpt.value();
+    const std::size_t bodySize = header.bodyBytesNum();
+    const uint8_t* body = pendingData() + TelegramHeader::size();
+    const std::size_t available =
+        std::min(pendingSize() - TelegramHeader::size(), bodySize);
+    if (available > m_bodyBytesSummed) {
+      ByteView chunk{body + m_bodyBytesSummed, available - m_bodyBytesSummed};
+      m_bodyCheckSum =
+          ByteArray::calcCheckSum(m_bodyCheckSum, chunk.data(), chunk.size());
+      if (m_bodyChunkVisitor) {
+        m_bodyChunkVisitor(header, chunk, m_bodyBytesSummed == 0);
       }
+    } else if ((bodySize == 0) && m_bodyChunkVisitor) {
+      // The visitor is told about the start of every frame
+      m_bodyChunkVisitor(header, ByteView{body, 0}, true);
+    }
+    m_bodyBytesSummed = available;
+    if (available < bodySize) {
+      break;
     }
+
+    if (m_bodyCheckSum == header.bodyCheckSum()) {
+      visitor(header, ByteView{body, bodySize});
+    } else {
+      m_errors.push_back("wrong checkSums " + std::to_string(m_bodyCheckSum) +
+                         " for " + header.info() + " , drop this chunk");
+    }
+    m_readPos += TelegramHeader::size() + bodySize;
+    m_headerOpt.reset();
+    mayContainFullTelegram = true;
   }
+  compact();
+}
+
+void TelegramBuffer::takeTelegramFrames(
+    std::vector<comm::TelegramFramePtr>& result) {
+  takeTelegramFrames([&result](const TelegramHeader& header, ByteView body) {
+    result.push_back(std::make_shared<TelegramFrame>(
+        TelegramFrame{header, ByteArray(body.begin(), body.end())}));
+  });
 }
 
 std::vector<comm::TelegramFramePtr> TelegramBuffer::takeTelegramFrames() {
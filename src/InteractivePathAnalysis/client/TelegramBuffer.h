@@ -27,6 +27,7 @@
 #ifndef TELEGRAMBUFFER_H
 #define TELEGRAMBUFFER_H
 
+#include <functional>
 #include <optional>
 #include <string>
 #include <vector>
@@ -43,31 +44,63 @@ namespace comm {
  *
  * It aggregates received bytes and return only well filled frames, separated by
  * telegram delimerer byte.
+ *
+ * Consumed bytes are not erased from the front, a read offset is moved
+ * instead and the pending bytes are moved to the front only when more than
+ * half of the storage is consumed. The body checksum is summed as the bytes
+ * arrive, so every byte is visited once even if a large telegram comes in
+ * many small pieces.
  */
 class TelegramBuffer {
   static const std::size_t DEFAULT_SIZE_HINT = 1024;
 
  public:
+  // Frame body is a view into the buffer, valid during the call only
+  using FrameVisitor =
+      std::function<void(const TelegramHeader& header, ByteView body)>;
+  // Called with every piece of a body as soon as it is received, before the
+  // frame is complete and its checksum is verified. An empty body is reported
+  // as one empty first chunk
+  using BodyChunkVisitor = std::function<void(
+      const TelegramHeader& header, ByteView chunk, bool firstChunk)>;
+
   TelegramBuffer(std::size_t sizeHint = DEFAULT_SIZE_HINT)
       : m_rawBuffer(sizeHint) {}
   ~TelegramBuffer() = default;
 
-  bool empty() { return m_rawBuffer.empty(); }
+  bool empty() const { return pendingSize() == 0; }
 
-  void clear() { m_rawBuffer.clear(); }
+  void clear();
 
   void append(const ByteArray&);
+  void append(const char* data, std::size_t size);
   void takeTelegramFrames(std::vector<TelegramFramePtr>&);
   std::vector<TelegramFramePtr> takeTelegramFrames();
+  // Zero copy version, visitor is called for every complete frame
+  void takeTelegramFrames(const FrameVisitor& visitor);
   void takeErrors(std::vector<std::string>&);
+  void setBodyChunkVisitor(const BodyChunkVisitor& visitor) {
+    m_bodyChunkVisitor = visitor;
+  }
 
-  const ByteArray& data() const { return m_rawBuffer; }
+  // Copy of the bytes not taken yet
+  ByteArray data() const {
+    return ByteArray(m_rawBuffer.begin() + m_readPos, m_rawBuffer.end());
+  }
 
  private:
   ByteArray m_rawBuffer;
+  std::size_t m_readPos{0};
   std::vector<std::string> m_errors;
   std::optional<TelegramHeader> m_headerOpt;
-
+  // Body bytes of the current telegram already summed into m_bodyCheckSum
+  std::size_t m_bodyBytesSummed{0};
+  uint32_t m_bodyCheckSum{0};
+  BodyChunkVisitor m_bodyChunkVisitor;
+
+  std::size_t pendingSize() const { return m_rawBuffer.size() - m_readPos; }
+  const uint8_t* pendingData() const { return m_rawBuffer.data() + m_readPos; }
+  void compact();
   bool checkRawBuffer();
 };
 
@@ -60,12 +60,18 @@ TelegramHeader::TelegramHeader(uint32_t length, uint32_t checkSum,
   m_isValid = true;
 }
 
-TelegramHeader::TelegramHeader(const ByteArray& buffer) {
+TelegramHeader::TelegramHeader(const ByteArray& buffer)
+    : TelegramHeader(buffer.data(), buffer.size()) {}
+
+TelegramHeader::TelegramHeader(const uint8_t* data, std::size_t size) {
   m_buffer.resize(TelegramHeader::size());
 
   bool hasError = false;
 
-  if (buffer.size() >= TelegramHeader::size()) {
+  if (size >= TelegramHeader::size()) {
+    std::memcpy(m_buffer.data(), data, TelegramHeader::size());
+    const ByteArray& buffer = m_buffer;
+
     // Check the signature to ensure that this is a valid header
     if (std::memcmp(buffer.data(), TelegramHeader::SIGNATURE,
                     TelegramHeader::SIGNATURE_SIZE)) {
@@ -49,6 +49,8 @@ class TelegramHeader {
   explicit TelegramHeader(uint32_t length, uint32_t checkSum,
                           uint8_t compressorId = 0);
   explicit TelegramHeader(const ByteArray& body);
+  // Parse a header from at least size() bytes
+  TelegramHeader(const uint8_t* data, std::size_t size);
   ~TelegramHeader() = default;
 
   static comm::TelegramHeader constructFromBody(const std::string& body,
@@ -68,6 +68,46 @@ bool TelegramParser::tryExtractJsonValueStr(
   return true;
 }
 
+TelegramParser::Response TelegramParser::decodeResponse(
+    std::string_view message) {
+  Response response;
+  std::size_t pos = 0;
+  while (true) {
+    std::size_t keyStart = message.find('"', pos);
+    if (keyStart == std::string_view::npos) {
+      break;
+    }
+    std::size_t keyEnd = message.find('"', keyStart + 1);
+    if (keyEnd == std::string_view::npos) {
+      break;
+    }
+    std::size_t valueStart = keyEnd + 1;
+    if ((message.substr(valueStart, 2) != ":\"")) {
+      pos = keyEnd;  // not a key, the quote may open the next one
+      continue;
+    }
+    valueStart += 2;
+    std::size_t valueEnd = message.find('"', valueStart);
+    if (valueEnd == std::string_view::npos) {
+      break;
+    }
+    std::string_view key = message.substr(keyStart + 1, keyEnd - keyStart - 1);
+    std::string_view value = message.substr(valueStart, valueEnd - valueStart);
+    // The first occurrence of a key wins
+    if ((key == KEY_JOB_ID) && !response.jobId) {
+      response.jobId = tryConvertToInt(value);
+    } else if ((key == KEY_CMD) && !response.cmd) {
+      response.cmd = tryConvertToInt(value);
+    } else if ((key == KEY_STATUS) && !response.status) {
+      response.status = tryConvertToInt(value);
+    } else if ((key == KEY_DATA) && !response.data) {
+      response.data = value;
+    }
+    pos = valueEnd + 1;
+  }
+  return response;
+}
+
 std::optional<int> TelegramParser::tryExtractFieldJobId(
     const std::string& message) {
   std::optional<int> result;
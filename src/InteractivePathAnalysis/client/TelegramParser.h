@@ -29,6 +29,7 @@
 
 #include <optional>
 #include <string>
+#include <string_view>
 
 namespace FOEDAG {
 
@@ -43,6 +44,21 @@ namespace comm {
  */
 class TelegramParser {
  public:
+  /**
+   * @brief Fields of a server response. Strings are views into the decoded
+   * message, valid as long as the message is.
+   */
+  struct Response {
+    std::optional<int> jobId;
+    std::optional<int> cmd;
+    std::optional<int> status;
+    std::optional<std::string_view> data;
+  };
+
+  // Single pass over the "KEY":"VALUE" pairs of a response, values end at the
+  // next quote like in tryExtractJsonValueStr
+  static Response decodeResponse(std::string_view message);
+
   static std::optional<int> tryExtractFieldJobId(const std::string& message);
   static std::optional<int> tryExtractFieldCmd(const std::string& message);
   static bool tryExtractFieldOptions(const std::string& message,
@@ -28,82 +28,175 @@
 
 #include <zlib.h>
 
+#include <algorithm>
+#include <chrono>
 #include <cstring>  // Include cstring for memset
 
 namespace FOEDAG {
 
-std::optional<std::string> tryCompress(const std::string& decompressed) {
-  z_stream zs;
-  memset(&zs, 0, sizeof(zs));
+namespace {
 
-  if (deflateInit(&zs, Z_BEST_COMPRESSION) != Z_OK) {
-    return std::nullopt;
-  }
-
-  zs.next_in = (Bytef*)decompressed.data();
-  zs.avail_in = decompressed.size();
-
-  int retCode;
-  char* resultBuffer = new char[32768];
-  std::string result;
-
-  do {
-    zs.next_out = reinterpret_cast<Bytef*>(resultBuffer);
-    zs.avail_out = sizeof(resultBuffer);
+// Ratio used for the output size of the first body
+constexpr std::size_t DEFAULT_COMPRESSION_RATIO = 4;
+constexpr std::size_t MIN_OUTPUT_SIZE = 4096;
 
-    retCode = deflate(&zs, Z_FINISH);
-
-    if (result.size() < zs.total_out) {
-      result.append(resultBuffer, zs.total_out - result.size());
-    }
-  } while (retCode == Z_OK);
+int64_t elapsedUs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
 
-  delete[] resultBuffer;
+}  // namespace
 
-  deflateEnd(&zs);
+ZlibCodec::ZlibCodec(int level)
+    : m_level(level),
+      m_deflate(std::make_unique<z_stream_s>()),
+      m_inflate(std::make_unique<z_stream_s>()) {
+  memset(m_deflate.get(), 0, sizeof(z_stream));
+  memset(m_inflate.get(), 0, sizeof(z_stream));
+}
 
-  if (retCode != Z_STREAM_END) {
-    return std::nullopt;
+ZlibCodec::~ZlibCodec() {
+  if (m_deflateReady) {
+    deflateEnd(m_deflate.get());
+  }
+  if (m_inflateReady) {
+    inflateEnd(m_inflate.get());
   }
-
-  return result;
 }
 
-std::optional<std::string> tryDecompress(const std::string& compressed) {
-  z_stream zs;
-  memset(&zs, 0, sizeof(zs));
-
-  if (inflateInit(&zs) != Z_OK) {
-    return std::nullopt;
+void ZlibCodec::setLevel(int level) {
+  if (level == m_level) {
+    return;
   }
+  m_level = level;
+  if (m_deflateReady) {
+    deflateEnd(m_deflate.get());
+    memset(m_deflate.get(), 0, sizeof(z_stream));
+    m_deflateReady = false;
+  }
+}
 
-  zs.next_in = (Bytef*)compressed.data();
-  zs.avail_in = compressed.size();
+bool ZlibCodec::compress(const char* data, std::size_t size,
+                         std::string& result) {
+  auto start = std::chrono::steady_clock::now();
+  z_stream* zs = m_deflate.get();
+  if (m_deflateReady) {
+    deflateReset(zs);
+  } else {
+    if (deflateInit(zs, m_level) != Z_OK) {
+      return false;
+    }
+    m_deflateReady = true;
+  }
 
-  int retCode;
-  char* resultBuffer = new char[32768];
-  std::string result;
+  // deflateBound is enough to finish in a single call
+  result.resize(deflateBound(zs, static_cast<uLong>(size)));
+  zs->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+  zs->avail_in = static_cast<uInt>(size);
+  zs->next_out = reinterpret_cast<Bytef*>(result.data());
+  zs->avail_out = static_cast<uInt>(result.size());
 
-  do {
-    zs.next_out = reinterpret_cast<Bytef*>(resultBuffer);
-    zs.avail_out = sizeof(resultBuffer);
+  int retCode = deflate(zs, Z_FINISH);
+  result.resize(zs->total_out);
 
-    retCode = inflate(&zs, 0);
+  m_compressStat.inBytes += size;
+  m_compressStat.outBytes += result.size();
+  m_compressStat.durationUs += elapsedUs(start);
+  return retCode == Z_STREAM_END;
+}
 
-    if (result.size() < zs.total_out) {
-      result.append(resultBuffer, zs.total_out - result.size());
+void ZlibCodec::beginDecompress(std::size_t compressedSize,
+                                std::size_t sizeHint) {
+  if (sizeHint == 0) {
+    std::size_t ratio = DEFAULT_COMPRESSION_RATIO;
+    if (m_decompressStat.inBytes > 0) {
+      ratio = m_decompressStat.outBytes / m_decompressStat.inBytes + 1;
     }
+    sizeHint = compressedSize * ratio;
+  }
+  m_inflated.clear();
+  m_inflated.resize(std::max(sizeHint, MIN_OUTPUT_SIZE));
+  m_inflatedSize = 0;
+  m_inflateFinished = false;
+  m_inflateFailed = false;
+  if (m_inflateReady) {
+    inflateReset(m_inflate.get());
+  } else if (inflateInit(m_inflate.get()) == Z_OK) {
+    m_inflateReady = true;
+  } else {
+    m_inflateFailed = true;
+  }
+}
 
-  } while (retCode == Z_OK);
+bool ZlibCodec::decompressChunk(const char* data, std::size_t size) {
+  if (m_inflateFailed) {
+    return false;
+  }
+  if (m_inflateFinished) {
+    // Trailing bytes after the end of the stream
+    return size == 0;
+  }
+  auto start = std::chrono::steady_clock::now();
+  z_stream* zs = m_inflate.get();
+  zs->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+  zs->avail_in = static_cast<uInt>(size);
+  int retCode = Z_OK;
+  while (retCode == Z_OK) {
+    if (m_inflatedSize == m_inflated.size()) {
+      m_inflated.resize(m_inflated.size() * 2);
+    }
+    zs->next_out = reinterpret_cast<Bytef*>(m_inflated.data() + m_inflatedSize);
+    zs->avail_out = static_cast<uInt>(m_inflated.size() - m_inflatedSize);
+    retCode = inflate(zs, Z_NO_FLUSH);
+    m_inflatedSize = m_inflated.size() - zs->avail_out;
+    if ((retCode == Z_OK) && (zs->avail_in == 0) && (zs->avail_out != 0)) {
+      break;  // wait for the next chunk
+    }
+  }
+  m_decompressStat.durationUs += elapsedUs(start);
+  if (retCode == Z_STREAM_END) {
+    m_inflateFinished = true;
+    m_decompressStat.inBytes += zs->total_in;
+    m_decompressStat.outBytes += m_inflatedSize;
+  } else if ((retCode != Z_OK) && (retCode != Z_BUF_ERROR)) {
+    m_inflateFailed = true;
+  }
+  return !m_inflateFailed;
+}
 
-  delete[] resultBuffer;
+std::string ZlibCodec::takeDecompressed() {
+  m_inflated.resize(m_inflatedSize);
+  m_inflatedSize = 0;
+  return std::move(m_inflated);
+}
 
-  inflateEnd(&zs);
+bool ZlibCodec::decompress(const char* data, std::size_t size,
+                           std::string& result, std::size_t sizeHint) {
+  beginDecompress(size, sizeHint);
+  if (!decompressChunk(data, size) || !decompressFinished()) {
+    return false;
+  }
+  result = takeDecompressed();
+  return true;
+}
 
-  if (retCode != Z_STREAM_END) {
+std::optional<std::string> tryCompress(const std::string& decompressed,
+                                       int level) {
+  ZlibCodec codec{level};
+  std::string result;
+  if (!codec.compress(decompressed.data(), decompressed.size(), result)) {
     return std::nullopt;
   }
+  return result;
+}
 
+std::optional<std::string> tryDecompress(const std::string& compressed) {
+  ZlibCodec codec;
+  std::string result;
+  if (!codec.decompress(compressed.data(), compressed.size(), result)) {
+    return std::nullopt;
+  }
   return result;
 }
 
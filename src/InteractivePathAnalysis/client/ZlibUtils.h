@@ -27,12 +27,76 @@
 #ifndef ZLIBUTILS_H
 #define ZLIBUTILS_H
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 
+struct z_stream_s;
+
 namespace FOEDAG {
 
-std::optional<std::string> tryCompress(const std::string& decompressed);
+/**
+ * @brief Reusable zlib codec for telegram bodies
+ *
+ * The deflate/inflate streams are created once and reset for every body.
+ * Output is produced directly into the result string, which is preallocated
+ * from deflateBound on compression and from a size hint on decompression.
+ * Decompression can be fed chunk by chunk as the compressed body arrives.
+ */
+class ZlibCodec {
+ public:
+  static constexpr int DEFAULT_LEVEL = -1;  // Z_DEFAULT_COMPRESSION
+  static constexpr int BEST_SPEED_LEVEL = 1;
+  static constexpr int BEST_COMPRESSION_LEVEL = 9;
+
+  struct Stat {
+    int64_t inBytes = 0;
+    int64_t outBytes = 0;
+    int64_t durationUs = 0;
+  };
+
+  explicit ZlibCodec(int level = DEFAULT_LEVEL);
+  ~ZlibCodec();
+  ZlibCodec(const ZlibCodec&) = delete;
+  ZlibCodec& operator=(const ZlibCodec&) = delete;
+
+  void setLevel(int level);
+  int level() const { return m_level; }
+
+  bool compress(const char* data, std::size_t size, std::string& result);
+
+  // Start a new body. Without a size hint the output is preallocated from
+  // the compression ratio of the previous bodies.
+  void beginDecompress(std::size_t compressedSize, std::size_t sizeHint = 0);
+  // Return false if the data is not a valid zlib stream
+  bool decompressChunk(const char* data, std::size_t size);
+  bool decompressFinished() const { return m_inflateFinished; }
+  std::string takeDecompressed();
+  bool decompress(const char* data, std::size_t size, std::string& result,
+                  std::size_t sizeHint = 0);
+
+  const Stat& compressStat() const { return m_compressStat; }
+  const Stat& decompressStat() const { return m_decompressStat; }
+
+ private:
+  int m_level = DEFAULT_LEVEL;
+  std::unique_ptr<z_stream_s> m_deflate;
+  std::unique_ptr<z_stream_s> m_inflate;
+  bool m_deflateReady = false;
+  bool m_inflateReady = false;
+  bool m_inflateFinished = false;
+  bool m_inflateFailed = false;
+  std::string m_inflated;
+  std::size_t m_inflatedSize = 0;
+  Stat m_compressStat;
+  Stat m_decompressStat;
+};
+
+std::optional<std::string> tryCompress(
+    const std::string& decompressed,
+    int level = ZlibCodec::BEST_COMPRESSION_LEVEL);
 std::optional<std::string> tryDecompress(const std::string& compressed);
 
 }  // namespace FOEDAG
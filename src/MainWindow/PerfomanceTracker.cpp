@@ -31,8 +31,9 @@ namespace FOEDAG {
 PerfomanceTracker::PerfomanceTracker(TaskManager *tManager)
     : m_taskManager(tManager) {
   m_view = new QTableWidget;
-  m_view->setColumnCount(3);
-  m_view->setHorizontalHeaderLabels({"Task", "Duration, s", "Utilization, MB"});
+  m_view->setColumnCount(4);
+  m_view->setHorizontalHeaderLabels(
+      {"Task", "Duration, s", "Utilization, MB", "CPU time, s"});
   m_view->verticalHeader()->hide();
   m_view->resizeColumnsToContents();
   m_view->setColumnWidth(0, 180);
@@ -62,13 +63,15 @@ void PerfomanceTracker::buildTable() {
     auto task = m_taskManager->task(taskId);
     if (!task) continue;
 
-    for (int i = 0; i < 3; i++) m_view->setItem(row, i, new QTableWidgetItem{});
+    for (int i = 0; i < 4; i++) m_view->setItem(row, i, new QTableWidgetItem{});
 
     m_view->item(row, 0)->setText(task->title());
     m_view->item(row, 1)->setText(
         ToString(static_cast<double>(task->utilization().duration) / 1000));
     m_view->item(row, 2)->setText(
         ToString(static_cast<double>(task->utilization().utilization) / 1024));
+    m_view->item(row, 3)->setText(
+        ToString(static_cast<double>(task->utilization().cpuTime) / 1000));
     row++;
   }
 }
@@ -0,0 +1,67 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "DesignChangeJournal.h"
+
+#include <algorithm>
+
+namespace FOEDAG {
+
+DesignChangeJournal::DesignChangeJournal(size_t capacity)
+    : m_capacity(std::max<size_t>(capacity, 1)) {}
+
+uint64_t DesignChangeJournal::record(const std::string &path,
+                                     DesignFileChange::Kind kind) {
+  std::lock_guard<std::mutex> lock{m_mutex};
+  DesignFileChange change;
+  change.sequence = ++m_lastSequence;
+  change.path = path;
+  change.kind = kind;
+  change.time = std::chrono::system_clock::now();
+  m_changes.push_back(change);
+  if (m_changes.size() > m_capacity) m_changes.pop_front();
+  return change.sequence;
+}
+
+uint64_t DesignChangeJournal::lastSequence() const {
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_lastSequence;
+}
+
+bool DesignChangeJournal::changesSince(
+    uint64_t sequence, std::vector<DesignFileChange> &changes) const {
+  std::lock_guard<std::mutex> lock{m_mutex};
+  changes.clear();
+  // Sequences are contiguous, the first kept change tells what was dropped
+  const uint64_t first =
+      m_changes.empty() ? m_lastSequence + 1 : m_changes.front().sequence;
+  for (const auto &change : m_changes) {
+    if (change.sequence > sequence) changes.push_back(change);
+  }
+  return sequence + 1 >= first;
+}
+
+void DesignChangeJournal::clear() {
+  std::lock_guard<std::mutex> lock{m_mutex};
+  // Sequences keep growing, consumers see the cleared changes as dropped
+  m_changes.clear();
+}
+
+}  // namespace FOEDAG
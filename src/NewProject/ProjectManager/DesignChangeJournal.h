@@ -0,0 +1,76 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace FOEDAG {
+
+struct DesignFileChange {
+  enum class Kind {
+    Modified,
+    Created,
+    Removed,
+    // File added to or removed from the project file list
+    Listed,
+    // Target device changed, path is the device name
+    Device,
+    // Watcher lost events, everything has to be checked again
+    Overflow
+  };
+  uint64_t sequence{0};
+  std::string path{};
+  Kind kind{Kind::Modified};
+  std::chrono::system_clock::time_point time{};
+};
+
+/*!
+ * \brief The DesignChangeJournal class
+ * Bounded and thread safe log of the design file changes. A consumer keeps
+ * the sequence of the last change it handled and asks for the following
+ * ones instead of checking the whole project again. When older changes were
+ * dropped, the consumer has to check everything.
+ */
+class DesignChangeJournal {
+ public:
+  explicit DesignChangeJournal(size_t capacity = 4096);
+
+  uint64_t record(const std::string &path, DesignFileChange::Kind kind);
+  // Sequence of the last recorded change, 0 if none
+  uint64_t lastSequence() const;
+  // Changes recorded after sequence. False if some of them were dropped
+  bool changesSince(uint64_t sequence,
+                    std::vector<DesignFileChange> &changes) const;
+  void clear();
+
+ private:
+  const size_t m_capacity;
+  std::deque<DesignFileChange> m_changes;
+  uint64_t m_lastSequence{0};
+  mutable std::mutex m_mutex;
+};
+
+}  // namespace FOEDAG
@@ -20,7 +20,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include "DesignFileWatcher.h"
 
+#include <QFileInfo>
+#include <QSet>
+#include <QTimer>
+#include <algorithm>
+
 #include "Compiler/Compiler.h"
+#include "InotifyWatcher.h"
 #include "MainWindow/Session.h"
 #include "project_manager.h"
 
@@ -38,17 +44,64 @@ DesignFileWatcher* DesignFileWatcher::Instance() {
 //  return designFileWatcher(); }
 
 void DesignFileWatcher::init() {
+  m_debounce = new QTimer{this};
+  m_debounce->setSingleShot(true);
+  QObject::connect(m_debounce, &QTimer::timeout, this,
+                   &DesignFileWatcher::flushChanges);
+
+  auto inotify = new InotifyWatcher{};
+  if (inotify->isValid()) {
+    m_inotify = inotify;
+    QObject::connect(m_inotify, &InotifyWatcher::pathChanged, this,
+                     &DesignFileWatcher::fileChanged);
+    return;
+  }
+  delete inotify;
   m_fileWatcher = new QFileSystemWatcher{};
   QObject::connect(m_fileWatcher, &QFileSystemWatcher::fileChanged, this,
-                   &DesignFileWatcher::designFilesChanged);
+                   [this](const QString& path) {
+                     // Saving through a rename drops the path from the
+                     // watcher, watch the new file again
+                     const bool exists = QFileInfo::exists(path);
+                     if (exists && !m_fileWatcher->files().contains(path))
+                       m_fileWatcher->addPath(path);
+                     fileChanged(path, exists
+                                           ? DesignFileChange::Kind::Modified
+                                           : DesignFileChange::Kind::Removed);
+                   });
 }
 
-void DesignFileWatcher::emitDesignCreated() { emit designCreated(); }
+void DesignFileWatcher::emitDesignCreated() {
+  // Flows of batch_run don't work on the project of the main window
+  if (Project::Scoped()) return;
+  emit designCreated();
+}
 
-void DesignFileWatcher::setFiles(const QStringList& filePaths) {
+void DesignFileWatcher::setFiles(const QStringList& filePaths,
+                                 const QStringList& dirPaths) {
   if (!isValid()) return;
   // Do nothing if new file list is the same
-  if (filePaths != m_watchFiles) {
+  if (filePaths == m_watchFiles && dirPaths == m_watchDirs) return;
+
+  // Convert paths incase they have PROJECT_OSRCDIR relative paths
+  auto resolve = [](const QStringList& paths) {
+    QSet<QString> resolved;
+    for (auto path : paths) {
+      path.replace(PROJECT_OSRCDIR, Project::Instance()->projectPath());
+      resolved.insert(path);
+    }
+    return resolved;
+  };
+  const QSet<QString> oldPaths = resolve(m_watchFiles) + resolve(m_watchDirs);
+  const QSet<QString> files = resolve(filePaths);
+  const QSet<QString> dirs = resolve(dirPaths);
+
+  if (m_inotify) {
+    // One watch per directory, the number of files doesn't matter
+    m_inotify->removeAll();
+    for (const auto& file : files) m_inotify->addFile(file);
+    for (const auto& dir : dirs) m_inotify->addDirectory(dir);
+  } else {
     // QT prints to terminal if you call removePaths on an empty filewatcher
     // so we have to check for empty first
     if (!m_fileWatcher->files().empty()) {
@@ -59,29 +112,63 @@ void DesignFileWatcher::setFiles(const QStringList& filePaths) {
     // Add each file to the watcher
     // Note that some systems potentially have a max file limit, see qt docs
     // for details https://doc.qt.io/qt-5/qfilesystemwatcher.html#details
-    for (auto file : filePaths) {
-      // Convert paths incase they have PROJECT_OSRCDIR relative paths
-      file.replace(PROJECT_OSRCDIR, Project::Instance()->projectPath());
-      // Add file to watcher
-      m_fileWatcher->addPath(file);
-    }
-    m_watchFiles = filePaths;
-
-    // Consider any change to the design file list (filePaths) a design change
-    emit designFilesChanged();
+    for (const auto& file : files) m_fileWatcher->addPath(file);
+  }
+  m_watchFiles = filePaths;
+  m_watchDirs = dirPaths;
+
+  // Consider any change to the design file list (filePaths) a design change
+  const QSet<QString> newPaths = files + dirs;
+  for (const auto& path : newPaths + oldPaths) {
+    if (newPaths.contains(path) != oldPaths.contains(path))
+      m_journal.record(path.toStdString(), DesignFileChange::Kind::Listed);
   }
+  flushChanges();
 }
 
 void DesignFileWatcher::setDevice(const std::string& device) {
   if (m_device != device) {
     m_device = device;
-    emit designFilesChanged();
+    m_journal.record(device, DesignFileChange::Kind::Device);
+    flushChanges();
+  }
+}
+
+void DesignFileWatcher::fileChanged(const QString& path,
+                                    DesignFileChange::Kind kind) {
+  using Kind = DesignFileChange::Kind;
+  auto pending = m_pending.find(path);
+  if (pending == m_pending.end()) {
+    m_pending.insert(path, kind);
+  } else if (pending.value() == Kind::Removed && kind == Kind::Created) {
+    // Editors saving through a temporary file replace the original
+    pending.value() = Kind::Modified;
+  } else if (kind == Kind::Removed || kind == Kind::Overflow) {
+    pending.value() = kind;
   }
+  m_hasPending = true;
+
+  // Restart the quiet period, bounded by the maximum latency
+  if (!m_firstPending.isValid()) m_firstPending.start();
+  const qint64 remaining = m_maxLatency - m_firstPending.elapsed();
+  m_debounce->start(static_cast<int>(
+      std::clamp<qint64>(remaining, 0, m_debounceInterval)));
+}
+
+void DesignFileWatcher::flushChanges() {
+  m_debounce->stop();
+  m_firstPending.invalidate();
+  for (auto it = m_pending.cbegin(); it != m_pending.cend(); ++it)
+    m_journal.record(it.key().toStdString(), it.value());
+  m_pending.clear();
+  m_hasPending = false;
+  emit designFilesChanged();
 }
 
 void DesignFileWatcher::updateDesignFileWatchers(ProjectManager* pManager) {
-  if (!isValid()) return;
+  if (!isValid() || Project::Scoped()) return;
   QStringList files;
+  QStringList dirs;
 
   // Watch Design Files
   files += pManager->getDesignFiles();
@@ -110,13 +197,28 @@ void DesignFileWatcher::updateDesignFileWatchers(ProjectManager* pManager) {
         // Store file
         files += QString::fromStdString(file.string());
       }
+      // inotify also sees the files added by the next generation
+      if (m_inotify)
+        dirs += QString::fromStdString(ipGen->GetBuildDir(instance).string());
     }
   }
 
-  setFiles(files);
+  setFiles(files, dirs);
   setDevice(pManager->getTargetDevice());
 }
 
-bool DesignFileWatcher::isValid() const { return m_fileWatcher != nullptr; }
+bool DesignFileWatcher::isValid() const {
+  return m_fileWatcher != nullptr || m_inotify != nullptr;
+}
+
+const DesignChangeJournal& DesignFileWatcher::journal() const {
+  return m_journal;
+}
+
+bool DesignFileWatcher::hasPendingChanges() const { return m_hasPending; }
+
+void DesignFileWatcher::setDebounceInterval(int msec) {
+  m_debounceInterval = std::max(msec, 0);
+}
 
 }  // namespace FOEDAG
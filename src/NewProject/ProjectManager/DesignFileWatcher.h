@@ -20,11 +20,28 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #pragma once
 
+#include <QElapsedTimer>
 #include <QFileSystemWatcher>
+#include <QMap>
+#include <atomic>
+
+#include "DesignChangeJournal.h"
+
+class QTimer;
 
 namespace FOEDAG {
 class ProjectManager;
+class InotifyWatcher;
 
+/*!
+ * \brief The DesignFileWatcher class
+ * Watches the design files of the project. File events are debounced: a
+ * burst of saves is reported by a single designFilesChanged once the files
+ * are quiet for the debounce interval, or at the latest after the maximum
+ * latency. Every change is recorded in the journal so consumers can tell
+ * which files changed. Uses inotify when available, QFileSystemWatcher
+ * otherwise.
+ */
 class DesignFileWatcher : public QObject {
   Q_OBJECT
 
@@ -34,19 +51,38 @@ class DesignFileWatcher : public QObject {
   void emitDesignCreated();
   void updateDesignFileWatchers(ProjectManager *pManager);
   bool isValid() const;
+  const DesignChangeJournal &journal() const;
+  // True while file events wait for the end of their burst, thread safe
+  bool hasPendingChanges() const;
+  void setDebounceInterval(int msec);
+  // Records a file event, designFilesChanged is emitted once the files are
+  // quiet
+  void fileChanged(const QString &path, DesignFileChange::Kind kind);
+  // Records the pending file events and emits designFilesChanged
+  void flushChanges();
 
  signals:
   void designFilesChanged();
   void designCreated();
 
  private:
-  void setFiles(const QStringList &filePaths);
+  void setFiles(const QStringList &filePaths, const QStringList &dirPaths);
   void setDevice(const std::string &device);
 
  private:
   QStringList m_watchFiles{};
+  QStringList m_watchDirs{};
   std::string m_device{};
   QFileSystemWatcher *m_fileWatcher{nullptr};
+  InotifyWatcher *m_inotify{nullptr};
+  DesignChangeJournal m_journal{};
+  // Changes waiting for the end of the burst, coalesced per path
+  QMap<QString, DesignFileChange::Kind> m_pending{};
+  QTimer *m_debounce{nullptr};
+  QElapsedTimer m_firstPending{};
+  std::atomic_bool m_hasPending{false};
+  int m_debounceInterval{200};
+  int m_maxLatency{1000};
 };
 
 }  // namespace FOEDAG
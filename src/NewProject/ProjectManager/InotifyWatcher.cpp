@@ -0,0 +1,180 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "InotifyWatcher.h"
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QSocketNotifier>
+#include <utility>
+#include <vector>
+
+namespace FOEDAG {
+
+#ifdef __linux__
+static constexpr uint32_t kWatchMask = IN_CLOSE_WRITE | IN_CREATE |
+                                       IN_DELETE | IN_MOVED_FROM |
+                                       IN_MOVED_TO | IN_DELETE_SELF |
+                                       IN_MOVE_SELF | IN_ONLYDIR;
+#endif
+
+InotifyWatcher::InotifyWatcher(QObject *parent) : QObject(parent) {
+#ifdef __linux__
+  m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (m_fd < 0) return;
+  m_notifier = new QSocketNotifier{m_fd, QSocketNotifier::Read, this};
+  connect(m_notifier, &QSocketNotifier::activated, this,
+          &InotifyWatcher::readEvents);
+#endif
+}
+
+InotifyWatcher::~InotifyWatcher() {
+#ifdef __linux__
+  if (m_fd >= 0) close(m_fd);
+#endif
+}
+
+bool InotifyWatcher::isValid() const { return m_fd >= 0; }
+
+bool InotifyWatcher::addFile(const QString &path) {
+  QFileInfo info{path};
+  int wd = watchDirectory(info.absolutePath());
+  if (wd < 0) return false;
+  m_watches[wd].files.insert(info.fileName());
+  return true;
+}
+
+bool InotifyWatcher::addDirectory(const QString &path) {
+  const QString dir = QFileInfo{path}.absoluteFilePath();
+  if (!QFileInfo{dir}.isDir()) return false;
+  addTree(dir);
+  return m_dirs.contains(dir);
+}
+
+void InotifyWatcher::removeFile(const QString &path) {
+  QFileInfo info{path};
+  auto dir = m_dirs.find(info.absolutePath());
+  if (dir == m_dirs.end()) return;
+  Watch &watch = m_watches[dir.value()];
+  watch.files.remove(info.fileName());
+  if (watch.files.isEmpty() && !watch.recursive) removeWatch(dir.value());
+}
+
+void InotifyWatcher::removeDirectory(const QString &path) {
+  const QString dir = QFileInfo{path}.absoluteFilePath();
+  std::vector<int> unused;
+  for (auto it = m_watches.begin(); it != m_watches.end(); ++it) {
+    if (it->dir != dir && !it->dir.startsWith(dir + "/")) continue;
+    it->recursive = false;
+    if (it->files.isEmpty()) unused.push_back(it.key());
+  }
+  for (int wd : unused) removeWatch(wd);
+}
+
+void InotifyWatcher::removeAll() {
+  const auto watches = m_watches.keys();
+  for (int wd : watches) removeWatch(wd);
+}
+
+int InotifyWatcher::watchDirectory(const QString &dir) {
+  auto existing = m_dirs.find(dir);
+  if (existing != m_dirs.end()) return existing.value();
+#ifdef __linux__
+  if (m_fd < 0) return -1;
+  int wd = inotify_add_watch(m_fd, dir.toLocal8Bit().constData(), kWatchMask);
+  if (wd < 0) return -1;
+  m_watches[wd].dir = dir;
+  m_dirs[dir] = wd;
+  return wd;
+#else
+  return -1;
+#endif
+}
+
+void InotifyWatcher::addTree(const QString &dir) {
+  int wd = watchDirectory(dir);
+  if (wd < 0) return;
+  m_watches[wd].recursive = true;
+  QDirIterator it{dir, QDir::Dirs | QDir::NoDotAndDotDot,
+                  QDirIterator::Subdirectories};
+  while (it.hasNext()) {
+    int sub = watchDirectory(it.next());
+    if (sub >= 0) m_watches[sub].recursive = true;
+  }
+}
+
+void InotifyWatcher::removeWatch(int wd) {
+  auto it = m_watches.find(wd);
+  if (it == m_watches.end()) return;
+#ifdef __linux__
+  inotify_rm_watch(m_fd, wd);
+#endif
+  m_dirs.remove(it->dir);
+  m_watches.erase(it);
+}
+
+void InotifyWatcher::readEvents() {
+#ifdef __linux__
+  // Signals are emitted once the watches are up to date
+  std::vector<std::pair<QString, DesignFileChange::Kind>> changes;
+  alignas(inotify_event) char buffer[4096];
+  ssize_t length{0};
+  while ((length = read(m_fd, buffer, sizeof(buffer))) > 0) {
+    const inotify_event *event{nullptr};
+    for (char *ptr = buffer; ptr < buffer + length;
+         ptr += sizeof(inotify_event) + event->len) {
+      event = reinterpret_cast<const inotify_event *>(ptr);
+      if (event->mask & IN_Q_OVERFLOW) {
+        changes.emplace_back(QString{}, DesignFileChange::Kind::Overflow);
+        continue;
+      }
+      auto it = m_watches.find(event->wd);
+      if (it == m_watches.end()) continue;
+      if (event->mask & IN_IGNORED) {
+        // Directory removed, the kernel dropped the watch
+        m_dirs.remove(it->dir);
+        m_watches.erase(it);
+        continue;
+      }
+      if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) continue;
+      const Watch watch = it.value();
+      const QString name = QString::fromLocal8Bit(event->name);
+      const QString path = watch.dir + "/" + name;
+      if (!watch.recursive && !watch.files.contains(name)) continue;
+      DesignFileChange::Kind kind{DesignFileChange::Kind::Modified};
+      if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+        kind = DesignFileChange::Kind::Created;
+        if (watch.recursive && (event->mask & IN_ISDIR)) addTree(path);
+      } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+        kind = DesignFileChange::Kind::Removed;
+      }
+      changes.emplace_back(path, kind);
+    }
+  }
+  for (const auto &[path, kind] : changes) emit pathChanged(path, kind);
+#endif
+}
+
+}  // namespace FOEDAG
@@ -0,0 +1,77 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+
+#include "DesignChangeJournal.h"
+
+class QSocketNotifier;
+
+namespace FOEDAG {
+
+/*!
+ * \brief The InotifyWatcher class
+ * Linux file watcher on top of inotify. Files are watched through their
+ * directory: one watch covers all the files of a directory and editors
+ * saving through a temporary file and a rename are still seen. Directories
+ * can be watched recursively, new subdirectories are watched as they show
+ * up. On other systems the watcher is not valid.
+ */
+class InotifyWatcher : public QObject {
+  Q_OBJECT
+
+ public:
+  explicit InotifyWatcher(QObject *parent = nullptr);
+  ~InotifyWatcher() override;
+  bool isValid() const;
+
+  bool addFile(const QString &path);
+  bool addDirectory(const QString &path);
+  void removeFile(const QString &path);
+  void removeDirectory(const QString &path);
+  void removeAll();
+
+ signals:
+  void pathChanged(const QString &path, FOEDAG::DesignFileChange::Kind kind);
+
+ private:
+  struct Watch {
+    QString dir;
+    // Files of interest, all of them if the directory is watched
+    QSet<QString> files;
+    bool recursive{false};
+  };
+  int watchDirectory(const QString &dir);
+  void addTree(const QString &dir);
+  void removeWatch(int wd);
+  void readEvents();
+
+  int m_fd{-1};
+  QSocketNotifier *m_notifier{nullptr};
+  QHash<int, Watch> m_watches;
+  QHash<QString, int> m_dirs;
+};
+
+}  // namespace FOEDAG
@@ -4,7 +4,25 @@ using namespace FOEDAG;
 
 Q_GLOBAL_STATIC(Project, project)
 
-Project *Project::Instance() { return project(); }
+// Project of the flow running on this thread, see Project::Scope
+static thread_local Project *scopedProject{nullptr};
+
+Project *Project::Instance() {
+  return scopedProject ? scopedProject : project();
+}
+
+Project *Project::Scoped() { return scopedProject; }
+
+Project::Scope::Scope(Project *project) : m_previous(scopedProject) {
+  scopedProject = project;
+}
+
+Project::Scope::~Scope() { scopedProject = m_previous; }
+
+Project::~Project() {
+  qDeleteAll(m_mapProjectRun);
+  qDeleteAll(m_mapProjectFileset);
+}
 
 void Project::InitProject() {
   m_projectName.clear();
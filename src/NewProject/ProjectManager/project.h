@@ -16,7 +16,27 @@ class Project : public QObject {
   Q_OBJECT
 
  public:
+  /*!
+   * \brief The Scope class
+   * Makes a project the one returned by Instance() on the calling thread for
+   * the lifetime of the scope, so that flows run side by side in one process
+   * each work on their own project.
+   */
+  class Scope {
+   public:
+    explicit Scope(Project *project);
+    ~Scope();
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+   private:
+    Project *m_previous{nullptr};
+  };
+
   static Project *Instance();
+  // Project of the scope active on the calling thread, nullptr if none
+  static Project *Scoped();
+  ~Project() override;
 
   void InitProject();
 
@@ -51,7 +71,7 @@ class Project : public QObject {
   QString m_projectName;
   QString m_projectPath;
 
-  ProjectConfiguration *m_projectConfig;
+  ProjectConfiguration *m_projectConfig{nullptr};
   std::unique_ptr<CompilerConfiguration> m_compilerConfig;
   std::unique_ptr<CompilerConfiguration> m_simulationConfig;
   std::unique_ptr<IpConfiguration> m_ipConfig;
@@ -20,10 +20,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include "PortsLoader.h"
 
-#include <QFile>
+#include <QDebug>
 
-#include "nlohmann_json/json.hpp"
-using json = nlohmann::ordered_json;
+#include "DesignQuery/PortIndex.h"
 
 namespace FOEDAG {
 
@@ -32,53 +31,34 @@ PortsLoader::PortsLoader(PortsModel *model, QObject *parent)
 
 std::pair<bool, QString> PortsLoader::load(const QString &file) {
   if (!m_model) return std::make_pair(false, "Ports model is missing");
-  QFile f{file};
-  if (!f.open(QFile::ReadOnly))
-    return std::make_pair(false, QString("Can't open file %1").arg(file));
+  auto [index, error] = PortIndex::Load(file.toStdString());
+  if (!index) return std::make_pair(false, QString::fromStdString(error));
+  if (!error.empty()) qWarning() << QString::fromStdString(error);
 
-  QString content = f.readAll();
-  json jsonObject;
-  try {
-    jsonObject = json::parse(content.toStdString());
-  } catch (json::parse_error &e) {
-    const QString error =
-        QString("Json Error: %1\nFile: %2\nByte position of error: %3")
-            .arg(e.what(), file, QString::number(e.byte));
-    return std::make_pair(false, error);
-  }
-  for (auto p{jsonObject.cbegin()}; p != jsonObject.cend(); ++p) {
+  for (const auto &ports : index->groups()) {
     IOPortGroup group;
-    auto ports = p->at("ports");
     group.ports.reserve(ports.size());
-    for (auto it{ports.cbegin()}; it != ports.cend(); ++it) {
-      const auto range = it->at("range");
-      const int msb = range["msb"];
-      const int lsb = range["lsb"];
-
-      IOPort ioport{QString::fromStdString(it->at("name")),
-                    QString::fromStdString(it->at("direction")),
-                    QString(),
-                    QString::fromStdString(it->at("type")),
-                    QString("Msb: %1, lsb: %2")
-                        .arg(QString::number(msb), QString::number(lsb)),
-                    (msb != lsb),
-                    {}};
+    for (const auto &port : ports) {
+      const QString name = QString::fromStdString(port.name);
+      const QString direction = QString::fromStdString(port.direction);
+      const QString type = QString::fromStdString(port.type);
+      const QString range =
+          QString("Msb: %1, lsb: %2")
+              .arg(QString::number(port.msb), QString::number(port.lsb));
+      IOPort ioport{name, direction, QString(), type, range, port.isBus(), {}};
       if (ioport.isBus) {
-        const int step = msb > lsb ? -1 : 1;
-        const int end = lsb + step;
-        ioport.ports.reserve(std::abs(msb - lsb) + 1);
-        for (int i{msb}; i != end; i += step) {
-          const IOPort port{
-              QString("%1[%2]").arg(QString::fromStdString(it->at("name")),
-                                    QString::number(i)),
-              QString::fromStdString(it->at("direction")),
-              QString(),
-              QString::fromStdString(it->at("type")),
-              QString("Msb: %1, lsb: %2")
-                  .arg(QString::number(msb), QString::number(lsb)),
-              false,
-              {}};
-          ioport.ports.append(port);
+        const int step = port.msb > port.lsb ? -1 : 1;
+        const int end = port.lsb + step;
+        ioport.ports.reserve(std::abs(port.msb - port.lsb) + 1);
+        for (int i{port.msb}; i != end; i += step) {
+          const IOPort bit{QString("%1[%2]").arg(name, QString::number(i)),
+                           direction,
+                           QString(),
+                           type,
+                           range,
+                           false,
+                           {}};
+          ioport.ports.append(bit);
         }
       }
       group.ports.append(ioport);
@@ -262,7 +262,8 @@ bool TclCommandIntegration::TclCreateProject(int argc, const char *argv[],
 
 bool TclCommandIntegration::TclCreateProject(const std::string &name,
                                              const std::string &type,
-                                             bool cleanup, std::ostream &out) {
+                                             bool cleanup, std::ostream &out,
+                                             const QString &baseDir) {
   if (!validate()) {
     out << "Command validation fail: internal error" << std::endl;
     return false;
@@ -282,13 +283,13 @@ bool TclCommandIntegration::TclCreateProject(const std::string &name,
   }
 
   QString nameqstr = QString::fromStdString(name);
-  QDir dir(nameqstr);
+  QDir dir(baseDir.isEmpty() ? nameqstr : QDir{baseDir}.filePath(nameqstr));
   if (dir.exists()) {
     if (cleanup) dir.removeRecursively();
     out << "Project \"" << name << "\" was rewritten.";
   }
 
-  createNewDesign(nameqstr, projectType);
+  createNewDesign(nameqstr, projectType, baseDir);
   return true;
 }
 
@@ -550,9 +551,11 @@ void TclCommandIntegration::setIPGenerator(IPGenerator *gen) {
 }
 
 void TclCommandIntegration::createNewDesign(const QString &projName,
-                                            int projectType) {
+                                            int projectType,
+                                            const QString &baseDir) {
+  const QString base = baseDir.isEmpty() ? QDir::currentPath() : baseDir;
   ProjectOptions opt{projName,
-                     QString("%1/%2").arg(QDir::currentPath(), projName),
+                     QString("%1/%2").arg(base, projName),
                      projectType,
                      {{}, false},
                      {{}, false},
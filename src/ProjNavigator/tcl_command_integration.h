@@ -51,8 +51,10 @@ class TclCommandIntegration : public QObject {
   bool TclSetActive(int argc, const char *argv[], std::ostream &out);
   bool TclSetAsTarget(int argc, const char *argv[], std::ostream &out);
   bool TclCreateProject(int argc, const char *argv[], std::ostream &out);
+  // The project is created in baseDir, the current path if empty
   bool TclCreateProject(const std::string &name, const std::string &type,
-                        bool cleanup, std::ostream &out);
+                        bool cleanup, std::ostream &out,
+                        const QString &baseDir = {});
   bool TclCloseProject();
   bool TclClearSimulationFiles(std::ostream &out);
 
@@ -77,7 +79,8 @@ class TclCommandIntegration : public QObject {
   void updateReports();
 
  private:
-  void createNewDesign(const QString &design, int projectType = 0);
+  void createNewDesign(const QString &design, int projectType = 0,
+                       const QString &baseDir = {});
   static bool isVHDL(const std::string &str);
 
  private:
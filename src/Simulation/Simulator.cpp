@@ -944,6 +944,9 @@ int Simulator::SimulationJob(SimulationType simulation, SimulatorType type,
     summaryUtils.duration += utils.duration;
     summaryUtils.utilization =
         std::max(summaryUtils.utilization, utils.utilization);
+    summaryUtils.cpuTime += utils.cpuTime;
+    summaryUtils.readBytes += utils.readBytes;
+    summaryUtils.writeBytes += utils.writeBytes;
   };
 
   std::string log{LogFile(simulation)};
@@ -957,7 +960,8 @@ int Simulator::SimulationJob(SimulationType simulation, SimulatorType type,
   command += " " + fileList;
   std::string workingDir =
       m_compiler->FilePath(Compiler::ToCompilerAction(simulation)).string();
-  FileUtils::WriteToFile(CommandLogFile("comp"), command);
+  const std::filesystem::path commandLogDir{workingDir};
+  FileUtils::WriteToFile(commandLogDir / CommandLogFile("comp"), command);
   int status = m_compiler->ExecuteAndMonitorSystemCommand(command, log, false,
                                                           workingDir);
   appendSumUtils(m_compiler->m_utils);
@@ -975,7 +979,7 @@ int Simulator::SimulationJob(SimulationType simulation, SimulatorType type,
           "make -j -C obj_dir/ -f V" + simulationTop + ".mk V" + simulationTop;
       if (!GetSimulatorElaborationOption(simulation, type).empty())
         command += " " + GetSimulatorElaborationOption(simulation, type);
-      FileUtils::WriteToFile(CommandLogFile("make"), command);
+      FileUtils::WriteToFile(commandLogDir / CommandLogFile("make"), command);
       status = m_compiler->ExecuteAndMonitorSystemCommand(command, log, true,
                                                           workingDir);
       appendSumUtils(m_compiler->m_utils);
@@ -995,7 +999,7 @@ int Simulator::SimulationJob(SimulationType simulation, SimulatorType type,
       if (!simulationTop.empty()) {
         command += TopModuleCmd(type) + simulationTop;
       }
-      FileUtils::WriteToFile(CommandLogFile("make"), command);
+      FileUtils::WriteToFile(commandLogDir / CommandLogFile("make"), command);
       status = m_compiler->ExecuteAndMonitorSystemCommand(command, log, true,
                                                           workingDir);
       appendSumUtils(m_compiler->m_utils);
@@ -1012,7 +1016,8 @@ int Simulator::SimulationJob(SimulationType simulation, SimulatorType type,
 
   // Actual simulation
   command = SimulatorRunCommand(simulation, type);
-  FileUtils::WriteToFile(CommandLogFile(std::string{}), command);
+  FileUtils::WriteToFile(commandLogDir / CommandLogFile(std::string{}),
+                         command);
   status = m_compiler->ExecuteAndMonitorSystemCommand(command, log, true,
                                                       workingDir);
   appendSumUtils(m_compiler->m_utils);
@@ -34,6 +34,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <regex>
 #include <sstream>
 #include <string>
@@ -41,6 +42,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Utils/StringUtils.h"
 
 std::vector<QProcess*> FOEDAG::FileUtils::m_processes{};
+std::mutex FOEDAG::FileUtils::m_processesMutex{};
 
 namespace FOEDAG {
 
@@ -298,13 +300,17 @@ Return FileUtils::ExecuteSystemCommand(const std::string& command,
     return {success ? 0 : -1,
             QString{"%1: Failed to start."}.arg(program).toStdString()};
   } else {
+    std::lock_guard<std::mutex> lock{m_processesMutex};
     m_processes.push_back(&process);
     process.start(program, args_);
   }
 
   bool finished = process.waitForFinished(timeout_ms);
-  auto it = std::find(m_processes.begin(), m_processes.end(), &process);
-  if (it != m_processes.end()) m_processes.erase(it);
+  {
+    std::lock_guard<std::mutex> lock{m_processesMutex};
+    auto it = std::find(m_processes.begin(), m_processes.end(), &process);
+    if (it != m_processes.end()) m_processes.erase(it);
+  }
 
   std::string message{};
   if (!finished) {
@@ -380,6 +386,7 @@ void FileUtils::printArgs(int argc, const char* argv[]) {
 }
 
 void FileUtils::terminateSystemCommand() {
+  std::lock_guard<std::mutex> lock{m_processesMutex};
   for (auto pr : m_processes) pr->terminate();
 }
 
@@ -0,0 +1,244 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "MultiPatternReplacer.h"
+
+#include <algorithm>
+#include <fstream>
+#include <queue>
+#include <sstream>
+
+namespace FOEDAG {
+
+bool MultiPatternReplacer::add(const std::string& from, const std::string& to) {
+  if (from.empty()) return false;
+  for (const auto& [pattern, replacement] : m_patterns)
+    if (pattern == from) return false;
+  m_patterns.emplace_back(from, to);
+  m_built = false;
+  return true;
+}
+
+void MultiPatternReplacer::clear() {
+  m_patterns.clear();
+  m_nodes.clear();
+  m_built = false;
+}
+
+void MultiPatternReplacer::build() const {
+  if (m_built) return;
+  m_built = true;
+  m_nodes.assign(1, Node{});
+  for (size_t i = 0; i < m_patterns.size(); i++) {
+    int state{0};
+    for (unsigned char c : m_patterns[i].first) {
+      auto& next = m_nodes[state].next;
+      auto it = std::lower_bound(
+          next.begin(), next.end(), c,
+          [](const std::pair<unsigned char, int>& p, unsigned char ch) {
+            return p.first < ch;
+          });
+      if (it != next.end() && it->first == c) {
+        state = it->second;
+        continue;
+      }
+      int child = static_cast<int>(m_nodes.size());
+      next.insert(it, {c, child});
+      Node node;
+      node.depth = m_nodes[state].depth + 1;
+      m_nodes.push_back(node);
+      state = child;
+    }
+    if (m_nodes[state].output == -1) m_nodes[state].output = i;
+  }
+  m_rootNext.fill(0);
+  for (const auto& [c, child] : m_nodes[0].next) m_rootNext[c] = child;
+
+  // breadth first, fail links point to strictly shorter nodes
+  std::queue<int> queue;
+  for (const auto& [c, child] : m_nodes[0].next) queue.push(child);
+  while (!queue.empty()) {
+    int state = queue.front();
+    queue.pop();
+    for (const auto& [c, child] : m_nodes[state].next) {
+      m_nodes[child].fail = step(m_nodes[state].fail, c);
+      // terminal node matches itself, otherwise the longest suffix match
+      if (m_nodes[child].output == -1)
+        m_nodes[child].output = m_nodes[m_nodes[child].fail].output;
+      queue.push(child);
+    }
+  }
+}
+
+int MultiPatternReplacer::step(int state, unsigned char c) const {
+  while (state != 0) {
+    const auto& next = m_nodes[state].next;
+    auto it = std::lower_bound(
+        next.begin(), next.end(), c,
+        [](const std::pair<unsigned char, int>& p, unsigned char ch) {
+          return p.first < ch;
+        });
+    if (it != next.end() && it->first == c) return it->second;
+    state = m_nodes[state].fail;
+  }
+  return m_rootNext[c];
+}
+
+/*!
+ * Scanning state of one input. m_buffer holds text not yet written out
+ * starting at m_begin, a match is committed once no match starting at or
+ * before it can appear.
+ */
+class MultiPatternReplacer::Stream {
+ public:
+  Stream(const MultiPatternReplacer& replacer, std::ostream& out)
+      : m_replacer(replacer), m_out(out) {}
+
+  void feed(std::string_view chunk) {
+    m_buffer.append(chunk.data(), chunk.size());
+    scan(false);
+  }
+  void finish() {
+    scan(true);
+    m_out.write(m_buffer.data() + m_begin, m_buffer.size() - m_begin);
+    m_buffer.clear();
+    m_begin = 0;
+  }
+  size_t replacements() const { return m_replacements; }
+
+ private:
+  void scan(bool final) {
+    const auto& nodes = m_replacer.m_nodes;
+    while (true) {
+      while (m_pos < m_buffer.size()) {
+        m_state = m_replacer.step(m_state, m_buffer[m_pos++]);
+        const Node& node = nodes[m_state];
+        if (node.output != -1) {
+          size_t length = m_replacer.m_patterns[node.output].first.size();
+          size_t start = m_pos - length;
+          if (m_match == -1 || start < m_matchStart ||
+              (start == m_matchStart && length > m_matchLength)) {
+            m_match = node.output;
+            m_matchStart = start;
+            m_matchLength = length;
+          }
+        }
+        if (m_match != -1 && m_pos - node.depth > m_matchStart) commit();
+      }
+      if (!final || m_match == -1) break;
+      commit();
+    }
+    if (final) return;
+    // text before any possible match start is final
+    size_t keep = m_pos - nodes[m_state].depth;
+    if (m_match != -1) keep = std::min(keep, m_matchStart);
+    if (keep > m_begin) {
+      m_out.write(m_buffer.data() + m_begin, keep - m_begin);
+      m_begin = keep;
+    }
+    m_buffer.erase(0, m_begin);
+    m_pos -= m_begin;
+    if (m_match != -1) m_matchStart -= m_begin;
+    m_begin = 0;
+  }
+
+  void commit() {
+    m_out.write(m_buffer.data() + m_begin, m_matchStart - m_begin);
+    m_out << m_replacer.m_patterns[m_match].second;
+    m_replacements++;
+    // rescan text after the match from the automaton root
+    m_begin = m_matchStart + m_matchLength;
+    m_pos = m_begin;
+    m_state = 0;
+    m_match = -1;
+  }
+
+  const MultiPatternReplacer& m_replacer;
+  std::ostream& m_out;
+  std::string m_buffer;
+  size_t m_begin{0};
+  size_t m_pos{0};
+  int m_state{0};
+  int m_match{-1};
+  size_t m_matchStart{0};
+  size_t m_matchLength{0};
+  size_t m_replacements{0};
+};
+
+std::string MultiPatternReplacer::replace(std::string_view text) const {
+  if (m_patterns.empty()) return std::string{text};
+  build();
+  std::ostringstream out;
+  Stream stream{*this, out};
+  stream.feed(text);
+  stream.finish();
+  return out.str();
+}
+
+size_t MultiPatternReplacer::replace(std::istream& in, std::ostream& out,
+                                     size_t chunkSize) const {
+  build();
+  Stream stream{*this, out};
+  std::vector<char> chunk(std::max<size_t>(chunkSize, 1));
+  while (in.read(chunk.data(), chunk.size()) || in.gcount() > 0)
+    stream.feed({chunk.data(), static_cast<size_t>(in.gcount())});
+  stream.finish();
+  return stream.replacements();
+}
+
+bool MultiPatternReplacer::replaceInFile(const std::filesystem::path& file,
+                                         size_t* replacements,
+                                         std::string* error) const {
+  auto setError = [error](const std::string& message) {
+    if (error) *error = message;
+    return false;
+  };
+  if (replacements) *replacements = 0;
+  if (m_patterns.empty()) return true;
+  std::ifstream in{file, std::ios::binary};
+  if (!in.good()) return setError("Failed to open file: " + file.string());
+  std::filesystem::path temporary{file.string() + ".tmp"};
+  std::ofstream out{temporary, std::ios::binary};
+  if (!out.good())
+    return setError("Failed to open file: " + temporary.string());
+  size_t count = replace(in, out);
+  out.close();
+  in.close();
+  std::error_code ec;
+  if (out.fail()) {
+    std::filesystem::remove(temporary, ec);
+    return setError("Failed to write content to file: " + temporary.string());
+  }
+  if (count == 0) {
+    std::filesystem::remove(temporary, ec);
+    return true;
+  }
+  std::filesystem::rename(temporary, file, ec);
+  if (ec) {
+    std::string message{"Failed to write data to: " + file.string() +
+                        ". Error: " + ec.message()};
+    std::filesystem::remove(temporary, ec);
+    return setError(message);
+  }
+  if (replacements) *replacements = count;
+  return true;
+}
+
+}  // namespace FOEDAG
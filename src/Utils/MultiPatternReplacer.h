@@ -0,0 +1,77 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace FOEDAG {
+
+/*!
+ * \brief The MultiPatternReplacer class
+ * Replaces occurrences of many patterns in a single pass over the text with
+ * an Aho-Corasick automaton. Matches are chosen leftmost-longest and don't
+ * overlap; replaced text is not scanned again. Input can be streamed in
+ * chunks of any size, only the text of a possible match in progress is
+ * kept in memory.
+ */
+class MultiPatternReplacer {
+ public:
+  // Returns false for empty or already added pattern, first one wins
+  bool add(const std::string& from, const std::string& to);
+  size_t size() const { return m_patterns.size(); }
+  bool empty() const { return m_patterns.empty(); }
+  void clear();
+
+  std::string replace(std::string_view text) const;
+  // Returns number of replacements
+  size_t replace(std::istream& in, std::ostream& out,
+                 size_t chunkSize = 1024 * 1024) const;
+  // Rewrites the file through a temporary file renamed over the original,
+  // the file is left untouched if nothing was replaced or on error
+  bool replaceInFile(const std::filesystem::path& file,
+                     size_t* replacements = nullptr,
+                     std::string* error = nullptr) const;
+
+ private:
+  struct Node {
+    std::vector<std::pair<unsigned char, int>> next;  // sorted by char
+    int fail{0};
+    int output{-1};  // longest pattern ending here
+    int depth{0};
+  };
+  class Stream;
+  void build() const;
+  int step(int state, unsigned char c) const;
+
+  std::vector<std::pair<std::string, std::string>> m_patterns;
+  mutable std::vector<Node> m_nodes;
+  mutable std::array<int, 256> m_rootNext{};
+  mutable bool m_built{false};
+};
+
+}  // namespace FOEDAG
@@ -20,54 +20,228 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include "ProcessUtils.h"
 
-#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <string>
+#include <vector>
+
+#if !(defined(_MSC_VER) || defined(__CYGWIN__))
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#endif
 
 namespace FOEDAG {
 
-ProcessUtils::~ProcessUtils() { cleanup(); }
+// getrusage(RUSAGE_CHILDREN) covers all children of this process, it can be
+// attributed to a monitor only when no other one is running
+static std::atomic<int> activeMonitors{0};
+
+static uint64_t steadyMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+ProcessUtils::~ProcessUtils() {
+  if (m_thread) Stop();
+}
 
 ProcessUtils::uint ProcessUtils::Utilization() const {
-  return m_max_utiliation;
+  return static_cast<uint>(m_stats.peakRss);
 }
 
 void ProcessUtils::Frequency(uint p) { m_frequency = p; }
 
-void process_mem_usage(int64_t processId, const char *proccessIdStr,
-                       double &vm_usage /*in kiB*/) {
 #if (defined(_MSC_VER) || defined(__CYGWIN__))
+void process_mem_usage(int64_t processId, double &vm_usage /*in kiB*/) {
   PROCESS_MEMORY_COUNTERS_EX pmc;
   auto p = OpenProcess(PROCESS_ALL_ACCESS, FALSE, processId);
   GetProcessMemoryInfo(p, (PROCESS_MEMORY_COUNTERS *)&pmc, sizeof(pmc));
+  CloseHandle(p);
   vm_usage = pmc.PrivateUsage / 1024.0;
+}
+
+void ProcessUtils::Start(int64_t processId) {
+  m_startTime = steadyMs();
+  auto start = [processId, this]() {
+    while (!m_stop) {
+      double vm;
+      process_mem_usage(processId, vm);
+      m_stats.peakRss = std::max(m_stats.peakRss, static_cast<uint64_t>(vm));
+
+      std::chrono::milliseconds dura(m_frequency);
+      std::this_thread::sleep_for(dura);
+    }
+  };
+  m_thread = new std::thread{start};
+}
+
+void ProcessUtils::Stop() {
+  m_stop = true;
+  if (m_thread) {
+    m_thread->join();
+    m_stats.wallTime = steadyMs() - m_startTime;
+  }
+  cleanup();
+}
+
+void ProcessUtils::cleanup() {
+  delete m_thread;
+  m_thread = nullptr;
+}
 #else
-  std::ifstream stat_stream(proccessIdStr, std::ios_base::in);
+static int openProc(int64_t processId, const std::string &file) {
+  auto path = "/proc/" + std::to_string(processId) + "/" + file;
+  return open(path.c_str(), O_RDONLY | O_CLOEXEC);
+}
 
-  // dummy vars for leading entries in stat that we don't care about
-  std::string pid, comm, state, ppid, pgrp, session, tty_nr;
-  std::string tpgid, flags, minflt, cminflt, majflt, cmajflt;
-  std::string utime, stime, cutime, cstime, priority, nice;
-  std::string O, itrealvalue, starttime;
+// /proc files are regenerated on every read from offset 0
+static ssize_t readProc(int fd, char *buf, size_t size) {
+  ssize_t n = pread(fd, buf, size - 1, 0);
+  buf[std::max<ssize_t>(n, 0)] = '\0';
+  return n;
+}
 
-  unsigned long vsize;
+static const char *skipFields(const char *p, int count) {
+  for (int i = 0; i < count; i++) {
+    while (*p == ' ') p++;
+    while (*p && *p != ' ') p++;
+    if (!*p) return nullptr;
+  }
+  while (*p == ' ') p++;
+  return p;
+}
 
-  stat_stream >> pid >> comm >> state >> ppid >> pgrp >> session >> tty_nr >>
-      tpgid >> flags >> minflt >> cminflt >> majflt >> cmajflt >> utime >>
-      stime >> cutime >> cstime >> priority >> nice >> O >> itrealvalue >>
-      starttime >> vsize;  // don't care about the rest
+// Fields of /proc/<pid>/stat are counted from 1, the command name (2) may
+// contain spaces so parsing starts after its closing bracket
+static const char *statField(const char *buf, int field) {
+  const char *p = strrchr(buf, ')');
+  return p ? skipFields(p + 1, field - 3) : nullptr;
+}
 
-  stat_stream.close();
-  vm_usage = vsize / 1024.0;
-#endif
+static uint64_t ioValue(const char *buf, const char *key) {
+  const char *p = strstr(buf, key);
+  return p ? strtoull(p + strlen(key), nullptr, 10) : 0;
+}
+
+void ProcessUtils::addProbe(int64_t processId) {
+  Probe probe;
+  probe.statFd = openProc(processId, "stat");
+  if (probe.statFd < 0) return;  // already gone
+  probe.ioFd = openProc(processId, "io");
+  auto id = std::to_string(processId);
+  probe.childrenFd = openProc(processId, "task/" + id + "/children");
+  m_probes.emplace(processId, probe);
+}
+
+void ProcessUtils::closeProbe(Probe &probe) {
+  for (int *fd : {&probe.statFd, &probe.ioFd, &probe.childrenFd}) {
+    if (*fd >= 0) close(*fd);
+    *fd = -1;
+  }
+  probe.alive = false;
+}
+
+void ProcessUtils::discover(int64_t rootId, bool scanAll) {
+  if (m_probes.empty()) addProbe(rootId);
+  char buf[4096];
+  bool childrenFiles{true};
+  std::vector<int64_t> queue{rootId};
+  for (size_t i = 0; i < queue.size(); i++) {
+    auto it = m_probes.find(queue[i]);
+    if (it == m_probes.end() || !it->second.alive) continue;
+    if (it->second.childrenFd < 0) {
+      childrenFiles = false;
+      continue;
+    }
+    if (readProc(it->second.childrenFd, buf, sizeof(buf)) <= 0) continue;
+    char *p = buf;
+    while (*p) {
+      char *end{nullptr};
+      int64_t child = strtoll(p, &end, 10);
+      if (end == p) break;
+      p = end;
+      if (m_probes.count(child) == 0) addProbe(child);
+      queue.push_back(child);
+    }
+  }
+  if (childrenFiles || !scanAll) return;
+
+  // Kernel without /proc/<pid>/task/<tid>/children, use parent ids instead
+  std::vector<std::pair<int64_t, int64_t>> parents;  // pid, ppid
+  if (DIR *dir = opendir("/proc")) {
+    while (dirent *entry = readdir(dir)) {
+      char *end{nullptr};
+      int64_t pid = strtoll(entry->d_name, &end, 10);
+      if (*end || pid <= 0) continue;
+      int fd = openProc(pid, "stat");
+      if (fd < 0) continue;
+      if (readProc(fd, buf, sizeof(buf)) > 0) {
+        if (const char *ppid = statField(buf, 4))
+          parents.emplace_back(pid, strtoll(ppid, nullptr, 10));
+      }
+      close(fd);
+    }
+    closedir(dir);
+  }
+  bool added{true};
+  while (added) {
+    added = false;
+    for (const auto &[pid, ppid] : parents) {
+      if (m_probes.count(pid) == 0 && m_probes.count(ppid) != 0) {
+        addProbe(pid);
+        added = true;
+      }
+    }
+  }
+}
+
+void ProcessUtils::sample(int64_t rootId, bool scanAll) {
+  discover(rootId, scanAll);
+  static const long pageKiB = sysconf(_SC_PAGESIZE) / 1024;
+  char buf[1024];
+  uint64_t rss{0};
+  for (auto &[pid, probe] : m_probes) {
+    if (!probe.alive) continue;
+    const char *utime{nullptr};
+    if (readProc(probe.statFd, buf, sizeof(buf)) <= 0 ||
+        !(utime = statField(buf, 14))) {
+      closeProbe(probe);  // process exited, keep last values
+      continue;
+    }
+    char *end{nullptr};
+    probe.ticks[0] = strtoull(utime, &end, 10);
+    probe.ticks[1] = strtoull(end, &end, 10);
+    if (const char *rssField = skipFields(end, 24 - 16))
+      probe.rss = strtoull(rssField, nullptr, 10) * pageKiB;
+    rss += probe.rss;
+    if (probe.ioFd >= 0 && readProc(probe.ioFd, buf, sizeof(buf)) > 0) {
+      probe.io[0] = ioValue(buf, "rchar:");
+      probe.io[1] = ioValue(buf, "wchar:");
+    }
+  }
+  m_stats.peakRss = std::max(m_stats.peakRss, rss);
+}
+
+static void childrenUsage(int64_t usage[2], long *maxRss = nullptr) {
+  rusage ru{};
+  getrusage(RUSAGE_CHILDREN, &ru);
+  usage[0] = ru.ru_utime.tv_sec * 1000000LL + ru.ru_utime.tv_usec;
+  usage[1] = ru.ru_stime.tv_sec * 1000000LL + ru.ru_stime.tv_usec;
+  if (maxRss) *maxRss = ru.ru_maxrss;
 }
 
 void ProcessUtils::Start(int64_t processId) {
+  activeMonitors++;
+  m_startTime = steadyMs();
+  childrenUsage(m_childUsage, &m_childMaxRss);
   auto start = [processId, this]() {
-    auto str = ("/proc/" + std::to_string(processId) + "/stat");
-    while (!m_stop) {
-      double vm;
-      process_mem_usage(processId, str.c_str(), vm);
-      m_vm = std::max(m_vm, vm);
+    for (uint count = 0; !m_stop; count++) {
+      // full /proc scan is needed only on old kernels, keep it rare
+      sample(processId, count % 10 == 0);
 
       std::chrono::milliseconds dura(m_frequency);
       std::this_thread::sleep_for(dura);
@@ -78,14 +252,41 @@ void ProcessUtils::Start(int64_t processId) {
 
 void ProcessUtils::Stop() {
   m_stop = true;
-  if (m_thread) m_thread->join();
+  if (!m_thread) return;
+  m_thread->join();
   cleanup();
-  m_max_utiliation = static_cast<uint>(m_vm);
+  m_stats.wallTime = steadyMs() - m_startTime;
+  static const long ticksPerSecond = sysconf(_SC_CLK_TCK);
+  for (const auto &[pid, probe] : m_probes) {
+    m_stats.userTime += probe.ticks[0] * 1000 / ticksPerSecond;
+    m_stats.systemTime += probe.ticks[1] * 1000 / ticksPerSecond;
+    m_stats.readBytes += probe.io[0];
+    m_stats.writeBytes += probe.io[1];
+  }
+  // Reaped children are accounted exactly by the kernel, sampling misses
+  // short living processes and the last period
+  if (activeMonitors == 1) {
+    int64_t usage[2]{0, 0};
+    long maxRss{0};
+    childrenUsage(usage, &maxRss);
+    m_stats.userTime = std::max<uint64_t>(
+        m_stats.userTime, (usage[0] - m_childUsage[0]) / 1000);
+    m_stats.systemTime = std::max<uint64_t>(
+        m_stats.systemTime, (usage[1] - m_childUsage[1]) / 1000);
+    // ru_maxrss is the maximum over all reaped children, it belongs to this
+    // process tree only if it grew during the run
+    if (maxRss > m_childMaxRss)
+      m_stats.peakRss = std::max<uint64_t>(m_stats.peakRss, maxRss);
+  }
+  activeMonitors--;
+  m_probes.clear();
 }
 
 void ProcessUtils::cleanup() {
   delete m_thread;
   m_thread = nullptr;
+  for (auto &[pid, probe] : m_probes) closeProbe(probe);
 }
+#endif
 
 }  // namespace FOEDAG
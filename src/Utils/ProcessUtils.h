@@ -43,10 +43,26 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <unistd.h>
 #endif
 
+#include <atomic>
+#include <cstdint>
+#include <map>
 #include <thread>
 
 namespace FOEDAG {
 
+/*!
+ * \brief The ProcessStats struct
+ * Resources used by a monitored process and all its descendants.
+ */
+struct ProcessStats {
+  uint64_t peakRss{0};     // kiB, peak of the summed RSS of the process tree
+  uint64_t userTime{0};    // ms
+  uint64_t systemTime{0};  // ms
+  uint64_t readBytes{0};
+  uint64_t writeBytes{0};
+  uint64_t wallTime{0};  // ms
+};
+
 class ProcessUtils {
  public:
   ProcessUtils() = default;
@@ -55,9 +71,10 @@ class ProcessUtils {
 
   /*!
    * \brief Utilization
-   * \return max usage of virtual memory in kiB.
+   * \return peak memory usage of the process tree in kiB.
    */
   uint Utilization() const;
+  const ProcessStats &Stats() const { return m_stats; }
 
   /*!
    * \brief Period sets the frequency of measurment
@@ -67,13 +84,30 @@ class ProcessUtils {
   void Stop();
 
  private:
+  // Per process /proc files, opened once and re-read with pread
+  struct Probe {
+    int statFd{-1};
+    int ioFd{-1};
+    int childrenFd{-1};
+    uint64_t ticks[2]{0, 0};  // user, system
+    uint64_t io[2]{0, 0};     // read, write
+    uint64_t rss{0};          // kiB
+    bool alive{true};
+  };
   void cleanup();
+  void sample(int64_t rootId, bool scanAll);
+  void discover(int64_t rootId, bool scanAll);
+  void addProbe(int64_t processId);
+  static void closeProbe(Probe &probe);
 
-  uint m_max_utiliation{0};
   uint m_frequency{10};
-  bool m_stop{false};
+  std::atomic<bool> m_stop{false};
   std::thread *m_thread{nullptr};
-  double m_vm{0};
+  std::map<int64_t, Probe> m_probes;
+  ProcessStats m_stats;
+  uint64_t m_startTime{0};
+  int64_t m_childUsage[2]{0, 0};  // getrusage(RUSAGE_CHILDREN) at start, us
+  long m_childMaxRss{0};
 };
 
 }  // namespace FOEDAG
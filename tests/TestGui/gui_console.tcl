@@ -22,4 +22,5 @@ puts "CONSOLE GUI: console_proc"      ; flush stdout ; console_proc tests/TestGu
 puts "CONSOLE GUI: console_multiline" ; flush stdout ; console_multiline
 puts "CONSOLE GUI: console_cancel"    ; flush stdout ; console_cancel
 puts "CONSOLE GUI: console_history"   ; flush stdout ; console_history
+puts "CONSOLE GUI: console_scrollback"; flush stdout ; console_scrollback
 puts "CONSOLE GUI: qt_getWidget"      ; flush stdout ; qt_getWidget TclConsole
@@ -21,6 +21,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "Configuration/CFGCommon/CFGCommon.h"
 
+#include <thread>
+
 #include "compiler_tcl_infra_common.h"
 #include "gtest/gtest.h"
 
@@ -399,3 +401,57 @@ TEST(CFGCommon, test_python_mgr) {
                          std::vector<CFG_Python_OBJ>({}));
   EXPECT_EQ(results.size(), 0);
 }
+
+#ifndef _WIN32
+TEST(CFGCommon, test_execute_cmd_streams) {
+  std::vector<std::string> lines;
+  CFG_EXECUTE_CMD_ARG arg;
+  arg.line_callback = [&lines](const std::string& line) {
+    lines.push_back(line);
+  };
+  CFG_EXECUTE_CMD_RESULT result = CFG_execute_cmd_ex(
+      "echo out1; echo err1 1>&2; sleep 0.1; printf out2", arg);
+  EXPECT_EQ(result.exit_code, 0);
+  EXPECT_EQ(lines, std::vector<std::string>({"out1\n", "err1\n", "out2"}));
+  EXPECT_EQ(result.output, "out1\nerr1\nout2");
+  result = CFG_execute_cmd_ex("exit 3", CFG_EXECUTE_CMD_ARG{});
+  EXPECT_EQ(result.exit_code, 3);
+  EXPECT_FALSE(result.stopped);
+}
+
+TEST(CFGCommon, test_execute_cmd_bounded_capture) {
+  CFG_EXECUTE_CMD_ARG arg;
+  arg.capture_head = 8;
+  arg.capture_tail = 13;
+  CFG_EXECUTE_CMD_RESULT result = CFG_execute_cmd_ex("seq 1 100000", arg);
+  EXPECT_EQ(result.exit_code, 0);
+  EXPECT_EQ(result.output_size, 588895u);
+  EXPECT_EQ(result.output.find("1\n2\n3\n4\n\n... "), 0u);
+  EXPECT_NE(result.output.find(" bytes of output omitted ..."),
+            std::string::npos);
+  EXPECT_EQ(result.output.substr(result.output.size() - 14),
+            "\n99999\n100000\n");
+}
+
+TEST(CFGCommon, test_execute_cmd_stop_and_timeout) {
+  CFG_EXECUTE_CMD_ARG arg;
+  arg.timeout_ms = 200;
+  auto start = std::chrono::steady_clock::now();
+  CFG_EXECUTE_CMD_RESULT result = CFG_execute_cmd_ex("sleep 20", arg);
+  EXPECT_TRUE(result.timed_out);
+  EXPECT_EQ(result.exit_code, -1);
+  // background job is in the same process group and holds the pipe
+  std::atomic<bool> stop = false;
+  std::thread stopper([&stop]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    stop = true;
+  });
+  std::string output;
+  EXPECT_EQ(CFG_execute_cmd("sleep 20 & echo started; wait", output, nullptr,
+                            stop),
+            -1);
+  stopper.join();
+  EXPECT_EQ(output, "started\n");
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+}
+#endif
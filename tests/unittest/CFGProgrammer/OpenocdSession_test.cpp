@@ -0,0 +1,470 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _WIN32
+
+#include "Configuration/HardwareManager/OpenocdSession.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <regex>
+#include <thread>
+
+#include "Configuration/HardwareManager/Device.h"
+#include "Configuration/HardwareManager/OpenocdAdapter.h"
+#include "Configuration/Programmer/Programmer.h"
+#include "Configuration/Programmer/Programmer_error_code.h"
+#include "gtest/gtest.h"
+
+using namespace FOEDAG;
+
+namespace {
+
+// Minimal OpenOCD stand-in: Tcl RPC on a local port, log lines on a pipe
+class FakeOpenocd {
+ public:
+  struct Reply {
+    int code{0};
+    std::string result;
+    std::vector<std::string> log;
+    int delayMs{0};
+    // close the connection instead of replying, like a crashed OpenOCD
+    bool drop{false};
+  };
+  using Handler = std::function<Reply(const std::string& cmd)>;
+
+  explicit FakeOpenocd(const Handler& handler) : m_handler(handler) {
+    m_listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    ::bind(m_listenFd, (sockaddr*)&addr, sizeof(addr));
+    ::listen(m_listenFd, 4);
+    ::getsockname(m_listenFd, (sockaddr*)&addr, &len);
+    m_port = ntohs(addr.sin_port);
+    EXPECT_EQ(::pipe(m_log), 0);
+    m_thread = std::thread{[this]() { serve(); }};
+  }
+  ~FakeOpenocd() {
+    ::shutdown(m_listenFd, SHUT_RDWR);
+    ::close(m_listenFd);
+    m_thread.join();
+    ::close(m_log[0]);
+    ::close(m_log[1]);
+  }
+
+  std::unique_ptr<OpenocdSession> attach(std::string& error) {
+    return OpenocdSession::attach("127.0.0.1", m_port, ::dup(m_log[0]),
+                                  error);
+  }
+  std::vector<std::string> commands() {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return m_commands;
+  }
+
+ private:
+  void serve() {
+    while (true) {
+      int fd = ::accept(m_listenFd, nullptr, nullptr);
+      if (fd < 0) return;
+      std::string buffer;
+      char chunk[1024];
+      ssize_t n{0};
+      while ((n = ::recv(fd, chunk, sizeof(chunk), 0)) > 0) {
+        buffer.append(chunk, static_cast<size_t>(n));
+        size_t end{0};
+        while ((end = buffer.find('\x1a')) != std::string::npos) {
+          std::string request = buffer.substr(0, end);
+          buffer.erase(0, end + 1);
+          handle(fd, request);
+        }
+      }
+      ::close(fd);
+    }
+  }
+  void handle(int fd, const std::string& request) {
+    std::smatch match;
+    std::string cmd{request}, marker;
+    if (std::regex_search(request, match,
+                          std::regex{R"(catch \{(.*)\} _session_out)"}))
+      cmd = match[1];
+    if (std::regex_search(request, match, std::regex{R"(echo \{([^}]*)\})"}))
+      marker = match[1];
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      m_commands.push_back(cmd);
+    }
+    Reply reply = m_handler(cmd);
+    if (reply.drop) {
+      ::shutdown(fd, SHUT_RDWR);
+      return;
+    }
+    for (const auto& line : reply.log) writeLog(line);
+    if (reply.delayMs)
+      std::this_thread::sleep_for(std::chrono::milliseconds(reply.delayMs));
+    if (!marker.empty()) writeLog(marker);
+    std::string response =
+        std::to_string(reply.code) + "\n" + reply.result + '\x1a';
+    ::send(fd, response.data(), response.size(), MSG_NOSIGNAL);
+  }
+  void writeLog(const std::string& line) {
+    std::string data = line + "\n";
+    EXPECT_EQ(::write(m_log[1], data.data(), data.size()),
+              static_cast<ssize_t>(data.size()));
+  }
+
+  Handler m_handler;
+  int m_listenFd{-1};
+  uint16_t m_port{0};
+  int m_log[2]{-1, -1};
+  std::thread m_thread;
+  std::mutex m_mutex;
+  std::vector<std::string> m_commands;
+};
+
+FakeOpenocd::Reply openocdReply(const std::string& cmd) {
+  if (cmd == "scan_chain")
+    return {0,
+            "   TapName  Enabled IdCode     Expected   IrLen IrCap IrMask\n"
+            " 0 gemini.tap  Y    0x1000563d 0x1000563d     5 0x01  0x03",
+            {}};
+  if (cmd.find("gemini load") == 0)
+    return {0,
+            "",
+            {"Info : loading", "Progress 50.00% (1/2 bytes)",
+             "Progress 100.00% (2/2 bytes)",
+             "[RS] Configured FPGA fabric successfully"},
+            20};
+  if (cmd.find("gemini status") == 0)
+    return {0, "  1 gemini 0 1 0", {}};
+  return {1, "invalid command name \"" + cmd + "\"", {}};
+}
+
+Cable testCable(const std::string& name) {
+  Cable cable{};
+  cable.index = 1;
+  cable.name = name;
+  cable.speed = 1000;
+  cable.transport = JTAG;
+  cable.cable_type = FTDI;
+  return cable;
+}
+
+Device testDevice(const Cable& cable) {
+  Device device{};
+  device.index = 1;
+  device.name = "Gemini";
+  device.type = GEMINI;
+  device.cable = cable;
+  device.tap = Tap{1, 0x1000563d, 5};
+  return device;
+}
+
+class OpenocdSessionTest : public testing::Test {
+ protected:
+  // the adapter checks the executable exists only
+  const std::string m_openocd{"/bin/sh"};
+};
+
+}  // namespace
+
+TEST_F(OpenocdSessionTest, ExecuteReturnsLogAndResult) {
+  FakeOpenocd server{openocdReply};
+  std::string error;
+  auto session = server.attach(error);
+  ASSERT_NE(session, nullptr) << error;
+  std::atomic<bool> stop{false};
+  std::vector<std::string> lines;
+  std::string output;
+  int res = session->execute(
+      "gemini load  1 fpga a.bit -p 1 -d gemini", output, stop, nullptr,
+      [&lines](const std::string& line) { lines.push_back(line); });
+  EXPECT_EQ(res, 0);
+  // all log lines are delivered before execute returns, in order
+  ASSERT_EQ(lines.size(), 4u);
+  EXPECT_EQ(lines[1], "Progress 50.00% (1/2 bytes)\n");
+  EXPECT_EQ(lines[3], "[RS] Configured FPGA fabric successfully\n");
+  EXPECT_EQ(output.find("@@openocd_session"), std::string::npos);
+
+  output.clear();
+  EXPECT_EQ(session->execute("scan_chain", output, stop), 0);
+  EXPECT_NE(output.find("0x1000563d"), std::string::npos);
+
+  output.clear();
+  EXPECT_EQ(session->execute("bogus", output, stop), 1);
+  EXPECT_EQ(output, "invalid command name \"bogus\"\n");
+  EXPECT_TRUE(session->alive());
+}
+
+TEST_F(OpenocdSessionTest, StopClosesSession) {
+  FakeOpenocd server{[](const std::string&) {
+    return FakeOpenocd::Reply{0, "done", {}, 300};
+  }};
+  std::string error;
+  auto session = server.attach(error);
+  ASSERT_NE(session, nullptr) << error;
+  std::atomic<bool> stop{false};
+  std::thread stopper{[&stop]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    stop = true;
+  }};
+  std::string output;
+  EXPECT_EQ(session->execute("gemini load  1 fpga a.bit", output, stop), -1);
+  stopper.join();
+  EXPECT_FALSE(session->alive());
+}
+
+TEST_F(OpenocdSessionTest, PoolReusesSessionPerCable) {
+  FakeOpenocd server{openocdReply};
+  OpenocdSessionPool pool{
+      [&server](const std::string&, const std::string&, std::string& error) {
+        return server.attach(error);
+      }};
+  OpenocdAdapter adapter{m_openocd};
+  adapter.set_session_pool(&pool);
+  Cable cable = testCable("cable_1");
+  Device device = testDevice(cable);
+
+  EXPECT_EQ(adapter.scan(cable), std::vector<uint32_t>{0x1000563d});
+  EXPECT_EQ(adapter.scan(cable), std::vector<uint32_t>{0x1000563d});
+  EXPECT_EQ(pool.launch_count(), 1u);
+
+  // taps and target are declared before init, new configuration restarts
+  adapter.update_taplist({device.tap});
+  std::atomic<bool> stop{false};
+  std::vector<std::string> progress;
+  EXPECT_EQ(adapter.program_fpga(
+                device, "a.bit", stop, nullptr, nullptr,
+                [&progress](std::string p) { progress.push_back(p); }),
+            ProgrammerErrorCode::NoError);
+  EXPECT_EQ(progress, (std::vector<std::string>{"50.00", "99.99", "100.00"}));
+  EXPECT_EQ(pool.launch_count(), 2u);
+
+  CfgStatus status;
+  std::string statusOutput;
+  EXPECT_EQ(adapter.query_fpga_status(device, status, statusOutput),
+            ProgrammerErrorCode::NoError);
+  EXPECT_TRUE(status.cfgDone);
+  EXPECT_FALSE(status.cfgError);
+  // scan runs in the configured session
+  adapter.scan(cable);
+  EXPECT_EQ(pool.launch_count(), 2u);
+  EXPECT_EQ(pool.size(), 1u);
+
+  pool.close(cable);
+  EXPECT_EQ(pool.size(), 0u);
+}
+
+TEST_F(OpenocdSessionTest, LostSessionIsRelaunched) {
+  std::atomic<int> calls{0};
+  FakeOpenocd server{[&calls](const std::string& cmd) {
+    if (calls++ == 0) return FakeOpenocd::Reply{0, "", {}, 0, true};
+    return openocdReply(cmd);
+  }};
+  OpenocdSessionPool pool{
+      [&server](const std::string&, const std::string&, std::string& error) {
+        return server.attach(error);
+      }};
+  OpenocdAdapter adapter{m_openocd};
+  adapter.set_session_pool(&pool);
+  Cable cable = testCable("cable_1");
+
+  EXPECT_EQ(adapter.scan(cable), std::vector<uint32_t>{0x1000563d});
+  EXPECT_EQ(pool.launch_count(), 2u);
+  EXPECT_EQ(adapter.scan(cable), std::vector<uint32_t>{0x1000563d});
+  EXPECT_EQ(pool.launch_count(), 2u);
+}
+
+TEST_F(OpenocdSessionTest, LaunchFailureReportedOncePerCable) {
+  bool fail{true};
+  FakeOpenocd server{openocdReply};
+  OpenocdSessionPool pool{[&server, &fail](const std::string&,
+                                           const std::string&,
+                                           std::string& error) {
+    if (!fail) return server.attach(error);
+    error = "cannot start openocd";
+    return std::unique_ptr<OpenocdSession>{};
+  }};
+  Cable cable = testCable("cable_1");
+  std::string error;
+  EXPECT_FALSE(pool.acquire(m_openocd, cable, {}, error));
+  EXPECT_EQ(error, "cannot start openocd");
+  error.clear();
+  EXPECT_FALSE(pool.acquire(m_openocd, cable, {}, error));
+  EXPECT_TRUE(error.empty());
+  // other cable reports its own failure
+  EXPECT_FALSE(pool.acquire(m_openocd, testCable("cable_2"), {}, error));
+  EXPECT_FALSE(error.empty());
+
+  // once the session started, a new failure is reported again
+  fail = false;
+  error.clear();
+  EXPECT_TRUE(pool.acquire(m_openocd, cable, {}, error));
+  fail = true;
+  pool.close(cable);
+  EXPECT_FALSE(pool.acquire(m_openocd, cable, {}, error));
+  EXPECT_FALSE(error.empty());
+}
+
+TEST_F(OpenocdSessionTest, ProgramCablesConcurrently) {
+  std::atomic<int> running{0};
+  std::atomic<int> maxRunning{0};
+  auto handler = [&](const std::string& cmd) {
+    int now = ++running;
+    int max = maxRunning;
+    while (now > max && !maxRunning.compare_exchange_weak(max, now)) {
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    --running;
+    auto reply = openocdReply(cmd);
+    return reply;
+  };
+  FakeOpenocd server1{handler};
+  FakeOpenocd server2{handler};
+  OpenocdSessionPool pool{[&](const std::string&, const std::string& config,
+                              std::string& error) {
+    return (config.find("serial cable_2") != std::string::npos)
+               ? server2.attach(error)
+               : server1.attach(error);
+  }};
+
+  std::vector<std::string> progress[2];
+  int results[2]{-1, -1};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 2; i++) {
+    threads.emplace_back([&, i]() {
+      Cable cable = testCable("cable_" + std::to_string(i + 1));
+      cable.serial_number = cable.name;
+      Device device = testDevice(cable);
+      OpenocdAdapter adapter{m_openocd};
+      adapter.set_session_pool(&pool);
+      adapter.update_taplist({device.tap});
+      std::atomic<bool> stop{false};
+      results[i] = adapter.program_fpga(
+          device, "a.bit", stop, nullptr, nullptr,
+          [&progress, i](std::string p) { progress[i].push_back(p); });
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  for (int i = 0; i < 2; i++) {
+    EXPECT_EQ(results[i], ProgrammerErrorCode::NoError);
+    EXPECT_EQ(progress[i].back(), "100.00");
+  }
+  EXPECT_EQ(pool.size(), 2u);
+  EXPECT_EQ(server1.commands().size(), 1u);
+  EXPECT_EQ(server2.commands().size(), 1u);
+  EXPECT_EQ(maxRunning, 2);
+}
+
+TEST_F(OpenocdSessionTest, CommandErrorFromLog) {
+  FakeOpenocd server{[](const std::string&) {
+    return FakeOpenocd::Reply{1, "", {"[RS] Command error 5."}};
+  }};
+  OpenocdSessionPool pool{
+      [&server](const std::string&, const std::string&, std::string& error) {
+        return server.attach(error);
+      }};
+  OpenocdAdapter adapter{m_openocd};
+  adapter.set_session_pool(&pool);
+  Device device = testDevice(testCable("cable_1"));
+  std::atomic<bool> stop{false};
+  EXPECT_EQ(adapter.program_flash(device, "a.bit", stop,
+                                  ProgramFlashOperation::Program),
+            5);
+}
+
+
+TEST_F(OpenocdSessionTest, IdleSessionIsClosed) {
+  FakeOpenocd server{openocdReply};
+  OpenocdSessionPool pool{
+      [&server](const std::string&, const std::string&, std::string& error) {
+        return server.attach(error);
+      }};
+  pool.set_idle_timeout(std::chrono::milliseconds(100));
+  Cable cable = testCable("cable_1");
+  std::string error;
+  {
+    auto session = pool.acquire(m_openocd, cable, {}, error);
+    ASSERT_TRUE(session);
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  }
+  // not closed while in use, idle from the release of the lease
+  EXPECT_EQ(pool.size(), 1u);
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  EXPECT_EQ(pool.size(), 0u);
+  EXPECT_TRUE(pool.acquire(m_openocd, cable, {}, error));
+  EXPECT_EQ(pool.launch_count(), 2u);
+}
+
+TEST_F(OpenocdSessionTest, ReleasedCableIsClosed) {
+  FakeOpenocd server{openocdReply};
+  OpenocdSessionPool pool{
+      [&server](const std::string&, const std::string&, std::string& error) {
+        return server.attach(error);
+      }};
+  Cable cable1 = testCable("cable_1");
+  Cable cable2 = testCable("cable_2");
+  std::string error;
+  EXPECT_TRUE(pool.acquire(m_openocd, cable1, {}, error));
+  EXPECT_TRUE(pool.acquire(m_openocd, cable2, {}, error));
+  EXPECT_EQ(pool.size(), 2u);
+  pool.close_released({cable2});
+  EXPECT_EQ(pool.size(), 1u);
+  pool.close_released({});
+  EXPECT_EQ(pool.size(), 0u);
+}
+
+#ifdef __linux__
+TEST_F(OpenocdSessionTest, LaunchInheritsNoDescriptor) {
+  // a descriptor another thread opened without close-on-exec
+  int leaked[2];
+  ASSERT_EQ(::pipe(leaked), 0);
+  const std::string script{"openocd_session_fds.sh"};
+  {
+    std::ofstream stream{script};
+    stream << "for fd in 0 1 2 " << leaked[0] << " " << leaked[1]
+           << "; do [ -e /proc/$$/fd/$fd ] && echo \"open $fd\"; done\n";
+  }
+  std::string error;
+  auto session = OpenocdSession::launch("sh " + script, "", error);
+  std::filesystem::remove(script);
+  ::close(leaked[0]);
+  ::close(leaked[1]);
+  // the script exits instead of serving the Tcl port
+  EXPECT_EQ(session, nullptr);
+  EXPECT_NE(error.find("open 1"), std::string::npos) << error;
+  EXPECT_NE(error.find("open 2"), std::string::npos) << error;
+  EXPECT_EQ(error.find("open " + std::to_string(leaked[0])),
+            std::string::npos)
+      << error;
+  EXPECT_EQ(error.find("open " + std::to_string(leaked[1])),
+            std::string::npos)
+      << error;
+}
+#endif
+
+#endif
@@ -0,0 +1,103 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Compiler/BatchRunner.h"
+
+#include <sstream>
+
+#include "Compiler/Compiler.h"
+#include "NewProject/ProjectManager/project.h"
+#include "Utils/FileUtils.h"
+#include "gtest/gtest.h"
+
+namespace fs = std::filesystem;
+using namespace FOEDAG;
+
+class BatchRunnerTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    FileUtils::removeAll(m_dir);
+    FileUtils::MkDirs(m_dir);
+  }
+  void TearDown() override { FileUtils::removeAll(m_dir); }
+
+  fs::path script(const std::string& name, const std::string& content) {
+    FileUtils::WriteToFile(m_dir / name, content);
+    return m_dir / name;
+  }
+
+  BatchRunner runner() {
+    return BatchRunner{[]() { return new Compiler; }, nullptr, &m_out};
+  }
+
+  const fs::path m_dir{"batch_runner_test"};
+  std::stringstream m_out;
+};
+
+TEST_F(BatchRunnerTest, FlowsRunInOwnWorkingDirectory) {
+  const auto cwd = fs::current_path();
+  const QString projectName = Project::Instance()->projectName();
+  auto flow = script("flow.tcl", "create_design top\nputs hello");
+  BatchRunner batch = runner();
+  batch.Jobs(2);
+  batch.AddRun(flow, m_dir / "a");
+  batch.AddRun(flow, m_dir / "b");
+  EXPECT_TRUE(batch.Execute());
+  ASSERT_EQ(batch.Runs().size(), 2u);
+  for (const auto& run : batch.Runs()) {
+    EXPECT_EQ(run.status, 0);
+    EXPECT_TRUE(FileUtils::FileExists(run.workingDir / "top" / "top.ospr"));
+    auto log = FileUtils::GetFileContent(run.logFile);
+    EXPECT_NE(log.find("hello"), std::string::npos);
+  }
+  // The flows have their own project and never change the current path
+  EXPECT_EQ(fs::current_path(), cwd);
+  EXPECT_EQ(Project::Instance()->projectName(), projectName);
+  EXPECT_FALSE(FileUtils::FileExists(cwd / "top"));
+}
+
+TEST_F(BatchRunnerTest, FailedRun) {
+  BatchRunner batch = runner();
+  batch.AddRun(script("fail.tcl", "error boom"), m_dir / "a");
+  EXPECT_FALSE(batch.Execute());
+  EXPECT_EQ(batch.Runs().front().status, 1);
+  EXPECT_NE(m_out.str().find("failed"), std::string::npos);
+  auto log = FileUtils::GetFileContent(batch.Runs().front().logFile);
+  EXPECT_NE(log.find("boom"), std::string::npos);
+}
+
+TEST_F(BatchRunnerTest, ExitEndsTheFlowOnly) {
+  BatchRunner batch = runner();
+  batch.AddRun(script("exit.tcl", "catch {exit 3}\nputs after"),
+               m_dir / "a");
+  EXPECT_FALSE(batch.Execute());
+  EXPECT_EQ(batch.Runs().front().status, 3);
+  auto log = FileUtils::GetFileContent(batch.Runs().front().logFile);
+  EXPECT_EQ(log.find("after"), std::string::npos);
+}
+
+TEST_F(BatchRunnerTest, StopSkipsPendingRuns) {
+  BatchRunner batch = runner();
+  batch.StopRequested([]() { return true; });
+  batch.AddRun(script("a.tcl", ""), m_dir / "a");
+  EXPECT_FALSE(batch.Execute());
+  EXPECT_NE(m_out.str().find("skipped"), std::string::npos);
+}
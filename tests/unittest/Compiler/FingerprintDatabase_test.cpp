@@ -0,0 +1,154 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Compiler/FingerprintDatabase.h"
+
+#include "Utils/FileUtils.h"
+#include "gtest/gtest.h"
+
+namespace fs = std::filesystem;
+using namespace FOEDAG;
+
+class FingerprintDatabaseTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    FileUtils::removeAll(m_dir);
+    FileUtils::MkDirs(m_dir);
+    FileUtils::WriteToFile(m_input, "module top; endmodule");
+    FileUtils::WriteToFile(m_output, "netlist");
+  }
+  void TearDown() override { FileUtils::removeAll(m_dir); }
+
+  StageFingerprint fingerprint(FingerprintDatabase& db) {
+    StageFingerprint fp;
+    fp.addFile(m_input.string(), db.fileHash(m_input));
+    fp.addScript(FingerprintDatabase::textHash("read_verilog top.v"));
+    fp.addOption("target_device", "dev");
+    return fp;
+  }
+
+  const fs::path m_dir{"fingerprint_test"};
+  const fs::path m_input{m_dir / "top.v"};
+  const fs::path m_output{m_dir / "top_post_synth.v"};
+  const fs::path m_db{m_dir / "impl" / "stage_fingerprints.json"};
+};
+
+TEST_F(FingerprintDatabaseTest, StaleWithoutRecord) {
+  FingerprintDatabase db{m_db};
+  auto decision = db.check("synthesis", fingerprint(db), m_output);
+  EXPECT_TRUE(decision.stale);
+  ASSERT_FALSE(decision.reasons.empty());
+}
+
+TEST_F(FingerprintDatabaseTest, UpToDateAfterCommit) {
+  {
+    FingerprintDatabase db{m_db};
+    db.check("synthesis", fingerprint(db), m_output);
+    EXPECT_TRUE(db.commit("synthesis"));
+  }
+  // record is persistent
+  FingerprintDatabase db{m_db};
+  auto decision = db.check("synthesis", fingerprint(db), m_output);
+  EXPECT_FALSE(decision.stale);
+  EXPECT_NE(db.lastDecision("synthesis"), nullptr);
+}
+
+TEST_F(FingerprintDatabaseTest, TouchedFileIsNotStale) {
+  FingerprintDatabase db{m_db};
+  db.check("synthesis", fingerprint(db), m_output);
+  db.commit("synthesis");
+  fs::last_write_time(m_input,
+                      fs::last_write_time(m_input) + std::chrono::hours(1));
+  EXPECT_FALSE(db.check("synthesis", fingerprint(db), m_output).stale);
+}
+
+TEST_F(FingerprintDatabaseTest, ModifiedFileIsStale) {
+  FingerprintDatabase db{m_db};
+  db.check("synthesis", fingerprint(db), m_output);
+  db.commit("synthesis");
+  FileUtils::WriteToFile(m_input, "module top(input a); endmodule");
+  auto decision = db.check("synthesis", fingerprint(db), m_output);
+  EXPECT_TRUE(decision.stale);
+  ASSERT_EQ(decision.reasons.size(), 1u);
+  EXPECT_EQ(decision.reasons.front(), "changed: file:" + m_input.string());
+}
+
+TEST_F(FingerprintDatabaseTest, ModifiedWithoutEventIsStale) {
+  FingerprintDatabase db{m_db};
+  db.check("synthesis", fingerprint(db), m_output);
+  db.commit("synthesis");
+  // Nobody calls markChanged(), as when the watcher event is still queued
+  FileUtils::WriteToFile(m_input, "module top(input a); endmodule");
+  EXPECT_TRUE(db.check("synthesis", fingerprint(db), m_output).stale);
+}
+
+TEST_F(FingerprintDatabaseTest, MarkedChangedIsRehashed) {
+  FingerprintDatabase db{m_db};
+  db.check("synthesis", fingerprint(db), m_output);
+  db.commit("synthesis");
+  // Same size and mtime: only the watcher event tells the file changed
+  const auto mtime = fs::last_write_time(m_input);
+  FileUtils::WriteToFile(m_input, "module pot; endmodule");
+  fs::last_write_time(m_input, mtime);
+  EXPECT_FALSE(db.check("synthesis", fingerprint(db), m_output).stale);
+  db.markChanged(m_input);
+  EXPECT_TRUE(db.check("synthesis", fingerprint(db), m_output).stale);
+}
+
+TEST_F(FingerprintDatabaseTest, MissingOutputIsStale) {
+  FingerprintDatabase db{m_db};
+  db.check("synthesis", fingerprint(db), m_output);
+  db.commit("synthesis");
+  FileUtils::removeFile(m_output);
+  EXPECT_TRUE(db.check("synthesis", fingerprint(db), m_output).stale);
+}
+
+TEST_F(FingerprintDatabaseTest, SavedOnlyOnCommit) {
+  FingerprintDatabase db{m_db};
+  db.check("synthesis", fingerprint(db), m_output);
+  EXPECT_FALSE(FileUtils::FileExists(m_db));
+  EXPECT_TRUE(db.commit("synthesis"));
+  EXPECT_TRUE(FileUtils::FileExists(m_db));
+}
+
+TEST_F(FingerprintDatabaseTest, MovedProjectIsNotStale) {
+  auto relocatable = [](FingerprintDatabase& db, const fs::path& dir) {
+    StageFingerprint fp;
+    fp.addFile(db.fileKey(dir / "top.v"), db.fileHash(dir / "top.v"));
+    return fp;
+  };
+  {
+    FingerprintDatabase db{m_db};
+    db.setRootPath(m_dir);
+    EXPECT_EQ(db.fileKey(m_input), "top.v");
+    db.check("synthesis", relocatable(db, m_dir), m_output);
+    db.commit("synthesis");
+  }
+  const fs::path moved{"fingerprint_test_moved"};
+  FileUtils::removeAll(moved);
+  fs::rename(m_dir, moved);
+  FingerprintDatabase db{moved / "impl" / "stage_fingerprints.json"};
+  db.setRootPath(moved);
+  auto decision = db.check("synthesis", relocatable(db, moved),
+                           moved / "top_post_synth.v");
+  FileUtils::removeAll(moved);
+  EXPECT_FALSE(decision.stale);
+}
@@ -0,0 +1,72 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Compiler/NetlistGraph.h"
+
+#include "gtest/gtest.h"
+
+using namespace FOEDAG;
+
+static nlohmann::json instances() {
+  return nlohmann::json::parse(R"([
+    {"module": "I_BUF", "name": "ibuf", "linked_object": "clk",
+     "connectivity": {"I": "clk", "O": "clk_ibuf"}},
+    {"module": "CLK_BUF", "connectivity": {"I": "clk_ibuf", "O": "clk_buf"}},
+    {"module": "FCLK_BUF", "connectivity": {"I": "clk_buf", "O": "fclk"}},
+    {"module": "FCLK_BUF", "connectivity": {"I": "clk_buf", "O": "fclk2"}},
+    {"module": "PLL", "connectivity": {"CLK_IN": "clk_buf"}},
+    {"module": "LOOP", "connectivity": {"I": "a", "O": "b"}},
+    {"module": "LOOP", "connectivity": {"I": "b", "O": "a"}}
+  ])");
+}
+
+TEST(NetlistGraph, Adjacency) {
+  NetlistGraph graph;
+  graph.build(instances());
+  EXPECT_EQ(graph.instanceCount(), 6u);
+  ASSERT_EQ(graph.drivers("clk_ibuf").size(), 1u);
+  EXPECT_EQ(graph.instance(graph.drivers("clk_ibuf").front()).name, "ibuf");
+  EXPECT_EQ(graph.loads("clk_buf").size(), 2u);
+  EXPECT_TRUE(graph.isDriven("fclk"));
+  EXPECT_FALSE(graph.isDriven("clk"));
+  EXPECT_TRUE(graph.loads("unknown").empty());
+}
+
+TEST(NetlistGraph, FaninFanout) {
+  NetlistGraph graph;
+  graph.build(instances());
+  std::set<std::string> nets;
+  graph.collectFanout("clk_ibuf", nets);
+  EXPECT_EQ(nets, (std::set<std::string>{"clk_ibuf", "clk_buf", "fclk",
+                                         "fclk2"}));
+  nets.clear();
+  graph.collectFanin("fclk", nets);
+  EXPECT_EQ(nets,
+            (std::set<std::string>{"fclk", "clk_buf", "clk_ibuf", "clk"}));
+}
+
+TEST(NetlistGraph, Cycle) {
+  NetlistGraph graph;
+  graph.build(instances());
+  std::set<std::string> nets;
+  graph.collectFanout("a", nets);
+  EXPECT_EQ(nets, (std::set<std::string>{"a", "b"}));
+}
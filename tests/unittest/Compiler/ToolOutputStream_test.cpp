@@ -0,0 +1,94 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Compiler/ToolOutputStream.h"
+
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+using namespace FOEDAG;
+
+TEST(RingBuffer, KeepsLastBytes) {
+  RingBuffer buffer{8};
+  buffer.append("0123", 4);
+  EXPECT_EQ(buffer.contents(), "0123");
+  buffer.append("456789", 6);
+  EXPECT_EQ(buffer.contents(), "23456789");
+  buffer.append("abcdefghijk", 11);
+  EXPECT_EQ(buffer.contents(), "defghijk");
+  EXPECT_EQ(buffer.size(), 8u);
+}
+
+TEST(ToolOutputStream, CoalescesCompleteLines) {
+  std::stringstream log, console;
+  ToolOutputStream::Options options;
+  options.flushInterval = 60000;
+  ToolOutputStream stream{&log, &console, options};
+  stream.write("line 1\n", 7);
+  stream.write("line", 4);
+  EXPECT_EQ(log.str(), "line 1\nline");
+  EXPECT_TRUE(console.str().empty());  // waits for the flush interval
+  stream.finish();
+  EXPECT_EQ(console.str(), "line 1\nline");
+  EXPECT_EQ(stream.totalBytes(), 11u);
+}
+
+TEST(ToolOutputStream, ForwardsOnlyCompleteLines) {
+  std::stringstream console;
+  ToolOutputStream::Options options;
+  options.flushInterval = 0;
+  ToolOutputStream stream{nullptr, &console, options};
+  stream.write("line 1\nli", 9);
+  EXPECT_EQ(console.str(), "line 1\n");
+  stream.write("ne 2\n", 5);
+  EXPECT_EQ(console.str(), "line 1\nline 2\n");
+}
+
+TEST(ToolOutputStream, CapKeepsTail) {
+  std::stringstream log, console;
+  ToolOutputStream::Options options;
+  options.flushInterval = 0;
+  options.consoleCap = 10;
+  options.tailSize = 8;
+  ToolOutputStream stream{&log, &console, options};
+  for (int i = 0; i < 5; i++) {
+    stream.write("line ", 5);
+    stream.write("x\n", 2);
+  }
+  stream.finish("tool.log");
+  EXPECT_EQ(log.str().size(), 35u);
+  EXPECT_EQ(console.str(),
+            "line x\n... 21 bytes of output omitted, see tool.log ...\n"
+            "line x\n");
+}
+
+TEST(ToolOutputStream, TailMode) {
+  std::stringstream console;
+  ToolOutputStream::Options options;
+  options.mode = ToolOutputStream::ConsoleMode::Tail;
+  options.tailSize = 4;
+  ToolOutputStream stream{nullptr, &console, options};
+  stream.write("aa\nbb\ncc\n", 9);
+  EXPECT_TRUE(console.str().empty());
+  stream.finish();
+  EXPECT_EQ(console.str(), "... 6 bytes of output omitted ...\ncc\n");
+}
@@ -0,0 +1,106 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Console/OutputFormatter.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QTextCursor>
+#include <QTextEdit>
+
+#include "Console/FileNameParser.h"
+#include "gtest/gtest.h"
+using namespace FOEDAG;
+
+class LinkAllParser : public LineParser {
+ public:
+  Result handleLine(const QString &message, OutputFormat format) override {
+    return Result{Status::Done, message, {LinkSpec{0, 4, "link"}}};
+  }
+};
+
+TEST(OutputFormatter, WrittenOnFlush) {
+  QTextEdit edit;
+  OutputFormatter formatter;
+  formatter.setTextEdit(&edit);
+  formatter.appendMessage("first line\nsecond ", Output);
+  formatter.appendMessage("line\nno newline", Error);
+  EXPECT_TRUE(formatter.hasPending());
+  EXPECT_TRUE(edit.toPlainText().isEmpty());
+
+  formatter.flush();
+  EXPECT_FALSE(formatter.hasPending());
+  EXPECT_EQ(edit.toPlainText(), "first line\nsecond line\n");
+}
+
+TEST(OutputFormatter, ManyLines) {
+  QTextEdit edit;
+  OutputFormatter formatter;
+  formatter.setTextEdit(&edit);
+  QString expected;
+  for (int i = 0; i < 1000; i++) {
+    const QString line = QString{"line %1\n"}.arg(i);
+    formatter.appendMessage(line, (i % 2) ? Output : Error);
+    expected += line;
+  }
+  formatter.flush();
+  EXPECT_EQ(edit.toPlainText(), expected);
+}
+
+TEST(OutputFormatter, Links) {
+  QTextEdit edit;
+  OutputFormatter formatter;
+  formatter.setTextEdit(&edit);
+  formatter.addParser(new LinkAllParser);
+  formatter.appendMessage("file.v\n", Output);
+  formatter.flush();
+  EXPECT_EQ(edit.toPlainText(), "file.v\n");
+  QTextCursor cursor{edit.document()};
+  cursor.movePosition(QTextCursor::NextCharacter);
+  EXPECT_EQ(cursor.charFormat().anchorHref(), "link");
+  cursor.movePosition(QTextCursor::NextCharacter, QTextCursor::MoveAnchor, 4);
+  EXPECT_FALSE(cursor.charFormat().isAnchor());
+}
+
+TEST(FileNameParser, CachedUntilReset) {
+  const QString file{"file_name_parser_test.v"};
+  QFile::remove(file);
+  FileNameParser parser;
+  const QString message{"ERROR: " + file + ":12 syntax error\n"};
+  auto result = parser.handleLine(message, Error);
+  ASSERT_EQ(result.linkSpecs.size(), 1);
+  EXPECT_EQ(result.linkSpecs[0].href,
+            addLinkSpecForAbsoluteFilePath(file, "12"));
+
+  QFile created{file};
+  ASSERT_TRUE(created.open(QFile::WriteOnly));
+  created.close();
+  result = parser.handleLine(message, Error);
+  EXPECT_EQ(result.linkSpecs[0].href,
+            addLinkSpecForAbsoluteFilePath(file, "12"));
+
+  parser.reset();
+  result = parser.handleLine(message, Error);
+  EXPECT_EQ(result.linkSpecs[0].href,
+            addLinkSpecForAbsoluteFilePath(QFileInfo{file}.absoluteFilePath(),
+                                           "12"));
+  QFile::remove(file);
+}
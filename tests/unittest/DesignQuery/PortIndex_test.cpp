@@ -0,0 +1,132 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "DesignQuery/PortIndex.h"
+
+#include <filesystem>
+
+#include "Utils/FileUtils.h"
+#include "gtest/gtest.h"
+
+using namespace FOEDAG;
+
+static const char* hierInfo = R"({"hierTree": [{"ports": [
+  {"name": "clk", "direction": "Input", "range": {"msb": 0, "lsb": 0}},
+  {"name": "data_in", "direction": "Input", "range": {"msb": 7, "lsb": 0}},
+  {"name": "data_out", "direction": "Output", "range": {"msb": 3, "lsb": 0}},
+  {"name": "io", "direction": "Inout", "range": {"msb": 0, "lsb": 0}}
+]}]})";
+
+TEST(GlobMatcher, StarTakesAtLeastOneCharacter) {
+  EXPECT_TRUE(GlobMatcher{"data_*"}.match("data_in"));
+  EXPECT_FALSE(GlobMatcher{"data_*"}.match("data_"));
+  EXPECT_TRUE(GlobMatcher{"*_*"}.match("data_out"));
+  EXPECT_FALSE(GlobMatcher{"*_in"}.match("_in"));
+  EXPECT_TRUE(GlobMatcher{"a**"}.match("abc"));
+  EXPECT_FALSE(GlobMatcher{"a**"}.match("ab"));
+  EXPECT_TRUE(GlobMatcher{"d[*]"}.match("d[1]"));
+  EXPECT_FALSE(GlobMatcher{"d.*"}.match("dx1"));
+}
+
+TEST(PortIndex, HierInfo) {
+  auto [index, error] = PortIndex::Parse(hierInfo);
+  ASSERT_TRUE(index) << error;
+  EXPECT_EQ(index->inputs(), (std::vector<std::string>{"clk", "data_in"}));
+  EXPECT_EQ(index->outputs(), (std::vector<std::string>{"data_out"}));
+  EXPECT_EQ(index->ports().size(), 3u);
+  EXPECT_EQ(index->groups().front().size(), 4u);
+  EXPECT_TRUE(index->hasPort("clk"));
+  EXPECT_FALSE(index->hasPort("io"));
+  EXPECT_TRUE(index->hasBusBit("data_in[7]"));
+  EXPECT_FALSE(index->hasBusBit("data_in[8]"));
+  EXPECT_FALSE(index->hasBusBit("clk[0]"));
+  EXPECT_EQ(index->match("data*"),
+            (std::vector<std::string>{"data_in", "data_out"}));
+}
+
+TEST(PortIndex, PortInfoArray) {
+  auto [index, error] = PortIndex::Parse(
+      R"([{"ports": [{"name": "a", "direction": "Output", "type": "REG",
+          "range": {"msb": 0, "lsb": 0}}]}])");
+  ASSERT_TRUE(index) << error;
+  EXPECT_EQ(index->groups().front().front().type, "REG");
+  EXPECT_EQ(index->outputs().size(), 1u);
+}
+
+TEST(PortIndex, MissingRangeIsOneBit) {
+  auto [index, error] = PortIndex::Parse(
+      R"([{"ports": [{"name": "a", "direction": "Input"}]}])");
+  ASSERT_TRUE(index) << error;
+  EXPECT_FALSE(index->groups().front().front().isBus());
+  EXPECT_TRUE(index->hasPort("a"));
+  EXPECT_FALSE(index->hasBusBit("a[0]"));
+}
+
+TEST(PortIndex, DuplicatePortsMerged) {
+  auto [index, error] = PortIndex::Parse(R"([
+    {"ports": [{"name": "d", "direction": "Input",
+                "range": {"msb": 3, "lsb": 0}}]},
+    {"ports": [{"name": "d", "direction": "Input",
+                "range": {"msb": 7, "lsb": 4}}]}])");
+  ASSERT_TRUE(index) << error;
+  EXPECT_EQ(index->inputs(), (std::vector<std::string>{"d"}));
+  EXPECT_TRUE(index->hasBusBit("d[0]"));
+  EXPECT_TRUE(index->hasBusBit("d[7]"));
+  EXPECT_FALSE(index->hasBusBit("d[8]"));
+}
+
+TEST(PortIndex, DuplicatePortDirectionMismatch) {
+  auto [index, error] = PortIndex::Parse(
+      R"([{"ports": [{"name": "a", "direction": "Input"},
+                     {"name": "a", "direction": "Output"}]}])",
+      "dup.json");
+  ASSERT_TRUE(index) << error;
+  EXPECT_NE(error.find("port a"), std::string::npos);
+  EXPECT_EQ(index->inputs(), (std::vector<std::string>{"a"}));
+  EXPECT_TRUE(index->outputs().empty());
+  ASSERT_EQ(index->groups().front().size(), 1u);
+  EXPECT_EQ(index->groups().front().front().direction, "Input");
+}
+
+TEST(PortIndex, ParseError) {
+  auto [index, error] = PortIndex::Parse("{", "broken.json");
+  EXPECT_FALSE(index);
+  EXPECT_NE(error.find("broken.json"), std::string::npos);
+}
+
+TEST(PortIndex, CacheFollowsContent) {
+  const std::filesystem::path file{"port_index_test.json"};
+  FileUtils::WriteToFile(file, hierInfo);
+  auto first = PortIndex::Load(file.string()).first;
+  ASSERT_TRUE(first);
+  EXPECT_EQ(PortIndex::Load(file.string()).first, first);
+  // touched, same content
+  std::filesystem::last_write_time(
+      file, std::filesystem::last_write_time(file) + std::chrono::hours(1));
+  EXPECT_EQ(PortIndex::Load(file.string()).first, first);
+  FileUtils::WriteToFile(file, R"({"hierTree": []})");
+  auto second = PortIndex::Load(file.string()).first;
+  ASSERT_TRUE(second);
+  EXPECT_NE(second, first);
+  EXPECT_TRUE(second->ports().empty());
+  FileUtils::removeFile(file);
+  PortIndex::ClearCache();
+}
@@ -0,0 +1,93 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+#include "DeviceModeling/device_instance.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+// A leaf block with ports and a parameter, and a tile made of leaf instances
+std::shared_ptr<device_block> make_tile_block(int leaves, int ports) {
+  auto leaf = std::make_shared<device_block>("leaf");
+  for (int p = 0; p < ports; p++) {
+    leaf->add_port(
+        std::make_shared<device_port>("p" + std::to_string(p), p % 2 == 0));
+  }
+  auto width = std::make_shared<ParameterType<int>>();
+  width->set_default_value(8);
+  leaf->add_int_parameter(
+      "width", std::make_shared<Parameter<int>>("width", 8, width));
+  auto tile = std::make_shared<device_block>("tile");
+  for (int l = 0; l < leaves; l++) {
+    tile->add_instance("l" + std::to_string(l),
+                       std::make_shared<device_block_instance>(leaf));
+  }
+  return tile;
+}
+
+// Resident set size of the process in KB, 0 when unknown
+long resident_kb() {
+  std::ifstream statm("/proc/self/statm");
+  long pages = 0;
+  long resident = 0;
+  if (!(statm >> pages >> resident)) return 0;
+  return resident * 4;
+}
+
+}  // namespace
+
+TEST(DeviceBlockInstanceBenchmark, LargeDeviceLoad) {
+  const int tiles = 5000;
+  std::shared_ptr<device_block> tile = make_tile_block(8, 16);
+  long rss_before = resident_kb();
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::shared_ptr<device_block_instance>> instances;
+  instances.reserve(tiles);
+  for (int t = 0; t < tiles; t++) {
+    instances.push_back(std::make_shared<device_block_instance>(tile));
+  }
+  auto load_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  long rss_after = resident_kb();
+  EXPECT_NE(instances.back()->findInstanceByName("l7"), nullptr);
+  std::cout << tiles * 9 << " instances: " << load_ms << " ms, "
+            << (rss_after - rss_before) / 1024 << " MB" << std::endl;
+}
+
+TEST(DeviceBlockInstanceBenchmark, LargeBlockLoad) {
+  const int blocks = 2000;
+  const int ports = 64;
+  long rss_before = resident_kb();
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::shared_ptr<device_block>> device;
+  device.reserve(blocks);
+  for (int b = 0; b < blocks; b++) {
+    auto block = std::make_shared<device_block>("b" + std::to_string(b));
+    for (int p = 0; p < ports; p++) {
+      block->add_port(
+          std::make_shared<device_port>("p" + std::to_string(p), p % 2 == 0));
+    }
+    device.push_back(block);
+  }
+  auto load_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  long rss_after = resident_kb();
+  start = std::chrono::steady_clock::now();
+  size_t found = 0;
+  for (auto& block : device) {
+    for (int p = 0; p < ports; p++) {
+      found += block->get_port("p" + std::to_string(p)) != nullptr;
+    }
+  }
+  auto lookup_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  EXPECT_EQ(found, size_t(blocks) * ports);
+  std::cout << blocks << " blocks: " << load_ms << " ms, "
+            << (rss_after - rss_before) / 1024 << " MB, "
+            << blocks * ports << " port lookups: " << lookup_ms << " ms"
+            << std::endl;
+}
@@ -69,6 +69,52 @@ TEST_F(DeviceBlockInstanceTest, FullConstructorTest) {
   EXPECT_EQ(instance.get_logic_address(), 300);
 }
 
+namespace {
+
+// A leaf block with ports and a parameter, and a tile made of leaf instances
+std::shared_ptr<device_block> make_tile_block(int leaves, int ports) {
+  auto leaf = std::make_shared<device_block>("leaf");
+  for (int p = 0; p < ports; p++) {
+    leaf->add_port(
+        std::make_shared<device_port>("p" + std::to_string(p), p % 2 == 0));
+  }
+  auto width = std::make_shared<ParameterType<int>>();
+  width->set_default_value(8);
+  leaf->add_int_parameter(
+      "width", std::make_shared<Parameter<int>>("width", 8, width));
+  auto tile = std::make_shared<device_block>("tile");
+  for (int l = 0; l < leaves; l++) {
+    tile->add_instance("l" + std::to_string(l),
+                       std::make_shared<device_block_instance>(leaf));
+  }
+  return tile;
+}
+
+}  // namespace
+
+TEST_F(DeviceBlockInstanceTest, InstanceTablesTest) {
+  std::shared_ptr<device_block> tile = make_tile_block(4, 6);
+  device_block_instance first(tile);
+  device_block_instance second(tile);
+  size_t symbols = device_symbol_pool::instance().size();
+
+  std::shared_ptr<device_block_instance> leaf = first.findInstanceByName("l3");
+  ASSERT_NE(leaf, nullptr);
+  EXPECT_NE(leaf, second.findInstanceByName("l3"));
+  EXPECT_EQ(first.findInstanceByName("l4"), nullptr);
+  EXPECT_EQ(first.findInstanceByName("never_interned_name"), nullptr);
+
+  ASSERT_NE(leaf->get_net("p5"), nullptr);
+  EXPECT_EQ(leaf->get_net("p5")->get_net_name(), "p5");
+  ASSERT_NE(leaf->get_port("p0"), nullptr);
+  EXPECT_TRUE(leaf->get_port("p0")->is_input());
+  EXPECT_NE(leaf->get_net("p5"), first.findInstanceByName("l2")->get_net("p5"));
+
+  // More instances reuse the interned names
+  device_block_instance third(tile);
+  EXPECT_EQ(symbols, device_symbol_pool::instance().size());
+}
+
 // int main(int argc, char **argv) {
 //     ::testing::InitGoogleTest(&argc, argv);
 //     return RUN_ALL_TESTS();
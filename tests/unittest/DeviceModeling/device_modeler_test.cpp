@@ -414,6 +414,115 @@ TEST_F(DeviceModelerTest, create_instance) {
   Model::get_modler().create_instance(argc, argv);
 }
 
+// create_instance
+TEST_F(DeviceModelerTest, create_second_instance) {
+  const int argc = 9;
+  const char* argv[argc] = { "create_instance",
+                              "-block",
+                              "TEST_BLOCK",
+                              "-name",
+                              "TEST_BLOCK_INST2",
+                              "-logic_address",
+                              "1",
+                              "-parent",
+                              "TEST_BLOCK_PARENT" };
+  Model::get_modler().create_instance(argc, argv);
+}
+
+// set_logic_address_bulk
+TEST_F(DeviceModelerTest, set_logic_address_bulk) {
+  const char* insts =
+      "TEST_BLOCK_PARENT.TEST_BLOCK_INST TEST_BLOCK_PARENT.TEST_BLOCK_INST2";
+  const char* set_argv[5] = { "set_logic_address_bulk", "-insts", insts,
+                              "-addresses", "7 0x8" };
+  EXPECT_TRUE(Model::get_modler().set_logic_address_bulk(5, set_argv));
+
+  const char* get_argv[3] = { "get_logic_address_bulk", "-insts", insts };
+  EXPECT_EQ(Model::get_modler().get_logic_address_bulk(3, get_argv),
+            std::vector<int>({7, 8}));
+
+  const char* one_argv[3] = { "get_logic_address", "-inst",
+                              "TEST_BLOCK_PARENT.TEST_BLOCK_INST2" };
+  EXPECT_EQ(Model::get_modler().get_logic_address(3, one_argv), 8);
+}
+
+// set_logic_address_bulk
+TEST_F(DeviceModelerTest, set_logic_address_bulk_mismatch) {
+  const char* insts =
+      "TEST_BLOCK_PARENT.TEST_BLOCK_INST TEST_BLOCK_PARENT.TEST_BLOCK_INST2";
+  const char* set_argv[5] = { "set_logic_address_bulk", "-insts", insts,
+                              "-addresses", "9" };
+  EXPECT_THROW(Model::get_modler().set_logic_address_bulk(5, set_argv),
+               std::runtime_error);
+
+  const char* bad_argv[5] = { "set_logic_address_bulk", "-insts",
+                              "TEST_BLOCK_PARENT.TEST_BLOCK_INST NO_SUCH_INST",
+                              "-addresses", "9 10" };
+  EXPECT_THROW(Model::get_modler().set_logic_address_bulk(5, bad_argv),
+               std::runtime_error);
+
+  // Nothing was set by the failing commands
+  const char* get_argv[3] = { "get_logic_address_bulk", "-insts", insts };
+  EXPECT_EQ(Model::get_modler().get_logic_address_bulk(3, get_argv),
+            std::vector<int>({7, 8}));
+}
+
+// set_phy_address_bulk
+TEST_F(DeviceModelerTest, set_phy_address_bulk) {
+  const char* insts =
+      "TEST_BLOCK_PARENT.TEST_BLOCK_INST TEST_BLOCK_PARENT.TEST_BLOCK_INST2";
+  const char* set_argv[5] = { "set_phy_address_bulk", "-insts", insts,
+                              "-addresses", "11 12" };
+  EXPECT_TRUE(Model::get_modler().set_phy_address_bulk(5, set_argv));
+
+  const char* get_argv[3] = { "get_phy_address_bulk", "-insts", insts };
+  EXPECT_EQ(Model::get_modler().get_phy_address_bulk(3, get_argv),
+            std::vector<int>({11, 12}));
+}
+
+// set_logic_location_bulk
+TEST_F(DeviceModelerTest, set_logic_location_bulk) {
+  const char* insts =
+      "TEST_BLOCK_PARENT.TEST_BLOCK_INST TEST_BLOCK_PARENT.TEST_BLOCK_INST2";
+  const char* set_argv[7] = { "set_logic_location_bulk", "-insts", insts,
+                              "-x", "1 2", "-z", "5 6" };
+  EXPECT_TRUE(Model::get_modler().set_logic_location_bulk(7, set_argv));
+
+  const char* get_argv[3] = { "get_logic_location", "-inst",
+                              "TEST_BLOCK_PARENT.TEST_BLOCK_INST2" };
+  std::vector<int> location =
+      Model::get_modler().get_logic_location(3, get_argv);
+  ASSERT_EQ(location.size(), 3);
+  EXPECT_EQ(location[0], 2);
+  EXPECT_EQ(location[1], -1);
+  EXPECT_EQ(location[2], 6);
+
+  const char* none_argv[3] = { "set_logic_location_bulk", "-insts", insts };
+  EXPECT_THROW(Model::get_modler().set_logic_location_bulk(3, none_argv),
+               std::runtime_error);
+}
+
+// find_instance_from_hierarchical_name
+TEST_F(DeviceModelerTest, overwritten_instance_is_found) {
+  const char* get_argv[3] = { "get_logic_address", "-inst",
+                              "TEST_BLOCK_PARENT.TEST_BLOCK_INST2" };
+  EXPECT_EQ(Model::get_modler().get_logic_address(3, get_argv), 8);
+
+  // The name resolved above now refers to a new instance
+  const int argc = 9;
+  const char* argv[argc] = { "create_instance",
+                              "-block",
+                              "TEST_BLOCK",
+                              "-name",
+                              "TEST_BLOCK_INST2",
+                              "-logic_address",
+                              "3",
+                              "-parent",
+                              "TEST_BLOCK_PARENT" };
+  Model::get_modler().create_instance(argc, argv);
+  EXPECT_EQ(Model::get_modler().get_logic_address(3, get_argv), 3);
+}
+
 // repeat_get_null_device_model
 TEST_F(DeviceModelerTest, repeat_get_null_device_model) {
   device* model = Model::get_modler().get_device_model("__default_device_name__");
@@ -0,0 +1,156 @@
+#include "DeviceModeling/device_snapshot.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include "DeviceModeling/Model.h"
+#include "DeviceModeling/device_modeler.h"
+#include "gtest/gtest.h"
+
+class DeviceSnapshotTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    device_modeler& modeler = Model::get_modler();
+    const char* device_argv[] = {"device_name", "SNAPSHOT_DEVICE"};
+    modeler.device_name(2, device_argv);
+    const char* leaf_argv[] = {"define_block", "-name", "LEAF"};
+    modeler.define_block(3, leaf_argv);
+    const char* ports_argv[] = {"define_ports", "-block", "LEAF", "-in",
+                                "a",            "-out",   "y"};
+    modeler.define_ports(7, ports_argv);
+    const char* attr_argv[] = {"define_attr", "-block",  "LEAF",
+                               "-name",       "MODE",    "-addr",
+                               "0",           "-width",  "1",
+                               "-enum",       "Slave 0,Master 1",
+                               "-default",    "Master"};
+    modeler.define_attr(13, attr_argv);
+    const char* param_argv[] = {"define_param", "-block", "LEAF", "-name",
+                                "DELAY",        "-addr",  "0x4",  "-width",
+                                "6",            "-type",  "int"};
+    modeler.define_param(11, param_argv);
+    const char* prop_argv[] = {"define_properties", "-block", "LEAF",
+                               "-speed", "fast"};
+    modeler.define_properties(5, prop_argv);
+    const char* mid_argv[] = {"define_block", "-name", "MID"};
+    modeler.define_block(3, mid_argv);
+    const char* leaf_inst_argv[] = {"create_instance", "-block", "LEAF",
+                                    "-name",           "L0",     "-parent",
+                                    "MID",             "-logic_address",
+                                    "3"};
+    modeler.create_instance(9, leaf_inst_argv);
+    const char* mid_net_argv[] = {"define_net", "-parent", "MID",
+                                  "-name",      "n0",      "-drive",
+                                  "L0.y"};
+    modeler.define_net(7, mid_net_argv);
+    const char* mid_inst_argv[] = {"create_instance", "-block", "MID",
+                                   "-name", "M0", "-logic_address", "1"};
+    modeler.create_instance(7, mid_inst_argv);
+    const char* address_argv[] = {"set_logic_address_bulk", "-insts", "M0.L0",
+                                  "-addresses", "9"};
+    modeler.set_logic_address_bulk(5, address_argv);
+  }
+
+  static void TearDownTestSuite() {
+    const char* argv[] = {"undefine_device", "SNAPSHOT_DEVICE"};
+    Model::get_modler().undefine_device(2, argv);
+    Model::get_modler().reset_current_device();
+  }
+
+  static device_snapshot::contents snapshot_contents() {
+    device_snapshot::contents snapshot;
+    snapshot.devices.push_back(
+        Model::get_modler().get_device("SNAPSHOT_DEVICE"));
+    snapshot.current_device = "SNAPSHOT_DEVICE";
+    snapshot.variables = "set ::SNAPSHOT_BANKS 2\n";
+    return snapshot;
+  }
+
+  static std::string temp_file(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+  }
+
+  static void write_text(const std::string& path, const std::string& text) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << text;
+  }
+};
+
+TEST_F(DeviceSnapshotTest, encode_decode_round_trip) {
+  std::string bytes = device_snapshot::encode(snapshot_contents());
+  device_snapshot::contents decoded = device_snapshot::decode(bytes);
+  ASSERT_EQ(decoded.devices.size(), 1);
+  EXPECT_EQ(decoded.current_device, "SNAPSHOT_DEVICE");
+  EXPECT_EQ(decoded.variables, "set ::SNAPSHOT_BANKS 2\n");
+  EXPECT_EQ(device_snapshot::encode(decoded), bytes);
+}
+
+TEST_F(DeviceSnapshotTest, decoded_device_matches) {
+  device_snapshot::contents decoded =
+      device_snapshot::decode(device_snapshot::encode(snapshot_contents()));
+  std::shared_ptr<device> dev = decoded.devices.front();
+  EXPECT_EQ(dev->device_name(), "SNAPSHOT_DEVICE");
+  EXPECT_NE(dev, Model::get_modler().get_device("SNAPSHOT_DEVICE"));
+
+  auto leaf = dev->get_block("LEAF");
+  ASSERT_NE(leaf, nullptr);
+  ASSERT_NE(leaf->get_port("a"), nullptr);
+  EXPECT_TRUE(leaf->get_port("a")->is_input());
+  EXPECT_FALSE(leaf->get_port("y")->is_input());
+  EXPECT_EQ(leaf->get_port("y")->get_block(), leaf.get());
+  EXPECT_EQ(leaf->getProperty("speed"), "fast");
+  auto mode = leaf->get_attribute("MODE");
+  ASSERT_NE(mode, nullptr);
+  EXPECT_EQ(mode->get_type()->get_enum_value("Master"), 1);
+  auto delay = leaf->get_int_parameter("DELAY");
+  ASSERT_NE(delay, nullptr);
+  EXPECT_EQ(delay->get_address(), 4);
+
+  auto mid = dev->get_block("MID");
+  ASSERT_NE(mid, nullptr);
+  auto l0 = mid->get_instance("L0");
+  ASSERT_NE(l0, nullptr);
+  EXPECT_EQ(l0->get_logic_address(), 3);
+  EXPECT_EQ(mid->get_net("n0")->get_source(), l0->get_net("y"));
+
+  auto m0 = dev->get_instance("M0");
+  ASSERT_NE(m0, nullptr);
+  EXPECT_EQ(m0->get_logic_address(), 1);
+  EXPECT_EQ(m0->findInstanceByName("L0")->get_logic_address(), 9);
+  EXPECT_EQ(m0->get_block(), mid);
+}
+
+TEST_F(DeviceSnapshotTest, rejects_changed_sources) {
+  std::string source = temp_file("device_snapshot_test.tcl");
+  std::string path = temp_file("device_snapshot_test.snapshot");
+  write_text(source, "device_name SNAPSHOT_DEVICE\n");
+  device_modeler& modeler = Model::get_modler();
+  modeler.write_snapshot(path, {"SNAPSHOT_DEVICE"}, {source});
+
+  std::string reason;
+  auto before = modeler.get_device("SNAPSHOT_DEVICE");
+  EXPECT_TRUE(modeler.load_snapshot(path, reason, false));
+  EXPECT_EQ(modeler.get_device("SNAPSHOT_DEVICE"), before);
+  EXPECT_TRUE(modeler.load_snapshot(path, reason));
+  EXPECT_NE(modeler.get_device("SNAPSHOT_DEVICE"), before);
+  EXPECT_EQ(modeler.get_current_device(),
+            modeler.get_device("SNAPSHOT_DEVICE"));
+
+  write_text(source, "device_name OTHER_DEVICE\n");
+  EXPECT_FALSE(modeler.load_snapshot(path, reason));
+  EXPECT_EQ(reason, source + " changed since the snapshot was built");
+  std::filesystem::remove(source);
+  std::filesystem::remove(path);
+}
+
+TEST_F(DeviceSnapshotTest, rejects_bad_snapshots) {
+  std::string bytes = device_snapshot::encode(snapshot_contents());
+  std::string corrupted = bytes;
+  corrupted.back() ^= 1;
+  EXPECT_THROW(device_snapshot::decode(corrupted), std::runtime_error);
+  std::string truncated = bytes.substr(0, bytes.size() / 2);
+  EXPECT_THROW(device_snapshot::decode(truncated), std::runtime_error);
+  std::string other_version = bytes;
+  other_version[8] = static_cast<char>(device_snapshot::VERSION + 1);
+  EXPECT_THROW(device_snapshot::decode(other_version), std::runtime_error);
+  EXPECT_THROW(device_snapshot::decode("not a snapshot"), std::runtime_error);
+}
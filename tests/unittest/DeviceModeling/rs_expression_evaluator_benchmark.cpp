@@ -0,0 +1,56 @@
+/**
+ * @file rs_expression_evaluator_benchmark.cpp
+ * @brief Timing of the compiled expression cache
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <map>
+
+#include "DeviceModeling/rs_expression_evaluator.h"
+
+using namespace std;
+
+typedef double T;
+typedef double E;
+
+typedef rs_expression_evaluator<T, E> ExprEval;
+
+TEST(RSExpressionEvaluatorTest, Benchmark) {
+  // A device validation evaluates few distinct constraints many times
+  const int distinct_num = 50;
+  const int evaluations_num = 5000;
+  std::vector<std::string> expressions;
+  for (int i = 0; i < distinct_num; i++) {
+    expressions.push_back("(width + " + std::to_string(i) + ") * depth");
+  }
+  map<string, E> value_map = {{"width", 8.0}, {"depth", 16.0}};
+  auto measure = [&](bool cached) {
+    auto start = std::chrono::steady_clock::now();
+    E sum = 0;
+    for (int i = 0; i < evaluations_num; i++) {
+      const std::string &expression = expressions[i % distinct_num];
+      if (!cached) ExprEval::clear_cache();
+      E result = 0;
+      EXPECT_TRUE(ExprEval::evaluate_expression(expression, value_map, result));
+      sum += result;
+    }
+    EXPECT_EQ(16.0 * (8.0 * evaluations_num +
+                      (distinct_num - 1) * evaluations_num / 2.0),
+              sum);
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+  };
+  auto compiled_each_time = measure(false);
+  auto cached = measure(true);
+  std::cout << evaluations_num << " evaluations: compiled each time "
+            << compiled_each_time << " ms, cached " << cached << " ms"
+            << std::endl;
+}
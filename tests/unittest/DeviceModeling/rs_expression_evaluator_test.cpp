@@ -14,6 +14,7 @@
 #include <gtest/gtest.h>
 
 #include <map>
+#include <thread>
 
 using namespace std;
 
@@ -82,6 +83,93 @@ TEST(RSExpressionEvaluatorTest, Evaluate) {
   ASSERT_EQ(expected_result, result);
 }
 
+TEST(RSExpressionEvaluatorTest, MissingSymbolFails) {
+  map<string, E> value_map = {{"x", 3.0}};
+  E result = 0;
+  ASSERT_FALSE(ExprEval::evaluate_expression("x + y", value_map, result));
+  // The value map isn't extended with the missing symbol
+  ASSERT_EQ(1u, value_map.size());
+}
+
+TEST(RSExpressionEvaluatorTest, CompiledOnce) {
+  ExprEval::clear_cache();
+  E result = 0;
+  ASSERT_TRUE(ExprEval::evaluate_expression("x - y", {{"x", 5}, {"y", 2}},
+                                            result));
+  ASSERT_EQ(3.0, result);
+  ASSERT_TRUE(ExprEval::evaluate_expression("x - y", {{"x", 1}, {"y", 2}},
+                                            result));
+  ASSERT_EQ(-1.0, result);
+  ASSERT_EQ(ExprEval::compile("x - y"), ExprEval::compile("x - y"));
+  ASSERT_EQ(1u, ExprEval::cache_size());
+
+  // Failed compilations are cached too
+  ASSERT_FALSE(ExprEval::compile("x - ")->is_valid());
+  ASSERT_FALSE(ExprEval::evaluate_expression("x - ", {{"x", 1}}, result));
+  ASSERT_EQ(2u, ExprEval::cache_size());
+}
+
+TEST(RSExpressionEvaluatorTest, EvaluateBatch) {
+  vector<map<string, E>> value_maps;
+  for (int i = 0; i < 10; i++) {
+    value_maps.push_back({{"x", E(i)}, {"y", 2.0}});
+  }
+  vector<E> results;
+  ASSERT_TRUE(ExprEval::evaluate_batch("x * y + 1", value_maps, results));
+  ASSERT_EQ(value_maps.size(), results.size());
+  for (int i = 0; i < 10; i++) {
+    ASSERT_EQ(2.0 * i + 1, results[i]);
+  }
+
+  value_maps[3].erase("y");
+  ASSERT_FALSE(ExprEval::evaluate_batch("x * y + 1", value_maps, results));
+  ASSERT_EQ(5.0, results[2]);
+  ASSERT_EQ(9.0, results[4]);
+}
+
+TEST(RSExpressionEvaluatorTest, EvaluateFromThreads) {
+  const int threads_num = 4;
+  const int evaluations_num = 1000;
+  std::vector<std::thread> threads;
+  std::vector<int> failures(threads_num, 0);
+  for (int t = 0; t < threads_num; t++) {
+    threads.emplace_back([t, &failures]() {
+      for (int i = 0; i < evaluations_num; i++) {
+        E result = 0;
+        bool ok = ExprEval::evaluate_expression("a * b + c",
+                                                {{"a", E(t)}, {"b", E(i)},
+                                                 {"c", 1.0}},
+                                                result);
+        if (!ok || result != E(t) * E(i) + 1.0) failures[t]++;
+      }
+    });
+  }
+  for (auto &thread : threads) thread.join();
+  for (int t = 0; t < threads_num; t++) {
+    EXPECT_EQ(0, failures[t]);
+  }
+}
+
+TEST(RSExpressionEvaluatorTest, DistinctExpressionsCachedOnce) {
+  // A device validation evaluates few distinct constraints many times
+  ExprEval::clear_cache();
+  const int distinct_num = 5;
+  const int evaluations_num = 20;
+  map<string, E> value_map = {{"width", 8.0}, {"depth", 16.0}};
+  E sum = 0;
+  for (int i = 0; i < evaluations_num; i++) {
+    const std::string expression =
+        "(width + " + std::to_string(i % distinct_num) + ") * depth";
+    E result = 0;
+    ASSERT_TRUE(ExprEval::evaluate_expression(expression, value_map, result));
+    sum += result;
+  }
+  EXPECT_EQ(16.0 * (8.0 * evaluations_num +
+                    (distinct_num - 1) * evaluations_num / 2.0),
+            sum);
+  EXPECT_EQ(size_t(distinct_num), ExprEval::cache_size());
+}
+
 // int main(int argc, char **argv)
 // {
 //     ::testing::InitGoogleTest(&argc, argv);
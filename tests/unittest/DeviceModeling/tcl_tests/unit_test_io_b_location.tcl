@@ -52,4 +52,22 @@ test set_and_get_logic_address {Set and get logic address for an instance} {
     get_logic_address -inst b_l1.inst_l2.inst_hv.u_gbox_root_bank_clkmux_hv_0
 } {36}
 
+# Test cases for the bulk address and location operations
+set clkmux_insts [list b_l1.inst_l2.inst_hv.u_gbox_root_bank_clkmux_hv_0 b_l1.inst_l2.inst_hv.u_gbox_root_bank_clkmux_hv_1]
+
+test set_and_get_logic_address_bulk {Set and get logic addresses for a list of instances} {
+    set_logic_address_bulk -insts $clkmux_insts -addresses {21 22}
+    get_logic_address_bulk -insts $clkmux_insts
+} {21 22}
+
+test set_and_get_phy_address_bulk {Set and get physical addresses for a list of instances} {
+    set_phy_address_bulk -insts $clkmux_insts -addresses {101 102}
+    get_phy_address_bulk -insts $clkmux_insts
+} {101 102}
+
+test set_logic_location_bulk {Set logic locations for a list of instances} {
+    set_logic_location_bulk -insts $clkmux_insts -x {1 2} -y {4 5} -z {7 8}
+    get_logic_location -inst b_l1.inst_l2.inst_hv.u_gbox_root_bank_clkmux_hv_1
+} {2 5 8}
+
 cleanupTests
@@ -0,0 +1,116 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "IPGenerate/IPCatalogIndex.h"
+
+#include "IPGenerate/IPCatalog.h"
+#include "Utils/FileUtils.h"
+#include "gtest/gtest.h"
+
+namespace fs = std::filesystem;
+using namespace FOEDAG;
+
+class IPCatalogIndexTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    FileUtils::removeAll(m_dir);
+    FileUtils::MkDirs(m_dir);
+    FileUtils::WriteToFile(m_generator, "print('{}')");
+  }
+  void TearDown() override { FileUtils::removeAll(m_dir); }
+
+  const fs::path m_dir{"ip_catalog_index_test"};
+  const fs::path m_generator{m_dir / "mock_ip_gen.py"};
+  const fs::path m_index{m_dir / "cache" / "ip_catalog_index.json"};
+  const std::string m_template{"{\"parameters\": []}"};
+};
+
+TEST_F(IPCatalogIndexTest, MissingEntry) {
+  IPCatalogIndex index{m_index};
+  std::string jsonStr;
+  EXPECT_FALSE(index.lookup(m_generator, "python3", jsonStr));
+}
+
+TEST_F(IPCatalogIndexTest, PersistentEntry) {
+  {
+    IPCatalogIndex index{m_index};
+    index.update(m_generator, "python3", m_template);
+    EXPECT_TRUE(index.save());
+  }
+  IPCatalogIndex index{m_index};
+  std::string jsonStr;
+  EXPECT_TRUE(index.lookup(m_generator, "python3", jsonStr));
+  EXPECT_EQ(jsonStr, m_template);
+  // Another interpreter may print another template
+  EXPECT_FALSE(index.lookup(m_generator, "/usr/bin/python3", jsonStr));
+}
+
+TEST_F(IPCatalogIndexTest, TouchedGeneratorIsUpToDate) {
+  IPCatalogIndex index{m_index};
+  index.update(m_generator, "python3", m_template);
+  fs::last_write_time(m_generator,
+                      fs::last_write_time(m_generator) + std::chrono::hours(1));
+  std::string jsonStr;
+  EXPECT_TRUE(index.lookup(m_generator, "python3", jsonStr));
+}
+
+TEST_F(IPCatalogIndexTest, ModifiedGeneratorIsStale) {
+  IPCatalogIndex index{m_index};
+  index.update(m_generator, "python3", m_template);
+  FileUtils::WriteToFile(m_generator, "print('{\"parameters\": [1]}')");
+  std::string jsonStr;
+  EXPECT_FALSE(index.lookup(m_generator, "python3", jsonStr));
+}
+
+TEST_F(IPCatalogIndexTest, UnreadableIndex) {
+  FileUtils::MkDirs(m_index.parent_path());
+  FileUtils::WriteToFile(m_index, "not a json");
+  IPCatalogIndex index{m_index};
+  std::string jsonStr;
+  EXPECT_FALSE(index.lookup(m_generator, "python3", jsonStr));
+  index.update(m_generator, "python3", m_template);
+  EXPECT_TRUE(index.save());
+}
+
+TEST(IPCatalogIndex, DefinitionLoadedOnFirstUse) {
+  IPCatalog catalog;
+  IPDefinition* def =
+      new IPDefinition(IPDefinition::IPType::LiteXGenerator, "MOCK_IP_V1_0",
+                       std::string{}, "MOCK_IP_gen.py", {}, {});
+  catalog.addIP(def);
+  def->Valid(false);
+  int loaded{0};
+  def->Loader([&catalog, &loaded]() {
+    loaded++;
+    std::vector<Value*> parameters{new IPParameter(
+        "width", "Width", "32", IPParameter::ParamType::Int)};
+    auto def = catalog.Definition("MOCK_IP_V1_0");
+    def->apply(IPDefinition::IPType::LiteXGenerator, "MOCK_IP_V1_0",
+               "mock_ip_wrapper", "MOCK_IP_gen.py", {}, parameters);
+    def->Valid(true);
+  });
+  EXPECT_EQ(def->Name(), "MOCK_IP_V1_0");
+  EXPECT_EQ(loaded, 0);
+  EXPECT_EQ(def->Parameters().size(), 1);
+  EXPECT_TRUE(def->Valid());
+  EXPECT_EQ(def->BuildName(), "mock_ip_wrapper");
+  EXPECT_EQ(loaded, 1);
+}
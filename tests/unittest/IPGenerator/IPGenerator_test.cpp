@@ -21,9 +21,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "IPGenerate/IPGenerator.h"
 
+#include <cstdlib>
+
 #include "Compiler/Compiler.h"
 #include "NewProject/ProjectManager/project_manager.h"
 #include "ProjNavigator/tcl_command_integration.h"
+#include "Utils/FileUtils.h"
 #include "gtest/gtest.h"
 
 namespace FOEDAG {
@@ -143,9 +146,142 @@ TEST(IPGenerate, CheckAllIPPath) {
             "run_1/IPs/.tmp/path_to_nowhere/module_name/"
             "MOCK_IP_module_name.json");
 
+  EXPECT_EQ(ipGen->GetLogPath(instance),
+            "run_1/IPs/path_to_nowhere/module_name/module_name_generate.log");
+
   EXPECT_EQ(ipGen->GetTmpPath(), "run_1/IPs/.tmp");
 
   EXPECT_EQ(ipGen->GetProjectIPsPath(), "run_1/IPs");
 }
 
+TEST(IPGenerate, ContentKey) {
+  IPCatalog* ipCat = new IPCatalog();
+  Compiler* compiler = new Compiler();
+  IPGenerator* ipGen = new IPGenerator(ipCat, compiler);
+
+  std::filesystem::path script =
+      std::filesystem::temp_directory_path() / "mock_ip_gen.py";
+  std::ofstream{script} << "print('v1')" << std::endl;
+
+  std::vector<Connector*> connections;
+  std::vector<Value*> parameters;
+  parameters.push_back(new IPParameter("width", "Width", "32",
+                                       IPParameter::ParamType::Int));
+  IPDefinition* def =
+      new IPDefinition(IPDefinition::IPType::LiteXGenerator, "MOCK_IP",
+                       "MOCK_IP_wrapper", script, connections, parameters);
+  ipCat->addIP(def);
+
+  std::vector<SParameter> params{SParameter{"width", "32"}};
+  std::vector<SParameter> params2{SParameter{"width", "64"}};
+  IPInstance* instance = new IPInstance("MOCK_IP", "V1_0", def, params,
+                                        "inst1", "project1/rs_ips/inst1");
+  IPInstance* moved = new IPInstance("MOCK_IP", "V1_0", def, params,
+                                     "inst1", "project2/rs_ips/inst1");
+  IPInstance* instance2 = new IPInstance("MOCK_IP", "V1_0", def, params2,
+                                         "inst1", "project1/rs_ips/inst1");
+  IPInstance* renamed = new IPInstance("MOCK_IP", "V1_0", def, params,
+                                       "inst2", "project1/rs_ips/inst2");
+
+  const std::string key = ipGen->GetContentKey(instance, "python3");
+  EXPECT_FALSE(key.empty());
+  EXPECT_EQ(key, ipGen->GetContentKey(instance, "python3"));
+  // Same IP in another project shares the key
+  EXPECT_EQ(key, ipGen->GetContentKey(moved, "python3"));
+  EXPECT_NE(key, ipGen->GetContentKey(instance2, "python3"));
+  EXPECT_NE(key, ipGen->GetContentKey(renamed, "python3"));
+  EXPECT_NE(key, ipGen->GetContentKey(instance, "/usr/bin/python3"));
+
+  // Generator script update
+  std::ofstream{script} << "print('v2')" << std::endl;
+  EXPECT_NE(key, ipGen->GetContentKey(instance, "python3"));
+
+  std::filesystem::remove(script);
+  EXPECT_TRUE(ipGen->GetContentKey(instance, "python3").empty());
+}
+
+#ifndef _WIN32
+TEST(IPGenerate, UserCachePath) {
+  setenv("FOEDAG_IP_CACHE", "ip_cache_dir", 1);
+  EXPECT_EQ(IPGenerator::GetUserCachePath(), "ip_cache_dir");
+  // Empty value disables the cache
+  setenv("FOEDAG_IP_CACHE", "", 1);
+  EXPECT_TRUE(IPGenerator::GetUserCachePath().empty());
+  unsetenv("FOEDAG_IP_CACHE");
+}
+
+class UserCacheIPGenerator : public IPGenerator {
+ public:
+  using IPGenerator::IPGenerator;
+  using IPGenerator::RestoreFromUserCache;
+  using IPGenerator::SaveToUserCache;
+};
+
+TEST(IPGenerate, UserCacheSaveRestore) {
+  namespace fs = std::filesystem;
+  const fs::path tmp = fs::temp_directory_path() / "foedag_ip_user_cache";
+  FileUtils::removeAll(tmp);
+  const fs::path cache = tmp / "cache";
+  setenv("FOEDAG_IP_CACHE", cache.c_str(), 1);
+
+  IPCatalog* ipCat = new IPCatalog();
+  Compiler* compiler = new Compiler();
+  UserCacheIPGenerator* ipGen = new UserCacheIPGenerator(ipCat, compiler);
+  ProjectManager* pm = new ProjectManager{};
+  compiler->setGuiTclSync(new TclCommandIntegration{pm, nullptr});
+  std::vector<Connector*> connections;
+  std::vector<Value*> parameters;
+  IPDefinition* def = new IPDefinition(
+      IPDefinition::IPType::LiteXGenerator, "MOCK_IP", "MOCK_IP_wrapper",
+      "path_to_nowhere", connections, parameters);
+  ipCat->addIP(def);
+  std::vector<SParameter> params;
+  IPInstance* instance = new IPInstance("MOCK_IP", "V1_0", def, params,
+                                        "inst1", tmp / "project1" / "inst1.v");
+
+  // Generated IP of the first project
+  Project::Instance()->setProjectPath(
+      QString::fromStdString((tmp / "project1").string()));
+  const fs::path buildDir = ipGen->GetBuildDir(instance);
+  FileUtils::MkDirs(buildDir / "src");
+  FileUtils::WriteToFile(buildDir / "src" / "inst1.v", "module inst1();");
+  // File lists of the generator embed its absolute build_dir
+  FileUtils::WriteToFile(buildDir / "inst1.f",
+                         (tmp / "project1" / "inst1.v").string(), false);
+  FileUtils::WriteToFile(ipGen->GetCachePath(instance), "{}");
+  FileUtils::WriteToFile(ipGen->GetLogPath(instance), "generated");
+  const fs::path jsonName = ipGen->GetCachePath(instance).filename();
+  const fs::path logName = ipGen->GetLogPath(instance).filename();
+
+  ipGen->SaveToUserCache(instance, "key");
+  EXPECT_TRUE(FileUtils::FileExists(cache / "key" / "src" / "inst1.v"));
+  EXPECT_EQ(FileUtils::GetFileContent(cache / "key" / "inst1.f"),
+            "${FOEDAG_IP_BUILD_DIR}/inst1.v");
+  // Project files are not shared
+  EXPECT_FALSE(FileUtils::FileExists(cache / "key" / jsonName));
+  EXPECT_FALSE(FileUtils::FileExists(cache / "key" / logName));
+
+  // Same IP in the second project, its json is written before the restore
+  Project::Instance()->setProjectPath(
+      QString::fromStdString((tmp / "project2").string()));
+  const fs::path restoreDir = ipGen->GetBuildDir(instance);
+  EXPECT_NE(restoreDir, buildDir);
+  FileUtils::MkDirs(restoreDir);
+  FileUtils::WriteToFile(restoreDir / jsonName, "project2", false);
+  EXPECT_FALSE(ipGen->RestoreFromUserCache(instance, "unknown_key"));
+  IPInstance* moved = new IPInstance("MOCK_IP", "V1_0", def, params, "inst1",
+                                     tmp / "project2" / "inst1.v");
+  EXPECT_TRUE(ipGen->RestoreFromUserCache(moved, "key"));
+  EXPECT_TRUE(FileUtils::FileExists(restoreDir / "src" / "inst1.v"));
+  EXPECT_EQ(FileUtils::GetFileContent(restoreDir / "inst1.f"),
+            (tmp / "project2" / "inst1.v").string());
+  EXPECT_EQ(FileUtils::GetFileContent(restoreDir / jsonName), "project2");
+  EXPECT_FALSE(FileUtils::FileExists(restoreDir / logName));
+
+  Project::Instance()->setProjectPath({});
+  unsetenv("FOEDAG_IP_CACHE");
+  FileUtils::removeAll(tmp);
+}
+#endif
+
 }  // namespace FOEDAG
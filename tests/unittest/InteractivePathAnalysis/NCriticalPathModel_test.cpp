@@ -270,6 +270,42 @@ TEST(NCriticalPathModel, Paths)
     EXPECT_QSTREQ(QString{""}, getDiffStr(std::map<QString, int>{}, model.outputNodes()));
 }
 
+TEST(NCriticalPathModel, PathChildrenAreFetchedOnDemand)
+{
+    NCriticalPathModel model;
+
+    QSignalSpy loadFinishedSpy(&model, &NCriticalPathModel::loadFinished);
+    model.loadFromString(getRawModelDataString());
+    EXPECT_TRUE(waitSignal(loadFinishedSpy));
+
+    int pathsCounter = 0;
+    for (int i=0; i<model.rowCount(); ++i) {
+        QModelIndex pathIndex = model.index(i, 0);
+        NCriticalPathItem* pathItem = static_cast<NCriticalPathItem*>(pathIndex.internalPointer());
+        if (!pathItem || !pathItem->isPath()) {
+            continue;
+        }
+        pathsCounter++;
+
+        // children are not created until requested
+        EXPECT_TRUE(model.hasChildren(pathIndex));
+        EXPECT_TRUE(model.canFetchMore(pathIndex));
+        EXPECT_EQ(0, model.rowCount(pathIndex));
+
+        model.fetchMore(pathIndex);
+        EXPECT_FALSE(model.canFetchMore(pathIndex));
+        EXPECT_TRUE(model.rowCount(pathIndex) > 0);
+        for (int j=0; j<model.rowCount(pathIndex); ++j) {
+            QModelIndex childIndex = model.index(j, 0, pathIndex);
+            NCriticalPathItem* childItem = static_cast<NCriticalPathItem*>(childIndex.internalPointer());
+            EXPECT_EQ(pathItem->id(), childItem->pathIndex());
+            EXPECT_EQ(j, childItem->row());
+            EXPECT_EQ(pathIndex, model.parent(childIndex));
+        }
+    }
+    EXPECT_EQ(EXPECTED_CRIT_PATH_NUM, pathsCounter);
+}
+
 
 // TODO: Previous test case wasn't compatible with current implementation. Moreover, the implementation will be changed soon (see https://github.com/QL-Proprietary/aurora2/issues/481)
 // Test case will be revised after/along with a new method of extracting path elements implementation.
@@ -527,3 +563,40 @@ TEST(NCriticalPathFilterModel, OutputFilterCriteriaRegexp)
     EXPECT_EQ(0, source.rowCount());
     EXPECT_EQ(0, filter.rowCount());
 }
+
+TEST(NCriticalPathFilterModel, BackgroundFilterOnManyPaths)
+{
+    // enough paths for the filter to go to the background thread
+    const int pathsNum = 12000;
+    NCriticalPathModel source;
+    NCriticalPathFilterModel filter;
+    filter.setSourceModel(&source);
+
+    ItemsHelperStructPtr itemsPtr = std::make_shared<ItemsHelperStruct>();
+    for (int i=0; i<pathsNum; ++i) {
+        QString data = QString("#Path %1\nStartpoint: in[%2].Q[0]\nEndpoint : out[%1].D[0]").arg(i + 1).arg(i % 4);
+        itemsPtr->items.push_back(new NCriticalPathItem(data, "", "", NCriticalPathItem::PATH, i, i, true));
+    }
+    source.loadItems(itemsPtr);
+    EXPECT_EQ(pathsNum, filter.rowCount());
+
+    /// APPLY FILTER
+    QSignalSpy filterFinishedSpy(&filter, &NCriticalPathFilterModel::backgroundFilterFinished);
+    FilterCriteriaConf inputConf{"IN[1]", false, false};
+    EXPECT_TRUE(filter.setFilterCriteria(inputConf, FilterCriteriaConf{}));
+
+    // paths stay visible until the result of the background filter is ready
+    EXPECT_EQ(pathsNum, filter.rowCount());
+    EXPECT_TRUE(waitSignal(filterFinishedSpy));
+
+    auto [pathItems, otherItems] = collectVisibleItems(filter);
+    EXPECT_EQ(pathsNum / 4, pathItems.size());
+    EXPECT_EQ(0, otherItems.size());
+    for (NCriticalPathItem* item: pathItems) {
+        EXPECT_TRUE(item->startPointLine().contains("in[1]"));
+    }
+
+    /// RESET FILTER
+    filter.clear();
+    EXPECT_EQ(pathsNum, filter.rowCount());
+}
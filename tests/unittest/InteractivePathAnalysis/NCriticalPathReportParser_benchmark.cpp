@@ -0,0 +1,51 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+
+#include "NCriticalPathReportSamples.h"
+#include "gtest/gtest.h"
+
+using namespace FOEDAG;
+
+TEST(NCriticalPathReportParser, Benchmark) {
+  const std::vector<std::string> lines = syntheticReport(10000);
+  const std::vector<std::string_view> views(lines.begin(), lines.end());
+  auto measure = [](const std::function<size_t()>& parse) {
+    auto start = std::chrono::steady_clock::now();
+    size_t groups = parse();
+    EXPECT_EQ(10002, groups);
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+  };
+  auto regex = measure([&]() { return parseReportRegex(lines).size(); });
+  auto sequential = measure([&]() {
+    return NCriticalPathReportParser::parseReport(views, 1).size();
+  });
+  auto parallel = measure(
+      [&]() { return NCriticalPathReportParser::parseReport(views).size(); });
+  std::cout << lines.size() << " lines: regex " << regex << " ms, scanner "
+            << sequential << " ms, parallel scanner " << parallel << " ms"
+            << std::endl;
+}
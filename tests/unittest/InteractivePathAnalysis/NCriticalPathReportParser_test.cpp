@@ -0,0 +1,90 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "InteractivePathAnalysis/NCriticalPathReportParser.h"
+
+#include <sstream>
+
+#include "NCriticalPathReportSamples.h"
+#include "gtest/gtest.h"
+
+using namespace FOEDAG;
+
+namespace {
+
+std::string dump(const std::vector<GroupPtr>& groups) {
+  std::stringstream ss;
+  for (const GroupPtr& group : groups) {
+    ss << "group " << group->pathInfo.index << " " << group->pathInfo.start
+       << " " << group->pathInfo.end << " " << group->pathInfo.slack << "\n";
+    for (const ElementPtr& element : group->elements) {
+      ss << " element\n";
+      for (const Line& line : element->lines) {
+        ss << "  " << line.role << line.isMultiColumn << " " << line.line
+           << "\n";
+      }
+    }
+  }
+  return ss.str();
+}
+
+}  // namespace
+
+TEST(NCriticalPathReportParser, SameAsRegexParser) {
+  std::vector<std::string> lines = syntheticReport(40);
+  // Corner cases of the former regular expressions
+  lines.insert(lines.begin() + 10,
+               {"#Path 7x", "Startpoint: a[1].b[2]c (x)",
+                "Startpoint: .bad", "Endpoint: no_space_before_colon",
+                "Endpoint \t: n.m[", "slack (VIOLATED) 1.", "slack (MET) 1.0",
+                "slack\t(VIOLATED)\t-12.5", "#Path "});
+  EXPECT_EQ(dump(parseReportRegex(lines)),
+            dump(NCriticalPathReportParser::parseReport(lines)));
+}
+
+TEST(NCriticalPathReportParser, ParallelSameAsSequential) {
+  const std::vector<std::string> lines = syntheticReport(5000);
+  const std::vector<std::string_view> views(lines.begin(), lines.end());
+  std::vector<GroupPtr> sequential =
+      NCriticalPathReportParser::parseReport(views, 1);
+  std::vector<GroupPtr> parallel =
+      NCriticalPathReportParser::parseReport(views, 4);
+  ASSERT_EQ(5002, parallel.size());
+  EXPECT_EQ(2500, parallel[2500]->pathInfo.index);
+  EXPECT_EQ(dump(sequential), dump(parallel));
+  EXPECT_EQ(dump(parseReportRegex(lines)), dump(parallel));
+}
+
+TEST(NCriticalPathReportParser, MetaData) {
+  std::string report;
+  for (const std::string& line : syntheticReport(3)) {
+    report += line + "\n";
+  }
+  std::vector<std::string_view> lines =
+      NCriticalPathReportParser::splitLines(report);
+  EXPECT_EQ("", lines.back());
+  std::map<int, std::pair<int, int>> metadata;
+  NCriticalPathReportParser::parseMetaData(lines, metadata);
+  std::map<int, std::pair<int, int>> expected{
+      {1, {3, 12}}, {2, {6, 12}}, {3, {9, 12}}};
+  EXPECT_EQ(expected, metadata);
+}
@@ -0,0 +1,135 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "InteractivePathAnalysis/NCriticalPathReportParser.h"
+
+namespace FOEDAG {
+
+// The regular expression parser the scanner replaced, kept as a reference
+inline std::vector<GroupPtr> parseReportRegex(
+    const std::vector<std::string>& lines) {
+  static std::regex pathPattern(R"(^\#Path (\d+)$)");
+  static std::regex startPointPattern(
+      R"(^Startpoint: (\w+(?:\[\d+\])?(\.\w+(?:\[\d+\])?)?))");
+  static std::regex endPointPattern(
+      R"(^Endpoint\s+: (\w+(?:\[\d+\])?(\.\w+(?:\[\d+\])?)?))");
+  static std::regex slackPattern(R"(^slack\s+\(VIOLATED\)\s+(-?\d+\.\d+)$)");
+
+  std::vector<GroupPtr> groups;
+  GroupPtr currentGroup = std::make_shared<Group>();
+  Role prevRole = Role::OTHER;
+  for (const std::string& line : lines) {
+    bool isMultiColumn = true;
+    bool isEndPathElement = false;
+    bool isEndReportReached = false;
+    Role currentRole = Role::OTHER;
+    std::smatch m;
+    if (line == "") {
+      currentRole = prevRole;
+      isMultiColumn = false;
+    } else if (std::regex_search(line, m, pathPattern)) {
+      groups.push_back(currentGroup);
+      currentGroup = std::make_shared<Group>();
+      currentGroup->pathInfo.index = std::atoi(m[1].str().c_str());
+      currentRole = Role::PATH;
+      isMultiColumn = false;
+    } else if (std::regex_search(line, m, slackPattern)) {
+      currentGroup->pathInfo.slack = m[1].str();
+    } else if (std::regex_search(line, m, startPointPattern)) {
+      currentGroup->pathInfo.start = m[1].str();
+      currentRole = Role::PATH;
+    } else if (std::regex_search(line, m, endPointPattern)) {
+      currentGroup->pathInfo.end = m[1].str();
+      currentRole = Role::PATH;
+    } else if (line.at(0) == '|') {
+      currentRole = Role::SEGMENT;
+    } else if ((line.find('[') != std::string::npos) &&
+               (line.find(']') != std::string::npos)) {
+      currentRole = Role::SEGMENT;
+      isEndPathElement = true;
+    } else if (line == "#End of timing report") {
+      groups.push_back(currentGroup);
+      currentGroup = std::make_shared<Group>();
+      isMultiColumn = false;
+      isEndReportReached = true;
+    }
+    if (currentRole != currentGroup->currentElement->currentRole()) {
+      currentGroup->getNextCurrentElement();
+    }
+    currentGroup->currentElement->lines.emplace_back(
+        Line{line, currentRole, isMultiColumn});
+    if (isEndPathElement) {
+      currentGroup->getNextCurrentElement();
+    }
+    if (isEndReportReached) {
+      break;
+    }
+    prevRole = currentRole;
+  }
+  groups.push_back(currentGroup);
+  return groups;
+}
+
+// Report of pathNum paths of 12 luts as VPR writes it
+inline std::vector<std::string> syntheticReport(int pathNum) {
+  std::vector<std::string> lines{"#Timing report of worst paths",
+                                 "# Unit scale: 1e-09 seconds",
+                                 "# Output precision: 3", ""};
+  for (int i = 1; i <= pathNum; i++) {
+    std::string dff = "count[" + std::to_string(i % 16) + "]";
+    lines.push_back("#Path " + std::to_string(i));
+    lines.push_back("Startpoint: " + dff + ".Q[0] (dffsre clocked by clk)");
+    lines.push_back((i % 2) ? "Endpoint  : out_" + std::to_string(i) +
+                                  ".outpad[0] (.output clocked by clk)"
+                            : "Endpoint  : " + dff + ".D[0] (dffsre)");
+    lines.push_back("Path Type : setup");
+    lines.push_back("");
+    lines.push_back("Point                          Incr      Path");
+    lines.push_back("---------------------------------------------");
+    lines.push_back("clock clk (rise edge)         0.000     0.000");
+    lines.push_back("| (intra 'clb' routing)       0.000     0.000");
+    for (int j = 0; j < 12; j++) {
+      lines.push_back("lut_" + std::to_string(j) + "[" + std::to_string(i) +
+                      "].in[0] (.names)    0.053     1.937");
+      lines.push_back("| (inter-block routing)       0.043     2.050");
+    }
+    lines.push_back("data arrival time                        4.147");
+    lines.push_back("");
+    lines.push_back("slack (VIOLATED)                        -" +
+                    std::to_string(i % 5) + ".488");
+    lines.push_back("");
+    lines.push_back("");
+  }
+  lines.push_back("#End of timing report");
+  lines.push_back("#RPT METADATA:");
+  for (int i = 1; i <= pathNum; i++) {
+    lines.push_back(std::to_string(i) + "/" + std::to_string(i * 3) + "/12");
+  }
+  return lines;
+}
+
+}  // namespace FOEDAG
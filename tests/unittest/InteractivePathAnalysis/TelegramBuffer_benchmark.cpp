@@ -0,0 +1,73 @@
+/**
+  * @file TelegramBuffer_benchmark.cpp
+  * @author The Foedag team
+  * @date 2026-10-16
+  * @copyright Copyright 2021 The Foedag team
+
+  * GPL License
+
+  * Copyright (c) 2021 The Open-Source FPGA Foundation
+
+  * This program is free software: you can redistribute it and/or modify
+  * it under the terms of the GNU General Public License as published by
+  * the Free Software Foundation, either version 3 of the License, or
+  * (at your option) any later version.
+
+  * This program is distributed in the hope that it will be useful,
+  * but WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  * GNU General Public License for more details.
+
+  * You should have received a copy of the GNU General Public License
+  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+#include "InteractivePathAnalysis/client/TelegramBuffer.h"
+#include "gtest/gtest.h"
+
+using namespace FOEDAG;
+
+TEST(TelegramBuffer, LargeTelegramsRandomSplit)
+{
+    // Several MB telegrams with rubbish in between, received in chunks of
+    // random size as a TCP socket delivers them
+    std::mt19937 generator(42);
+    std::vector<comm::ByteArray> bodies;
+    comm::ByteArray stream;
+    for (std::size_t size : {4u << 20, 1u, 3u << 20, 8u << 20}) {
+        comm::ByteArray body(size);
+        body.resize(size);
+        for (auto& b : body) {
+            b = static_cast<uint8_t>(generator());
+        }
+        stream.append(comm::ByteArray{"#@!"});
+        stream.append(comm::TelegramHeader::constructFromBody(body).buffer());
+        stream.append(body);
+        bodies.push_back(std::move(body));
+    }
+
+    comm::TelegramBuffer tBuff;
+    std::vector<comm::TelegramFramePtr> frames;
+    std::uniform_int_distribution<std::size_t> chunkSize(1, 64 * 1024);
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t pos = 0; pos < stream.size();) {
+        std::size_t size = std::min(chunkSize(generator), stream.size() - pos);
+        tBuff.append(reinterpret_cast<const char*>(stream.data()) + pos, size);
+        tBuff.takeTelegramFrames(frames);
+        pos += size;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now() - start).count();
+    std::cout << "TelegramBuffer: " << stream.size() << " bytes in "
+              << elapsed << " us" << std::endl;
+
+    ASSERT_EQ(bodies.size(), frames.size());
+    for (std::size_t i = 0; i < bodies.size(); ++i) {
+        EXPECT_EQ(bodies[i].size(), frames[i]->header.bodyBytesNum());
+        EXPECT_TRUE(bodies[i] == frames[i]->body);
+    }
+}
@@ -25,6 +25,8 @@
 
 #include "InteractivePathAnalysis/client/TelegramBuffer.h"
 
+#include <random>
+
 #include "gtest/gtest.h"
 
 using namespace FOEDAG;
@@ -156,3 +158,123 @@ TEST(TelegramBuffer, Clear)
 
     EXPECT_EQ(comm::ByteArray{}, tBuff.data());
 }
+
+TEST(TelegramBuffer, ZeroCopyFrames)
+{
+    comm::TelegramBuffer tBuff;
+
+    const comm::ByteArray msgBody1{"message1"};
+    const comm::ByteArray msgBody2{"message2"};
+
+    comm::ByteArray t(comm::TelegramHeader::constructFromBody(msgBody1).buffer());
+    t.append(msgBody1);
+    t.append(comm::TelegramHeader::constructFromBody(msgBody2).buffer());
+    t.append(msgBody2);
+
+    std::vector<std::string> bodies;
+    for (std::size_t i = 0; i < t.size(); ++i) {
+        tBuff.append(reinterpret_cast<const char*>(t.data()) + i, 1);
+        tBuff.takeTelegramFrames([&bodies](const comm::TelegramHeader&, comm::ByteView body) {
+            bodies.push_back(body.to_string());
+        });
+    }
+    ASSERT_EQ(2, bodies.size());
+    EXPECT_EQ("message1", bodies[0]);
+    EXPECT_EQ("message2", bodies[1]);
+    EXPECT_TRUE(tBuff.empty());
+}
+
+TEST(TelegramBuffer, WrongCheckSum)
+{
+    comm::TelegramBuffer tBuff;
+
+    const comm::ByteArray msgBody{"message"};
+    comm::ByteArray t(comm::TelegramHeader{static_cast<uint32_t>(msgBody.size()), 1}.buffer());
+    t.append(msgBody);
+    tBuff.append(t);
+
+    EXPECT_EQ(0, tBuff.takeTelegramFrames().size());
+    std::vector<std::string> errors;
+    tBuff.takeErrors(errors);
+    EXPECT_EQ(1, errors.size());
+    EXPECT_TRUE(tBuff.empty());
+}
+
+TEST(TelegramBuffer, BodyChunkVisitorSeesEveryFrameStart)
+{
+    comm::TelegramBuffer tBuff;
+
+    const comm::ByteArray msgBody1{"message1"};
+    const comm::ByteArray msgBody2{"message2"};
+
+    // Dropped frame, empty frame and a regular one
+    comm::ByteArray t(comm::TelegramHeader{static_cast<uint32_t>(msgBody1.size()), 1}.buffer());
+    t.append(msgBody1);
+    t.append(comm::TelegramHeader::constructFromBody(comm::ByteArray{}).buffer());
+    t.append(comm::TelegramHeader::constructFromBody(msgBody2).buffer());
+    t.append(msgBody2);
+
+    std::vector<std::string> chunks;
+    tBuff.setBodyChunkVisitor([&chunks](const comm::TelegramHeader&, comm::ByteView chunk, bool firstChunk) {
+        if (firstChunk) {
+            chunks.emplace_back();
+        }
+        ASSERT_FALSE(chunks.empty());
+        chunks.back() += chunk.to_string();
+    });
+    std::vector<std::string> bodies;
+    for (std::size_t i = 0; i < t.size(); ++i) {
+        tBuff.append(reinterpret_cast<const char*>(t.data()) + i, 1);
+        tBuff.takeTelegramFrames([&bodies](const comm::TelegramHeader&, comm::ByteView body) {
+            bodies.push_back(body.to_string());
+        });
+    }
+    ASSERT_EQ(3, chunks.size());
+    EXPECT_EQ("message1", chunks[0]);
+    EXPECT_EQ("", chunks[1]);
+    EXPECT_EQ("message2", chunks[2]);
+    ASSERT_EQ(2, bodies.size());
+    EXPECT_EQ("", bodies[0]);
+    EXPECT_EQ("message2", bodies[1]);
+    EXPECT_TRUE(tBuff.empty());
+}
+
+TEST(TelegramBuffer, TelegramsRandomSplit)
+{
+    // Telegrams with rubbish in between, received in chunks of random size
+    // as a TCP socket delivers them. Chunks split both headers and bodies
+    std::mt19937 generator(42);
+    std::vector<comm::ByteArray> bodies;
+    comm::ByteArray stream;
+    for (std::size_t size : {40000u, 1u, 30000u, 80000u}) {
+        comm::ByteArray body(size);
+        body.resize(size);
+        for (auto& b : body) {
+            b = static_cast<uint8_t>(generator());
+        }
+        stream.append(comm::ByteArray{"#@!"});
+        stream.append(comm::TelegramHeader::constructFromBody(body).buffer());
+        stream.append(body);
+        bodies.push_back(std::move(body));
+    }
+
+    comm::TelegramBuffer tBuff;
+    std::vector<comm::TelegramFramePtr> frames;
+    std::uniform_int_distribution<std::size_t> chunkSize(1, 4096);
+    for (std::size_t pos = 0; pos < stream.size();) {
+        std::size_t size = std::min(chunkSize(generator), stream.size() - pos);
+        tBuff.append(reinterpret_cast<const char*>(stream.data()) + pos, size);
+        tBuff.takeTelegramFrames(frames);
+        pos += size;
+    }
+
+    ASSERT_EQ(bodies.size(), frames.size());
+    for (std::size_t i = 0; i < bodies.size(); ++i) {
+        EXPECT_EQ(bodies[i].size(), frames[i]->header.bodyBytesNum());
+        EXPECT_TRUE(bodies[i] == frames[i]->body);
+    }
+    std::vector<std::string> errors;
+    tBuff.takeErrors(errors);
+    EXPECT_TRUE(errors.empty());
+    EXPECT_TRUE(tBuff.empty());
+}
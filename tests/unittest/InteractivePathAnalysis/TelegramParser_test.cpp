@@ -66,4 +66,38 @@ TEST(TelegramParser, invalidTypes)
     EXPECT_EQ(std::nullopt, comm::TelegramParser::tryExtractFieldJobId(tBadData));
     EXPECT_EQ(std::nullopt, comm::TelegramParser::tryExtractFieldCmd(tBadData));
     EXPECT_EQ(std::nullopt, comm::TelegramParser::tryExtractFieldStatus(tBadData));
-}
\ No newline at end of file
+}
+
+TEST(TelegramParser, decodeResponse)
+{
+    const std::string tData{R"({"JOB_ID":"7","CMD":"0","OPTIONS":"a:b:c","DATA":"line1\nline2","STATUS":"1"})"};
+
+    comm::TelegramParser::Response response = comm::TelegramParser::decodeResponse(tData);
+    EXPECT_EQ(std::optional<int>{7}, response.jobId);
+    EXPECT_EQ(std::optional<int>{0}, response.cmd);
+    EXPECT_EQ(std::optional<int>{1}, response.status);
+    ASSERT_TRUE(response.data);
+    EXPECT_EQ("line1\\nline2", response.data.value());
+    // the data is a view into the message, not a copy
+    EXPECT_EQ(tData.data() + tData.find("line1"), response.data.value().data());
+}
+
+TEST(TelegramParser, decodeResponseInvalid)
+{
+    const std::string tBadKeys{R"({"_JOB_ID":"7","_CMD":"2","_DATA":"some_data...","_STATUS":"1"})"};
+    comm::TelegramParser::Response response = comm::TelegramParser::decodeResponse(tBadKeys);
+    EXPECT_EQ(std::nullopt, response.jobId);
+    EXPECT_EQ(std::nullopt, response.cmd);
+    EXPECT_EQ(std::nullopt, response.status);
+    EXPECT_EQ(std::nullopt, response.data);
+
+    const std::string tBadTypes{R"({"JOB_ID":"x","CMD":"2y","STATUS":"","DATA":"")"};
+    response = comm::TelegramParser::decodeResponse(tBadTypes);
+    EXPECT_EQ(std::nullopt, response.jobId);
+    EXPECT_EQ(std::nullopt, response.cmd);
+    EXPECT_EQ(std::nullopt, response.status);
+    EXPECT_EQ(std::optional<std::string_view>{""}, response.data);
+
+    EXPECT_EQ(std::nullopt, comm::TelegramParser::decodeResponse("").jobId);
+    EXPECT_EQ(std::nullopt, comm::TelegramParser::decodeResponse(R"({"JOB_ID")").jobId);
+}
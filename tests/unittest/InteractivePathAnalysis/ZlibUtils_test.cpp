@@ -25,6 +25,8 @@
 
 #include "InteractivePathAnalysis/client/ZlibUtils.h"
 
+#include <random>
+
 #include "gtest/gtest.h"
 
 using namespace FOEDAG;
@@ -46,3 +48,61 @@ TEST(ZlibUtils, compressionAndDecompression)
 
 
 
+
+TEST(ZlibUtils, codecLevelsAndReuse)
+{
+    std::string orig;
+    for (int i = 0; i < 100000; ++i) {
+        orig += "path " + std::to_string(i % 97) + "\n";
+    }
+
+    ZlibCodec codec{ZlibCodec::BEST_SPEED_LEVEL};
+    std::string fast;
+    EXPECT_TRUE(codec.compress(orig.data(), orig.size(), fast));
+    codec.setLevel(ZlibCodec::BEST_COMPRESSION_LEVEL);
+    std::string best;
+    EXPECT_TRUE(codec.compress(orig.data(), orig.size(), best));
+    EXPECT_LE(best.size(), fast.size());
+
+    for (const std::string& compressed : {fast, best}) {
+        std::string decompressed;
+        EXPECT_TRUE(codec.decompress(compressed.data(), compressed.size(), decompressed));
+        EXPECT_EQ(orig, decompressed);
+    }
+    EXPECT_EQ(2 * orig.size(), codec.decompressStat().outBytes);
+    EXPECT_EQ(2 * orig.size(), codec.compressStat().inBytes);
+}
+
+TEST(ZlibUtils, decompressInChunks)
+{
+    std::mt19937 generator(7);
+    std::string orig;
+    for (int i = 0; i < 200000; ++i) {
+        orig += static_cast<char>('a' + generator() % 4);
+    }
+    std::optional<std::string> compressedOpt = tryCompress(orig);
+    ASSERT_TRUE(compressedOpt);
+    const std::string& compressed = compressedOpt.value();
+
+    ZlibCodec codec;
+    // a tiny size hint forces the output to grow
+    codec.beginDecompress(compressed.size(), 1);
+    std::uniform_int_distribution<std::size_t> chunkSize(1, 1000);
+    for (std::size_t pos = 0; pos < compressed.size();) {
+        std::size_t size = std::min(chunkSize(generator), compressed.size() - pos);
+        EXPECT_FALSE(codec.decompressFinished());
+        EXPECT_TRUE(codec.decompressChunk(compressed.data() + pos, size));
+        pos += size;
+    }
+    EXPECT_TRUE(codec.decompressFinished());
+    EXPECT_EQ(orig, codec.takeDecompressed());
+}
+
+TEST(ZlibUtils, decompressInvalidData)
+{
+    EXPECT_FALSE(tryDecompress("not a zlib stream"));
+
+    std::string compressed = tryCompress("some data").value();
+    compressed.resize(compressed.size() - 2);
+    EXPECT_FALSE(tryDecompress(compressed));
+}
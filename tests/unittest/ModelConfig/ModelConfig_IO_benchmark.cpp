@@ -0,0 +1,164 @@
+/*
+Copyright 2026 The Foedag team
+
+GPL License
+
+Copyright (c) 2026 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <chrono>
+#include <fstream>
+
+#include "Configuration/ModelConfig/ModelConfig_IO.h"
+#include "compiler_tcl_infra_common.h"
+
+class ModelConfig_IO : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    compiler_tcl_common_setup();
+    create_unittest_directory("ModelConfig");
+    std::filesystem::current_path("utst/ModelConfig");
+  }
+  void TearDown() override { std::filesystem::current_path("../.."); }
+};
+
+TEST_F(ModelConfig_IO, validation_rules) {
+  std::string current_dir = COMPILER_TCL_COMMON_GET_CURRENT_DIR();
+  std::ifstream input(CFG_print("%s/apis/config_attributes.mapping.json",
+                                current_dir.c_str()));
+  nlohmann::json mapping = nlohmann::json::parse(input);
+  input.close();
+  std::map<std::string, std::string> init_args = {
+      {"__resources_string__", mapping["__resources__"].dump()}};
+  nlohmann::json& rules = mapping["__primary_validation__"];
+  std::vector<std::string> sequence = {"__pin_is_valid__",
+                                       "__check_pin_resource__"};
+  // Every pin is used twice, and the CC pins of HP_1 are misspelled
+  std::vector<std::string> banks = {"HP_1", "HP_2", "HR_1",
+                                    "HR_2", "HR_3", "HR_5"};
+  std::vector<std::string> locations;
+  for (uint32_t i = 0; i < 2 * 6 * 40; i++) {
+    uint32_t pin = (i / 6) % 40;
+    bool cc = pin == 18 || pin == 19 || pin == 38 || pin == 39;
+    locations.push_back(CFG_print("%s_%s%d_%d%c", banks[i % 6].c_str(),
+                                  cc && i % 6 ? "CC_" : "", pin, pin / 2,
+                                  pin % 2 ? 'N' : 'P'));
+  }
+  std::vector<bool> results[2];
+  uint64_t elapsed_us[2] = {0, 0};
+  for (uint32_t compiled = 0; compiled < 2; compiled++) {
+    CFG_Python_MGR python;
+    std::vector<std::string> init;
+    for (auto& e : mapping["__init__"]["__equation__"]) {
+      init.push_back(
+          FOEDAG::ModelConfig_IO_RULE::substitute((std::string)(e), init_args));
+    }
+    python.run(init, {});
+    std::vector<FOEDAG::ModelConfig_IO_RULE*> compiled_rules;
+    for (auto& seq : sequence) {
+      compiled_rules.push_back(
+          new FOEDAG::ModelConfig_IO_RULE(rules[seq]["__equation__"]));
+    }
+    auto begin = std::chrono::high_resolution_clock::now();
+    for (auto& location : locations) {
+      std::map<std::string, std::string> args = {{"__location0__", location}};
+      bool status = true;
+      for (size_t i = 0; i < compiled_rules.size() && status; i++) {
+        if (compiled) {
+          compiled_rules[i]->run(&python, args, {"pin_result"});
+        } else {
+          std::vector<std::string> equations;
+          for (auto& e : rules[sequence[i]]["__equation__"]) {
+            std::string equation = (std::string)(e);
+            equations.push_back(
+                FOEDAG::ModelConfig_IO_RULE::substitute(equation, args));
+          }
+          python.run(equations, {"pin_result"});
+        }
+        status = python.result_bool("pin_result");
+      }
+      results[compiled].push_back(status);
+    }
+    elapsed_us[compiled] =
+        (uint64_t)(std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::high_resolution_clock::now() - begin)
+                       .count());
+    while (compiled_rules.size()) {
+      delete compiled_rules.back();
+      compiled_rules.pop_back();
+    }
+  }
+  printf("Validate %ld locations: interpreted %ld us, compiled %ld us\n",
+         locations.size(), elapsed_us[0], elapsed_us[1]);
+  EXPECT_EQ(results[0], results[1]);
+  uint32_t passed = 0;
+  for (auto result : results[1]) {
+    passed += result ? 1 : 0;
+  }
+  // A pin only passes the first time it is used
+  EXPECT_EQ(passed, 6 * 40 - 4);
+}
+
+TEST_F(ModelConfig_IO, gen_ppdb_large_netlist) {
+  std::string current_dir = COMPILER_TCL_COMMON_GET_CURRENT_DIR();
+  // Synthetic netlist PPDB, pins wrap around so some of them are reused
+  nlohmann::json netlist = nlohmann::json::object();
+  netlist["messages"] = nlohmann::json::array();
+  netlist["instances"] = nlohmann::json::array();
+  for (uint32_t i = 0; i < 300; i++) {
+    std::string port = CFG_print("din%d", i);
+    uint32_t pin = i % 40;
+    bool cc = pin == 18 || pin == 19 || pin == 38 || pin == 39;
+    nlohmann::json instance = nlohmann::json::object();
+    instance["module"] = "I_BUF";
+    instance["name"] = CFG_print("$ibuf$top.$ibuf_%s", port.c_str());
+    instance["linked_object"] = port;
+    instance["linked_objects"][port]["location"] =
+        CFG_print("HR_%d_%s%d_%d%c", 1 + (i / 40) % 3, cc ? "CC_" : "", pin,
+                  pin / 2, pin % 2 ? 'N' : 'P');
+    instance["linked_objects"][port]["properties"] = nlohmann::json::object();
+    instance["connectivity"]["I"] = port;
+    instance["connectivity"]["O"] = CFG_print("$ibuf_%s", port.c_str());
+    instance["parameters"]["WEAK_KEEPER"] = "NONE";
+    instance["pre_primitive"] = "";
+    instance["post_primitives"] = nlohmann::json::array();
+    instance["route_clock_to"] = nlohmann::json::object();
+    instance["errors"] = nlohmann::json::array();
+    netlist["instances"].push_back(instance);
+  }
+  std::ofstream output("model_config_large_netlist.ppdb.json");
+  output << netlist.dump(2);
+  output.close();
+  std::string outputs[2] = {"model_config.large.interpreted.ppdb.json",
+                            "model_config.large.ppdb.json"};
+  for (uint32_t compiled = 0; compiled < 2; compiled++) {
+    std::string cmd = CFG_print(
+        "model_config gen_ppdb -netlist_ppdb "
+        "model_config_large_netlist.ppdb.json "
+        "-config_mapping %s/apis/config_attributes.mapping.json "
+        "-is_unittest %s %s",
+        current_dir.c_str(), compiled ? "" : "-interpret_rules",
+        outputs[compiled].c_str());
+    auto begin = std::chrono::high_resolution_clock::now();
+    compiler_tcl_common_run(cmd);
+    printf("gen_ppdb with %s rules: %ld ms\n",
+           compiled ? "compiled" : "interpreted",
+           (long)(std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::high_resolution_clock::now() - begin)
+                      .count()));
+  }
+  EXPECT_TRUE(CFG_compare_two_text_files(outputs[0], outputs[1]));
+}
@@ -21,6 +21,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "Configuration/ModelConfig/ModelConfig_IO.h"
 
+#include <fstream>
+
 #include "Utils/FileUtils.h"
 #include "compiler_tcl_infra_common.h"
 
@@ -107,6 +109,215 @@ TEST_F(ModelConfig_IO, allocate_resources) {
   }
 }
 
+TEST_F(ModelConfig_IO, allocate_resources_order) {
+  // Least fortunate instance decides first: B {0,1} takes resource 0 even
+  // though A {0,1,2} was added before it
+  std::vector<MODEL_RESOURCE_INSTANCE*> instances;
+  MODEL_RESOURCE_INSTANCE* new_resource =
+      new MODEL_RESOURCE_INSTANCE("a", 0x7, 4, 0);
+  EXPECT_EQ(FOEDAG::ModelConfig_IO::allocate_resource(instances, new_resource,
+                                                      false),
+            true);
+  new_resource = new MODEL_RESOURCE_INSTANCE("b", 0x3, 4, 1);
+  MODEL_RESOURCE_ALLOCATION allocation;
+  EXPECT_EQ(FOEDAG::ModelConfig_IO::allocate_resource(
+                instances, new_resource, false, &allocation),
+            true);
+  EXPECT_EQ(instances[0]->decision, 1);
+  EXPECT_EQ(instances[1]->decision, 0);
+  EXPECT_EQ(allocation.shifted, 1);
+  while (instances.size()) {
+    delete instances.back();
+    instances.pop_back();
+  }
+  // The greedy pass can't decide {0,3} {0,1,2} {0,1} {1,2}, the matching
+  // does
+  uint32_t masks[] = {0x9, 0x7, 0x3, 0x6};
+  for (uint32_t i = 0; i < 4; i++) {
+    new_resource = new MODEL_RESOURCE_INSTANCE("c", masks[i], 4, i);
+    EXPECT_EQ(FOEDAG::ModelConfig_IO::allocate_resource(instances,
+                                                        new_resource, false),
+              true);
+  }
+  EXPECT_EQ(instances[0]->decision, 3);
+  EXPECT_EQ(instances[1]->decision, 1);
+  EXPECT_EQ(instances[2]->decision, 0);
+  EXPECT_EQ(instances[3]->decision, 2);
+  while (instances.size()) {
+    delete instances.back();
+    instances.pop_back();
+  }
+}
+
+TEST_F(ModelConfig_IO, allocate_resources_beyond_32) {
+  // Instance i can use resource i or i + 1. The last instance can only use
+  // resource 0, so every previous decision has to shift by one.
+  const uint32_t total = 200;
+  std::vector<MODEL_RESOURCE_INSTANCE*> instances;
+  for (uint32_t i = 0; i < total - 1; i++) {
+    MODEL_RESOURCE_BITSET possible(total);
+    possible.set(i);
+    possible.set(i + 1);
+    MODEL_RESOURCE_INSTANCE* new_resource =
+        new MODEL_RESOURCE_INSTANCE("a", possible, i);
+    EXPECT_EQ(FOEDAG::ModelConfig_IO::allocate_resource(instances,
+                                                        new_resource, false),
+              true);
+  }
+  MODEL_RESOURCE_BITSET first(total);
+  first.set(0);
+  MODEL_RESOURCE_INSTANCE* new_resource =
+      new MODEL_RESOURCE_INSTANCE("b", first, total - 1);
+  MODEL_RESOURCE_ALLOCATION allocation;
+  EXPECT_EQ(FOEDAG::ModelConfig_IO::allocate_resource(
+                instances, new_resource, false, &allocation),
+            true);
+  EXPECT_EQ(allocation.shifted, total - 1);
+  EXPECT_EQ((uint32_t)(instances.size()), total);
+  for (uint32_t i = 0; i < total - 1; i++) {
+    EXPECT_EQ(instances[i]->decision, i + 1);
+  }
+  EXPECT_EQ(instances[total - 1]->decision, 0);
+
+  // Resources 0 to 5 are all taken by 6 instances, a 7th one fails and the
+  // conflict names the resources
+  MODEL_RESOURCE_BITSET fifth(total);
+  fifth.set(5);
+  new_resource = new MODEL_RESOURCE_INSTANCE("c", fifth, 5);
+  EXPECT_EQ(FOEDAG::ModelConfig_IO::allocate_resource(
+                instances, new_resource, false, &allocation),
+            false);
+  EXPECT_EQ(new_resource, nullptr);
+  EXPECT_NE(allocation.conflict.find("7 instance(s)"), std::string::npos);
+  EXPECT_NE(allocation.conflict.find("{0,1,2,3,4,5}"), std::string::npos);
+  EXPECT_EQ(instances[total - 1]->decision, 0);
+
+  // Full matching from scratch finds a decision for every instance
+  for (auto& instance : instances) {
+    instance->decision = 0;
+  }
+  EXPECT_EQ(FOEDAG::ModelConfig_IO::match_resources(instances, false),
+            (size_t)(total));
+  while (instances.size()) {
+    delete instances.back();
+    instances.pop_back();
+  }
+}
+
+TEST_F(ModelConfig_IO, validation_rules) {
+  std::string current_dir = COMPILER_TCL_COMMON_GET_CURRENT_DIR();
+  std::ifstream input(CFG_print("%s/apis/config_attributes.mapping.json",
+                                current_dir.c_str()));
+  nlohmann::json mapping = nlohmann::json::parse(input);
+  input.close();
+  std::map<std::string, std::string> init_args = {
+      {"__resources_string__", mapping["__resources__"].dump()}};
+  nlohmann::json& rules = mapping["__primary_validation__"];
+  std::vector<std::string> sequence = {"__pin_is_valid__",
+                                       "__check_pin_resource__"};
+  // Every pin is used twice, and the CC pins of HP_1 are misspelled
+  std::vector<std::string> banks = {"HP_1", "HP_2", "HR_1",
+                                    "HR_2", "HR_3", "HR_5"};
+  std::vector<std::string> locations;
+  for (uint32_t i = 0; i < 2 * 6 * 20; i++) {
+    uint32_t pin = (i / 6) % 20;
+    bool cc = pin == 18 || pin == 19;
+    locations.push_back(CFG_print("%s_%s%d_%d%c", banks[i % 6].c_str(),
+                                  cc && i % 6 ? "CC_" : "", pin, pin / 2,
+                                  pin % 2 ? 'N' : 'P'));
+  }
+  std::vector<bool> results[2];
+  for (uint32_t compiled = 0; compiled < 2; compiled++) {
+    CFG_Python_MGR python;
+    std::vector<std::string> init;
+    for (auto& e : mapping["__init__"]["__equation__"]) {
+      init.push_back(
+          FOEDAG::ModelConfig_IO_RULE::substitute((std::string)(e), init_args));
+    }
+    python.run(init, {});
+    std::vector<FOEDAG::ModelConfig_IO_RULE*> compiled_rules;
+    for (auto& seq : sequence) {
+      compiled_rules.push_back(
+          new FOEDAG::ModelConfig_IO_RULE(rules[seq]["__equation__"]));
+    }
+    for (auto& location : locations) {
+      std::map<std::string, std::string> args = {{"__location0__", location}};
+      bool status = true;
+      for (size_t i = 0; i < compiled_rules.size() && status; i++) {
+        if (compiled) {
+          compiled_rules[i]->run(&python, args, {"pin_result"});
+        } else {
+          std::vector<std::string> equations;
+          for (auto& e : rules[sequence[i]]["__equation__"]) {
+            std::string equation = (std::string)(e);
+            equations.push_back(
+                FOEDAG::ModelConfig_IO_RULE::substitute(equation, args));
+          }
+          python.run(equations, {"pin_result"});
+        }
+        status = python.result_bool("pin_result");
+      }
+      results[compiled].push_back(status);
+    }
+    while (compiled_rules.size()) {
+      delete compiled_rules.back();
+      compiled_rules.pop_back();
+    }
+  }
+  EXPECT_EQ(results[0], results[1]);
+  uint32_t passed = 0;
+  for (auto result : results[1]) {
+    passed += result ? 1 : 0;
+  }
+  // A pin only passes the first time it is used
+  EXPECT_EQ(passed, 6 * 20 - 2);
+}
+
+TEST_F(ModelConfig_IO, gen_ppdb_compiled_rules) {
+  std::string current_dir = COMPILER_TCL_COMMON_GET_CURRENT_DIR();
+  // Synthetic netlist PPDB, pins wrap around so some of them are reused
+  nlohmann::json netlist = nlohmann::json::object();
+  netlist["messages"] = nlohmann::json::array();
+  netlist["instances"] = nlohmann::json::array();
+  for (uint32_t i = 0; i < 160; i++) {
+    std::string port = CFG_print("din%d", i);
+    uint32_t pin = i % 40;
+    bool cc = pin == 18 || pin == 19 || pin == 38 || pin == 39;
+    nlohmann::json instance = nlohmann::json::object();
+    instance["module"] = "I_BUF";
+    instance["name"] = CFG_print("$ibuf$top.$ibuf_%s", port.c_str());
+    instance["linked_object"] = port;
+    instance["linked_objects"][port]["location"] =
+        CFG_print("HR_%d_%s%d_%d%c", 1 + (i / 40) % 3, cc ? "CC_" : "", pin,
+                  pin / 2, pin % 2 ? 'N' : 'P');
+    instance["linked_objects"][port]["properties"] = nlohmann::json::object();
+    instance["connectivity"]["I"] = port;
+    instance["connectivity"]["O"] = CFG_print("$ibuf_%s", port.c_str());
+    instance["parameters"]["WEAK_KEEPER"] = "NONE";
+    instance["pre_primitive"] = "";
+    instance["post_primitives"] = nlohmann::json::array();
+    instance["route_clock_to"] = nlohmann::json::object();
+    instance["errors"] = nlohmann::json::array();
+    netlist["instances"].push_back(instance);
+  }
+  std::ofstream output("model_config_rules_netlist.ppdb.json");
+  output << netlist.dump(2);
+  output.close();
+  std::string outputs[2] = {"model_config.rules.interpreted.ppdb.json",
+                            "model_config.rules.ppdb.json"};
+  for (uint32_t compiled = 0; compiled < 2; compiled++) {
+    std::string cmd = CFG_print(
+        "model_config gen_ppdb -netlist_ppdb "
+        "model_config_rules_netlist.ppdb.json "
+        "-config_mapping %s/apis/config_attributes.mapping.json "
+        "-is_unittest %s %s",
+        current_dir.c_str(), compiled ? "" : "-interpret_rules",
+        outputs[compiled].c_str());
+    compiler_tcl_common_run(cmd);
+  }
+  EXPECT_TRUE(CFG_compare_two_text_files(outputs[0], outputs[1]));
+}
+
 TEST_F(ModelConfig_IO, set_property) {
   compiler_tcl_common_run("clear_property");
   compiler_tcl_common_run(
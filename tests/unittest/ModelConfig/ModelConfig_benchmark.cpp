@@ -0,0 +1,82 @@
+/*
+Copyright 2026 The Foedag team
+
+GPL License
+
+Copyright (c) 2026 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <chrono>
+#include <fstream>
+
+#include "compiler_tcl_infra_common.h"
+
+class ModelConfig : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    compiler_tcl_common_setup();
+    create_unittest_directory("ModelConfig");
+    std::filesystem::current_path("utst/ModelConfig");
+  }
+  void TearDown() override { std::filesystem::current_path("../.."); }
+};
+
+TEST_F(ModelConfig, large_device_bitstream) {
+  // Synthetic device of 4096 blocks with four 8-bit attributes each, every
+  // block being configured by the design
+  const int count = 4096;
+  compiler_tcl_common_run("device_name LARGE_TOP");
+  compiler_tcl_common_run("define_block -name LARGE_SUB");
+  for (int i = 0; i < 4; i++) {
+    compiler_tcl_common_run(CFG_print(
+        "define_attr -block LARGE_SUB -name ATTR%d -addr %d -width 8", i,
+        i * 8));
+  }
+  compiler_tcl_common_run("define_block -name LARGE_TOP");
+  compiler_tcl_common_run(CFG_print(
+      "for {set i 0} {$i < %d} {incr i} { create_instance -block LARGE_SUB "
+      "-name SUB_$i -logic_address [expr {$i * 32}] -parent LARGE_TOP }",
+      count));
+  std::ofstream design("model_config_large_design.json");
+  design << "{\"instances\": [";
+  for (int i = 0; i < count; i++) {
+    design << (i ? "," : "")
+           << CFG_print(
+                  "{\"module\": \"SUB\", \"name\": \"SUB_%d\", "
+                  "\"location\": \"SUB_%d\", \"config_attributes\": "
+                  "{\"ATTR0\": \"%d\", \"ATTR1\": \"%d\"}}",
+                  i, i, i & 0xFF, i >> 8);
+  }
+  design << "]}";
+  design.close();
+
+  auto start = std::chrono::steady_clock::now();
+  compiler_tcl_common_run("model_config set_model -feature LARGE LARGE_TOP");
+  compiler_tcl_common_run(
+      "model_config set_design -feature LARGE model_config_large_design.json");
+  compiler_tcl_common_run(
+      "model_config write -feature LARGE -format WORD "
+      "model_config_large_word.txt");
+  compiler_tcl_common_run(
+      "model_config write -feature LARGE -format BIN "
+      "model_config_large_bin.bin");
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start);
+  printf("Large device bitstream: %d bits in %lld ms\n", count * 32,
+         (long long)(elapsed.count()));
+  EXPECT_EQ(std::filesystem::file_size("model_config_large_bin.bin"),
+            count * 4);
+}
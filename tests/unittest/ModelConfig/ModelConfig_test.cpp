@@ -19,6 +19,8 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <fstream>
+
 #include "compiler_tcl_infra_common.h"
 
 class ModelConfig : public ::testing::Test {
@@ -145,3 +147,58 @@ TEST_F(ModelConfig, compare_result) {
                         golden_dir);
   // CFG_INTERNAL_ERROR("stop");
 }
+
+TEST_F(ModelConfig, many_blocks_bitstream) {
+  // Synthetic device of 300 blocks with four 8-bit attributes each, every
+  // block being configured by the design. ATTR1 is set from block 256 on
+  const int count = 300;
+  compiler_tcl_common_run("device_name LARGE_TOP");
+  compiler_tcl_common_run("define_block -name LARGE_SUB");
+  for (int i = 0; i < 4; i++) {
+    compiler_tcl_common_run(CFG_print(
+        "define_attr -block LARGE_SUB -name ATTR%d -addr %d -width 8", i,
+        i * 8));
+  }
+  compiler_tcl_common_run("define_block -name LARGE_TOP");
+  compiler_tcl_common_run(CFG_print(
+      "for {set i 0} {$i < %d} {incr i} { create_instance -block LARGE_SUB "
+      "-name SUB_$i -logic_address [expr {$i * 32}] -parent LARGE_TOP }",
+      count));
+  std::ofstream design("model_config_large_design.json");
+  design << "{\"instances\": [";
+  for (int i = 0; i < count; i++) {
+    design << (i ? "," : "")
+           << CFG_print(
+                  "{\"module\": \"SUB\", \"name\": \"SUB_%d\", "
+                  "\"location\": \"SUB_%d\", \"config_attributes\": "
+                  "{\"ATTR0\": \"%d\", \"ATTR1\": \"%d\"}}",
+                  i, i, i & 0xFF, i >> 8);
+  }
+  design << "]}";
+  design.close();
+
+  compiler_tcl_common_run("model_config set_model -feature LARGE LARGE_TOP");
+  compiler_tcl_common_run(
+      "model_config set_design -feature LARGE model_config_large_design.json");
+  compiler_tcl_common_run(
+      "model_config write -feature LARGE -format WORD "
+      "model_config_large_word.txt");
+  compiler_tcl_common_run(
+      "model_config write -feature LARGE -format BIN "
+      "model_config_large_bin.bin");
+  // Word i holds ATTR0 = i & 0xFF and ATTR1 = i >> 8 of block i
+  std::ifstream words("model_config_large_word.txt");
+  std::string line;
+  int index = 0;
+  while (std::getline(words, line)) {
+    if (line.find("//") == 0) {
+      continue;
+    }
+    ASSERT_LT(index, count);
+    EXPECT_EQ(line, CFG_print("%08X", index));
+    index++;
+  }
+  EXPECT_EQ(index, count);
+  EXPECT_EQ(std::filesystem::file_size("model_config_large_bin.bin"),
+            count * 4);
+}
@@ -0,0 +1,77 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "NewProject/ProjectManager/DesignChangeJournal.h"
+
+#include "gtest/gtest.h"
+using namespace FOEDAG;
+
+TEST(DesignChangeJournal, Empty) {
+  DesignChangeJournal journal;
+  std::vector<DesignFileChange> changes;
+  EXPECT_EQ(journal.lastSequence(), 0);
+  EXPECT_TRUE(journal.changesSince(0, changes));
+  EXPECT_TRUE(changes.empty());
+}
+
+TEST(DesignChangeJournal, ChangesSince) {
+  DesignChangeJournal journal;
+  journal.record("top.v", DesignFileChange::Kind::Modified);
+  auto seq = journal.record("sub.v", DesignFileChange::Kind::Created);
+  journal.record("old.v", DesignFileChange::Kind::Removed);
+  EXPECT_EQ(journal.lastSequence(), 3);
+
+  std::vector<DesignFileChange> changes;
+  EXPECT_TRUE(journal.changesSince(seq, changes));
+  ASSERT_EQ(changes.size(), 1);
+  EXPECT_EQ(changes[0].path, "old.v");
+  EXPECT_EQ(changes[0].kind, DesignFileChange::Kind::Removed);
+  EXPECT_EQ(changes[0].sequence, 3);
+
+  EXPECT_TRUE(journal.changesSince(0, changes));
+  EXPECT_EQ(changes.size(), 3);
+  EXPECT_TRUE(journal.changesSince(journal.lastSequence(), changes));
+  EXPECT_TRUE(changes.empty());
+}
+
+TEST(DesignChangeJournal, DroppedChanges) {
+  DesignChangeJournal journal{2};
+  journal.record("a.v", DesignFileChange::Kind::Modified);
+  journal.record("b.v", DesignFileChange::Kind::Modified);
+  journal.record("c.v", DesignFileChange::Kind::Modified);
+
+  std::vector<DesignFileChange> changes;
+  EXPECT_FALSE(journal.changesSince(0, changes));
+  EXPECT_EQ(changes.size(), 2);
+  EXPECT_TRUE(journal.changesSince(1, changes));
+  ASSERT_EQ(changes.size(), 2);
+  EXPECT_EQ(changes[0].path, "b.v");
+}
+
+TEST(DesignChangeJournal, Clear) {
+  DesignChangeJournal journal;
+  journal.record("a.v", DesignFileChange::Kind::Modified);
+  journal.clear();
+  std::vector<DesignFileChange> changes;
+  EXPECT_FALSE(journal.changesSince(0, changes));
+  EXPECT_TRUE(journal.changesSince(1, changes));
+  EXPECT_EQ(journal.record("b.v", DesignFileChange::Kind::Listed), 2);
+}
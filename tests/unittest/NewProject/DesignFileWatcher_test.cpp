@@ -0,0 +1,74 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "NewProject/ProjectManager/DesignFileWatcher.h"
+
+#include <QSignalSpy>
+
+#include "gtest/gtest.h"
+using namespace FOEDAG;
+using Kind = DesignFileChange::Kind;
+
+TEST(DesignFileWatcher, BurstIsDebounced) {
+  DesignFileWatcher watcher;
+  watcher.init();
+  watcher.setDebounceInterval(20);
+  QSignalSpy changed{&watcher, &DesignFileWatcher::designFilesChanged};
+  watcher.fileChanged("top.v", Kind::Modified);
+  watcher.fileChanged("sub.v", Kind::Modified);
+  watcher.fileChanged("top.v", Kind::Modified);
+  EXPECT_TRUE(watcher.hasPendingChanges());
+  EXPECT_EQ(changed.count(), 0);
+  EXPECT_EQ(watcher.journal().lastSequence(), 0);
+
+  EXPECT_TRUE(changed.wait(1000));
+  EXPECT_EQ(changed.count(), 1);
+  EXPECT_FALSE(watcher.hasPendingChanges());
+  std::vector<DesignFileChange> changes;
+  EXPECT_TRUE(watcher.journal().changesSince(0, changes));
+  ASSERT_EQ(changes.size(), 2);
+  EXPECT_EQ(changes[0].path, "sub.v");
+  EXPECT_EQ(changes[1].path, "top.v");
+}
+
+TEST(DesignFileWatcher, ChangesCoalescedPerPath) {
+  DesignFileWatcher watcher;
+  watcher.init();
+  QSignalSpy changed{&watcher, &DesignFileWatcher::designFilesChanged};
+  // Save through a temporary file
+  watcher.fileChanged("top.v", Kind::Removed);
+  watcher.fileChanged("top.v", Kind::Created);
+  watcher.fileChanged("old.v", Kind::Modified);
+  watcher.fileChanged("old.v", Kind::Removed);
+  watcher.fileChanged("new.v", Kind::Created);
+  watcher.flushChanges();
+  EXPECT_EQ(changed.count(), 1);
+
+  std::vector<DesignFileChange> changes;
+  EXPECT_TRUE(watcher.journal().changesSince(0, changes));
+  ASSERT_EQ(changes.size(), 3);
+  EXPECT_EQ(changes[0].path, "new.v");
+  EXPECT_EQ(changes[0].kind, Kind::Created);
+  EXPECT_EQ(changes[1].path, "old.v");
+  EXPECT_EQ(changes[1].kind, Kind::Removed);
+  EXPECT_EQ(changes[2].path, "top.v");
+  EXPECT_EQ(changes[2].kind, Kind::Modified);
+}
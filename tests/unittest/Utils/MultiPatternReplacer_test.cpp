@@ -0,0 +1,93 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Utils/MultiPatternReplacer.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "Utils/FileUtils.h"
+#include "gtest/gtest.h"
+
+using namespace FOEDAG;
+
+TEST(MultiPatternReplacer, LongestMatchWins) {
+  MultiPatternReplacer replacer;
+  replacer.add("$ipad_data_1", "data[1]");
+  replacer.add("$ipad_data_10", "data[10]");
+  EXPECT_EQ(replacer.replace("$ipad_data_10 $ipad_data_1 $ipad_data_1x"),
+            "data[10] data[1] data[1]x");
+}
+
+TEST(MultiPatternReplacer, LeftmostMatchWins) {
+  MultiPatternReplacer replacer;
+  replacer.add("bc", "X");
+  replacer.add("abcd", "Y");
+  EXPECT_EQ(replacer.replace("abcd abc bcd"), "Y aX Xd");
+}
+
+TEST(MultiPatternReplacer, ReplacedTextIsNotRescanned) {
+  MultiPatternReplacer replacer;
+  replacer.add("a", "b");
+  replacer.add("b", "c");
+  EXPECT_EQ(replacer.replace("ab"), "bc");
+}
+
+TEST(MultiPatternReplacer, DuplicateAndEmptyPatterns) {
+  MultiPatternReplacer replacer;
+  EXPECT_TRUE(replacer.add("a", "1"));
+  EXPECT_FALSE(replacer.add("a", "2"));
+  EXPECT_FALSE(replacer.add("", "3"));
+  EXPECT_EQ(replacer.size(), 1u);
+  EXPECT_EQ(replacer.replace("aa"), "11");
+}
+
+TEST(MultiPatternReplacer, StreamChunksDontSplitMatches) {
+  MultiPatternReplacer replacer;
+  replacer.add("inner_net", "pio");
+  replacer.add("inner_net_2", "pio_2");
+  std::string text;
+  for (int i = 0; i < 100; i++) text += "inner_net inner_net_2 x\n";
+  const std::string expected = replacer.replace(text);
+  for (size_t chunk : {1, 3, 7, 64}) {
+    std::istringstream in{text};
+    std::ostringstream out;
+    EXPECT_EQ(replacer.replace(in, out, chunk), 200u);
+    EXPECT_EQ(out.str(), expected);
+  }
+}
+
+TEST(MultiPatternReplacer, ReplaceInFile) {
+  const std::filesystem::path file{"multi_pattern_test.rpt"};
+  FileUtils::WriteToFile(file, "clk_inner -> clk\n");
+  MultiPatternReplacer replacer;
+  replacer.add("clk_inner", "clk_pad");
+  size_t count{0};
+  EXPECT_TRUE(replacer.replaceInFile(file, &count));
+  EXPECT_EQ(count, 1u);
+  std::ifstream in{file};
+  std::string line;
+  std::getline(in, line);
+  EXPECT_EQ(line, "clk_pad -> clk");
+  EXPECT_FALSE(FileUtils::FileExists(file.string() + ".tmp"));
+  in.close();
+  FileUtils::removeFile(file);
+}
@@ -0,0 +1,67 @@
+/*
+Copyright 2024 The Foedag team
+
+GPL License
+
+Copyright (c) 2024 The Open-Source FPGA Foundation
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Utils/ProcessUtils.h"
+
+#include "gtest/gtest.h"
+
+#ifndef _WIN32
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char **environ;
+
+using namespace FOEDAG;
+
+static pid_t spawnShell(const char *script) {
+  pid_t pid{0};
+  const char *argv[] = {"sh", "-c", script, nullptr};
+  posix_spawnp(&pid, "sh", nullptr, nullptr, const_cast<char **>(argv),
+               environ);
+  return pid;
+}
+
+TEST(ProcessUtils, ProcessTreeStats) {
+  // memory is held by tail, a child of the monitored shell
+  pid_t pid = spawnShell(
+      "head -c 20000000 /dev/zero | tail -c 16000000 > /dev/null; "
+      "i=0; while [ $i -lt 20000 ]; do i=$((i+1)); done");
+  ASSERT_GT(pid, 0);
+  ProcessUtils utils;
+  utils.Frequency(5);
+  utils.Start(pid);
+  int status{0};
+  waitpid(pid, &status, 0);
+  utils.Stop();
+  const auto &stats = utils.Stats();
+  EXPECT_GE(utils.Utilization(), 16000u / 1024 * 1000);
+  EXPECT_GT(stats.userTime + stats.systemTime, 0u);
+  EXPECT_GT(stats.readBytes, 0u);
+  EXPECT_GT(stats.wallTime, 0u);
+}
+
+TEST(ProcessUtils, StopWithoutStart) {
+  ProcessUtils utils;
+  utils.Stop();
+  EXPECT_EQ(utils.Utilization(), 0u);
+  EXPECT_EQ(utils.Stats().wallTime, 0u);
+}
+#endif